@@ -12,6 +12,9 @@
 #define ASIO_STANDALONE
 #define ASIO_SEPARATE_COMPILATION
 
+#include "system/uuid.h"
+
+#include <cstdint>
 #include <iostream>
 
 #include <asio.hpp>
@@ -47,6 +50,120 @@ enum class InternetProtocol
 */
 std::ostream& operator<<(std::ostream& stream, InternetProtocol protocol);
 
+//! Shard policy
+/*!
+    Shard policy is used by sharded servers to select the shard
+    (Asio service) for a new accepted session.
+*/
+enum class ShardPolicy
+{
+    RoundRobin,         //!< Select shards one by one in a round-robin order
+    LeastLoaded,        //!< Select the shard with the least count of connected sessions
+    ReusePort           //!< Listen in each shard with its own SO_REUSEPORT acceptor and let the OS kernel distribute connections
+};
+
+//! Stream output: Shard policy
+/*!
+    \param stream - Output stream
+    \param policy - Shard policy
+    \return Output stream
+*/
+std::ostream& operator<<(std::ostream& stream, ShardPolicy policy);
+
+//! Id policy
+/*!
+    Id policy is used by servers and clients to generate identifiers of
+    new sessions and clients. Each session or client always gets a compact
+    64-bit key, the policy selects how the key and the UUID Id are made.
+*/
+enum class IdPolicy
+{
+    Sequential,         //!< Generate monotonic 64-bit keys and make UUID Ids from keys
+    ShardSequential,    //!< Generate monotonic 64-bit keys prefixed with the shard index and make UUID Ids from keys
+    UUID                //!< Generate monotonic 64-bit keys and random UUID Ids
+};
+
+//! Stream output: Id policy
+/*!
+    \param stream - Output stream
+    \param policy - Id policy
+    \return Output stream
+*/
+std::ostream& operator<<(std::ostream& stream, IdPolicy policy);
+
+//! Slow consumer policy
+/*!
+    Slow consumer policy is used by clients and sessions when the send
+    buffer reaches its high watermark or the server send buffer limit.
+*/
+enum class SlowConsumerPolicy
+{
+    Reject,             //!< Reject the new data to send
+    DropOldest,         //!< Queue the new data and drop the oldest pending data which is not being sent
+    Disconnect          //!< Reject the new data to send and disconnect
+};
+
+//! Stream output: Slow consumer policy
+/*!
+    \param stream - Output stream
+    \param policy - Slow consumer policy
+    \return Output stream
+*/
+std::ostream& operator<<(std::ostream& stream, SlowConsumerPolicy policy);
+
+//! Idle timeout
+/*!
+    Idle timeout is reported by servers when their session has not received
+    or sent any data for the configured time or lived for its total lifetime.
+*/
+enum class IdleTimeout
+{
+    Read,               //!< Session has not received any data for the read idle timeout
+    Write,              //!< Session has not sent any data for the write idle timeout
+    Lifetime            //!< Session has been connected for its total lifetime
+};
+
+//! Stream output: Idle timeout
+/*!
+    \param stream - Output stream
+    \param timeout - Idle timeout
+    \return Output stream
+*/
+std::ostream& operator<<(std::ostream& stream, IdleTimeout timeout);
+
+//! Shard prefix shift of the shard sequential keys
+const size_t SHARD_KEY_SHIFT = 48;
+
+//! Generate a new 64-bit key unique inside the process
+/*!
+    Thread-safe.
+
+    \return Monotonic 64-bit key
+*/
+uint64_t GenerateKey();
+
+//! Make UUID Id from the given 64-bit key
+/*!
+    Made UUID Id is as unique as the given key and is much cheaper than
+    a random UUID.
+
+    \param key - 64-bit key
+    \return UUID Id
+*/
+CppCommon::UUID MakeId(uint64_t key);
+
+#if defined(SO_REUSEPORT)
+//! Reuse port socket option
+/*!
+    Allows several sockets to be bound to the same address and port
+    (SO_REUSEPORT). The OS kernel balances incoming connections and
+    datagrams among such sockets.
+
+    Not available on platforms without SO_REUSEPORT support (e.g. Windows).
+*/
+typedef asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> ReusePort;
+#endif
+
 } // namespace Asio
 
 } // namespace CppServer
@@ -0,0 +1,190 @@
+/*!
+    \file buffer_pool.h
+    \brief Buffer pool definition
+    \author Ivan Shynkarenka
+    \date 25.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_BUFFER_POOL_H
+#define CPPSERVER_ASIO_BUFFER_POOL_H
+
+#include "asio.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CppServer {
+namespace Asio {
+
+//! Buffer pool
+/*!
+    Buffer pool is used by Asio services to lend receive buffers to their
+    clients and sessions. Buffers are grouped in power of two size classes
+    starting from the socket chunk size. Small size classes are carved from
+    slabs, so lots of connections do not fragment the heap. Large size
+    classes are allocated separately and only a few of them are cached, so
+    a single burst does not pin lots of memory.
+
+    Each slab keeps its own free buffers and buffers are lent from the slab
+    which got free buffers most recently. Slabs which become fully free are
+    returned to the heap once the size class already retains a few of them,
+    so the pool shrinks back after a burst of connections.
+
+    Buffers which are larger than the largest size class are allocated
+    and freed directly without pooling.
+
+    Thread-safe.
+*/
+class BufferPool
+{
+public:
+    //! Count of size classes
+    static const size_t CLASSES = 8;
+    //! Slab size
+    static const size_t SLAB = 256 * 1024;
+    //! Count of cached buffers of each size class which is not carved from slabs
+    static const size_t CACHED = 4;
+    //! Count of fully free slabs retained by each size class
+    static const size_t RETAINED = 2;
+
+    BufferPool();
+    BufferPool(const BufferPool&) = delete;
+    BufferPool(BufferPool&&) = delete;
+    ~BufferPool();
+
+    BufferPool& operator=(const BufferPool&) = delete;
+    BufferPool& operator=(BufferPool&&) = delete;
+
+    //! Get the count of bytes allocated by the pool
+    size_t allocated() const noexcept { return _allocated; }
+    //! Get the count of bytes lent by the pool
+    size_t borrowed() const noexcept { return _borrowed; }
+
+    //! Get the buffer size which will be acquired for the given requested size
+    /*!
+        \param size - Requested size
+        \return Size of the size class or the requested size if it is larger than the largest size class
+    */
+    static size_t Capacity(size_t size) noexcept;
+
+    //! Acquire a buffer of the given size
+    /*!
+        \param size - Buffer size (should be returned by Capacity() method)
+        \return Acquired buffer
+    */
+    uint8_t* Acquire(size_t size);
+    //! Release the given buffer
+    /*!
+        \param buffer - Buffer to release
+        \param size - Buffer size (the same as was acquired)
+    */
+    void Release(uint8_t* buffer, size_t size);
+
+private:
+    // Slab of a size class
+    struct Slab
+    {
+        std::unique_ptr<uint8_t[]> memory;
+        std::vector<uint8_t*> free;
+        size_t index;
+    };
+
+    // Size class
+    struct SizeClass
+    {
+        std::mutex lock;
+        // Cached buffers which are not carved from slabs
+        std::vector<uint8_t*> free;
+        // Slabs by their addresses, slabs with free buffers and count of fully free slabs
+        std::map<uint8_t*, Slab> slabs;
+        std::vector<Slab*> partial;
+        size_t empty = 0;
+    };
+
+    SizeClass _classes[CLASSES];
+    std::atomic<size_t> _allocated;
+    std::atomic<size_t> _borrowed;
+
+    //! Get the size class index of the given size
+    /*!
+        \return Size class index or CLASSES if the size is too large
+    */
+    static size_t Index(size_t size) noexcept;
+
+    //! Add the given slab to slabs with free buffers of the given size class
+    static void AddPartial(SizeClass& size_class, Slab& slab);
+    //! Remove the given slab from slabs with free buffers of the given size class
+    static void RemovePartial(SizeClass& size_class, Slab& slab);
+};
+
+//! Receive buffer
+/*!
+    Receive buffer is borrowed by a client or a session from the buffer
+    pool of its Asio service. The buffer grows twice after each full read
+    and shrinks back when a window of subsequent reads uses only a small
+    part of it. The buffer could be released into the pool between reads
+    so idle connections hold no receive memory.
+
+    Not thread-safe.
+*/
+class ReceiveBuffer
+{
+public:
+    //! Count of reads in the shrink window
+    static const size_t WINDOW = 16;
+
+    ReceiveBuffer() : _pool(nullptr), _data(nullptr), _size(0), _capacity(CHUNK), _peak(0), _reads(0) {}
+    ReceiveBuffer(const ReceiveBuffer&) = delete;
+    ReceiveBuffer(ReceiveBuffer&&) = delete;
+    ~ReceiveBuffer() { Release(); }
+
+    ReceiveBuffer& operator=(const ReceiveBuffer&) = delete;
+    ReceiveBuffer& operator=(ReceiveBuffer&&) = delete;
+
+    //! Get the buffer data
+    uint8_t* data() noexcept { return _data; }
+    //! Get the buffer size
+    size_t size() const noexcept { return _size; }
+    //! Get the buffer capacity which will be acquired next time
+    size_t capacity() const noexcept { return _capacity; }
+
+    //! Is the buffer empty (not acquired)?
+    bool empty() const noexcept { return (_data == nullptr); }
+
+    //! Acquire the buffer from the given pool
+    /*!
+        \param pool - Buffer pool
+    */
+    void Acquire(BufferPool& pool);
+    //! Release the buffer into its pool
+    void Release();
+
+    //! Update the buffer with the count of bytes received by the last read
+    /*!
+        The buffer will be grown or shrunk according to the given size.
+        Could be called only when the buffer is acquired.
+
+        \param size - Count of received bytes
+    */
+    void Update(size_t size);
+
+private:
+    BufferPool* _pool;
+    uint8_t* _data;
+    size_t _size;
+    size_t _capacity;
+    size_t _peak;
+    size_t _reads;
+
+    //! Reacquire the buffer with a new capacity
+    void Reacquire(size_t capacity);
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_BUFFER_POOL_H
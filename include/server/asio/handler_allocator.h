@@ -0,0 +1,164 @@
+/*!
+    \file handler_allocator.h
+    \brief Handler allocator definition
+    \author Ivan Shynkarenka
+    \date 06.04.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_HANDLER_ALLOCATOR_H
+#define CPPSERVER_ASIO_HANDLER_ALLOCATOR_H
+
+#include "asio.h"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace CppServer {
+namespace Asio {
+
+//! Handler storage
+/*!
+    Asio allocates an operation object with the completion handler for each
+    asynchronous operation. Handler storage keeps the memory block of a
+    single pending operation, so clients and sessions which never have more
+    than one pending operation of each kind (receive, send) recycle the same
+    memory block for all of them instead of the heap allocation per operation.
+    The block grows to the largest operation and is kept until the storage
+    is destroyed.
+
+    Operations which are started while the storage is in use are allocated
+    from the heap.
+
+    Not thread-safe.
+*/
+class HandlerStorage
+{
+public:
+    HandlerStorage() noexcept : _memory(nullptr), _size(0), _in_use(false) {}
+    HandlerStorage(const HandlerStorage&) = delete;
+    HandlerStorage(HandlerStorage&&) = delete;
+    ~HandlerStorage() { ::operator delete(_memory); }
+
+    HandlerStorage& operator=(const HandlerStorage&) = delete;
+    HandlerStorage& operator=(HandlerStorage&&) = delete;
+
+    //! Get the size of the recycled memory block
+    size_t size() const noexcept { return _size; }
+
+    //! Is the storage in use?
+    bool in_use() const noexcept { return _in_use; }
+
+    //! Allocate the memory for the operation of the given size
+    void* allocate(size_t size)
+    {
+        if (_in_use)
+            return ::operator new(size);
+
+        // Grow the memory block for the larger operation
+        if (size > _size)
+        {
+            ::operator delete(_memory);
+            _memory = nullptr;
+            _size = 0;
+            _memory = ::operator new(size);
+            _size = size;
+        }
+
+        _in_use = true;
+        return _memory;
+    }
+
+    //! Deallocate the memory of the operation
+    void deallocate(void* pointer) noexcept
+    {
+        if (pointer == _memory)
+            _in_use = false;
+        else
+            ::operator delete(pointer);
+    }
+
+private:
+    void* _memory;
+    size_t _size;
+    bool _in_use;
+};
+
+//! Handler allocator
+/*!
+    Standard allocator which allocates Asio operations from the handler storage.
+
+    Not thread-safe.
+*/
+template <typename T>
+class HandlerAllocator
+{
+    template <typename> friend class HandlerAllocator;
+
+public:
+    typedef T value_type;
+
+    explicit HandlerAllocator(HandlerStorage& storage) noexcept : _storage(storage) {}
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& allocator) noexcept : _storage(allocator._storage) {}
+
+    T* allocate(size_t n) const { return static_cast<T*>(_storage.allocate(sizeof(T) * n)); }
+    void deallocate(T* pointer, size_t n) const noexcept { _storage.deallocate(pointer); }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& allocator) const noexcept { return &_storage == &allocator._storage; }
+    template <typename U>
+    bool operator!=(const HandlerAllocator<U>& allocator) const noexcept { return &_storage != &allocator._storage; }
+
+private:
+    HandlerStorage& _storage;
+};
+
+//! Allocating handler
+/*!
+    Allocating handler wraps the completion handler and provides Asio with
+    the handler storage through the associated allocator and through the
+    handler allocation hooks, which are used by wrapped and composed handlers.
+
+    Not thread-safe.
+*/
+template <typename THandler>
+class AllocHandler
+{
+public:
+    typedef HandlerAllocator<THandler> allocator_type;
+
+    AllocHandler(HandlerStorage& storage, THandler handler) : _storage(storage), _handler(std::move(handler)) {}
+
+    //! Get the associated allocator
+    allocator_type get_allocator() const noexcept { return allocator_type(_storage); }
+
+    template <typename... Args>
+    void operator()(Args&&... args) { _handler(std::forward<Args>(args)...); }
+
+    friend void* asio_handler_allocate(size_t size, AllocHandler<THandler>* handler) { return handler->_storage.allocate(size); }
+    friend void asio_handler_deallocate(void* pointer, size_t size, AllocHandler<THandler>* handler) { handler->_storage.deallocate(pointer); }
+
+private:
+    HandlerStorage& _storage;
+    THandler _handler;
+};
+
+//! Wrap the given completion handler to allocate its operation from the given handler storage
+/*!
+    \param storage - Handler storage
+    \param handler - Completion handler
+    \return Allocating handler
+*/
+template <typename THandler>
+inline AllocHandler<typename std::decay<THandler>::type> MakeAllocHandler(HandlerStorage& storage, THandler&& handler)
+{
+    return AllocHandler<typename std::decay<THandler>::type>(storage, std::forward<THandler>(handler));
+}
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_HANDLER_ALLOCATOR_H
@@ -0,0 +1,126 @@
+/*!
+    \file message_framer.h
+    \brief Message framer definition
+    \author Ivan Shynkarenka
+    \date 26.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_MESSAGE_FRAMER_H
+#define CPPSERVER_ASIO_MESSAGE_FRAMER_H
+
+#include "errors/exceptions.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace CppServer {
+namespace Asio {
+
+//! Byte order
+enum class ByteOrder
+{
+    BigEndian,          //!< Big-endian (network) byte order
+    LittleEndian        //!< Little-endian byte order
+};
+
+//! Message framer
+/*!
+    Message framer is used by clients and sessions to split the received
+    stream into messages with a length prefix. Complete messages are parsed
+    in place from the receive buffer, only a message split between several
+    reads is copied into the framer tail buffer. Receive rings keep split
+    messages themselves, so they are parsed without copying at all.
+
+    Not thread-safe.
+*/
+class MessageFramer
+{
+public:
+    //! Default maximal message size
+    static const size_t MAX_SIZE = 16 * 1024 * 1024;
+    //! Maximal capacity of the tail buffer kept between split messages
+    static const size_t TAIL_CAPACITY = 64 * 1024;
+
+    MessageFramer() : _enabled(false), _prefix(4), _order(ByteOrder::BigEndian), _max_size(MAX_SIZE), _expected(0) {}
+    MessageFramer(const MessageFramer&) = delete;
+    MessageFramer(MessageFramer&&) = default;
+    ~MessageFramer() = default;
+
+    MessageFramer& operator=(const MessageFramer&) = delete;
+    MessageFramer& operator=(MessageFramer&&) = default;
+
+    //! Get the length prefix size
+    size_t prefix_size() const noexcept { return _prefix; }
+    //! Get the length prefix byte order
+    ByteOrder byte_order() const noexcept { return _order; }
+    //! Get the maximal message size
+    size_t max_size() const noexcept { return _max_size; }
+
+    //! Is the message framing enabled?
+    bool enabled() const noexcept { return _enabled; }
+
+    //! Setup the message framing
+    /*!
+        \param prefix_size - Length prefix size (1, 2, 4 or 8 bytes)
+        \param byte_order - Length prefix byte order
+        \param max_size - Maximal message size (should fit the length prefix size)
+    */
+    void Setup(size_t prefix_size, ByteOrder byte_order, size_t max_size);
+
+    //! Encode the length prefix of the message with the given size
+    /*!
+        \param size - Message size
+        \param buffer - Buffer to encode the length prefix into (should have at least 8 bytes)
+        \return Length prefix size or zero if the message is larger than the maximal message size
+    */
+    size_t Encode(size_t size, uint8_t* buffer) const noexcept;
+
+    //! Process the received data and call the handler for each complete message
+    /*!
+        \param buffer - Received data buffer
+        \param size - Received data size
+        \param handler - Message handler with (const uint8_t* message, size_t size) signature
+        \return 'true' if the data was successfully processed, 'false' if the message is larger than the maximal message size
+    */
+    template <typename THandler>
+    bool Process(const uint8_t* buffer, size_t size, THandler&& handler);
+    //! Parse complete messages in place and call the handler for each of them
+    /*!
+        Unlike Process() method the split message tail is not copied, so the
+        caller should keep the rest of the data and parse it again when more
+        data is received.
+
+        \param buffer - Received data buffer
+        \param size - Received data size
+        \param handler - Message handler with (const uint8_t* message, size_t size) signature
+        \param parsed - Count of parsed bytes
+        \return 'true' if the data was successfully parsed, 'false' if the message is larger than the maximal message size
+    */
+    template <typename THandler>
+    bool Parse(const uint8_t* buffer, size_t size, THandler&& handler, size_t& parsed);
+
+    //! Reset the framer and drop the split message tail
+    void Reset();
+
+private:
+    bool _enabled;
+    size_t _prefix;
+    ByteOrder _order;
+    size_t _max_size;
+    // Split message tail
+    std::vector<uint8_t> _tail;
+    size_t _expected;
+
+    //! Decode the length prefix from the given buffer
+    uint64_t Decode(const uint8_t* buffer) const noexcept;
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#include "message_framer.inl"
+
+#endif // CPPSERVER_ASIO_MESSAGE_FRAMER_H
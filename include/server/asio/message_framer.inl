@@ -0,0 +1,154 @@
+/*!
+    \file message_framer.inl
+    \brief Message framer inline implementation
+    \author Ivan Shynkarenka
+    \date 26.03.2017
+    \copyright MIT License
+*/
+
+namespace CppServer {
+namespace Asio {
+
+inline void MessageFramer::Setup(size_t prefix_size, ByteOrder byte_order, size_t max_size)
+{
+    assert(((prefix_size == 1) || (prefix_size == 2) || (prefix_size == 4) || (prefix_size == 8)) && "Length prefix size should be 1, 2, 4 or 8 bytes!");
+    if ((prefix_size != 1) && (prefix_size != 2) && (prefix_size != 4) && (prefix_size != 8))
+        throw CppCommon::ArgumentException("Length prefix size should be 1, 2, 4 or 8 bytes!");
+
+    assert((max_size > 0) && "Maximal message size should be greater than zero!");
+    if (max_size == 0)
+        throw CppCommon::ArgumentException("Maximal message size should be greater than zero!");
+
+    // Every accepted message size should be encodable with the length prefix
+    bool encodable = (prefix_size == 8) || (((uint64_t)max_size >> (8 * prefix_size)) == 0);
+    assert(encodable && "Maximal message size should fit the length prefix size!");
+    if (!encodable)
+        throw CppCommon::ArgumentException("Maximal message size should fit the length prefix size!");
+
+    _enabled = true;
+    _prefix = prefix_size;
+    _order = byte_order;
+    _max_size = max_size;
+    Reset();
+}
+
+inline size_t MessageFramer::Encode(size_t size, uint8_t* buffer) const noexcept
+{
+    // The maximal message size always fits the length prefix
+    if (size > _max_size)
+        return 0;
+
+    uint64_t value = size;
+    for (size_t i = 0; i < _prefix; ++i)
+    {
+        size_t index = (_order == ByteOrder::BigEndian) ? (_prefix - 1 - i) : i;
+        buffer[index] = (uint8_t)(value >> (8 * i));
+    }
+    return _prefix;
+}
+
+inline uint64_t MessageFramer::Decode(const uint8_t* buffer) const noexcept
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < _prefix; ++i)
+    {
+        size_t index = (_order == ByteOrder::BigEndian) ? (_prefix - 1 - i) : i;
+        value |= ((uint64_t)buffer[index]) << (8 * i);
+    }
+    return value;
+}
+
+template <typename THandler>
+inline bool MessageFramer::Process(const uint8_t* buffer, size_t size, THandler&& handler)
+{
+    // Complete the split message tail
+    if (!_tail.empty())
+    {
+        // Complete the length prefix
+        if (_tail.size() < _prefix)
+        {
+            size_t count = std::min(_prefix - _tail.size(), size);
+            _tail.insert(_tail.end(), buffer, buffer + count);
+            buffer += count;
+            size -= count;
+            if (_tail.size() < _prefix)
+                return true;
+
+            uint64_t length = Decode(_tail.data());
+            if (length > _max_size)
+                return false;
+            _expected = _prefix + (size_t)length;
+            _tail.reserve(_expected);
+        }
+
+        // Complete the message
+        size_t count = std::min(_expected - _tail.size(), size);
+        _tail.insert(_tail.end(), buffer, buffer + count);
+        buffer += count;
+        size -= count;
+        if (_tail.size() < _expected)
+            return true;
+
+        handler(_tail.data() + _prefix, _expected - _prefix);
+
+        // Do not keep the memory of large split messages
+        if (_tail.capacity() > TAIL_CAPACITY)
+            Reset();
+        else
+        {
+            _tail.clear();
+            _expected = 0;
+        }
+    }
+
+    // Parse complete messages in place
+    size_t parsed;
+    if (!Parse(buffer, size, handler, parsed))
+        return false;
+    buffer += parsed;
+    size -= parsed;
+
+    // Copy the split message tail
+    if (size > 0)
+    {
+        if (size >= _prefix)
+        {
+            // The message length was already checked by the parse loop
+            _expected = _prefix + (size_t)Decode(buffer);
+            _tail.reserve(_expected);
+        }
+        _tail.insert(_tail.end(), buffer, buffer + size);
+    }
+
+    return true;
+}
+
+template <typename THandler>
+inline bool MessageFramer::Parse(const uint8_t* buffer, size_t size, THandler&& handler, size_t& parsed)
+{
+    parsed = 0;
+
+    while ((size - parsed) >= _prefix)
+    {
+        uint64_t length = Decode(buffer + parsed);
+        if (length > _max_size)
+            return false;
+        if ((size - parsed - _prefix) < length)
+            break;
+
+        handler(buffer + parsed + _prefix, (size_t)length);
+        parsed += _prefix + (size_t)length;
+    }
+
+    return true;
+}
+
+inline void MessageFramer::Reset()
+{
+    _tail.clear();
+    _tail.shrink_to_fit();
+    _expected = 0;
+}
+
+} // namespace Asio
+} // namespace CppServer
@@ -0,0 +1,112 @@
+/*!
+    \file ring_buffer.h
+    \brief Ring buffer definition
+    \author Ivan Shynkarenka
+    \date 30.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_RING_BUFFER_H
+#define CPPSERVER_ASIO_RING_BUFFER_H
+
+#include "asio.h"
+
+#include <cstdint>
+
+namespace CppServer {
+namespace Asio {
+
+//! Ring buffer
+/*!
+    Ring buffer is used by clients and sessions to receive the stream data
+    without splitting it into separate reads. Received data is appended to
+    the free space of the ring and stays there until it is consumed, so
+    unconsumed data is always available as one contiguous span.
+
+    On Linux the ring memory is mapped twice into adjacent virtual memory
+    with memfd_create() and mmap(), so the data which wraps around the end
+    of the ring is contiguous without copying. On other platforms or if the
+    mapping fails the ring falls back to a linear buffer which moves the
+    unconsumed data to its beginning when the free space runs out.
+
+    The ring memory is mapped on the first use and released when the ring
+    buffer is destroyed or setup with another capacity.
+
+    Not thread-safe.
+*/
+class RingBuffer
+{
+public:
+    RingBuffer() noexcept : _buffer(nullptr), _capacity(0), _mirrored(false), _head(0), _size(0) {}
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer(RingBuffer&& buffer) noexcept;
+    ~RingBuffer() { Unmap(); }
+
+    RingBuffer& operator=(const RingBuffer&) = delete;
+    RingBuffer& operator=(RingBuffer&& buffer) noexcept;
+
+    //! Get the unconsumed data
+    uint8_t* data() noexcept { return _buffer + _head; }
+    //! Get the unconsumed data size
+    size_t size() const noexcept { return _size; }
+    //! Get the ring capacity
+    size_t capacity() const noexcept { return _capacity; }
+
+    //! Is the ring buffer enabled?
+    bool enabled() const noexcept { return (_capacity > 0); }
+    //! Is the ring memory mirrored?
+    bool mirrored() const noexcept { return _mirrored; }
+    //! Is the ring buffer empty?
+    bool empty() const noexcept { return (_size == 0); }
+    //! Is the ring buffer full?
+    bool full() const noexcept { return (_size == _capacity); }
+
+    //! Setup the ring capacity
+    /*!
+        Unconsumed data is dropped and the ring memory is released.
+
+        \param capacity - Ring capacity (rounded up to the memory page size, 0 to disable the ring)
+    */
+    void Setup(size_t capacity);
+
+    //! Prepare the free space of the ring to receive more data
+    /*!
+        Maps the ring memory if it is not mapped yet.
+
+        \return Contiguous free space of the ring (empty if the ring is full)
+    */
+    asio::mutable_buffer Prepare();
+    //! Commit the given count of bytes received into the prepared free space
+    /*!
+        \param size - Count of received bytes
+    */
+    void Commit(size_t size);
+    //! Consume the given count of bytes from the beginning of the unconsumed data
+    /*!
+        \param size - Count of bytes to consume
+    */
+    void Consume(size_t size);
+
+    //! Clear the ring buffer
+    /*!
+        Unconsumed data is dropped, but the ring memory is kept.
+    */
+    void Clear() noexcept { _head = 0; _size = 0; }
+
+private:
+    uint8_t* _buffer;
+    size_t _capacity;
+    bool _mirrored;
+    size_t _head;
+    size_t _size;
+
+    //! Map the ring memory
+    void Map();
+    //! Unmap the ring memory
+    void Unmap();
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_RING_BUFFER_H
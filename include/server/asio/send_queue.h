@@ -0,0 +1,280 @@
+/*!
+    \file send_queue.h
+    \brief Send queue definition
+    \author Ivan Shynkarenka
+    \date 21.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_SEND_QUEUE_H
+#define CPPSERVER_ASIO_SEND_QUEUE_H
+
+#include "shared_buffer.h"
+#include "shared_file.h"
+
+#include <atomic>
+#include <vector>
+
+namespace CppServer {
+namespace Asio {
+
+//! Const buffers view
+/*!
+    Const buffers view refers to the buffers sequence without copying it.
+    Asio copies buffer sequences into write operations, so writing the view
+    instead of the buffers vector saves the heap allocation per write.
+    Viewed buffers should stay unchanged until the write is completed.
+
+    Not thread-safe.
+*/
+class ConstBuffersView
+{
+public:
+    typedef asio::const_buffer value_type;
+    typedef const asio::const_buffer* const_iterator;
+
+    explicit ConstBuffersView(const std::vector<asio::const_buffer>& buffers) noexcept
+        : _begin(buffers.data()), _end(buffers.data() + buffers.size())
+    {}
+
+    const_iterator begin() const noexcept { return _begin; }
+    const_iterator end() const noexcept { return _end; }
+
+private:
+    const_iterator _begin;
+    const_iterator _end;
+};
+
+//! Send queue
+/*!
+    Send queue is used by clients and sessions to collect pending data
+    and write it into the socket with a single scatter/gather operation.
+
+    Producer threads push buffers into the lock-free multiple producers
+    single consumer list. The consumer (the thread which runs client or
+    session handlers) drains the list into the main part, which is moved
+    into the flush part for the next write operation. The consumer could
+    also push buffers directly into the main part bypassing the list.
+
+    Small buffers are copied and coalesced in the main part. Shared
+    buffers are queued by reference without copying. File regions are
+    queued by reference to the shared file and are never loaded into
+    the memory. The flush part contains either buffers or a single file
+    region, so file regions keep their order with buffers. The flush part
+    storage could be pinned to keep its buffers alive after they are
+    consumed (e.g. until the kernel completes a zero copy send).
+
+    Several send queues could share a total counter of pending bytes,
+    which is used by servers to limit the memory buffered by all their
+    sessions. File regions are not counted in the total counter.
+
+    Thread-safe for producers. Consumer methods should be called from
+    the single consumer thread (strand).
+*/
+class SendQueue
+{
+public:
+    SendQueue() : _head(nullptr), _size(0), _files(0), _total(nullptr), _flush_size(0), _flush_offset(0), _flush_file_offset(0) {}
+    SendQueue(const SendQueue&) = delete;
+    SendQueue(SendQueue&&) = delete;
+    ~SendQueue();
+
+    SendQueue& operator=(const SendQueue&) = delete;
+    SendQueue& operator=(SendQueue&&) = delete;
+
+    //! Get the count of pending bytes (queued and not yet written)
+    size_t size() const noexcept { return _size; }
+    //! Get the count of pending bytes held in the memory (not counting file regions)
+    size_t buffered() const noexcept { size_t size = _size; size_t files = _files; return (size > files) ? (size - files) : 0; }
+    //! Get the count of bytes not yet written from the flush part
+    size_t flush_size() const noexcept { return _flush_size - _flush_offset; }
+
+    //! Get the buffers sequence of the flush part
+    const std::vector<asio::const_buffer>& buffers() const noexcept { return _flush_buffers; }
+    //! Get the shared file of the flush part (invalid if the flush part contains buffers)
+    const SharedFile& file() const noexcept { return _flush_file; }
+    //! Get the offset of the not yet written file region of the flush part
+    uint64_t file_offset() const noexcept { return _flush_file_offset + _flush_offset; }
+
+    //! Is the send queue empty?
+    bool empty() const noexcept { return (_size == 0); }
+
+    //! Setup the total counter of pending bytes shared with other send queues
+    /*!
+        Should be setup before anything is pushed into the send queue.
+
+        \param total - Total counter of pending bytes (nullptr to disable)
+    */
+    void SetupTotal(std::atomic<size_t>* total) noexcept { _total = total; }
+
+    //! Push a copy of the given buffer from any producer thread
+    /*!
+        Buffers larger than a socket chunk are copied into their own
+        shared buffer so the coalescing storage does not grow with large
+        payloads.
+
+        \param buffer - Buffer to push
+        \param size - Buffer size
+        \return Count of pending bytes in the send queue
+    */
+    size_t Push(const void* buffer, size_t size);
+    //! Push the given shared buffer from any producer thread without copying
+    /*!
+        \param buffer - Shared buffer to push
+        \return Count of pending bytes in the send queue
+    */
+    size_t Push(const SharedBuffer& buffer);
+    //! Push the given file region from any producer thread
+    /*!
+        \param file - Shared file to push
+        \param offset - File region offset
+        \param size - File region size
+        \return Count of pending bytes in the send queue
+    */
+    size_t Push(const SharedFile& file, uint64_t offset, size_t size);
+
+    //! Push a copy of the given buffer from the consumer thread
+    /*!
+        \param buffer - Buffer to push
+        \param size - Buffer size
+        \return Count of pending bytes in the send queue
+    */
+    size_t PushDirect(const void* buffer, size_t size);
+    //! Push the given shared buffer from the consumer thread without copying
+    /*!
+        \param buffer - Shared buffer to push
+        \return Count of pending bytes in the send queue
+    */
+    size_t PushDirect(const SharedBuffer& buffer);
+    //! Push the given file region from the consumer thread
+    /*!
+        \param file - Shared file to push
+        \param offset - File region offset
+        \param size - File region size
+        \return Count of pending bytes in the send queue
+    */
+    size_t PushDirect(const SharedFile& file, uint64_t offset, size_t size);
+
+    //! Move the main part into the flush part if the flush part is empty
+    /*!
+        \return 'true' if the flush part has some data to write, 'false' if the send queue is empty
+    */
+    bool Flush();
+
+    //! Pin the storage of the flush part
+    /*!
+        The returned holder keeps all buffers of the flush part alive even
+        after they are consumed or the send queue is cleared. The same
+        holder is returned until the flush part is written completely.
+
+        \return Storage holder of the flush part
+    */
+    std::shared_ptr<const void> Pin();
+
+    //! Consume the given count of written bytes from the flush part
+    /*!
+        \param size - Count of written bytes
+        \return 'true' if the flush part was written completely, 'false' if some data is still pending
+    */
+    bool Consume(size_t size);
+
+    //! Drop the oldest pending buffers which are not being written
+    /*!
+        Buffers are dropped as a whole from the main part until the given
+        count of buffered bytes is dropped or the main part is empty. File
+        regions queued before dropped buffers are dropped too. The flush
+        part is never dropped, because it is being written into the socket.
+
+        Should be called from the consumer thread.
+
+        \param size - Count of bytes to drop
+        \return Count of dropped bytes (including file regions)
+    */
+    size_t Drop(size_t size);
+
+    //! Clear the send queue
+    /*!
+        \return Count of cleared pending bytes
+    */
+    size_t Clear();
+
+private:
+    // Producer node with copied bytes stored right after the node
+    struct Node
+    {
+        Node* next;
+        SharedBuffer shared;
+        SharedFile file;
+        uint64_t offset;
+        size_t size;
+
+        uint8_t* data() noexcept { return (uint8_t*)(this + 1); }
+    };
+
+    // Queued segment
+    struct Segment
+    {
+        size_t index;   // Index of the shared buffer, the file region or offset in the copied bytes
+        size_t size;    // Segment size
+        bool shared;    // Shared buffer flag
+        bool file;      // File region flag
+    };
+
+    // Queued file region
+    struct FileRegion
+    {
+        SharedFile file;
+        uint64_t offset;
+    };
+
+    // Pinned storage of the flush part
+    struct Pinned
+    {
+        std::vector<uint8_t> bytes;
+        std::vector<SharedBuffer> shared;
+    };
+
+    // Producers list
+    std::atomic<Node*> _head;
+    std::atomic<size_t> _size;
+    std::atomic<size_t> _files;
+    std::atomic<size_t>* _total;
+    // Main part
+    std::vector<uint8_t> _main_bytes;
+    std::vector<SharedBuffer> _main_shared;
+    std::vector<FileRegion> _main_files;
+    std::vector<Segment> _main_segments;
+    // Flush part
+    std::vector<uint8_t> _flush_bytes;
+    std::vector<SharedBuffer> _flush_shared;
+    std::vector<asio::const_buffer> _flush_buffers;
+    size_t _flush_size;
+    size_t _flush_offset;
+    SharedFile _flush_file;
+    uint64_t _flush_file_offset;
+    std::shared_ptr<const void> _flush_holder;
+
+    //! Increase the count of pending bytes
+    size_t Increase(size_t size, bool file = false);
+    //! Decrease the count of pending bytes
+    void Decrease(size_t size, bool file = false);
+
+    //! Link the given node into the producers list
+    void Link(Node* node);
+    //! Drain the producers list into the main part
+    void Drain();
+
+    //! Append a copy of the given buffer into the main part
+    void Append(const void* buffer, size_t size);
+    //! Append the given shared buffer into the main part
+    void Append(const SharedBuffer& buffer);
+    //! Append the given file region into the main part
+    void Append(const SharedFile& file, uint64_t offset, size_t size);
+    //! Remove the given count of the oldest segments from the main part
+    void Remove(size_t count);
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_SEND_QUEUE_H
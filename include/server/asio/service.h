@@ -9,14 +9,20 @@
 #ifndef CPPSERVER_ASIO_SERVICE_H
 #define CPPSERVER_ASIO_SERVICE_H
 
-#include "asio.h"
+#include "buffer_pool.h"
+#include "service_statistics.h"
+#include "timing_wheel.h"
+#include "zero_copy.h"
 
+#include "system/cpu.h"
 #include "threads/thread.h"
 
 #include <atomic>
 #include <cassert>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace CppServer {
 namespace Asio {
@@ -24,8 +30,47 @@ namespace Asio {
 //! Asio service
 /*!
     Asio service is used to host all clients/servers based on Asio C++ library.
-    It is implemented based on Asio C++ Library and use a separate thread to
-    perform all asynchronous IO operations and communications.
+    It is implemented based on Asio C++ Library and use one or several separate
+    threads to perform all asynchronous IO operations and communications.
+
+    If the service is started with several working threads all of them run
+    the same Asio service. In this case all clients, servers and sessions
+    serialize their handlers through their own strands.
+
+    Service instrumentation could be enabled to watch the health of the
+    service loop: busy and idle time of each working thread, run time of
+    handlers, count of handlers ready at once and loop lag of periodically
+    posted probe handlers. Instrumented threads run handlers one by one and
+    take a timestamp per handler. The thread CPU clock is sampled at most
+    once per millisecond of waiting, so the instrumentation is cheap enough
+    to be always enabled.
+
+    Polling mode keeps working threads busy all the time. Adaptive polling
+    mode spins only for the given budget after the last handler and then
+    blocks working threads until new handlers are ready, so the service
+    reacts fast under the load and does not burn CPU when it is idle.
+
+    Working threads could be pinned to CPU cores. Each pinned working thread
+    lends receive buffers from its own buffer pool, which is created and
+    filled by the thread itself. The operating system places memory pages
+    on the NUMA node of the thread which touches them first, so receive
+    buffers of pinned threads stay on their local NUMA node.
+
+    Only receive buffers are placed by the service itself. Session objects
+    are allocated by the thread which accepts them (the pinned shard thread
+    only with ShardPolicy::ReusePort), receive rings are allocated by the
+    session thread on the first receive and send buffers are allocated by
+    the thread which sends first. Pooled sessions keep the memory of their
+    first allocation.
+
+    Service timing wheel keeps coarse timers of all clients, servers and
+    sessions hosted by the service (e.g. idle timeouts) with O(1) arm,
+    re-arm and cancel instead of an Asio timer for each of them. The wheel
+    is ticked by a single Asio timer only while some timer is armed.
+
+    Zero copy sends of closed sockets linger in the service until the kernel
+    reports their completion, lingering sockets are polled with each tick of
+    the timing wheel.
 
     Thread-safe.
 
@@ -34,8 +79,20 @@ namespace Asio {
 class Service : public std::enable_shared_from_this<Service>
 {
 public:
+    //! CPU core set
+    /*!
+        Indexes of logical CPUs, so core sets are not limited by the count
+        of CPUs of the affinity mask. Windows logical CPU index is the number
+        of the processor group multiplied by 64 plus the processor number in
+        the group.
+    */
+    typedef std::vector<int> CPUSet;
+
     //! Initialize a new Asio service
-    Service();
+    /*!
+        \param threads - Working threads count (default is 1)
+    */
+    explicit Service(int threads = 1);
     //! Initialize Asio service with a given Asio service
     /*!
         \param service - Asio service
@@ -50,9 +107,135 @@ public:
 
     //! Get the Asio service
     std::shared_ptr<asio::io_service>& service() noexcept { return _service; }
+    //! Get the receive buffer pool
+    /*!
+        Pinned working threads get their local buffer pools. Other threads
+        get the shared buffer pool of the service.
+    */
+    BufferPool& buffer_pool() noexcept;
+
+    //! Get the working threads count
+    int threads() const noexcept { return _threads_count; }
+
+    //! Is the service instrumentation enabled?
+    bool instrumentation() const noexcept { return !_instruments.empty(); }
+    //! Get the loop lag probe interval in milliseconds
+    int probe_interval() const noexcept { return _probe_interval; }
+    //! Get the spin budget of the adaptive polling mode in microseconds
+    int spin_budget() const noexcept { return _spin_budget; }
+    //! Get the CPU affinity of working threads
+    const std::vector<CPUSet>& affinity() const noexcept { return _affinity; }
+    //! Get the timing wheel resolution in milliseconds
+    int timer_resolution() const noexcept { return _timer_resolution; }
+    //! Get the coarse time of the timing wheel in milliseconds
+    /*!
+        The time is counted from the service creation and is updated with
+        the timing wheel resolution while any timer is armed, so reading
+        it costs a single relaxed atomic load.
+    */
+    uint64_t timer_time() const noexcept { return _timer_time.load(std::memory_order_relaxed); }
+    //! Get the count of closed sockets with lingering zero copy sends
+    size_t zero_copy_lingering() const { return _zero_copy_linger.size(); }
+
+    //! Get the service statistics snapshot
+    /*!
+        Statistics are collected since the service start and are empty
+        if the service instrumentation is disabled.
+    */
+    ServiceStatistics statistics() const;
 
     //! Is the service started?
     bool IsStarted() const noexcept { return _started; }
+    //! Is the service required strand to serialize handlers?
+    /*!
+        Strand is required when the service runs its Asio service
+        in several working threads.
+    */
+    bool IsStrandRequired() const noexcept { return (_threads_count > 1); }
+    //! Is the current thread running the Asio service handlers?
+    bool IsServiceThread() noexcept { return _service->get_executor().running_in_this_thread(); }
+
+    //! Setup the service instrumentation
+    /*!
+        Should be called before the service is started.
+
+        Handlers run right after the idle wait are timed with the thread
+        CPU clock, because the wait and the handler could not be measured
+        separately. Such handler time does not include the time the handler
+        is blocked in the kernel.
+
+        \param enable - Enable the service instrumentation
+        \param probe_interval - Loop lag probe interval in milliseconds (default is 100, 0 to disable probes)
+    */
+    void SetupInstrumentation(bool enable, int probe_interval = 100);
+    //! Setup the adaptive polling mode
+    /*!
+        Should be called before the service is started in the polling mode.
+
+        Working threads poll handlers and call the idle handler until no
+        handlers are ready for the given spin budget. Then they block until
+        the next ready handler and start spinning again.
+
+        \param spin_budget - Spin budget in microseconds (0 to poll without blocking)
+    */
+    void SetupAdaptivePolling(int spin_budget);
+    //! Setup the CPU affinity of working threads
+    /*!
+        Should be called before the service is started.
+
+        Each working thread is pinned to the CPU core set with the same index
+        in the given affinity list. If there are less core sets than working
+        threads, core sets are assigned in round-robin order. Failed pinning
+        is reported with the error notification and the working thread keeps
+        running unpinned.
+
+        \param affinity - CPU core sets of working threads (empty to disable pinning)
+    */
+    void SetupAffinity(const std::vector<CPUSet>& affinity);
+    //! Setup the timing wheel resolution
+    /*!
+        Should be called before the service is started and before any timer
+        is armed.
+
+        \param resolution - Timing wheel tick in milliseconds (default is 100)
+    */
+    void SetupTimingWheel(int resolution = 100);
+
+    //! Arm or re-arm the given timer in the service timing wheel
+    /*!
+        The timer expires after the given timeout rounded up to the timing
+        wheel resolution. Its expiration handler is called from the service
+        thread under the timing wheel lock, so it should only post the actual
+        work and should not arm or cancel timers by itself. Armed timers
+        should be canceled before they are destroyed.
+
+        Thread-safe.
+
+        \param timer - Timer to arm
+        \param timeout - Timeout in milliseconds
+    */
+    void ArmTimer(TimingWheel::Timer& timer, uint64_t timeout);
+    //! Cancel the given timer in the service timing wheel
+    /*!
+        Thread-safe.
+
+        \param timer - Timer to cancel
+        \return 'true' if the timer was canceled, 'false' if the timer is not armed
+    */
+    bool CancelTimer(TimingWheel::Timer& timer);
+
+    //! Linger zero copy sends of the closing socket
+    /*!
+        Should be called before the socket is closed. Zero copy sends which
+        are still waiting for the kernel completion keep their buffers in the
+        service until the completion arrives.
+
+        Thread-safe.
+
+        \param zero_copy - Zero copy send of the socket
+        \param socket - Closing socket
+    */
+    void LingerZeroCopy(ZeroCopy& zero_copy, asio::ip::tcp::socket& socket);
 
     //! Start the service
     /*!
@@ -71,6 +254,32 @@ public:
     */
     bool Restart();
 
+    //! Get CPU core sets of all physical cores
+    /*!
+        Each core set contains all logical cores (hyper-threads) of a single
+        physical core, core sets are ordered by CPU packages. Linux topology
+        is read from sysfs and only logical cores allowed for the process
+        are returned. Windows topology is read from the processor core
+        relationship of all processor groups. If the topology is not
+        available (e.g. other platforms) each logical core gets its own
+        core set, so hyper-thread siblings are pinned as separate cores.
+
+        \return CPU core sets of all physical cores
+    */
+    static std::vector<CPUSet> PhysicalCores();
+
+    //! Create pinned Asio services for all physical cores
+    /*!
+        Each created service has a single working thread pinned to its own
+        physical core, so servers sharded over these services keep all their
+        connections and receive buffers local to the cores.
+
+        \param args - Arguments of the service constructor
+        \return Created Asio services
+    */
+    template <class TService = Service, typename... Args>
+    static std::vector<std::shared_ptr<TService>> CreatePinned(Args&&... args);
+
     //! Dispatch the given handler
     /*!
         The given handler may be executed immediately if this function is called from IO service thread.
@@ -98,11 +307,13 @@ protected:
     //! Initialize thread handler
     /*!
          This handler can be used to initialize priority or affinity of the service thread.
+         It is called once for each working thread.
     */
     virtual void onThreadInitialize() {}
     //! Cleanup thread handler
     /*!
          This handler can be used to cleanup priority or affinity of the service thread.
+         It is called once for each working thread.
     */
     virtual void onThreadCleanup() {}
 
@@ -125,11 +336,80 @@ protected:
 private:
     // Asio service
     std::shared_ptr<asio::io_service> _service;
-    std::thread _thread;
+    int _threads_count;
+    std::vector<std::thread> _threads;
     std::atomic<bool> _started;
+    // Receive buffer pool
+    std::shared_ptr<BufferPool> _buffer_pool;
+    // Service instrumentation
+    struct Instrument;
+    std::vector<std::shared_ptr<Instrument>> _instruments;
+    int _probe_interval;
+    std::shared_ptr<asio::steady_timer> _probe_timer;
+    // Adaptive polling mode
+    int _spin_budget;
+    // Working threads affinity and local buffer pools
+    std::vector<CPUSet> _affinity;
+    std::vector<std::shared_ptr<BufferPool>> _buffer_pools;
+    // Zero copy sends of closed sockets
+    ZeroCopyLinger _zero_copy_linger;
+    TimingWheel::Timer _zero_copy_timer;
+    // Timing wheel
+    std::mutex _timer_lock;
+    TimingWheel _timer_wheel;
+    int _timer_resolution;
+    std::atomic<uint64_t> _timer_time;
+    asio::steady_timer::time_point _timer_start;
+    std::shared_ptr<asio::steady_timer> _timer_ticker;
+    uint64_t _timer_chain;
+    bool _timer_ticking;
+    // Working thread of the current thread
+    struct WorkingThread
+    {
+        Service* service;
+        size_t index;
+    };
 
     //! Service loop
-    void ServiceLoop(bool polling);
+    /*!
+        \param polling - Polling loop mode
+        \param thread - Working thread index
+    */
+    void ServiceLoop(bool polling, size_t thread);
+    //! Wait for ready handlers and run all of them with the given instrument
+    /*!
+        Contiguous waits of the run loop sample the thread CPU clock once per
+        sampling interval and split the whole interval into busy and idle
+        time. Other waits sample the thread CPU clock around each wait.
+
+        \param instrument - Instrument of the service thread
+        \param contiguous - Is the wait called in a loop of waits?
+        \return Count of run handlers (0 if the service is stopped)
+    */
+    size_t WaitInstrumented(Instrument& instrument, bool contiguous);
+    //! Poll all ready handlers with the given instrument
+    /*!
+        \param instrument - Instrument of the service thread
+        \param depth - Count of handlers already run after the wake up (default is 0)
+        \return Count of polled handlers
+    */
+    size_t PollInstrumented(Instrument& instrument, size_t depth = 0);
+    //! Post the next loop lag probe
+    void Probe();
+    //! Get the current tick of the timing wheel clock
+    uint64_t TimerTick() const;
+    //! Start ticking the timing wheel (should be called under the timing wheel lock)
+    void StartTicking();
+    //! Schedule the next timing wheel tick of the given ticking chain (should be called under the timing wheel lock)
+    void ScheduleTick(uint64_t chain);
+    //! Advance the timing wheel with the given ticking chain
+    void Tick(uint64_t chain);
+    //! Poll lingering zero copy sends with each timing wheel tick
+    void PollZeroCopy();
+    //! Get the working thread of the current thread
+    static WorkingThread& CurrentThread() noexcept;
+    //! Pin the current thread to the given CPU core set
+    static std::error_code PinThread(const CPUSet& cores);
 
     //! Send error notification
     void SendError(std::error_code ec);
@@ -140,4 +420,6 @@ private:
 } // namespace Asio
 } // namespace CppServer
 
+#include "service.inl"
+
 #endif // CPPSERVER_ASIO_SERVICE_H
@@ -0,0 +1,26 @@
+/*!
+    \file service.inl
+    \brief Asio service inline implementation
+    \author Ivan Shynkarenka
+    \date 05.04.2017
+    \copyright MIT License
+*/
+
+namespace CppServer {
+namespace Asio {
+
+template <class TService, typename... Args>
+inline std::vector<std::shared_ptr<TService>> Service::CreatePinned(Args&&... args)
+{
+    std::vector<std::shared_ptr<TService>> services;
+    for (auto& core : PhysicalCores())
+    {
+        auto service = std::make_shared<TService>(args...);
+        service->SetupAffinity({ core });
+        services.emplace_back(service);
+    }
+    return services;
+}
+
+} // namespace Asio
+} // namespace CppServer
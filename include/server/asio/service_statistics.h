@@ -0,0 +1,244 @@
+/*!
+    \file service_statistics.h
+    \brief Asio service statistics definition
+    \author Ivan Shynkarenka
+    \date 04.04.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_SERVICE_STATISTICS_H
+#define CPPSERVER_ASIO_SERVICE_STATISTICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace CppServer {
+namespace Asio {
+
+//! Service histogram
+/*!
+    Log-linear histogram with 4 linear sub-buckets for each power of two.
+    Any value is kept with at most 25% relative error in a fixed 2 KB array,
+    so recording a value costs a single bit scan and an increment.
+
+    Not thread-safe.
+*/
+class ServiceHistogram
+{
+    friend class ServiceHistogramRecorder;
+
+public:
+    //! Count of sub-bucket bits
+    static const size_t SUB_BUCKET_BITS = 3;
+    //! Count of sub-buckets
+    static const uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+    //! Count of histogram buckets
+    static const size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * (SUB_BUCKET_COUNT / 2) + (SUB_BUCKET_COUNT / 2);
+
+    ServiceHistogram() noexcept : _counts(), _count(0), _sum(0), _max(0) {}
+
+    //! Get the count of recorded values
+    uint64_t count() const noexcept { return _count; }
+    //! Get the sum of recorded values
+    uint64_t sum() const noexcept { return _sum; }
+    //! Get the maximal recorded value
+    uint64_t max() const noexcept { return _max; }
+    //! Get the mean of recorded values
+    uint64_t mean() const noexcept { return (_count > 0) ? (_sum / _count) : 0; }
+
+    //! Get the value at the given percentile
+    /*!
+        \param percentile - Percentile in range [0, 100]
+        \return The highest value of the bucket with the given percentile (not greater than the maximal recorded value)
+    */
+    uint64_t Percentile(double percentile) const noexcept
+    {
+        if (_count == 0)
+            return 0;
+
+        uint64_t target = std::max((uint64_t)std::ceil(percentile * _count / 100.0), (uint64_t)1);
+        uint64_t total = 0;
+        for (size_t i = 0; i < BUCKETS; ++i)
+        {
+            total += _counts[i];
+            if (total >= target)
+                return std::min(Highest(i), _max);
+        }
+        return _max;
+    }
+
+    //! Record the given value
+    void Record(uint64_t value) noexcept
+    {
+        ++_counts[Index(value)];
+        ++_count;
+        _sum += value;
+        _max = std::max(_max, value);
+    }
+
+    ServiceHistogram& operator+=(const ServiceHistogram& histogram) noexcept
+    {
+        for (size_t i = 0; i < BUCKETS; ++i)
+            _counts[i] += histogram._counts[i];
+        _count += histogram._count;
+        _sum += histogram._sum;
+        _max = std::max(_max, histogram._max);
+        return *this;
+    }
+
+    //! Get the bucket index of the given value
+    static size_t Index(uint64_t value) noexcept
+    {
+        // Small values are recorded exactly, larger ones keep their most significant bits
+        if (value < SUB_BUCKET_COUNT)
+            return (size_t)value;
+
+        size_t shift = MostSignificantBit(value) - (SUB_BUCKET_BITS - 1);
+        return (size_t)(shift * (SUB_BUCKET_COUNT / 2) + (value >> shift));
+    }
+
+    //! Get the highest value of the given bucket
+    static uint64_t Highest(size_t index) noexcept
+    {
+        if (index < SUB_BUCKET_COUNT)
+            return index;
+
+        size_t shift = index / (SUB_BUCKET_COUNT / 2) - 1;
+        return ((index - shift * (SUB_BUCKET_COUNT / 2)) << shift) + ((1ull << shift) - 1);
+    }
+
+private:
+    uint64_t _counts[BUCKETS];
+    uint64_t _count;
+    uint64_t _sum;
+    uint64_t _max;
+
+    static size_t MostSignificantBit(uint64_t value) noexcept
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return (size_t)index;
+#else
+        return (size_t)(63 - __builtin_clzll(value));
+#endif
+    }
+};
+
+//! Service histogram recorder
+/*!
+    Service histogram recorder is updated by a single writer thread and
+    could be collected into the service histogram snapshot from any other
+    thread. Single writer updates are relaxed atomic loads and stores, so
+    they are not more expensive than updates of plain integers.
+
+    Thread-safe for a single writer.
+*/
+class ServiceHistogramRecorder
+{
+public:
+    ServiceHistogramRecorder() noexcept { Reset(); }
+    ServiceHistogramRecorder(const ServiceHistogramRecorder&) = delete;
+    ServiceHistogramRecorder(ServiceHistogramRecorder&&) = delete;
+    ~ServiceHistogramRecorder() = default;
+
+    ServiceHistogramRecorder& operator=(const ServiceHistogramRecorder&) = delete;
+    ServiceHistogramRecorder& operator=(ServiceHistogramRecorder&&) = delete;
+
+    //! Record the given value by the single writer
+    void Record(uint64_t value) noexcept
+    {
+        Increase(_counts[ServiceHistogram::Index(value)], 1);
+        Increase(_count, 1);
+        Increase(_sum, value);
+        if (value > _max.load(std::memory_order_relaxed))
+            _max.store(value, std::memory_order_relaxed);
+    }
+
+    //! Collect recorded values into the given histogram snapshot
+    void Collect(ServiceHistogram& histogram) const noexcept
+    {
+        for (size_t i = 0; i < ServiceHistogram::BUCKETS; ++i)
+            histogram._counts[i] += _counts[i].load(std::memory_order_relaxed);
+        histogram._count += _count.load(std::memory_order_relaxed);
+        histogram._sum += _sum.load(std::memory_order_relaxed);
+        histogram._max = std::max(histogram._max, _max.load(std::memory_order_relaxed));
+    }
+
+    //! Reset recorded values
+    void Reset() noexcept
+    {
+        for (auto& count : _counts)
+            count.store(0, std::memory_order_relaxed);
+        _count.store(0, std::memory_order_relaxed);
+        _sum.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> _counts[ServiceHistogram::BUCKETS];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _max;
+
+    static void Increase(std::atomic<uint64_t>& counter, uint64_t value) noexcept
+    { counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+};
+
+//! Service thread statistics snapshot
+struct ServiceThreadStatistics
+{
+    //! Time spent running handlers (in nanoseconds)
+    uint64_t busy_time;
+    //! Time spent waiting for handlers (in nanoseconds)
+    uint64_t idle_time;
+    //! Handlers run time (in nanoseconds)
+    /*!
+        The first handler after the service thread wakes up is timed only
+        when the thread CPU clock is sampled, other handlers are timed all.
+    */
+    ServiceHistogram handler_time;
+    //! Count of handlers run at once after the service thread wakes up
+    ServiceHistogram queue_depth;
+    //! Loop lag of probe handlers from post to execution (in nanoseconds)
+    ServiceHistogram loop_lag;
+
+    ServiceThreadStatistics() noexcept : busy_time(0), idle_time(0) {}
+
+    //! Get the count of run handlers
+    uint64_t handlers() const noexcept { return queue_depth.sum(); }
+    //! Get the busy time ratio in range [0, 1]
+    double utilization() const noexcept { return ((busy_time + idle_time) > 0) ? ((double)busy_time / (busy_time + idle_time)) : 0.0; }
+
+    ServiceThreadStatistics& operator+=(const ServiceThreadStatistics& statistics) noexcept
+    {
+        busy_time += statistics.busy_time;
+        idle_time += statistics.idle_time;
+        handler_time += statistics.handler_time;
+        queue_depth += statistics.queue_depth;
+        loop_lag += statistics.loop_lag;
+        return *this;
+    }
+};
+
+//! Service statistics snapshot
+struct ServiceStatistics
+{
+    //! Statistics of all working threads
+    ServiceThreadStatistics total;
+    //! Statistics of each working thread
+    std::vector<ServiceThreadStatistics> threads;
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_SERVICE_STATISTICS_H
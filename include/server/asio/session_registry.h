@@ -0,0 +1,111 @@
+/*!
+    \file session_registry.h
+    \brief Session registry definition
+    \author Ivan Shynkarenka
+    \date 23.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_SESSION_REGISTRY_H
+#define CPPSERVER_ASIO_SESSION_REGISTRY_H
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace CppServer {
+namespace Asio {
+
+//! Session registry
+/*!
+    Session registry is used by servers to keep connected sessions by their
+    compact 64-bit keys. Sessions are stored in a dense array, so iteration
+    over all sessions (e.g. for multicast) is cache-friendly. The key index
+    is an open-addressing hash table with linear probing, so insert, find
+    and erase operations take O(1) time without node allocations.
+
+    The key value 0 is reserved and could not be used as a session key.
+
+    Not thread-safe.
+*/
+template <class TSession>
+class SessionRegistry
+{
+public:
+    typedef typename std::vector<std::shared_ptr<TSession>>::iterator iterator;
+    typedef typename std::vector<std::shared_ptr<TSession>>::const_iterator const_iterator;
+
+    SessionRegistry() : _mask(0) {}
+    SessionRegistry(const SessionRegistry&) = delete;
+    SessionRegistry(SessionRegistry&&) = default;
+    ~SessionRegistry() = default;
+
+    SessionRegistry& operator=(const SessionRegistry&) = delete;
+    SessionRegistry& operator=(SessionRegistry&&) = default;
+
+    //! Get the count of registered sessions
+    size_t size() const noexcept { return _sessions.size(); }
+    //! Is the registry empty?
+    bool empty() const noexcept { return _sessions.empty(); }
+
+    //! Get the begin iterator of registered sessions
+    iterator begin() noexcept { return _sessions.begin(); }
+    const_iterator begin() const noexcept { return _sessions.begin(); }
+    //! Get the end iterator of registered sessions
+    iterator end() noexcept { return _sessions.end(); }
+    const_iterator end() const noexcept { return _sessions.end(); }
+
+    //! Insert the session with the given key
+    /*!
+        \param key - Session key
+        \param session - Session to insert
+        \return 'true' if the session was successfully inserted, 'false' if the session with the same key is already registered
+    */
+    bool Insert(uint64_t key, const std::shared_ptr<TSession>& session);
+    //! Find the session with the given key
+    /*!
+        \param key - Session key
+        \return Session with the given key or 'nullptr' if the session is not registered
+    */
+    std::shared_ptr<TSession> Find(uint64_t key) const;
+    //! Erase the session with the given key
+    /*!
+        \param key - Session key
+        \return Erased session or 'nullptr' if the session is not registered
+    */
+    std::shared_ptr<TSession> Erase(uint64_t key);
+
+    //! Clear the registry
+    void Clear();
+
+private:
+    // Key index slot
+    struct Slot
+    {
+        uint64_t key;   // Session key (0 for the empty slot)
+        size_t index;   // Session index in the dense array
+    };
+
+    std::vector<Slot> _slots;
+    size_t _mask;
+    std::vector<std::shared_ptr<TSession>> _sessions;
+    std::vector<uint64_t> _keys;
+
+    //! Get the home slot of the given key
+    size_t Home(uint64_t key) const noexcept;
+    //! Find the slot of the given key
+    /*!
+        \return Slot index or the capacity of the key index if the key is not found
+    */
+    size_t Lookup(uint64_t key) const noexcept;
+    //! Rebuild the key index with the given capacity
+    void Rehash(size_t capacity);
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#include "session_registry.inl"
+
+#endif // CPPSERVER_ASIO_SESSION_REGISTRY_H
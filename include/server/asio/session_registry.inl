@@ -0,0 +1,145 @@
+/*!
+    \file session_registry.inl
+    \brief Session registry inline implementation
+    \author Ivan Shynkarenka
+    \date 23.03.2017
+    \copyright MIT License
+*/
+
+namespace CppServer {
+namespace Asio {
+
+template <class TSession>
+inline bool SessionRegistry<TSession>::Insert(uint64_t key, const std::shared_ptr<TSession>& session)
+{
+    assert((key != 0) && "Session key should not be equal to zero!");
+    if (key == 0)
+        return false;
+
+    // Keep the key index load factor not greater than 1/2
+    if (((_sessions.size() + 1) * 2) > _slots.size())
+        Rehash(_slots.empty() ? 16 : (_slots.size() * 2));
+
+    // Find an empty slot
+    size_t slot = Home(key);
+    while (_slots[slot].key != 0)
+    {
+        if (_slots[slot].key == key)
+            return false;
+        slot = (slot + 1) & _mask;
+    }
+
+    // Append the session into the dense array
+    _slots[slot].key = key;
+    _slots[slot].index = _sessions.size();
+    _sessions.push_back(session);
+    _keys.push_back(key);
+
+    return true;
+}
+
+template <class TSession>
+inline std::shared_ptr<TSession> SessionRegistry<TSession>::Find(uint64_t key) const
+{
+    size_t slot = Lookup(key);
+    if (slot == _slots.size())
+        return nullptr;
+
+    return _sessions[_slots[slot].index];
+}
+
+template <class TSession>
+inline std::shared_ptr<TSession> SessionRegistry<TSession>::Erase(uint64_t key)
+{
+    size_t slot = Lookup(key);
+    if (slot == _slots.size())
+        return nullptr;
+
+    size_t index = _slots[slot].index;
+    std::shared_ptr<TSession> result = std::move(_sessions[index]);
+
+    // Move the last session into the erased place of the dense array
+    size_t last = _sessions.size() - 1;
+    if (index != last)
+    {
+        _sessions[index] = std::move(_sessions[last]);
+        _keys[index] = _keys[last];
+        _slots[Lookup(_keys[index])].index = index;
+    }
+    _sessions.pop_back();
+    _keys.pop_back();
+
+    // Erase the slot with backward shift of the following probe sequence
+    size_t hole = slot;
+    size_t next = (hole + 1) & _mask;
+    while (_slots[next].key != 0)
+    {
+        size_t home = Home(_slots[next].key);
+        // Shift the slot if its home is not inside the (hole, next] range
+        if (((next - home) & _mask) >= ((next - hole) & _mask))
+        {
+            _slots[hole] = _slots[next];
+            hole = next;
+        }
+        next = (next + 1) & _mask;
+    }
+    _slots[hole].key = 0;
+
+    return result;
+}
+
+template <class TSession>
+inline void SessionRegistry<TSession>::Clear()
+{
+    _slots.clear();
+    _mask = 0;
+    _sessions.clear();
+    _keys.clear();
+}
+
+template <class TSession>
+inline size_t SessionRegistry<TSession>::Home(uint64_t key) const noexcept
+{
+    // Mix key bits to spread sequential keys over the key index
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDull;
+    key ^= key >> 33;
+    return (size_t)key & _mask;
+}
+
+template <class TSession>
+inline size_t SessionRegistry<TSession>::Lookup(uint64_t key) const noexcept
+{
+    if (_slots.empty() || (key == 0))
+        return _slots.size();
+
+    size_t slot = Home(key);
+    while (_slots[slot].key != 0)
+    {
+        if (_slots[slot].key == key)
+            return slot;
+        slot = (slot + 1) & _mask;
+    }
+
+    return _slots.size();
+}
+
+template <class TSession>
+inline void SessionRegistry<TSession>::Rehash(size_t capacity)
+{
+    _slots.assign(capacity, Slot{ 0, 0 });
+    _mask = capacity - 1;
+
+    // Reinsert all keys into the new key index
+    for (size_t i = 0; i < _keys.size(); ++i)
+    {
+        size_t slot = Home(_keys[i]);
+        while (_slots[slot].key != 0)
+            slot = (slot + 1) & _mask;
+        _slots[slot].key = _keys[i];
+        _slots[slot].index = i;
+    }
+}
+
+} // namespace Asio
+} // namespace CppServer
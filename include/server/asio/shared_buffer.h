@@ -0,0 +1,105 @@
+/*!
+    \file shared_buffer.h
+    \brief Shared buffer definition
+    \author Ivan Shynkarenka
+    \date 21.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_SHARED_BUFFER_H
+#define CPPSERVER_ASIO_SHARED_BUFFER_H
+
+#include "asio.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace CppServer {
+namespace Asio {
+
+//! Shared buffer
+/*!
+    Shared buffer is a reference-counted immutable byte range. Copies of
+    the shared buffer share the same storage, so the same payload could be
+    queued into many clients and sessions without copying. The storage is
+    released when the last copy of the shared buffer is destroyed.
+
+    Thread-safe.
+*/
+class SharedBuffer
+{
+public:
+    //! Initialize an empty shared buffer
+    SharedBuffer() noexcept : _data(nullptr), _size(0) {}
+    //! Initialize shared buffer with a copy of the given buffer
+    /*!
+        \param buffer - Buffer to copy
+        \param size - Buffer size
+    */
+    explicit SharedBuffer(const void* buffer, size_t size);
+    //! Initialize shared buffer with a copy of the given text string
+    /*!
+        \param text - Text string to copy
+    */
+    explicit SharedBuffer(const std::string& text) : SharedBuffer(text.data(), text.size()) {}
+    //! Initialize shared buffer by taking the ownership of the given bytes vector
+    /*!
+        \param bytes - Bytes vector to take
+    */
+    explicit SharedBuffer(std::vector<uint8_t>&& bytes);
+    //! Initialize shared buffer by taking the ownership of the given text string
+    /*!
+        \param text - Text string to take
+    */
+    explicit SharedBuffer(std::string&& text);
+    //! Initialize shared buffer with an external storage
+    /*!
+        The shared buffer keeps the given storage holder alive while
+        the buffer or any of its copies are in use.
+
+        \param holder - Storage holder
+        \param buffer - Buffer inside the storage
+        \param size - Buffer size
+    */
+    explicit SharedBuffer(std::shared_ptr<const void> holder, const void* buffer, size_t size);
+    SharedBuffer(const SharedBuffer&) = default;
+    SharedBuffer(SharedBuffer&&) noexcept = default;
+    ~SharedBuffer() = default;
+
+    SharedBuffer& operator=(const SharedBuffer&) = default;
+    SharedBuffer& operator=(SharedBuffer&&) noexcept = default;
+
+    //! Check if the shared buffer is not empty
+    explicit operator bool() const noexcept { return !empty(); }
+
+    //! Get the shared buffer data
+    const uint8_t* data() const noexcept { return _data; }
+    //! Get the shared buffer size
+    size_t size() const noexcept { return _size; }
+    //! Is the shared buffer empty?
+    bool empty() const noexcept { return (_size == 0); }
+
+    //! Get Asio buffer of the shared buffer
+    asio::const_buffer buffer() const noexcept { return asio::const_buffer(_data, _size); }
+
+    //! Get the slice of the shared buffer
+    /*!
+        The slice shares the same storage with the shared buffer.
+
+        \param offset - Slice offset
+        \param size - Slice size
+        \return Slice of the shared buffer
+    */
+    SharedBuffer Slice(size_t offset, size_t size) const;
+
+private:
+    std::shared_ptr<const void> _holder;
+    const uint8_t* _data;
+    size_t _size;
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_SHARED_BUFFER_H
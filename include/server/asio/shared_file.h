@@ -0,0 +1,95 @@
+/*!
+    \file shared_file.h
+    \brief Shared file definition
+    \author Ivan Shynkarenka
+    \date 28.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_SHARED_FILE_H
+#define CPPSERVER_ASIO_SHARED_FILE_H
+
+#include "asio.h"
+
+#include <memory>
+#include <string>
+
+namespace CppServer {
+namespace Asio {
+
+//! Shared file
+/*!
+    Shared file is a reference-counted read-only file descriptor. Copies
+    of the shared file share the same descriptor, so the same file could
+    be queued into many clients and sessions. The descriptor is closed
+    when the last copy of the shared file is destroyed.
+
+    File regions are written into sockets directly from the page cache
+    with sendfile(2) on Linux. Other platforms read the file region by
+    chunks into a temporary buffer.
+
+    Thread-safe.
+*/
+class SharedFile
+{
+public:
+    //! Initialize an invalid shared file
+    SharedFile() noexcept : _size(0) {}
+    //! Open the shared file with the given path
+    /*!
+        The shared file is invalid if the file cannot be opened.
+
+        \param path - File path
+    */
+    explicit SharedFile(const std::string& path);
+    //! Initialize shared file with a duplicate of the given file descriptor
+    /*!
+        The file descriptor is duplicated, so the caller could close it
+        right after the shared file is created. The shared file is invalid
+        if the file descriptor cannot be duplicated.
+
+        \param fd - File descriptor
+    */
+    explicit SharedFile(int fd);
+    SharedFile(const SharedFile&) = default;
+    SharedFile(SharedFile&&) noexcept = default;
+    ~SharedFile() = default;
+
+    SharedFile& operator=(const SharedFile&) = default;
+    SharedFile& operator=(SharedFile&&) noexcept = default;
+
+    //! Check if the shared file is valid
+    explicit operator bool() const noexcept { return valid(); }
+
+    //! Get the file size at the moment the file was opened
+    uint64_t size() const noexcept { return _size; }
+    //! Is the shared file valid?
+    bool valid() const noexcept { return (_file != nullptr); }
+
+    //! Write the file region into the given socket
+    /*!
+        The socket is switched into the native non-blocking mode, so the
+        method never blocks and returns asio::error::would_block if the
+        socket is not ready for writing.
+
+        \param socket - Socket to write into
+        \param offset - File region offset
+        \param size - File region size
+        \param ec - Error code
+        \return Count of written bytes
+    */
+    size_t Send(asio::ip::tcp::socket& socket, uint64_t offset, size_t size, asio::error_code& ec) const;
+
+private:
+    class Impl;
+    std::shared_ptr<Impl> _file;
+    uint64_t _size;
+
+    //! Attach the opened file descriptor
+    void Attach(int fd);
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_SHARED_FILE_H
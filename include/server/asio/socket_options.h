@@ -0,0 +1,111 @@
+/*!
+    \file socket_options.h
+    \brief Socket options definition
+    \author Ivan Shynkarenka
+    \date 27.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_SOCKET_OPTIONS_H
+#define CPPSERVER_ASIO_SOCKET_OPTIONS_H
+
+#include "asio.h"
+
+#include <string>
+
+namespace CppServer {
+namespace Asio {
+
+//! Socket options
+/*!
+    Socket options are used by servers and clients to tune TCP sockets
+    at accept and connect time. Each option keeps the operating system
+    default value until it is explicitly set. Options which are not
+    supported by the current platform are silently ignored.
+
+    Not thread-safe.
+*/
+struct SocketOptions
+{
+    //! Disable the Nagle algorithm (TCP_NODELAY), -1 to keep the system default
+    int no_delay;
+    //! Socket send buffer size in bytes (SO_SNDBUF), 0 to keep the system default
+    int send_buffer_size;
+    //! Socket receive buffer size in bytes (SO_RCVBUF), 0 to keep the system default
+    int receive_buffer_size;
+    //! Enable quick acknowledgements (TCP_QUICKACK, Linux only), -1 to keep the system default
+    int quick_ack;
+    //! Limit of unsent bytes in the socket send buffer (TCP_NOTSENT_LOWAT, Linux and macOS only), 0 to keep the system default
+    int not_sent_lowat;
+    //! Enable TCP keep-alive (SO_KEEPALIVE), -1 to keep the system default
+    int keep_alive;
+    //! Idle time in seconds before the first keep-alive probe (TCP_KEEPIDLE), 0 to keep the system default
+    int keep_alive_idle;
+    //! Interval in seconds between keep-alive probes (TCP_KEEPINTVL), 0 to keep the system default
+    int keep_alive_interval;
+    //! Count of unacknowledged keep-alive probes before the connection is dropped (TCP_KEEPCNT), 0 to keep the system default
+    int keep_alive_count;
+    //! Congestion control algorithm name (TCP_CONGESTION, Linux only), empty to keep the system default
+    std::string congestion_control;
+    //! Busy poll time in microseconds for blocking receives (SO_BUSY_POLL, Linux only), 0 to keep the system default
+    int busy_poll;
+
+    SocketOptions()
+        : no_delay(-1),
+          send_buffer_size(0),
+          receive_buffer_size(0),
+          quick_ack(-1),
+          not_sent_lowat(0),
+          keep_alive(-1),
+          keep_alive_idle(0),
+          keep_alive_interval(0),
+          keep_alive_count(0),
+          busy_poll(0)
+    {}
+
+    //! Are all socket options kept with system defaults?
+    bool empty() const noexcept;
+
+    //! Apply socket options to the given connected or opened socket
+    /*!
+        \param socket - Socket to tune
+        \param ec - Error code of the first failed option
+    */
+    void Apply(asio::ip::tcp::socket::lowest_layer_type& socket, asio::error_code& ec) const;
+    //! Apply socket buffer sizes to the given acceptor
+    /*!
+        Accepted sockets inherit socket buffer sizes of the acceptor, so
+        the window scale negotiated during the handshake matches them.
+
+        \param acceptor - Acceptor to tune
+        \param ec - Error code of the first failed option
+    */
+    void Apply(asio::ip::tcp::acceptor& acceptor, asio::error_code& ec) const;
+
+    //! Cork or uncork the given connected socket
+    /*!
+        While the socket is corked the kernel holds partial packets and
+        sends only full ones. Uncorking the socket pushes the held data
+        right away. Corking is supported on Linux only (TCP_CORK).
+
+        \param socket - Socket to cork
+        \param enable - Cork or uncork the socket
+        \return 'true' if the socket was successfully corked or uncorked, 'false' if corking is not supported or failed
+    */
+    static bool Cork(asio::ip::tcp::socket::lowest_layer_type& socket, bool enable);
+};
+
+//! Stream output: Socket options
+/*!
+    Only socket options which are explicitly set are written.
+
+    \param stream - Output stream
+    \param options - Socket options
+    \return Output stream
+*/
+std::ostream& operator<<(std::ostream& stream, const SocketOptions& options);
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_SOCKET_OPTIONS_H
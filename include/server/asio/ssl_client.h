@@ -9,6 +9,11 @@
 #ifndef CPPSERVER_ASIO_SSL_CLIENT_H
 #define CPPSERVER_ASIO_SSL_CLIENT_H
 
+#include "handler_allocator.h"
+#include "message_framer.h"
+#include "ring_buffer.h"
+#include "send_queue.h"
+#include "socket_options.h"
 #include "service.h"
 
 #include "system/uuid.h"
@@ -21,6 +26,8 @@ namespace Asio {
 //! SSL client
 /*!
     SSL client is used to read/write data from/into the connected SSL server.
+    All client handlers are serialized through the client strand if the
+    Asio service is running in several working threads.
 
     Thread-safe.
 */
@@ -51,6 +58,12 @@ public:
 
     //! Get the client Id
     const CppCommon::UUID& id() const noexcept { return _id; }
+    //! Get the client key
+    /*!
+        Client key is a compact 64-bit identifier of the client unique
+        inside the process.
+    */
+    uint64_t key() const noexcept { return _key; }
 
     //! Get the Asio service
     std::shared_ptr<Service>& service() noexcept;
@@ -67,6 +80,20 @@ public:
     uint64_t bytes_sent() const noexcept;
     //! Get the number of bytes received by this client
     uint64_t bytes_received() const noexcept;
+    //! Get the message framer
+    const MessageFramer& framer() const noexcept { return _framer; }
+    //! Get the receive ring capacity (0 if the receive ring mode is disabled)
+    size_t receive_ring() const noexcept { return _receive_ring.capacity(); }
+    //! Get the send buffer high watermark
+    size_t send_buffer_high() const noexcept { return _send_buffer_high; }
+    //! Get the send buffer low watermark
+    size_t send_buffer_low() const noexcept { return _send_buffer_low; }
+    //! Get the slow consumer policy
+    SlowConsumerPolicy slow_consumer_policy() const noexcept { return _slow_consumer_policy; }
+    //! Get the socket options
+    const SocketOptions& socket_options() const noexcept { return _socket_options; }
+    //! Is the client send buffer corked?
+    bool corked() const noexcept;
 
     //! Is the client connected?
     bool IsConnected() const noexcept;
@@ -89,6 +116,15 @@ public:
     */
     bool Reconnect();
 
+    //! Setup the id policy of the client
+    /*!
+        By default the client Id is made from its monotonic 64-bit key.
+        Random UUID Id should be requested explicitly with IdPolicy::UUID.
+
+        \param policy - Id policy
+    */
+    void SetupIdPolicy(IdPolicy policy);
+
     //! Send data to the server
     /*!
         \param buffer - Buffer to send
@@ -102,6 +138,118 @@ public:
         \return Count of pending bytes in the send buffer
     */
     size_t Send(const std::string& text) { return Send(text.data(), text.size()); }
+    //! Send a shared buffer to the server
+    /*!
+        The shared buffer is queued without copying and is kept alive
+        until it is completely sent.
+
+        \param buffer - Shared buffer to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t Send(const SharedBuffer& buffer);
+    //! Send several shared buffers to the server
+    /*!
+        All shared buffers are queued without copying and are written
+        with a single scatter/gather operation.
+
+        \param buffers - Shared buffers to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t Send(const std::vector<SharedBuffer>& buffers);
+
+    //! Send a message with the length prefix to the server
+    /*!
+        The message is prefixed with its length according to the message
+        framing setup and is queued as a single buffer, so messages sent
+        from several threads are never interleaved.
+
+        \param buffer - Message buffer to send
+        \param size - Message size
+        \return Count of pending bytes in the send buffer or zero if the message is larger than the maximal message size
+    */
+    size_t SendFrame(const void* buffer, size_t size);
+    //! Send a text message with the length prefix to the server
+    /*!
+        \param text - Text message to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t SendFrame(const std::string& text) { return SendFrame(text.data(), text.size()); }
+
+    //! Cork the client send buffer
+    /*!
+        While the client is corked all sent data is collected in the send
+        buffer and is not written into the stream. When the client is
+        uncorked the collected data is written with a single write operation.
+        The socket is corked with TCP_CORK where supported, so SSL records
+        of the collected data are packed into full packets. Cork() and
+        Uncork() calls could be nested and should be balanced.
+
+        Thread-safe.
+    */
+    void Cork() noexcept;
+    //! Uncork the client send buffer and write all collected data
+    /*!
+        Thread-safe.
+    */
+    void Uncork();
+
+    //! Setup the message framing mode
+    /*!
+        In the message framing mode the received stream is split into
+        messages with a length prefix and onReceivedMessage() handler is
+        called for each message instead of onReceived() handler. Complete
+        messages are delivered in place from the receive buffer. The mode
+        should be setup before the client is connected.
+
+        \param prefix_size - Length prefix size (1, 2, 4 or 8 bytes, default is 4)
+        \param byte_order - Length prefix byte order (default is ByteOrder::BigEndian)
+        \param max_size - Maximal message size (default is MessageFramer::MAX_SIZE)
+    */
+    void SetupFraming(size_t prefix_size = 4, ByteOrder byte_order = ByteOrder::BigEndian, size_t max_size = MessageFramer::MAX_SIZE) { _framer.Setup(prefix_size, byte_order, max_size); }
+    //! Setup the receive ring mode
+    /*!
+        In the receive ring mode the client reads data into a ring buffer and
+        onReceivedRing() handler is called with all unconsumed received data
+        as one contiguous span. Processed data should be consumed with
+        ConsumeReceived() method, the rest of the data is passed into the
+        handler again together with the next received data. If the message
+        framing is enabled messages are parsed in place from the ring, so
+        split messages are never copied. The client is disconnected with an
+        error if the ring is full after the handler call. The mode should
+        be setup before the client is connected.
+
+        \param capacity - Receive ring capacity (rounded up to the memory page size, 0 to disable)
+    */
+    void SetupReceiveRing(size_t capacity) { _receive_ring.Setup(capacity); }
+    //! Consume the given count of received bytes from the receive ring
+    /*!
+        Should be called from onReceivedRing() handler.
+
+        \param size - Count of bytes to consume (should not be greater than the unconsumed data size)
+    */
+    void ConsumeReceived(size_t size) { _receive_ring.Consume(size); }
+    //! Setup the send buffer watermarks
+    /*!
+        When the send buffer reaches the high watermark the slow consumer
+        policy is applied to the new data and onSendBufferHigh() handler
+        is called. When the send buffer is drained down to the low
+        watermark onSendBufferLow() handler is called. The watermarks
+        should be setup before the client is connected.
+
+        \param high - Send buffer high watermark in bytes (0 to disable)
+        \param low - Send buffer low watermark in bytes (should not be greater than the high watermark)
+        \param policy - Slow consumer policy (default is SlowConsumerPolicy::Reject)
+    */
+    void SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy = SlowConsumerPolicy::Reject);
+    //! Setup the socket options
+    /*!
+        Socket options are applied to the client socket before it is
+        connected. Socket options should be setup before the client is
+        connected.
+
+        \param options - Socket options
+    */
+    void SetupSocketOptions(const SocketOptions& options) { _socket_options = options; }
 
 protected:
     //! Handle client connected notification
@@ -120,6 +268,26 @@ protected:
         \param size - Received buffer size
     */
     virtual void onReceived(const void* buffer, size_t size) {}
+    //! Handle message received notification
+    /*!
+        Notification is called in the message framing mode when another
+        complete message was received from the server. The message buffer
+        is valid only during the notification call.
+
+        \param buffer - Received message buffer
+        \param size - Received message size
+    */
+    virtual void onReceivedMessage(const void* buffer, size_t size) {}
+    //! Handle received data notification in the receive ring mode
+    /*!
+        Notification is called in the receive ring mode when some data was
+        received from the server. The buffer contains all received data which
+        was not consumed yet and is valid only during the notification call.
+
+        \param buffer - Unconsumed received data
+        \param size - Unconsumed received data size
+    */
+    virtual void onReceivedRing(const void* buffer, size_t size) {}
     //! Handle buffer sent notification
     /*!
         Notification is called when another chunk of buffer was sent
@@ -142,6 +310,22 @@ protected:
     */
     virtual void onEmpty() {}
 
+    //! Handle send buffer high watermark notification
+    /*!
+        Notification is called when the new data to send reached the send
+        buffer high watermark and the slow consumer policy
+        was applied to it.
+    */
+    virtual void onSendBufferHigh() {}
+    //! Handle send buffer low watermark notification
+    /*!
+        Notification is called when the send buffer was drained down to
+        the low watermark after the high watermark notification.
+
+        This handler could be used to resume sending data to the server.
+    */
+    virtual void onSendBufferLow() {}
+
     //! Handle error notification
     /*!
         \param error - Error code
@@ -151,8 +335,19 @@ protected:
     virtual void onError(int error, const std::string& category, const std::string& message) {}
 
 private:
-    // Client Id
+    // Client key & Id
+    uint64_t _key;
     CppCommon::UUID _id;
+    // Message framer
+    MessageFramer _framer;
+    // Receive ring
+    RingBuffer _receive_ring;
+    // Send buffer watermarks
+    size_t _send_buffer_high;
+    size_t _send_buffer_low;
+    SlowConsumerPolicy _slow_consumer_policy;
+    // Socket options
+    SocketOptions _socket_options;
 
     friend class Impl;
     class Impl;
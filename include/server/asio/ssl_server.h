@@ -9,9 +9,11 @@
 #ifndef CPPSERVER_ASIO_SSL_SERVER_H
 #define CPPSERVER_ASIO_SSL_SERVER_H
 
+#include "session_registry.h"
+#include "socket_options.h"
 #include "ssl_session.h"
 
-#include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -25,6 +27,17 @@ class SSLSession;
 /*!
     SSL server is used to connect, disconnect and manage SSL sessions.
 
+    SSL server could be sharded over several Asio services (e.g. one per
+    CPU core). In this case the server acceptor runs in the first service
+    and accepted sessions are distributed among all services according to
+    the shard policy. Each shard keeps its own sessions registry which is
+    modified only from the shard service, so session handlers and server
+    session notifications of different shards are called in parallel.
+
+    With ShardPolicy::ReusePort each shard listens with its own SO_REUSEPORT
+    acceptor in the shard service, so accepting new connections is spread
+    by the OS kernel among all shards instead of a single acceptor.
+
     Thread-safe.
 */
 template <class TServer, class TSession>
@@ -50,13 +63,39 @@ public:
         \param port - Port number
     */
     explicit SSLServer(std::shared_ptr<Service> service, std::shared_ptr<asio::ssl::context> context, const std::string& address, int port);
-    //! Initialize SSL server with a given a given Asio service and endpoint
+    //! Initialize SSL server with a given Asio service and endpoint
     /*!
         \param service - Asio service
         \param context - SSL context
         \param endpoint - Server SSL endpoint
     */
     explicit SSLServer(std::shared_ptr<Service> service, std::shared_ptr<asio::ssl::context> context, const asio::ip::tcp::endpoint& endpoint);
+    //! Initialize sharded SSL server with a given Asio services, protocol and port number
+    /*!
+        \param services - Asio services (the first one is used to accept new connections)
+        \param context - SSL context
+        \param protocol - Protocol type
+        \param port - Port number
+        \param policy - Shard policy (default is ShardPolicy::RoundRobin)
+    */
+    explicit SSLServer(const std::vector<std::shared_ptr<Service>>& services, std::shared_ptr<asio::ssl::context> context, InternetProtocol protocol, int port, ShardPolicy policy = ShardPolicy::RoundRobin);
+    //! Initialize sharded SSL server with a given Asio services, IP address and port number
+    /*!
+        \param services - Asio services (the first one is used to accept new connections)
+        \param context - SSL context
+        \param address - IP address
+        \param port - Port number
+        \param policy - Shard policy (default is ShardPolicy::RoundRobin)
+    */
+    explicit SSLServer(const std::vector<std::shared_ptr<Service>>& services, std::shared_ptr<asio::ssl::context> context, const std::string& address, int port, ShardPolicy policy = ShardPolicy::RoundRobin);
+    //! Initialize sharded SSL server with a given Asio services and endpoint
+    /*!
+        \param services - Asio services (the first one is used to accept new connections)
+        \param context - SSL context
+        \param endpoint - Server SSL endpoint
+        \param policy - Shard policy (default is ShardPolicy::RoundRobin)
+    */
+    explicit SSLServer(const std::vector<std::shared_ptr<Service>>& services, std::shared_ptr<asio::ssl::context> context, const asio::ip::tcp::endpoint& endpoint, ShardPolicy policy = ShardPolicy::RoundRobin);
     SSLServer(const SSLServer&) = delete;
     SSLServer(SSLServer&&) = default;
     virtual ~SSLServer() = default;
@@ -66,6 +105,32 @@ public:
 
     //! Get the Asio service
     std::shared_ptr<Service>& service() noexcept { return _service; }
+    //! Get the Asio service of the given shard
+    std::shared_ptr<Service>& service(size_t shard) noexcept { return _shards[shard]->service; }
+    //! Get the number of server shards
+    size_t shards() const noexcept { return _shards.size(); }
+    //! Get the shard policy
+    ShardPolicy shard_policy() const noexcept { return _shard_policy; }
+    //! Get the id policy of new sessions
+    IdPolicy id_policy() const noexcept { return _id_policy; }
+    //! Get the send buffer high watermark of new sessions
+    size_t send_buffer_high() const noexcept { return _send_buffer_high; }
+    //! Get the send buffer low watermark of new sessions
+    size_t send_buffer_low() const noexcept { return _send_buffer_low; }
+    //! Get the slow consumer policy of new sessions
+    SlowConsumerPolicy slow_consumer_policy() const noexcept { return _slow_consumer_policy; }
+    //! Get the limit of bytes pending in send buffers of all sessions
+    size_t send_buffer_limit() const noexcept { return _send_buffer_limit; }
+    //! Get the socket options of new sessions
+    const SocketOptions& socket_options() const noexcept { return _socket_options; }
+    //! Get the session pool size of each server shard (0 if the session pool is disabled)
+    size_t session_pool() const noexcept { return _session_pool; }
+    //! Get the read idle timeout of new sessions in milliseconds (0 if disabled)
+    uint64_t read_timeout() const noexcept { return _read_timeout; }
+    //! Get the write idle timeout of new sessions in milliseconds (0 if disabled)
+    uint64_t write_timeout() const noexcept { return _write_timeout; }
+    //! Get the total lifetime of new sessions in milliseconds (0 if disabled)
+    uint64_t lifetime() const noexcept { return _lifetime; }
     //! Get the server SSL context
     std::shared_ptr<asio::ssl::context>& context() noexcept { return _context; }
     //! Get the server endpoint
@@ -74,11 +139,25 @@ public:
     asio::ip::tcp::acceptor& acceptor() noexcept { return _acceptor; }
 
     //! Get the number of sessions currently connected to this server
-    uint64_t current_sessions() const noexcept { return _sessions.size(); }
+    uint64_t current_sessions() const noexcept;
     //! Get the number of bytes sent by this server
-    uint64_t bytes_sent() const noexcept { return _bytes_sent; }
+    uint64_t bytes_sent() const noexcept { return statistics().bytes_sent; }
     //! Get the number of bytes received by this server
-    uint64_t bytes_received() const noexcept { return _bytes_received; }
+    uint64_t bytes_received() const noexcept { return statistics().bytes_received; }
+    //! Get the statistics snapshot of this server
+    /*!
+        Server counters are kept separately for each shard and updated only
+        by sessions of that shard. Snapshot aggregates counters of all shards.
+    */
+    Statistics statistics() const noexcept;
+    //! Get the statistics snapshot of the given shard
+    Statistics statistics(size_t shard) const noexcept;
+    //! Get the number of bytes pending in send buffers of all sessions
+    /*!
+        Pending bytes are counted only when the server send buffer limit
+        is setup.
+    */
+    size_t send_buffer_size() const noexcept { return _send_buffer_size; }
 
     //! Is the server started?
     bool IsStarted() const noexcept { return _started; }
@@ -99,8 +178,87 @@ public:
     */
     bool Restart();
 
+    //! Setup the id policy of new sessions
+    /*!
+        By default sessions get monotonic 64-bit keys with UUID Ids made
+        from them. Random UUID Ids should be requested explicitly with
+        IdPolicy::UUID. The policy should be setup before the server
+        is started.
+
+        \param policy - Id policy
+    */
+    void SetupIdPolicy(IdPolicy policy) noexcept { _id_policy = policy; }
+    //! Setup the send buffer watermarks of new sessions
+    /*!
+        When a session send buffer reaches the high watermark the slow
+        consumer policy is applied to the new data and the session gets
+        onSendBufferHigh() notification. When the send buffer is drained
+        down to the low watermark the session gets onSendBufferLow()
+        notification. Watermarks should be setup before the server is
+        started.
+
+        \param high - Send buffer high watermark in bytes (0 to disable)
+        \param low - Send buffer low watermark in bytes (should not be greater than the high watermark)
+        \param policy - Slow consumer policy (default is SlowConsumerPolicy::Reject)
+    */
+    void SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy = SlowConsumerPolicy::Reject);
+    //! Setup the limit of bytes pending in send buffers of all sessions
+    /*!
+        When the limit is reached the slow consumer policy of the session
+        is applied to its new data as if the session reached its high
+        watermark. Shared buffers multicasted to several sessions are
+        counted once for each session. The limit should be setup before
+        the server is started.
+
+        \param limit - Send buffer limit in bytes (0 to disable)
+    */
+    void SetupSendBufferLimit(size_t limit) noexcept { _send_buffer_limit = limit; }
+    //! Setup the socket options of new sessions
+    /*!
+        Socket options are applied to each accepted socket before the
+        session is created. Socket buffer sizes are also applied to the
+        server acceptor. Socket options should be setup before the server
+        is started.
+
+        \param options - Socket options
+    */
+    void SetupSocketOptions(const SocketOptions& options) { _socket_options = options; }
+    //! Setup the session pool
+    /*!
+        Released sessions are kept in the session pool of their shard
+        instead of being destroyed, and new accepted connections reuse
+        them together with their send & receive buffers. Each Asio service
+        of the server keeps up to the given count of idle sessions. Reused
+        sessions are not constructed again, so they get onRecycled()
+        notification to reset their connection state. Idle sessions are
+        destroyed when the server is stopped. The session pool should be
+        setup before the server is started.
+
+        \param size - Count of idle sessions kept for each server shard (0 to disable)
+    */
+    void SetupSessionPool(size_t size) noexcept { _session_pool = size; }
+    //! Setup idle timeouts of new sessions
+    /*!
+        Sessions which have not received or sent any data for the given
+        idle timeout or which have been connected for the given lifetime
+        are reported with onIdle() notification. Idle timeouts are kept
+        in the timing wheel of the session service and have its resolution.
+        Sessions only update their last read and write time for each
+        operation and re-arm their timers when they expire, so active
+        sessions do not touch the timing wheel at all. Idle timeouts
+        should be setup before the server is started.
+
+        \param read - Read idle timeout in milliseconds (0 to disable)
+        \param write - Write idle timeout in milliseconds (0 to disable)
+        \param lifetime - Total lifetime of sessions in milliseconds (default is 0 to disable)
+    */
+    void SetupIdleTimeouts(uint64_t read, uint64_t write, uint64_t lifetime = 0) noexcept { _read_timeout = read; _write_timeout = write; _lifetime = lifetime; }
+
     //! Multicast data to all connected sessions
     /*!
+        The data is copied once into a shared payload which is queued
+        into all connected sessions without further copying.
+
         \param buffer - Buffer to multicast
         \param size - Buffer size
         \return 'true' if the data was successfully multicast, 'false' if the server it not started
@@ -112,6 +270,22 @@ public:
         \return 'true' if the text string was successfully multicast, 'false' if the server it not started
     */
     bool Multicast(const std::string& text) { return Multicast(text.data(), text.size()); }
+    //! Multicast a shared buffer to all connected sessions
+    /*!
+        The shared buffer is queued into all connected sessions without
+        copying, so the multicast cost does not depend on the data size.
+
+        \param buffer - Shared buffer to multicast
+        \return 'true' if the shared buffer was successfully multicast, 'false' if the server it not started
+    */
+    bool Multicast(const SharedBuffer& buffer);
+
+    //! Find the connected session with the given key
+    /*!
+        \param key - Session key
+        \return Connected session or 'nullptr' if the session with the given key is not connected
+    */
+    std::shared_ptr<TSession> FindSession(uint64_t key);
 
     //! Disconnect all connected sessions
     /*!
@@ -127,14 +301,32 @@ protected:
 
     //! Handle new session connected notification
     /*!
+        Notification is called in the Asio service of the session shard.
+
         \param session - Connected session
     */
     virtual void onConnected(std::shared_ptr<TSession>& session) {}
     //! Handle session disconnected notification
     /*!
+        Notification is called in the Asio service of the session shard.
+
         \param session - Disconnected session
     */
     virtual void onDisconnected(std::shared_ptr<TSession>& session) {}
+    //! Handle session idle notification
+    /*!
+        Notification is called in the session thread when the session
+        reached its idle timeout. Read and write idle time of the session
+        starts again after the notification, the lifetime is reported once.
+
+        By default the session is disconnected when it reached its read
+        idle timeout or its lifetime. This handler could be used to send
+        heartbeats into sessions which reached their write idle timeout.
+
+        \param session - Idle session
+        \param timeout - Reached idle timeout
+    */
+    virtual void onIdle(std::shared_ptr<TSession>& session, IdleTimeout timeout) { if (timeout != IdleTimeout::Write) session->Disconnect(); }
 
     //! Handle error notification
     /*!
@@ -145,36 +337,114 @@ protected:
     virtual void onError(int error, const std::string& category, const std::string& message) {}
 
 private:
-    // Asio service
+    // Server shard
+    struct Shard
+    {
+        // Shard index, Asio service & strand
+        size_t index;
+        std::shared_ptr<Service> service;
+        asio::io_service::strand strand;
+        bool strand_required;
+        // Shard sessions
+        std::atomic<size_t> sessions_count;
+        std::atomic<uint64_t> sessions_key;
+        std::mutex sessions_lock;
+        SessionRegistry<TSession> sessions;
+        // Shard acceptor & socket
+        asio::ip::tcp::acceptor acceptor;
+        asio::ip::tcp::socket socket;
+        // Shard session pool
+        std::mutex pool_lock;
+        std::vector<TSession*> pool;
+        // Shard statistic
+        StatisticsShard statistics;
+
+        explicit Shard(size_t index, std::shared_ptr<Service> service);
+        ~Shard();
+    };
+
+    // Asio service & strand
     std::shared_ptr<Service> _service;
-    // Server SSL context, endpoint, acceptor and socket
+    asio::io_service::strand _strand;
+    bool _strand_required;
+    // Server shards
+    std::vector<std::unique_ptr<Shard>> _shards;
+    ShardPolicy _shard_policy;
+    size_t _shard_next;
+    // Server session ids
+    IdPolicy _id_policy;
+    std::atomic<uint64_t> _session_key;
+    // Server session send buffers
+    size_t _send_buffer_high;
+    size_t _send_buffer_low;
+    SlowConsumerPolicy _slow_consumer_policy;
+    size_t _send_buffer_limit;
+    std::atomic<size_t> _send_buffer_size;
+    // Server session socket options
+    SocketOptions _socket_options;
+    // Server session pool
+    size_t _session_pool;
+    // Server session idle timeouts
+    uint64_t _read_timeout;
+    uint64_t _write_timeout;
+    uint64_t _lifetime;
+    // Server SSL context, endpoint and acceptor
     std::shared_ptr<asio::ssl::context> _context;
     asio::ip::tcp::endpoint _endpoint;
     asio::ip::tcp::acceptor _acceptor;
-    asio::ip::tcp::socket _socket;
     std::atomic<bool> _started;
-    // Server statistic
-    uint64_t _bytes_sent;
-    uint64_t _bytes_received;
-    // Server sessions
-    std::map<CppCommon::UUID, std::shared_ptr<TSession>> _sessions;
-    // Multicast buffer
-    std::mutex _multicast_lock;
-    std::vector<uint8_t> _multicast_buffer;
-
-    //! Accept new connections
+
+    //! Create server shards for the given Asio services
+    void CreateShards(const std::vector<std::shared_ptr<Service>>& services);
+    //! Select the shard for a new accepted session
+    size_t SelectShard();
+    //! Get the shard of the session constructed by the current thread
+    /*!
+        Session constructor reads the shard of its accepted socket from
+        here, so custom sessions keep the plain (server, socket) signature.
+        The value is per thread, because shards accept in parallel.
+    */
+    static size_t& AcceptingShard() noexcept { static thread_local size_t shard = 0; return shard; }
+
+    //! Accept new connections with the server acceptor
     void Accept();
+    //! Accept new connections with the SO_REUSEPORT acceptor of the given shard
+    /*!
+        \param shard - Server shard
+    */
+    void Accept(Shard* shard);
+
+    //! Generate the key & Id of a new session
+    /*!
+        \param shard - Session shard
+        \param session - New session
+    */
+    void GenerateId(Shard* shard, TSession& session);
+
+    //! Create a new session or reuse the pooled one
+    /*!
+        \param shard - Server shard with the accepted socket
+    */
+    std::shared_ptr<TSession> CreateSession(Shard* shard);
+    //! Recycle the released session into the session pool of its shard
+    /*!
+        \param session - Released session
+    */
+    static void RecycleSession(TSession* session);
+    //! Destroy idle sessions of all session pools
+    void ClearSessionPools();
 
     //! Register a new session
-    std::shared_ptr<TSession> RegisterSession();
+    /*!
+        \param shard - Server shard with the accepted socket
+    */
+    std::shared_ptr<TSession> RegisterSession(Shard* shard);
     //! Unregister the given session
     /*!
-        \param id - Session Id
+        \param shard - Session shard
+        \param key - Session key
     */
-    void UnregisterSession(const CppCommon::UUID& id);
-
-    //! Clear multicast buffer
-    void ClearBuffers();
+    void UnregisterSession(size_t shard, uint64_t key);
 
     //! Send error notification
     void SendError(std::error_code ec);
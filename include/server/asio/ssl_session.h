@@ -20,6 +20,8 @@ class SSLServer;
 //! SSL session
 /*!
     SSL session is used to read and write data from the connected SSL client.
+    All session handlers are serialized through the session strand if the
+    Asio service is running in several working threads.
 
     Thread-safe.
 */
@@ -39,29 +41,47 @@ public:
     explicit SSLSession(std::shared_ptr<SSLServer<TServer, TSession>> server, asio::ip::tcp::socket&& socket, std::shared_ptr<asio::ssl::context> context);
     SSLSession(const SSLSession&) = delete;
     SSLSession(SSLSession&&) = default;
-    virtual ~SSLSession() = default;
+    virtual ~SSLSession();
 
     SSLSession& operator=(const SSLSession&) = delete;
     SSLSession& operator=(SSLSession&&) = default;
 
     //! Get the session Id
     const CppCommon::UUID& id() const noexcept { return _id; }
+    //! Get the session key
+    /*!
+        Session key is a compact 64-bit identifier of the session unique
+        inside its server. It is used to find the session in the server.
+    */
+    uint64_t key() const noexcept { return _key; }
 
     //! Get the Asio service
-    std::shared_ptr<Service>& service() noexcept { return _server->service(); }
+    std::shared_ptr<Service>& service() noexcept { return _service; }
     //! Get the session server
     std::shared_ptr<SSLServer<TServer, TSession>>& server() noexcept { return _server; }
     //! Get the session SSL stream
-    asio::ssl::stream<asio::ip::tcp::socket>& stream() noexcept { return _stream; }
+    asio::ssl::stream<asio::ip::tcp::socket>& stream() noexcept { return *_stream; }
     //! Get the session socket
-    asio::ssl::stream<asio::ip::tcp::socket>::lowest_layer_type& socket() noexcept { return _stream.lowest_layer(); }
+    asio::ssl::stream<asio::ip::tcp::socket>::lowest_layer_type& socket() noexcept { return _stream->lowest_layer(); }
     //! Get the session SSL context
     std::shared_ptr<asio::ssl::context>& context() noexcept { return _context; }
 
     //! Get the number of bytes sent by this session
-    uint64_t bytes_sent() const noexcept { return _bytes_sent; }
+    uint64_t bytes_sent() const noexcept { return _statistics.bytes_sent(); }
     //! Get the number of bytes received by this session
-    uint64_t bytes_received() const noexcept { return _bytes_received; }
+    uint64_t bytes_received() const noexcept { return _statistics.bytes_received(); }
+    //! Get the message framer
+    const MessageFramer& framer() const noexcept { return _framer; }
+    //! Get the receive ring capacity (0 if the receive ring mode is disabled)
+    size_t receive_ring() const noexcept { return _receive_ring.capacity(); }
+    //! Get the send buffer high watermark
+    size_t send_buffer_high() const noexcept { return _send_buffer_high; }
+    //! Get the send buffer low watermark
+    size_t send_buffer_low() const noexcept { return _send_buffer_low; }
+    //! Get the slow consumer policy
+    SlowConsumerPolicy slow_consumer_policy() const noexcept { return _slow_consumer_policy; }
+    //! Is the session send buffer corked?
+    bool corked() const noexcept { return (_corked > 0); }
 
     //! Is the session connected?
     bool IsConnected() const noexcept { return _connected; }
@@ -87,6 +107,109 @@ public:
         \return Count of pending bytes in the send buffer
     */
     size_t Send(const std::string& text) { return Send(text.data(), text.size()); }
+    //! Send a shared buffer into the session
+    /*!
+        The shared buffer is queued without copying and is kept alive
+        until it is completely sent.
+
+        \param buffer - Shared buffer to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t Send(const SharedBuffer& buffer);
+    //! Send several shared buffers into the session
+    /*!
+        All shared buffers are queued without copying and are written
+        with a single scatter/gather operation.
+
+        \param buffers - Shared buffers to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t Send(const std::vector<SharedBuffer>& buffers);
+
+    //! Send a message with the length prefix to the client
+    /*!
+        The message is prefixed with its length according to the message
+        framing setup and is queued as a single buffer, so messages sent
+        from several threads are never interleaved.
+
+        \param buffer - Message buffer to send
+        \param size - Message size
+        \return Count of pending bytes in the send buffer or zero if the message is larger than the maximal message size
+    */
+    size_t SendFrame(const void* buffer, size_t size);
+    //! Send a text message with the length prefix to the client
+    /*!
+        \param text - Text message to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t SendFrame(const std::string& text) { return SendFrame(text.data(), text.size()); }
+
+    //! Cork the session send buffer
+    /*!
+        While the session is corked all sent data is collected in the send
+        buffer and is not written into the stream. When the session is
+        uncorked the collected data is written with a single write operation.
+        The socket is corked with TCP_CORK where supported, so SSL records
+        of the collected data are packed into full packets. Cork() and
+        Uncork() calls could be nested and should be balanced.
+
+        Thread-safe.
+    */
+    void Cork() noexcept { ++_corked; }
+    //! Uncork the session send buffer and write all collected data
+    /*!
+        Thread-safe.
+    */
+    void Uncork();
+
+    //! Setup the message framing mode
+    /*!
+        In the message framing mode the received stream is split into
+        messages with a length prefix and onReceivedMessage() handler is
+        called for each message instead of onReceived() handler. Complete
+        messages are delivered in place from the receive buffer. The mode
+        should be setup before the session is connected (e.g. in the session constructor).
+
+        \param prefix_size - Length prefix size (1, 2, 4 or 8 bytes, default is 4)
+        \param byte_order - Length prefix byte order (default is ByteOrder::BigEndian)
+        \param max_size - Maximal message size (default is MessageFramer::MAX_SIZE)
+    */
+    void SetupFraming(size_t prefix_size = 4, ByteOrder byte_order = ByteOrder::BigEndian, size_t max_size = MessageFramer::MAX_SIZE) { _framer.Setup(prefix_size, byte_order, max_size); }
+    //! Setup the receive ring mode
+    /*!
+        In the receive ring mode the session reads data into a ring buffer and
+        onReceivedRing() handler is called with all unconsumed received data
+        as one contiguous span. Processed data should be consumed with
+        ConsumeReceived() method, the rest of the data is passed into the
+        handler again together with the next received data. If the message
+        framing is enabled messages are parsed in place from the ring, so
+        split messages are never copied. The session is disconnected with an
+        error if the ring is full after the handler call. The mode should
+        be setup before the session is connected.
+
+        \param capacity - Receive ring capacity (rounded up to the memory page size, 0 to disable)
+    */
+    void SetupReceiveRing(size_t capacity) { _receive_ring.Setup(capacity); }
+    //! Consume the given count of received bytes from the receive ring
+    /*!
+        Should be called from onReceivedRing() handler.
+
+        \param size - Count of bytes to consume (should not be greater than the unconsumed data size)
+    */
+    void ConsumeReceived(size_t size) { _receive_ring.Consume(size); }
+    //! Setup the send buffer watermarks
+    /*!
+        When the send buffer reaches the high watermark the slow consumer
+        policy is applied to the new data and onSendBufferHigh() handler
+        is called. When the send buffer is drained down to the low
+        watermark onSendBufferLow() handler is called. By default the session gets watermarks of its server. The watermarks
+        should be setup before the session is connected.
+
+        \param high - Send buffer high watermark in bytes (0 to disable)
+        \param low - Send buffer low watermark in bytes (should not be greater than the high watermark)
+        \param policy - Slow consumer policy (default is SlowConsumerPolicy::Reject)
+    */
+    void SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy = SlowConsumerPolicy::Reject);
 
 protected:
     //! Handle session connected notification
@@ -95,6 +218,16 @@ protected:
     virtual void onHandshaked() {}
     //! Handle session disconnected notification
     virtual void onDisconnected() {}
+    //! Handle session recycled notification
+    /*!
+        Notification is called when the session is taken from the server
+        session pool for a new connection and before it is connected.
+        Session settings are kept from the previous connection.
+
+        This handler should be used to reset the connection state of the
+        derived session class.
+    */
+    virtual void onRecycled() {}
 
     //! Handle buffer received notification
     /*!
@@ -105,6 +238,26 @@ protected:
         \param size - Received buffer size
     */
     virtual void onReceived(const void* buffer, size_t size) {}
+    //! Handle message received notification
+    /*!
+        Notification is called in the message framing mode when another
+        complete message was received from the client. The message buffer
+        is valid only during the notification call.
+
+        \param buffer - Received message buffer
+        \param size - Received message size
+    */
+    virtual void onReceivedMessage(const void* buffer, size_t size) {}
+    //! Handle received data notification in the receive ring mode
+    /*!
+        Notification is called in the receive ring mode when some data was
+        received from the client. The buffer contains all received data which
+        was not consumed yet and is valid only during the notification call.
+
+        \param buffer - Unconsumed received data
+        \param size - Unconsumed received data size
+    */
+    virtual void onReceivedRing(const void* buffer, size_t size) {}
     //! Handle buffer sent notification
     /*!
         Notification is called when another chunk of buffer was sent
@@ -127,6 +280,22 @@ protected:
     */
     virtual void onEmpty() {}
 
+    //! Handle send buffer high watermark notification
+    /*!
+        Notification is called when the new data to send reached the send
+        buffer high watermark or the server send buffer limit and the slow consumer policy
+        was applied to it.
+    */
+    virtual void onSendBufferHigh() {}
+    //! Handle send buffer low watermark notification
+    /*!
+        Notification is called when the send buffer was drained down to
+        the low watermark after the high watermark notification.
+
+        This handler could be used to resume sending data to the client.
+    */
+    virtual void onSendBufferLow() {}
+
     //! Handle error notification
     /*!
         \param error - Error code
@@ -136,26 +305,53 @@ protected:
     virtual void onError(int error, const std::string& category, const std::string& message) {}
 
 private:
-    // Session Id
+    // Session Id & key
     CppCommon::UUID _id;
-    // Session server, SSL stream and SSL context
+    uint64_t _key;
+    // Session server, shard, service, strand, SSL stream and SSL context
     std::shared_ptr<SSLServer<TServer, TSession>> _server;
-    asio::ssl::stream<asio::ip::tcp::socket> _stream;
+    size_t _shard;
+    std::shared_ptr<Service> _service;
+    asio::io_service::strand _strand;
+    bool _strand_required;
+    std::unique_ptr<asio::ssl::stream<asio::ip::tcp::socket>> _stream;
     std::shared_ptr<asio::ssl::context> _context;
     std::atomic<bool> _connected;
     std::atomic<bool> _handshaked;
+    bool _shutting_down;
     // Session statistic
-    uint64_t _bytes_sent;
-    uint64_t _bytes_received;
+    SessionStatistics<> _statistics;
     // Receive buffer & cache
     bool _reciving;
-    std::vector<uint8_t> _recive_buffer;
-    // Send buffer & cache
+    ReceiveBuffer _recive_buffer;
+    // Message framer
+    MessageFramer _framer;
+    // Receive ring
+    RingBuffer _receive_ring;
+    // Send queue
     bool _sending;
-    std::mutex _send_lock;
-    std::vector<uint8_t> _send_buffer_main;
-    std::vector<uint8_t> _send_buffer_flush;
-    size_t _send_buffer_flush_offset;
+    std::atomic<bool> _send_scheduled;
+    SendQueue _send_queue;
+    // Handler storages of receive and send operations
+    HandlerStorage _receive_storage;
+    HandlerStorage _send_storage;
+    // Send batching
+    std::atomic<int> _corked;
+    bool _socket_corked;
+    // Send buffer watermarks
+    size_t _send_buffer_high;
+    size_t _send_buffer_low;
+    SlowConsumerPolicy _slow_consumer_policy;
+    std::atomic<bool> _send_buffer_overflow;
+    bool _send_buffer_full;
+    // Idle timeouts
+    TimingWheel::Timer _idle_timer;
+    std::weak_ptr<SSLSession<TServer, TSession>> _idle_self;
+    bool _idle_timed;
+    bool _lifetime_expired;
+    uint64_t _connect_time;
+    uint64_t _read_time;
+    uint64_t _write_time;
 
     //! Connect the session
     void Connect();
@@ -165,15 +361,66 @@ private:
         \return 'true' if the session was successfully disconnected, 'false' if the session is already disconnected
     */
     bool Disconnect(bool dispatch);
+    //! Complete the session disconnect
+    void Disconnected();
 
     //! Try to receive new data
     void TryReceive();
+    //! Try to receive new data into the receive ring
+    void TryReceiveRing();
+    //! Is the current thread running the session handlers?
+    bool IsInStrand() { return _strand_required ? _strand.running_in_this_thread() : _service->IsServiceThread(); }
+
+    //! Schedule the send routine
+    void ScheduleSend();
     //! Try to send pending data
     void TrySend();
+    //! Cork or uncork the session socket
+    void CorkSocket(bool enable);
+
+    //! Check the send buffer for the new data to send and apply the slow consumer policy
+    /*!
+        \param size - Size of the new data to send
+        \return 'true' if the new data should be queued, 'false' if the new data was rejected
+    */
+    bool CheckSendBuffer(size_t size);
+    //! Handle the send buffer overflow in the send routine
+    void HandleSendBufferOverflow();
+    //! Handle the drained send buffer in the send routine
+    /*!
+        \param pending - Count of pending bytes in the send buffer
+    */
+    void HandleSendBufferDrain(size_t pending);
+
+    //! Start idle timeouts of the connected session
+    void StartIdleTimer();
+    //! Schedule the idle timeouts check routine
+    void ScheduleIdleCheck();
+    //! Check idle timeouts and wait for the nearest one
+    void CheckIdle();
 
     //! Clear receive & send buffers
     void ClearBuffers();
 
+    //! Prepare the released session for the session pool
+    /*!
+        Send queue is cleared again, because producers could push data after
+        the disconnect cleared it and before the connected flag was reset.
+
+        The SSL stream is destroyed with its SSL state and all buffered data,
+        so the pooled session keeps only its SSL context and buffers memory.
+        The new SSL stream is created when the session is reused.
+
+        \return 'true' if the session could be reused, 'false' if the session should be destroyed
+    */
+    bool Recycle();
+    //! Reuse the pooled session for the new accepted socket
+    /*!
+        \param server - Session server
+        \param socket - Accepted socket
+    */
+    void Reuse(std::shared_ptr<SSLServer<TServer, TSession>> server, asio::ip::tcp::socket&& socket);
+
     //! Send error notification
     void SendError(std::error_code ec);
 };
@@ -11,19 +11,45 @@ namespace Asio {
 
 template <class TServer, class TSession>
 inline SSLSession<TServer, TSession>::SSLSession(std::shared_ptr<SSLServer<TServer, TSession>> server, asio::ip::tcp::socket&& socket, std::shared_ptr<asio::ssl::context> context)
-    : _id(CppCommon::UUID::Generate()),
+    : _id(CppCommon::UUID::Nil()),
+      _key(0),
       _server(server),
-      _stream(std::move(socket), *context),
+      _shard(server->AcceptingShard()),
+      _service(server->service(_shard)),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
+      _stream(new asio::ssl::stream<asio::ip::tcp::socket>(std::move(socket), *context)),
       _context(context),
       _connected(false),
       _handshaked(false),
-      _bytes_sent(0),
-      _bytes_received(0),
+      _shutting_down(false),
       _reciving(false),
       _sending(false),
-      _recive_buffer(CHUNK + 1),
-      _send_buffer_flush_offset(0)
+      _send_scheduled(false),
+      _corked(0),
+      _socket_corked(false),
+      _send_buffer_high(server->send_buffer_high()),
+      _send_buffer_low(server->send_buffer_low()),
+      _slow_consumer_policy(server->slow_consumer_policy()),
+      _send_buffer_overflow(false),
+      _send_buffer_full(false),
+      _idle_timer([this]() { ScheduleIdleCheck(); }),
+      _idle_timed(false),
+      _lifetime_expired(false),
+      _connect_time(0),
+      _read_time(0),
+      _write_time(0)
 {
+    // Count pending bytes of all sessions if the server send buffer is limited
+    if (server->send_buffer_limit() > 0)
+        _send_queue.SetupTotal(&server->_send_buffer_size);
+}
+
+template <class TServer, class TSession>
+inline SSLSession<TServer, TSession>::~SSLSession()
+{
+    // Released session could be never disconnected, so its idle timer leaves the timing wheel here
+    _service->CancelTimer(_idle_timer);
 }
 
 template <class TServer, class TSession>
@@ -32,44 +58,62 @@ inline void SSLSession<TServer, TSession>::Connect()
     if (IsConnected() || IsHandshaked())
         return;
 
-    // Reset statistic
-    _bytes_sent = 0;
-    _bytes_received = 0;
-
-    // Update the connected flag
-    _connected = true;
-
-    // Call the session connected handler
-    onConnected();
-
-    // Perform SSL handshake
     auto self(this->shared_from_this());
-    _stream.async_handshake(asio::ssl::stream_base::server, [this, self](std::error_code ec)
+    auto connect_handler = [this, self]()
     {
-        if (IsHandshaked())
+        if (IsConnected() || IsHandshaked())
             return;
 
-        if (!ec)
+        // Reset statistic
+        _statistics.Reset();
+
+        // Update the connected flag
+        _connected = true;
+
+        // Start idle timeouts
+        StartIdleTimer();
+
+        // Call the session connected handler
+        onConnected();
+
+        // Perform SSL handshake
+        auto async_handshake_handler = [this, self](std::error_code ec)
         {
-            // Update the handshaked flag
-            _handshaked = true;
+            if (IsHandshaked())
+                return;
 
-            // Call the session handshaked handler
-            onHandshaked();
+            if (!ec)
+            {
+                // Update the handshaked flag
+                _handshaked = true;
 
-            // Call the empty send buffer handler
-            onEmpty();
+                // Call the session handshaked handler
+                onHandshaked();
 
-            // Try to receive something from the client
-            TryReceive();
-        }
+                // Call the empty send buffer handler
+                onEmpty();
+
+                // Try to receive something from the client
+                TryReceive();
+            }
+            else
+            {
+                // Disconnect on in case of the bad handshake
+                SendError(ec);
+                Disconnect(true);
+            }
+        };
+        if (_strand_required)
+            _stream->async_handshake(asio::ssl::stream_base::server, _strand.wrap(async_handshake_handler));
         else
-        {
-            // Disconnect on in case of the bad handshake
-            SendError(ec);
-            Disconnect(true);
-        }
-    });
+            _stream->async_handshake(asio::ssl::stream_base::server, async_handshake_handler);
+    };
+
+    // Dispatch the connect routine into the session strand
+    if (_strand_required)
+        _strand.dispatch(connect_handler);
+    else
+        connect_handler();
 }
 
 template <class TServer, class TSession>
@@ -84,39 +128,91 @@ inline bool SSLSession<TServer, TSession>::Disconnect(bool dispatch)
         if (!IsConnected())
             return;
 
+        // The peer which drops the connection without close_notify fails
+        // the receive during the pending shutdown, so the session is closed
+        // at once and the pending shutdown is aborted with the socket
+        if (_shutting_down)
+        {
+            Disconnected();
+            return;
+        }
+
+        _shutting_down = true;
+
+        // Stop idle timeouts
+        if (_idle_timed)
+        {
+            _idle_timed = false;
+            _service->CancelTimer(_idle_timer);
+        }
+
         // Shutdown the client stream
-        _stream.async_shutdown([this, self](std::error_code ec)
+        auto async_shutdown_handler = [this, self](std::error_code ec)
         {
             if (!IsConnected())
                 return;
 
-            // Close the session socket
-            socket().close();
+            Disconnected();
+        };
+        if (_strand_required)
+            _stream->async_shutdown(_strand.wrap(async_shutdown_handler));
+        else
+            _stream->async_shutdown(async_shutdown_handler);
+    };
 
-            // Clear receive/send buffers
-            ClearBuffers();
+    // Dispatch or post the disconnect routine
+    if (_strand_required)
+    {
+        if (dispatch)
+            _strand.dispatch(disconnect);
+        else
+            _strand.post(disconnect);
+    }
+    else
+    {
+        if (dispatch)
+            service()->Dispatch(disconnect);
+        else
+            service()->Post(disconnect);
+    }
 
-            // Update the handshaked flag
-            _handshaked = false;
+    return true;
+}
 
-            // Update the connected flag
-            _connected = false;
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::Disconnected()
+{
+    _shutting_down = false;
 
-            // Call the session disconnected handler
-            onDisconnected();
+    // Close the session socket
+    socket().close();
 
-            // Unregister the session
-            _server->UnregisterSession(id());
-        });
-    };
+    // Clear receive/send buffers
+    ClearBuffers();
 
-    // Dispatch or post the disconnect routine
-    if (dispatch)
-        service()->Dispatch(disconnect);
-    else
-        service()->Post(disconnect);
+    // Update the handshaked flag
+    _handshaked = false;
 
-    return true;
+    // Update the connected flag
+    _connected = false;
+
+    // Call the session disconnected handler
+    onDisconnected();
+
+    // Unregister the session
+    _server->UnregisterSession(_shard, key());
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy)
+{
+    assert((low <= high) && "Send buffer low watermark should not be greater than the high watermark!");
+    if (low > high)
+        throw CppCommon::ArgumentException("Send buffer low watermark should not be greater than the high watermark!");
+
+    _send_buffer_high = high;
+    _send_buffer_low = low;
+    _slow_consumer_policy = policy;
 }
 
 template <class TServer, class TSession>
@@ -130,27 +226,166 @@ inline size_t SSLSession<TServer, TSession>::Send(const void* buffer, size_t siz
     if (!IsHandshaked())
         return 0;
 
-    size_t result;
+    // Apply the slow consumer policy to the new data
+    if (!CheckSendBuffer(size))
+        return 0;
+
+    // Send the data directly from the session thread
+    if (IsInStrand())
     {
-        std::lock_guard<std::mutex> locker(_send_lock);
+        size_t result = _send_queue.PushDirect(buffer, size);
+        TrySend();
+        return result;
+    }
+
+    // Copy the buffer into the send queue and schedule the send routine
+    size_t result = _send_queue.Push(buffer, size);
+    ScheduleSend();
 
-        // Fill the main send buffer
-        const uint8_t* bytes = (const uint8_t*)buffer;
-        _send_buffer_main.insert(_send_buffer_main.end(), bytes, bytes + size);
-        result = _send_buffer_main.size();
+    return result;
+}
+
+template <class TServer, class TSession>
+inline size_t SSLSession<TServer, TSession>::Send(const SharedBuffer& buffer)
+{
+    assert(!buffer.empty() && "Shared buffer should not be empty!");
+    if (buffer.empty())
+        return 0;
+
+    if (!IsHandshaked())
+        return 0;
+
+    // Apply the slow consumer policy to the new data
+    if (!CheckSendBuffer(buffer.size()))
+        return 0;
+
+    // Send the data directly from the session thread
+    if (IsInStrand())
+    {
+        size_t result = _send_queue.PushDirect(buffer);
+        TrySend();
+        return result;
     }
 
-    // Dispatch the send routine
-    auto self(this->shared_from_this());
-    service()->Dispatch([this, self]()
+    // Queue the shared buffer and schedule the send routine
+    size_t result = _send_queue.Push(buffer);
+    ScheduleSend();
+
+    return result;
+}
+
+template <class TServer, class TSession>
+inline size_t SSLSession<TServer, TSession>::Send(const std::vector<SharedBuffer>& buffers)
+{
+    assert(!buffers.empty() && "Shared buffers vector should not be empty!");
+    if (buffers.empty())
+        return 0;
+
+    if (!IsHandshaked())
+        return 0;
+
+    // Apply the slow consumer policy to the new data
+    size_t size = 0;
+    for (auto& buffer : buffers)
+        size += buffer.size();
+    if (!CheckSendBuffer(size))
+        return 0;
+
+    // Send the data directly from the session thread
+    if (IsInStrand())
     {
-        // Try to send the main buffer
+        size_t result = 0;
+        for (auto& buffer : buffers)
+            result = _send_queue.PushDirect(buffer);
         TrySend();
-    });
+        return result;
+    }
+
+    // Queue all shared buffers and schedule the send routine once
+    size_t result = 0;
+    for (auto& buffer : buffers)
+        result = _send_queue.Push(buffer);
+    ScheduleSend();
 
     return result;
 }
 
+template <class TServer, class TSession>
+inline size_t SSLSession<TServer, TSession>::SendFrame(const void* buffer, size_t size)
+{
+    // Encode the length prefix
+    uint8_t prefix[8];
+    size_t prefix_size = _framer.Encode(size, prefix);
+    if (prefix_size == 0)
+    {
+        // The peer would disconnect on the oversize message
+        SendError(asio::error::message_size);
+        return 0;
+    }
+
+    // Copy small messages with the length prefix on the stack
+    if ((prefix_size + size) <= CHUNK)
+    {
+        uint8_t frame[CHUNK];
+        std::memcpy(frame, prefix, prefix_size);
+        if (size > 0)
+            std::memcpy(frame + prefix_size, buffer, size);
+        return Send(frame, prefix_size + size);
+    }
+
+    // Copy large messages with the length prefix into a shared buffer
+    std::vector<uint8_t> frame(prefix_size + size);
+    std::memcpy(frame.data(), prefix, prefix_size);
+    std::memcpy(frame.data() + prefix_size, buffer, size);
+    return Send(SharedBuffer(std::move(frame)));
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::Uncork()
+{
+    assert((_corked > 0) && "Session send buffer is not corked!");
+
+    // Only the last balanced call writes the collected data
+    int corked = _corked;
+    do
+    {
+        if (corked <= 0)
+            return;
+    } while (!_corked.compare_exchange_weak(corked, corked - 1));
+    if (corked > 1)
+        return;
+
+    if (!IsHandshaked())
+        return;
+
+    // Write the collected data right away from the session thread
+    if (IsInStrand())
+        TrySend();
+    else
+        ScheduleSend();
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::ScheduleSend()
+{
+    // Schedule only one send routine for all buffers queued before it runs
+    if (_send_scheduled.exchange(true))
+        return;
+
+    auto self(this->shared_from_this());
+    auto send_handler = [this, self]()
+    {
+        _send_scheduled = false;
+
+        // Try to send the send queue
+        TrySend();
+    };
+    if (_strand_required)
+        _strand.post(send_handler);
+    else
+        service()->Post(send_handler);
+}
+
 template <class TServer, class TSession>
 inline void SSLSession<TServer, TSession>::TryReceive()
 {
@@ -160,28 +395,47 @@ inline void SSLSession<TServer, TSession>::TryReceive()
     if (!IsHandshaked())
         return;
 
+    // Receive data into the ring in the receive ring mode
+    if (_receive_ring.enabled())
+    {
+        TryReceiveRing();
+        return;
+    }
+
     _reciving = true;
     auto self(this->shared_from_this());
-    _stream.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), [this, self](std::error_code ec, std::size_t size)
+
+    // Borrow the receive buffer from the service buffer pool
+    _recive_buffer.Acquire(_service->buffer_pool());
+
+    auto async_receive_handler = [this, self](std::error_code ec, std::size_t size)
     {
         _reciving = false;
 
         if (!IsHandshaked())
+        {
+            _recive_buffer.Release();
             return;
+        }
 
         // Received some data from the client
         if (size > 0)
         {
             // Update statistic
-            _bytes_received += size;
-            _server->_bytes_received += size;
+            _statistics.Received(size);
+            _server->_shards[_shard]->statistics.Received(size);
+
+            // Update the last read time
+            _read_time = _service->timer_time();
 
-            // Call the buffer received handler
-            onReceived(_recive_buffer.data(), size);
+            // Call the buffer received handler or parse received messages
+            if (!_framer.enabled())
+                onReceived(_recive_buffer.data(), size);
+            else if (!_framer.Process(_recive_buffer.data(), size, [this](const uint8_t* message, size_t message_size) { onReceivedMessage(message, message_size); }))
+                ec = asio::error::message_size;
 
-            // If the receive buffer is full increase its size
-            if (_recive_buffer.size() == size)
-                _recive_buffer.resize(2 * size);
+            // Grow or shrink the receive buffer
+            _recive_buffer.Update(size);
         }
 
         // Try to receive again if the session is valid
@@ -189,41 +443,107 @@ inline void SSLSession<TServer, TSession>::TryReceive()
             TryReceive();
         else
         {
+            _recive_buffer.Release();
             SendError(ec);
             Disconnect(true);
         }
-    });
+    };
+    if (_strand_required)
+        _stream->async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), _strand.wrap(MakeAllocHandler(_receive_storage, async_receive_handler)));
+    else
+        _stream->async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), MakeAllocHandler(_receive_storage, async_receive_handler));
 }
 
 template <class TServer, class TSession>
-inline void SSLSession<TServer, TSession>::TrySend()
+inline void SSLSession<TServer, TSession>::TryReceiveRing()
 {
-    if (_sending)
-        return;
+    _reciving = true;
+    auto self(this->shared_from_this());
+    auto async_receive_handler = [this, self](std::error_code ec, std::size_t size)
+    {
+        _reciving = false;
+
+        if (!IsHandshaked())
+            return;
+
+        // Received some data from the client
+        if (size > 0)
+        {
+            // Update statistic
+            _statistics.Received(size);
+            _server->_shards[_shard]->statistics.Received(size);
+
+            // Update the last read time
+            _read_time = _service->timer_time();
+
+            // Call the ring received handler or parse received messages in place
+            _receive_ring.Commit(size);
+            if (!_framer.enabled())
+                onReceivedRing(_receive_ring.data(), _receive_ring.size());
+            else
+            {
+                size_t parsed;
+                if (_framer.Parse(_receive_ring.data(), _receive_ring.size(), [this](const uint8_t* message, size_t message_size) { onReceivedMessage(message, message_size); }, parsed))
+                    _receive_ring.Consume(parsed);
+                else
+                    ec = asio::error::message_size;
+            }
+
+            // Nothing more could be received into the full ring
+            if (!ec && IsHandshaked() && _receive_ring.full())
+                ec = asio::error::no_buffer_space;
+        }
+
+        // Try to receive again if the session is valid
+        if (!ec)
+            TryReceive();
+        else
+        {
+            SendError(ec);
+            Disconnect(true);
+        }
+    };
 
+    // Read into the free space of the receive ring
+    asio::mutable_buffer buffer = _receive_ring.Prepare();
+    if (_strand_required)
+        _stream->async_read_some(asio::buffer(buffer), _strand.wrap(MakeAllocHandler(_receive_storage, async_receive_handler)));
+    else
+        _stream->async_read_some(asio::buffer(buffer), MakeAllocHandler(_receive_storage, async_receive_handler));
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::TrySend()
+{
     if (!IsHandshaked())
         return;
 
-    // Swap send buffers
-    if (_send_buffer_flush.empty())
-    {
-        std::lock_guard<std::mutex> locker(_send_lock);
+    // Apply the slow consumer policy to the send buffer
+    if (_send_buffer_overflow)
+        HandleSendBufferOverflow();
 
-        // Swap flush and main buffers
-        _send_buffer_flush.swap(_send_buffer_main);
-        _send_buffer_flush_offset = 0;
+    // Collect sent data until the session is uncorked
+    if (_corked > 0)
+    {
+        CorkSocket(true);
+        return;
     }
 
-    // Check if the flush buffer is empty
-    if (_send_buffer_flush.empty())
+    if (_sending)
+        return;
+
+    // Move queued buffers into the flush part
+    if (!_send_queue.Flush())
     {
         // Nothing to send...
+        CorkSocket(false);
+        HandleSendBufferDrain(_send_queue.size());
         return;
     }
 
     _sending = true;
     auto self(this->shared_from_this());
-    asio::async_write(_stream, asio::buffer(_send_buffer_flush.data() + _send_buffer_flush_offset, _send_buffer_flush.size() - _send_buffer_flush_offset), [this, self](std::error_code ec, std::size_t size)
+    auto async_write_handler = [this, self](std::error_code ec, std::size_t size)
     {
         _sending = false;
 
@@ -236,25 +556,24 @@ inline void SSLSession<TServer, TSession>::TrySend()
         if (size > 0)
         {
             // Update statistic
-            _bytes_sent += size;
-            _server->_bytes_sent += size;
+            _statistics.Sent(size);
+            _server->_shards[_shard]->statistics.Sent(size);
 
-            // Call the buffer sent handler
-            onSent(size, _send_buffer_flush.size() - size);
+            // Update the last write time
+            _write_time = _service->timer_time();
 
-            // Increase the flush buffer offset
-            _send_buffer_flush_offset += size;
+            // Consume the written data from the send queue
+            _send_queue.Consume(size);
+            size_t pending = _send_queue.size();
 
-            // Successfully send the whole flush buffer
-            if (_send_buffer_flush_offset == _send_buffer_flush.size())
-            {
-                // Clear the flush buffer
-                _send_buffer_flush.clear();
-                _send_buffer_flush_offset = 0;
+            // Stop sending operation if the send queue is empty
+            resume = (pending > 0);
 
-                // Stop sending operation
-                resume = false;
-            }
+            // Call the buffer sent handler
+            onSent(size, pending);
+
+            // Check the send buffer low watermark
+            HandleSendBufferDrain(pending);
         }
 
         // Try to send again if the session is valid
@@ -263,27 +582,247 @@ inline void SSLSession<TServer, TSession>::TrySend()
             if (resume)
                 TrySend();
             else
+            {
+                // Push the tail of the last write held by the corked socket
+                if (_corked == 0)
+                    CorkSocket(false);
                 onEmpty();
+            }
         }
         else
         {
             SendError(ec);
             Disconnect(true);
         }
-    });
+    };
+    if (_strand_required)
+        asio::async_write(*_stream, ConstBuffersView(_send_queue.buffers()), _strand.wrap(MakeAllocHandler(_send_storage, async_write_handler)));
+    else
+        asio::async_write(*_stream, ConstBuffersView(_send_queue.buffers()), MakeAllocHandler(_send_storage, async_write_handler));
 }
 
 template <class TServer, class TSession>
-inline void SSLSession<TServer, TSession>::ClearBuffers()
+inline void SSLSession<TServer, TSession>::CorkSocket(bool enable)
+{
+    if (_socket_corked == enable)
+        return;
+
+    // Corking the socket is only a hint, so its failure is ignored
+    _socket_corked = SocketOptions::Cork(_stream->lowest_layer(), enable) && enable;
+}
+
+template <class TServer, class TSession>
+inline bool SSLSession<TServer, TSession>::CheckSendBuffer(size_t size)
+{
+    size_t limit = _server->_send_buffer_limit;
+    if ((_send_buffer_high == 0) && (limit == 0))
+        return true;
+
+    // Check the send buffer high watermark and the server send buffer limit
+    if (((_send_buffer_high == 0) || ((_send_queue.size() + size) <= _send_buffer_high)) &&
+        ((limit == 0) || ((_server->_send_buffer_size + size) <= limit)))
+        return true;
+
+    // Schedule the slow consumer policy for the send routine
+    _send_buffer_overflow = true;
+
+    switch (_slow_consumer_policy)
+    {
+        case SlowConsumerPolicy::DropOldest:
+            // The oldest pending data will be dropped by the send routine
+            return true;
+        case SlowConsumerPolicy::Disconnect:
+            Disconnect(false);
+            return false;
+        default:
+            // Notify about the rejected data from the send routine
+            ScheduleSend();
+            return false;
+    }
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::HandleSendBufferOverflow()
+{
+    _send_buffer_overflow = false;
+
+    // Drop the oldest pending data over the high watermark and the server send buffer limit
+    if (_slow_consumer_policy == SlowConsumerPolicy::DropOldest)
+    {
+        size_t pending = _send_queue.size();
+        size_t excess = ((_send_buffer_high > 0) && (pending > _send_buffer_high)) ? (pending - _send_buffer_high) : 0;
+        size_t limit = _server->_send_buffer_limit;
+        size_t total = _server->_send_buffer_size;
+        if ((limit > 0) && (total > limit))
+            excess = std::max(excess, total - limit);
+        if (excess > 0)
+            _send_queue.Drop(excess);
+    }
+
+    // Call the send buffer high watermark handler
+    if (!_send_buffer_full)
+    {
+        _send_buffer_full = true;
+        onSendBufferHigh();
+    }
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::HandleSendBufferDrain(size_t pending)
+{
+    // Call the send buffer low watermark handler
+    if (_send_buffer_full && (pending <= _send_buffer_low))
+    {
+        _send_buffer_full = false;
+        onSendBufferLow();
+    }
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::StartIdleTimer()
+{
+    uint64_t read = _server->_read_timeout;
+    uint64_t write = _server->_write_timeout;
+    uint64_t lifetime = _server->_lifetime;
+
+    _idle_timed = ((read > 0) || (write > 0) || (lifetime > 0));
+    if (!_idle_timed)
+        return;
+
+    // Idle timer handler should not revive the session which is released under the timing wheel lock
+    _idle_self = this->shared_from_this();
+
+    // Arm the idle timer to the nearest timeout, the timer refreshes the service time
+    uint64_t timeout = std::numeric_limits<uint64_t>::max();
+    if (read > 0)
+        timeout = std::min(timeout, read);
+    if (write > 0)
+        timeout = std::min(timeout, write);
+    if (lifetime > 0)
+        timeout = std::min(timeout, lifetime);
+    _service->ArmTimer(_idle_timer, timeout);
+
+    // Start the idle time and the lifetime
+    _lifetime_expired = false;
+    _connect_time = _read_time = _write_time = _service->timer_time();
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::ScheduleIdleCheck()
+{
+    // The idle timer expires under the timing wheel lock, so the check routine is posted
+    auto self(_idle_self.lock());
+    if (!self)
+        return;
+
+    auto idle_handler = [this, self]() { CheckIdle(); };
+    if (_strand_required)
+        _strand.post(idle_handler);
+    else
+        _service->Post(idle_handler);
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::CheckIdle()
 {
-    // Clear send buffers
+    if (!IsConnected() || !_idle_timed)
+        return;
+
+    auto session = std::static_pointer_cast<TSession>(this->shared_from_this());
+    uint64_t now = _service->timer_time();
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+
+    // Check the read idle timeout
+    uint64_t timeout = _server->_read_timeout;
+    if (timeout > 0)
+    {
+        if (now >= (_read_time + timeout))
+        {
+            _read_time = now;
+            _server->onIdle(session, IdleTimeout::Read);
+        }
+        next = std::min(next, _read_time + timeout);
+    }
+
+    // Check the write idle timeout
+    timeout = _server->_write_timeout;
+    if ((timeout > 0) && IsConnected())
     {
-        std::lock_guard<std::mutex> locker(_send_lock);
+        if (now >= (_write_time + timeout))
+        {
+            _write_time = now;
+            _server->onIdle(session, IdleTimeout::Write);
+        }
+        next = std::min(next, _write_time + timeout);
+    }
 
-        _send_buffer_main.clear();
-        _send_buffer_flush.clear();
-        _send_buffer_flush_offset = 0;
+    // Check the lifetime
+    timeout = _server->_lifetime;
+    if ((timeout > 0) && !_lifetime_expired && IsConnected())
+    {
+        if (now >= (_connect_time + timeout))
+        {
+            _lifetime_expired = true;
+            _server->onIdle(session, IdleTimeout::Lifetime);
+        }
+        else
+            next = std::min(next, _connect_time + timeout);
     }
+
+    // Wait for the nearest idle timeout
+    if (IsConnected() && (next != std::numeric_limits<uint64_t>::max()))
+        _service->ArmTimer(_idle_timer, next - std::min(next, now));
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::ClearBuffers()
+{
+    // Clear the send queue
+    _send_queue.Clear();
+    _send_buffer_overflow = false;
+    _send_buffer_full = false;
+    _socket_corked = false;
+
+    // Drop the split message tail
+    _framer.Reset();
+}
+
+template <class TServer, class TSession>
+inline bool SSLSession<TServer, TSession>::Recycle()
+{
+    // Pooled session should not be reached by its idle timer
+    _idle_timed = false;
+    _service->CancelTimer(_idle_timer);
+
+    // Return the receive buffer into the buffer pool of the service
+    _recive_buffer.Release();
+
+    // Drop data sent after the disconnect, so it never reaches the next peer
+    ClearBuffers();
+
+    // Destroy the SSL stream with its SSL state and buffered data
+    _stream.reset();
+
+    return true;
+}
+
+template <class TServer, class TSession>
+inline void SSLSession<TServer, TSession>::Reuse(std::shared_ptr<SSLServer<TServer, TSession>> server, asio::ip::tcp::socket&& socket)
+{
+    _server = server;
+    _stream.reset(new asio::ssl::stream<asio::ip::tcp::socket>(std::move(socket), *_context));
+    _shutting_down = false;
+
+    // Reset the connection state, send & receive buffers keep their memory
+    _reciving = false;
+    _sending = false;
+    _send_scheduled = false;
+    _corked = 0;
+    _socket_corked = false;
+    _receive_ring.Clear();
+
+    // Call the session recycled handler
+    onRecycled();
 }
 
 template <class TServer, class TSession>
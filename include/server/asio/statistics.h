@@ -0,0 +1,189 @@
+/*!
+    \file statistics.h
+    \brief Statistics counters definition
+    \author Ivan Shynkarenka
+    \date 02.04.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_STATISTICS_H
+#define CPPSERVER_ASIO_STATISTICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace CppServer {
+namespace Asio {
+
+//! Statistics snapshot
+/*!
+    Statistics snapshot keeps the values of server or session counters
+    collected at some moment. Messages are counted only by message based
+    servers (e.g. UDP datagrams or WebSocket messages).
+*/
+struct Statistics
+{
+    //! Number of messages sent
+    uint64_t messages_sent;
+    //! Number of messages received
+    uint64_t messages_received;
+    //! Number of bytes sent
+    uint64_t bytes_sent;
+    //! Number of bytes received
+    uint64_t bytes_received;
+
+    Statistics() noexcept : messages_sent(0), messages_received(0), bytes_sent(0), bytes_received(0) {}
+
+    Statistics& operator+=(const Statistics& statistics) noexcept
+    {
+        messages_sent += statistics.messages_sent;
+        messages_received += statistics.messages_received;
+        bytes_sent += statistics.bytes_sent;
+        bytes_received += statistics.bytes_received;
+        return *this;
+    }
+};
+
+//! Statistics shard
+/*!
+    Statistics shard keeps server counters updated by sessions of one server
+    shard (one Asio service). Counters are surrounded by cache line padding,
+    so counters of different shards never share the same cache line and
+    sessions of different shards do not bounce it between CPU cores.
+
+    Counters are updated with relaxed atomic operations, because several
+    working threads of the same Asio service may update them in parallel.
+    Each counter of the snapshot is never less than in any previous snapshot,
+    but counters of different kind may be collected at slightly different
+    moments.
+
+    Thread-safe.
+*/
+class StatisticsShard
+{
+public:
+    //! Assumed CPU cache line size
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    StatisticsShard() noexcept { Reset(); }
+    StatisticsShard(const StatisticsShard&) = delete;
+    StatisticsShard(StatisticsShard&&) = delete;
+    ~StatisticsShard() = default;
+
+    StatisticsShard& operator=(const StatisticsShard&) = delete;
+    StatisticsShard& operator=(StatisticsShard&&) = delete;
+
+    //! Count sent bytes and messages
+    /*!
+        \param bytes - Count of sent bytes
+        \param messages - Count of sent messages (default is 0)
+    */
+    void Sent(size_t bytes, size_t messages = 0) noexcept
+    {
+        if (messages > 0)
+            _messages_sent.fetch_add(messages, std::memory_order_relaxed);
+        _bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    //! Count received bytes and messages
+    /*!
+        \param bytes - Count of received bytes
+        \param messages - Count of received messages (default is 0)
+    */
+    void Received(size_t bytes, size_t messages = 0) noexcept
+    {
+        if (messages > 0)
+            _messages_received.fetch_add(messages, std::memory_order_relaxed);
+        _bytes_received.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    //! Collect shard counters into the given statistics snapshot
+    /*!
+        \param statistics - Statistics snapshot to add shard counters
+    */
+    void Collect(Statistics& statistics) const noexcept
+    {
+        statistics.messages_sent += _messages_sent.load(std::memory_order_relaxed);
+        statistics.messages_received += _messages_received.load(std::memory_order_relaxed);
+        statistics.bytes_sent += _bytes_sent.load(std::memory_order_relaxed);
+        statistics.bytes_received += _bytes_received.load(std::memory_order_relaxed);
+    }
+
+    //! Reset shard counters
+    void Reset() noexcept
+    {
+        _messages_sent.store(0, std::memory_order_relaxed);
+        _messages_received.store(0, std::memory_order_relaxed);
+        _bytes_sent.store(0, std::memory_order_relaxed);
+        _bytes_received.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // Full cache line padding on both sides does not depend on the shard alignment
+    uint8_t _padding1[CACHE_LINE_SIZE];
+    std::atomic<uint64_t> _messages_sent;
+    std::atomic<uint64_t> _messages_received;
+    std::atomic<uint64_t> _bytes_sent;
+    std::atomic<uint64_t> _bytes_received;
+    uint8_t _padding2[CACHE_LINE_SIZE];
+};
+
+//! Session statistics
+/*!
+    Session statistics keeps counters of a single session. Counters could be
+    plain integers if they are updated only from the session strand or atomic
+    integers otherwise.
+
+    Session counters could be compiled out by defining
+    CPPSERVER_ASIO_NO_SESSION_STATISTICS. In this case counting is a no-op
+    and all session counters are always 0, but server statistics are still
+    available.
+
+    Not thread-safe unless atomic counters are used.
+*/
+template <typename TCounter = uint64_t>
+class SessionStatistics
+{
+public:
+#if !defined(CPPSERVER_ASIO_NO_SESSION_STATISTICS)
+    SessionStatistics() noexcept { Reset(); }
+
+    //! Get the number of messages sent
+    uint64_t messages_sent() const noexcept { return _messages_sent; }
+    //! Get the number of messages received
+    uint64_t messages_received() const noexcept { return _messages_received; }
+    //! Get the number of bytes sent
+    uint64_t bytes_sent() const noexcept { return _bytes_sent; }
+    //! Get the number of bytes received
+    uint64_t bytes_received() const noexcept { return _bytes_received; }
+
+    //! Count sent bytes and messages
+    void Sent(size_t bytes, size_t messages = 0) noexcept { _messages_sent += messages; _bytes_sent += bytes; }
+    //! Count received bytes and messages
+    void Received(size_t bytes, size_t messages = 0) noexcept { _messages_received += messages; _bytes_received += bytes; }
+
+    //! Reset session counters
+    void Reset() noexcept { _messages_sent = 0; _messages_received = 0; _bytes_sent = 0; _bytes_received = 0; }
+
+private:
+    TCounter _messages_sent;
+    TCounter _messages_received;
+    TCounter _bytes_sent;
+    TCounter _bytes_received;
+#else
+    uint64_t messages_sent() const noexcept { return 0; }
+    uint64_t messages_received() const noexcept { return 0; }
+    uint64_t bytes_sent() const noexcept { return 0; }
+    uint64_t bytes_received() const noexcept { return 0; }
+
+    void Sent(size_t bytes, size_t messages = 0) noexcept {}
+    void Received(size_t bytes, size_t messages = 0) noexcept {}
+
+    void Reset() noexcept {}
+#endif
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_STATISTICS_H
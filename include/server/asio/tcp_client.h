@@ -9,11 +9,16 @@
 #ifndef CPPSERVER_ASIO_TCP_CLIENT_H
 #define CPPSERVER_ASIO_TCP_CLIENT_H
 
+#include "handler_allocator.h"
+#include "message_framer.h"
+#include "ring_buffer.h"
+#include "send_queue.h"
+#include "socket_options.h"
 #include "service.h"
+#include "zero_copy.h"
 
 #include "system/uuid.h"
 
-#include <mutex>
 #include <vector>
 
 namespace CppServer {
@@ -22,6 +27,8 @@ namespace Asio {
 //! TCP client
 /*!
     TCP client is used to read/write data from/into the connected TCP server.
+    All client handlers are serialized through the client strand if the
+    Asio service is running in several working threads.
 
     Thread-safe.
 */
@@ -43,13 +50,27 @@ public:
     explicit TCPClient(std::shared_ptr<Service> service, const asio::ip::tcp::endpoint& endpoint);
     TCPClient(const TCPClient&) = delete;
     TCPClient(TCPClient&&) = default;
-    virtual ~TCPClient() = default;
+    virtual ~TCPClient();
 
     TCPClient& operator=(const TCPClient&) = delete;
     TCPClient& operator=(TCPClient&&) = default;
 
     //! Get the client Id
     const CppCommon::UUID& id() const noexcept { return _id; }
+    //! Get the client key
+    /*!
+        Client key is a compact 64-bit identifier of the client unique
+        inside the process.
+    */
+    uint64_t key() const noexcept { return _key; }
+    //! Is the idle receive mode enabled?
+    bool idle_receive() const noexcept { return _idle_receive; }
+    //! Is the speculative I/O mode enabled?
+    bool speculative_io() const noexcept { return _speculative_io; }
+    //! Get the minimal size of pending data to send with zero copy (0 if the zero copy mode is disabled)
+    size_t zero_copy() const noexcept { return _zero_copy.threshold(); }
+    //! Is the client send buffer corked?
+    bool corked() const noexcept { return (_corked > 0); }
 
     //! Get the Asio service
     std::shared_ptr<Service>& service() noexcept { return _service; }
@@ -62,6 +83,18 @@ public:
     uint64_t bytes_sent() const noexcept { return _bytes_sent; }
     //! Get the number of bytes received by this client
     uint64_t bytes_received() const noexcept { return _bytes_received; }
+    //! Get the message framer
+    const MessageFramer& framer() const noexcept { return _framer; }
+    //! Get the receive ring capacity (0 if the receive ring mode is disabled)
+    size_t receive_ring() const noexcept { return _receive_ring.capacity(); }
+    //! Get the send buffer high watermark
+    size_t send_buffer_high() const noexcept { return _send_buffer_high; }
+    //! Get the send buffer low watermark
+    size_t send_buffer_low() const noexcept { return _send_buffer_low; }
+    //! Get the slow consumer policy
+    SlowConsumerPolicy slow_consumer_policy() const noexcept { return _slow_consumer_policy; }
+    //! Get the socket options
+    const SocketOptions& socket_options() const noexcept { return _socket_options; }
 
     //! Is the client connected?
     bool IsConnected() const noexcept { return _connected; }
@@ -82,6 +115,52 @@ public:
     */
     bool Reconnect();
 
+    //! Setup the id policy of the client
+    /*!
+        By default the client Id is made from its monotonic 64-bit key.
+        Random UUID Id should be requested explicitly with IdPolicy::UUID.
+
+        \param policy - Id policy
+    */
+    void SetupIdPolicy(IdPolicy policy);
+    //! Setup the idle receive mode
+    /*!
+        In the idle receive mode the client waits for incoming data without
+        a receive buffer and borrows it from the service buffer pool only to
+        read the available data, so an idle client holds no receive memory.
+        The mode costs an additional wait operation for each read and should
+        be setup before the client is connected.
+
+        \param enable - Enable the idle receive mode
+    */
+    void SetupIdleReceive(bool enable) noexcept { _idle_receive = enable; }
+    //! Setup the speculative I/O mode
+    /*!
+        In the speculative I/O mode the client tries to read and write data
+        with non-blocking operations right on the client thread and falls
+        back to asynchronous operations only when the socket is not ready.
+        It saves the completion handler round trip through the Asio service
+        for each successful operation, but costs a failed system call when
+        the socket is not ready. The mode should be setup before the client
+        is connected.
+
+        \param enable - Enable the speculative I/O mode
+    */
+    void SetupSpeculativeIO(bool enable) noexcept { _speculative_io = enable; }
+    //! Setup the zero copy send mode
+    /*!
+        In the zero copy send mode the client writes pending data of the
+        given size or larger with MSG_ZEROCOPY, so the kernel transmits it
+        right from the send buffer without copying. The send buffer keeps
+        the written data until the kernel reports the completion. If the
+        kernel does not support zero copy sends or copies the data anyway
+        the client falls back to normal sends. The mode should be setup
+        before the client is connected.
+
+        \param threshold - Minimal size of pending data to send with zero copy (0 to disable)
+    */
+    void SetupZeroCopy(size_t threshold) noexcept { _zero_copy.Setup(threshold); }
+
     //! Send data to the server
     /*!
         \param buffer - Buffer to send
@@ -95,6 +174,151 @@ public:
         \return Count of pending bytes in the send buffer
     */
     size_t Send(const std::string& text) { return Send(text.data(), text.size()); }
+    //! Send a shared buffer to the server
+    /*!
+        The shared buffer is queued without copying and is kept alive
+        until it is completely sent.
+
+        \param buffer - Shared buffer to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t Send(const SharedBuffer& buffer);
+    //! Send several shared buffers to the server
+    /*!
+        All shared buffers are queued without copying and are written
+        with a single scatter/gather operation.
+
+        \param buffers - Shared buffers to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t Send(const std::vector<SharedBuffer>& buffers);
+
+    //! Send a file region to the server
+    /*!
+        The file region is written into the socket directly from the page
+        cache with sendfile(2) on Linux and is never loaded into the memory.
+        It keeps its order with other data sent to the server and its
+        progress is reported with onSent() handler. File regions are not
+        limited by the send buffer watermarks.
+
+        \param file - Shared file to send
+        \param offset - File region offset (default is 0)
+        \param size - File region size (default is 0 to send the file till its end)
+        \return Count of pending bytes in the send buffer or 0 if the file is invalid
+    */
+    size_t SendFile(const SharedFile& file, uint64_t offset = 0, uint64_t size = 0);
+    //! Send a file region with the given path to the server
+    /*!
+        \param path - File path
+        \param offset - File region offset (default is 0)
+        \param size - File region size (default is 0 to send the file till its end)
+        \return Count of pending bytes in the send buffer or 0 if the file cannot be opened
+    */
+    size_t SendFile(const std::string& path, uint64_t offset = 0, uint64_t size = 0) { return SendFile(SharedFile(path), offset, size); }
+    //! Send a file region with the given file descriptor to the server
+    /*!
+        The file descriptor is duplicated, so the caller could close it
+        right after the call.
+
+        \param fd - File descriptor
+        \param offset - File region offset (default is 0)
+        \param size - File region size (default is 0 to send the file till its end)
+        \return Count of pending bytes in the send buffer or 0 if the file descriptor is invalid
+    */
+    size_t SendFile(int fd, uint64_t offset = 0, uint64_t size = 0) { return SendFile(SharedFile(fd), offset, size); }
+
+    //! Send a message with the length prefix to the server
+    /*!
+        The message is prefixed with its length according to the message
+        framing setup and is queued as a single buffer, so messages sent
+        from several threads are never interleaved.
+
+        \param buffer - Message buffer to send
+        \param size - Message size
+        \return Count of pending bytes in the send buffer or zero if the message is larger than the maximal message size
+    */
+    size_t SendFrame(const void* buffer, size_t size);
+    //! Send a text message with the length prefix to the server
+    /*!
+        \param text - Text message to send
+        \return Count of pending bytes in the send buffer
+    */
+    size_t SendFrame(const std::string& text) { return SendFrame(text.data(), text.size()); }
+
+    //! Cork the client send buffer
+    /*!
+        While the client is corked all sent data is collected in the send
+        buffer and is not written into the socket. When the client is
+        uncorked the collected data is written with a single scatter/gather
+        operation. The socket is corked with TCP_CORK where supported.
+        Cork() and Uncork() calls could be nested and should be balanced.
+
+        Thread-safe.
+    */
+    void Cork() noexcept { ++_corked; }
+    //! Uncork the client send buffer and write all collected data
+    /*!
+        Thread-safe.
+    */
+    void Uncork();
+
+    //! Setup the message framing mode
+    /*!
+        In the message framing mode the received stream is split into
+        messages with a length prefix and onReceivedMessage() handler is
+        called for each message instead of onReceived() handler. Complete
+        messages are delivered in place from the receive buffer. The mode
+        should be setup before the client is connected.
+
+        \param prefix_size - Length prefix size (1, 2, 4 or 8 bytes, default is 4)
+        \param byte_order - Length prefix byte order (default is ByteOrder::BigEndian)
+        \param max_size - Maximal message size (default is MessageFramer::MAX_SIZE)
+    */
+    void SetupFraming(size_t prefix_size = 4, ByteOrder byte_order = ByteOrder::BigEndian, size_t max_size = MessageFramer::MAX_SIZE) { _framer.Setup(prefix_size, byte_order, max_size); }
+    //! Setup the receive ring mode
+    /*!
+        In the receive ring mode the client reads data into a ring buffer and
+        onReceivedRing() handler is called with all unconsumed received data
+        as one contiguous span. Processed data should be consumed with
+        ConsumeReceived() method, the rest of the data is passed into the
+        handler again together with the next received data. If the message
+        framing is enabled messages are parsed in place from the ring, so
+        split messages are never copied. The client is disconnected with an
+        error if the ring is full after the handler call. The mode should
+        be setup before the client is connected.
+
+        \param capacity - Receive ring capacity (rounded up to the memory page size, 0 to disable)
+    */
+    void SetupReceiveRing(size_t capacity) { _receive_ring.Setup(capacity); }
+    //! Consume the given count of received bytes from the receive ring
+    /*!
+        Should be called from onReceivedRing() handler.
+
+        \param size - Count of bytes to consume (should not be greater than the unconsumed data size)
+    */
+    void ConsumeReceived(size_t size) { _receive_ring.Consume(size); }
+    //! Setup the send buffer watermarks
+    /*!
+        When the send buffer reaches the high watermark the slow consumer
+        policy is applied to the new data and onSendBufferHigh() handler
+        is called. When the send buffer is drained down to the low
+        watermark onSendBufferLow() handler is called. The watermarks
+        should be setup before the client is connected.
+
+        \param high - Send buffer high watermark in bytes (0 to disable)
+        \param low - Send buffer low watermark in bytes (should not be greater than the high watermark)
+        \param policy - Slow consumer policy (default is SlowConsumerPolicy::Reject)
+    */
+    void SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy = SlowConsumerPolicy::Reject);
+    //! Setup the socket options
+    /*!
+        Socket options are applied to the client socket before it is
+        connected. Socket options should be setup before the client is
+        connected.
+
+        \param options - Socket options
+    */
+    void SetupSocketOptions(const SocketOptions& options) { _socket_options = options; }
 
 protected:
     //! Handle client connected notification
@@ -111,6 +335,26 @@ protected:
         \param size - Received buffer size
     */
     virtual void onReceived(const void* buffer, size_t size) {}
+    //! Handle message received notification
+    /*!
+        Notification is called in the message framing mode when another
+        complete message was received from the server. The message buffer
+        is valid only during the notification call.
+
+        \param buffer - Received message buffer
+        \param size - Received message size
+    */
+    virtual void onReceivedMessage(const void* buffer, size_t size) {}
+    //! Handle received data notification in the receive ring mode
+    /*!
+        Notification is called in the receive ring mode when some data was
+        received from the server. The buffer contains all received data which
+        was not consumed yet and is valid only during the notification call.
+
+        \param buffer - Unconsumed received data
+        \param size - Unconsumed received data size
+    */
+    virtual void onReceivedRing(const void* buffer, size_t size) {}
     //! Handle buffer sent notification
     /*!
         Notification is called when another chunk of buffer was sent
@@ -133,6 +377,22 @@ protected:
     */
     virtual void onEmpty() {}
 
+    //! Handle send buffer high watermark notification
+    /*!
+        Notification is called when the new data to send reached the send
+        buffer high watermark and the slow consumer policy
+        was applied to it.
+    */
+    virtual void onSendBufferHigh() {}
+    //! Handle send buffer low watermark notification
+    /*!
+        Notification is called when the send buffer was drained down to
+        the low watermark after the high watermark notification.
+
+        This handler could be used to resume sending data to the server.
+    */
+    virtual void onSendBufferLow() {}
+
     //! Handle error notification
     /*!
         \param error - Error code
@@ -142,10 +402,13 @@ protected:
     virtual void onError(int error, const std::string& category, const std::string& message) {}
 
 private:
-    // Client Id
+    // Client key & Id
+    uint64_t _key;
     CppCommon::UUID _id;
-    // Asio service
+    // Asio service & strand
     std::shared_ptr<Service> _service;
+    asio::io_service::strand _strand;
+    bool _strand_required;
     // Server endpoint & client socket
     asio::ip::tcp::endpoint _endpoint;
     asio::ip::tcp::socket _socket;
@@ -156,13 +419,37 @@ private:
     uint64_t _bytes_received;
     // Receive buffer & cache
     bool _reciving;
-    std::vector<uint8_t> _recive_buffer;
-    // Send buffer & cache
+    bool _idle_receive;
+    ReceiveBuffer _recive_buffer;
+    // Message framer
+    MessageFramer _framer;
+    // Receive ring
+    RingBuffer _receive_ring;
+    // Send queue
     bool _sending;
-    std::mutex _send_lock;
-    std::vector<uint8_t> _send_buffer_main;
-    std::vector<uint8_t> _send_buffer_flush;
-    size_t _send_buffer_flush_offset;
+    std::atomic<bool> _send_scheduled;
+    SendQueue _send_queue;
+    // Handler storages of receive and send operations
+    HandlerStorage _receive_storage;
+    HandlerStorage _send_storage;
+    // Send batching
+    std::atomic<int> _corked;
+    bool _socket_corked;
+    // Send buffer watermarks
+    size_t _send_buffer_high;
+    size_t _send_buffer_low;
+    SlowConsumerPolicy _slow_consumer_policy;
+    std::atomic<bool> _send_buffer_overflow;
+    bool _send_buffer_full;
+    // Speculative I/O
+    bool _speculative_io;
+    bool _speculative_receiving;
+    bool _speculative_sending;
+    // Zero copy send
+    ZeroCopy _zero_copy;
+    bool _zero_copy_waiting;
+    // Socket options
+    SocketOptions _socket_options;
 
     //! Disconnect the client
     /*!
@@ -173,8 +460,33 @@ private:
 
     //! Try to receive new data
     void TryReceive();
+    //! Try to receive new data into the receive ring
+    void TryReceiveRing();
+    //! Is the current thread running the client handlers?
+    bool IsInStrand() { return _strand_required ? _strand.running_in_this_thread() : _service->IsServiceThread(); }
+
+    //! Schedule the send routine
+    void ScheduleSend();
     //! Try to send pending data
     void TrySend();
+    //! Try to release buffers of completed zero copy sends
+    void TryComplete();
+    //! Cork or uncork the client socket
+    void CorkSocket(bool enable);
+
+    //! Check the send buffer for the new data to send and apply the slow consumer policy
+    /*!
+        \param size - Size of the new data to send
+        \return 'true' if the new data should be queued, 'false' if the new data was rejected
+    */
+    bool CheckSendBuffer(size_t size);
+    //! Handle the send buffer overflow in the send routine
+    void HandleSendBufferOverflow();
+    //! Handle the drained send buffer in the send routine
+    /*!
+        \param pending - Count of pending bytes in the send buffer
+    */
+    void HandleSendBufferDrain(size_t pending);
 
     //! Clear receive & send buffers
     void ClearBuffers();
@@ -9,18 +9,69 @@
 namespace CppServer {
 namespace Asio {
 
+template <class TServer, class TSession>
+inline TCPServer<TServer, TSession>::Shard::Shard(size_t index, std::shared_ptr<Service> service)
+    : index(index),
+      service(service),
+      strand(*service->service()),
+      strand_required(service->IsStrandRequired()),
+      sessions_count(0),
+      sessions_key(0),
+      acceptor(*service->service()),
+      socket(*service->service())
+{
+}
+
+template <class TServer, class TSession>
+inline TCPServer<TServer, TSession>::Shard::~Shard()
+{
+    // Destroy idle pooled sessions
+    for (auto session : pool)
+        delete session;
+}
+
 template <class TServer, class TSession>
 inline TCPServer<TServer, TSession>::TCPServer(std::shared_ptr<Service> service, InternetProtocol protocol, int port)
-    : _service(service),
+    : TCPServer(std::vector<std::shared_ptr<Service>>({ service }), protocol, port)
+{
+}
+
+template <class TServer, class TSession>
+inline TCPServer<TServer, TSession>::TCPServer(std::shared_ptr<Service> service, const std::string& address, int port)
+    : TCPServer(std::vector<std::shared_ptr<Service>>({ service }), address, port)
+{
+}
+
+template <class TServer, class TSession>
+inline TCPServer<TServer, TSession>::TCPServer(std::shared_ptr<Service> service, const asio::ip::tcp::endpoint& endpoint)
+    : TCPServer(std::vector<std::shared_ptr<Service>>({ service }), endpoint)
+{
+}
+
+template <class TServer, class TSession>
+inline TCPServer<TServer, TSession>::TCPServer(const std::vector<std::shared_ptr<Service>>& services, InternetProtocol protocol, int port, ShardPolicy policy)
+    : _service(services.empty() ? nullptr : services.front()),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
+      _shard_policy(policy),
+      _shard_next(0),
+      _id_policy(IdPolicy::Sequential),
+      _session_key(0),
+      _idle_receive(false),
+      _speculative_io(false),
+      _send_buffer_high(0),
+      _send_buffer_low(0),
+      _slow_consumer_policy(SlowConsumerPolicy::Reject),
+      _send_buffer_limit(0),
+      _send_buffer_size(0),
+      _session_pool(0),
+      _read_timeout(0),
+      _write_timeout(0),
+      _lifetime(0),
       _acceptor(*_service->service()),
-      _socket(*_service->service()),
-      _started(false),
-      _bytes_sent(0),
-      _bytes_received(0)
+      _started(false)
 {
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
-        throw CppCommon::ArgumentException("ASIO service is invalid!");
+    CreateShards(services);
 
     switch (protocol)
     {
@@ -34,34 +85,103 @@ inline TCPServer<TServer, TSession>::TCPServer(std::shared_ptr<Service> service,
 }
 
 template <class TServer, class TSession>
-inline TCPServer<TServer, TSession>::TCPServer(std::shared_ptr<Service> service, const std::string& address, int port)
-    : _service(service),
+inline TCPServer<TServer, TSession>::TCPServer(const std::vector<std::shared_ptr<Service>>& services, const std::string& address, int port, ShardPolicy policy)
+    : _service(services.empty() ? nullptr : services.front()),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
+      _shard_policy(policy),
+      _shard_next(0),
+      _id_policy(IdPolicy::Sequential),
+      _session_key(0),
+      _idle_receive(false),
+      _speculative_io(false),
+      _send_buffer_high(0),
+      _send_buffer_low(0),
+      _slow_consumer_policy(SlowConsumerPolicy::Reject),
+      _send_buffer_limit(0),
+      _send_buffer_size(0),
+      _session_pool(0),
+      _read_timeout(0),
+      _write_timeout(0),
+      _lifetime(0),
       _acceptor(*_service->service()),
-      _socket(*_service->service()),
-      _started(false),
-      _bytes_sent(0),
-      _bytes_received(0)
+      _started(false)
 {
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
-        throw CppCommon::ArgumentException("ASIO service is invalid!");
+    CreateShards(services);
 
     _endpoint = asio::ip::tcp::endpoint(asio::ip::address::from_string(address), port);
 }
 
 template <class TServer, class TSession>
-inline TCPServer<TServer, TSession>::TCPServer(std::shared_ptr<Service> service, const asio::ip::tcp::endpoint& endpoint)
-    : _service(service),
+inline TCPServer<TServer, TSession>::TCPServer(const std::vector<std::shared_ptr<Service>>& services, const asio::ip::tcp::endpoint& endpoint, ShardPolicy policy)
+    : _service(services.empty() ? nullptr : services.front()),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
+      _shard_policy(policy),
+      _shard_next(0),
+      _id_policy(IdPolicy::Sequential),
+      _session_key(0),
+      _idle_receive(false),
+      _speculative_io(false),
+      _send_buffer_high(0),
+      _send_buffer_low(0),
+      _slow_consumer_policy(SlowConsumerPolicy::Reject),
+      _send_buffer_limit(0),
+      _send_buffer_size(0),
+      _session_pool(0),
+      _read_timeout(0),
+      _write_timeout(0),
+      _lifetime(0),
       _endpoint(endpoint),
       _acceptor(*_service->service()),
-      _socket(*_service->service()),
-      _started(false),
-      _bytes_sent(0),
-      _bytes_received(0)
+      _started(false)
+{
+    CreateShards(services);
+}
+
+template <class TServer, class TSession>
+inline void TCPServer<TServer, TSession>::CreateShards(const std::vector<std::shared_ptr<Service>>& services)
+{
+    for (auto& service : services)
+    {
+        assert((service != nullptr) && "ASIO service is invalid!");
+        if (service == nullptr)
+            throw CppCommon::ArgumentException("ASIO service is invalid!");
+
+        _shards.emplace_back(std::make_unique<Shard>(_shards.size(), service));
+    }
+
+#if !defined(SO_REUSEPORT)
+    // Fallback to the single server acceptor if SO_REUSEPORT is not supported
+    if (_shard_policy == ShardPolicy::ReusePort)
+        _shard_policy = ShardPolicy::RoundRobin;
+#endif
+}
+
+template <class TServer, class TSession>
+inline uint64_t TCPServer<TServer, TSession>::current_sessions() const noexcept
+{
+    uint64_t result = 0;
+    for (auto& shard : _shards)
+        result += shard->sessions_count;
+    return result;
+}
+
+template <class TServer, class TSession>
+inline Statistics TCPServer<TServer, TSession>::statistics() const noexcept
 {
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
-        throw CppCommon::ArgumentException("ASIO service is invalid!");
+    Statistics result;
+    for (auto& shard : _shards)
+        shard->statistics.Collect(result);
+    return result;
+}
+
+template <class TServer, class TSession>
+inline Statistics TCPServer<TServer, TSession>::statistics(size_t shard) const noexcept
+{
+    Statistics result;
+    _shards[shard]->statistics.Collect(result);
+    return result;
 }
 
 template <class TServer, class TSession>
@@ -73,17 +193,26 @@ inline bool TCPServer<TServer, TSession>::Start()
 
     // Post the start routine
     auto self(this->shared_from_this());
-    _service->service()->post([this, self]()
+    auto start_handler = [this, self]()
     {
         if (IsStarted())
             return;
 
         // Create the server acceptor
-        _acceptor = asio::ip::tcp::acceptor(*_service->service(), _endpoint);
+        if (_shard_policy != ShardPolicy::ReusePort)
+        {
+            _acceptor = asio::ip::tcp::acceptor(*_service->service(), _endpoint);
+
+            // Apply socket buffer sizes inherited by accepted sockets
+            asio::error_code ec;
+            _socket_options.Apply(_acceptor, ec);
+            if (ec)
+                SendError(ec);
+        }
 
         // Reset statistic
-        _bytes_sent = 0;
-        _bytes_received = 0;
+        for (auto& shard : _shards)
+            shard->statistics.Reset();
 
         // Update the started flag
         _started = true;
@@ -92,8 +221,18 @@ inline bool TCPServer<TServer, TSession>::Start()
         onStarted();
 
         // Perform the first server accept
-        Accept();
-    });
+        if (_shard_policy != ShardPolicy::ReusePort)
+            Accept();
+        else
+        {
+            for (auto& shard : _shards)
+                Accept(shard.get());
+        }
+    };
+    if (_strand_required)
+        _strand.post(start_handler);
+    else
+        _service->Post(start_handler);
 
     return true;
 }
@@ -107,26 +246,48 @@ inline bool TCPServer<TServer, TSession>::Stop()
 
     // Post the stopped routine
     auto self(this->shared_from_this());
-    _service->service()->post([this, self]()
+    auto stop_handler = [this, self]()
     {
         if (!IsStarted())
             return;
 
         // Close the server acceptor
-        _acceptor.close();
-
-        // Clear multicast buffer
-        ClearBuffers();
+        if (_shard_policy != ShardPolicy::ReusePort)
+            _acceptor.close();
+        else
+        {
+            for (auto& shard_ptr : _shards)
+            {
+                Shard* shard = shard_ptr.get();
+
+                // Dispatch the shard acceptor close routine into the shard
+                auto close_handler = [this, self, shard]()
+                {
+                    shard->acceptor.close();
+                };
+                if (shard->strand_required)
+                    shard->strand.dispatch(close_handler);
+                else
+                    shard->service->Dispatch(close_handler);
+            }
+        }
 
         // Disconnect all sessions
         DisconnectAll();
 
+        // Destroy idle pooled sessions
+        ClearSessionPools();
+
         // Update the started flag
         _started = false;
 
         // Call the server stopped handler
         onStopped();
-    });
+    };
+    if (_strand_required)
+        _strand.post(stop_handler);
+    else
+        _service->Post(stop_handler);
 
     return true;
 }
@@ -143,30 +304,112 @@ inline bool TCPServer<TServer, TSession>::Restart()
     return Start();
 }
 
+template <class TServer, class TSession>
+inline void TCPServer<TServer, TSession>::SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy)
+{
+    assert((low <= high) && "Send buffer low watermark should not be greater than the high watermark!");
+    if (low > high)
+        throw CppCommon::ArgumentException("Send buffer low watermark should not be greater than the high watermark!");
+
+    _send_buffer_high = high;
+    _send_buffer_low = low;
+    _slow_consumer_policy = policy;
+}
+
 template <class TServer, class TSession>
 inline void TCPServer<TServer, TSession>::Accept()
 {
     if (!IsStarted())
         return;
 
-    // Dispatch the disconnect routine
+    // Dispatch the accept routine
     auto self(this->shared_from_this());
-    _service->Dispatch([this, self]()
+    auto accept_handler = [this, self]()
     {
         if (!IsStarted())
             return;
 
-        _acceptor.async_accept(_socket, [this, self](std::error_code ec)
+        // Accept the next session into the socket of the selected shard
+        Shard* shard = _shards[SelectShard()].get();
+
+        auto async_accept_handler = [this, self, shard](std::error_code ec)
         {
             if (!ec)
-                RegisterSession();
+                RegisterSession(shard);
             else
                 SendError(ec);
 
             // Perform the next server accept
             Accept();
-        });
-    });
+        };
+        if (_strand_required)
+            _acceptor.async_accept(shard->socket, _strand.wrap(async_accept_handler));
+        else
+            _acceptor.async_accept(shard->socket, async_accept_handler);
+    };
+    if (_strand_required)
+        _strand.dispatch(accept_handler);
+    else
+        _service->Dispatch(accept_handler);
+}
+
+template <class TServer, class TSession>
+inline void TCPServer<TServer, TSession>::Accept(Shard* shard)
+{
+    if (!IsStarted())
+        return;
+
+    // Dispatch the accept routine into the shard
+    auto self(this->shared_from_this());
+    auto accept_handler = [this, self, shard]()
+    {
+        if (!IsStarted())
+            return;
+
+        // Create the shard SO_REUSEPORT acceptor
+        if (!shard->acceptor.is_open())
+        {
+            asio::error_code ec;
+            shard->acceptor.open(_endpoint.protocol(), ec);
+            if (!ec)
+                shard->acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true), ec);
+#if defined(SO_REUSEPORT)
+            if (!ec)
+                shard->acceptor.set_option(ReusePort(true), ec);
+#endif
+            if (!ec)
+                _socket_options.Apply(shard->acceptor, ec);
+            if (!ec)
+                shard->acceptor.bind(_endpoint, ec);
+            if (!ec)
+                shard->acceptor.listen(asio::socket_base::max_connections, ec);
+            if (ec)
+            {
+                SendError(ec);
+                shard->acceptor.close(ec);
+                return;
+            }
+        }
+
+        auto async_accept_handler = [this, self, shard](std::error_code ec)
+        {
+            if (!ec)
+                RegisterSession(shard);
+            else
+                SendError(ec);
+
+            // Perform the next shard accept
+            Accept(shard);
+        };
+        if (shard->strand_required)
+            shard->acceptor.async_accept(shard->socket, shard->strand.wrap(async_accept_handler));
+        else
+            shard->acceptor.async_accept(shard->socket, async_accept_handler);
+    };
+    if (shard->strand_required)
+        shard->strand.dispatch(accept_handler);
+    else
+        shard->service->Dispatch(accept_handler);
 }
 
 template <class TServer, class TSession>
@@ -180,36 +423,57 @@ inline bool TCPServer<TServer, TSession>::Multicast(const void* buffer, size_t s
     if (!IsStarted())
         return false;
 
-    {
-        std::lock_guard<std::mutex> locker(_multicast_lock);
+    // Copy the data into the single multicast payload shared by all sessions
+    return Multicast(SharedBuffer(buffer, size));
+}
 
-        // Fill the multicast buffer
-        const uint8_t* bytes = (const uint8_t*)buffer;
-        _multicast_buffer.insert(_multicast_buffer.end(), bytes, bytes + size);
-    }
+template <class TServer, class TSession>
+inline bool TCPServer<TServer, TSession>::Multicast(const SharedBuffer& buffer)
+{
+    assert(!buffer.empty() && "Shared buffer should not be empty!");
+    if (buffer.empty())
+        return false;
+
+    if (!IsStarted())
+        return false;
 
-    // Dispatch the multicast routine
     auto self(this->shared_from_this());
-    _service->Dispatch([this, self]()
+    for (auto& shard_ptr : _shards)
     {
-        if (!IsStarted())
-            return;
+        Shard* shard = shard_ptr.get();
 
-        std::lock_guard<std::mutex> locker(_multicast_lock);
+        // Dispatch the multicast routine into the shard
+        auto multicast_handler = [this, self, shard, buffer]()
+        {
+            if (!IsStarted())
+                return;
+
+            // Multicast the shared payload to all shard sessions
+            for (auto& session : shard->sessions)
+                session->Send(buffer);
+        };
+        if (shard->strand_required)
+            shard->strand.dispatch(multicast_handler);
+        else
+            shard->service->Dispatch(multicast_handler);
+    }
 
-        // Check for empty multicast buffer
-        if (_multicast_buffer.empty())
-            return;
+    return true;
+}
 
-        // Multicast all sessions
-        for (auto& session : _sessions)
-            session.second->Send(_multicast_buffer.data(), _multicast_buffer.size());
+template <class TServer, class TSession>
+inline std::shared_ptr<TSession> TCPServer<TServer, TSession>::FindSession(uint64_t key)
+{
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> locker(shard->sessions_lock);
 
-        // Clear the multicast buffer
-        _multicast_buffer.clear();
-    });
+        auto session = shard->sessions.Find(key);
+        if (session)
+            return session;
+    }
 
-    return true;
+    return nullptr;
 }
 
 template <class TServer, class TSession>
@@ -218,59 +482,203 @@ inline bool TCPServer<TServer, TSession>::DisconnectAll()
     if (!IsStarted())
         return false;
 
-    // Dispatch the disconnect routine
     auto self(this->shared_from_this());
-    _service->Dispatch([this, self]()
+    for (auto& shard_ptr : _shards)
     {
-        if (!IsStarted())
-            return;
+        Shard* shard = shard_ptr.get();
 
-        // Disconnect all sessions
-        for (auto& session : _sessions)
-            session.second->Disconnect();
-    });
+        // Dispatch the disconnect routine into the shard
+        auto disconnect_all_handler = [this, self, shard]()
+        {
+            // Disconnect all shard sessions
+            for (auto& session : shard->sessions)
+                session->Disconnect();
+        };
+        if (shard->strand_required)
+            shard->strand.dispatch(disconnect_all_handler);
+        else
+            shard->service->Dispatch(disconnect_all_handler);
+    }
 
     return true;
 }
 
 template <class TServer, class TSession>
-inline std::shared_ptr<TSession> TCPServer<TServer, TSession>::RegisterSession()
+inline size_t TCPServer<TServer, TSession>::SelectShard()
+{
+    switch (_shard_policy)
+    {
+        case ShardPolicy::LeastLoaded:
+        {
+            size_t result = 0;
+            for (size_t i = 1; i < _shards.size(); ++i)
+                if (_shards[i]->sessions_count < _shards[result]->sessions_count)
+                    result = i;
+            return result;
+        }
+        case ShardPolicy::RoundRobin:
+        case ShardPolicy::ReusePort:
+        default:
+            return _shard_next++ % _shards.size();
+    }
+}
+
+template <class TServer, class TSession>
+inline void TCPServer<TServer, TSession>::GenerateId(Shard* shard, TSession& session)
+{
+    // Generate the session key
+    if (_id_policy == IdPolicy::ShardSequential)
+        session._key = ((uint64_t)(session._shard + 1) << SHARD_KEY_SHIFT) | ++shard->sessions_key;
+    else
+        session._key = ++_session_key;
+
+    // Generate the session Id
+    if (_id_policy == IdPolicy::UUID)
+        session._id = CppCommon::UUID::Generate();
+    else
+        session._id = MakeId(session._key);
+}
+
+template <class TServer, class TSession>
+inline std::shared_ptr<TSession> TCPServer<TServer, TSession>::CreateSession(Shard* shard)
 {
-    // Create and register a new session
     auto self(this->shared_from_this());
-    auto session = std::make_shared<TSession>(self, std::move(_socket));
-    _sessions.emplace(session->id(), session);
 
-    // Connect a new session
-    session->Connect();
+    // Publish the shard of the accepted socket to the session constructor
+    AcceptingShard() = shard->index;
 
-    // Call a new session connected handler
-    onConnected(session);
+    if (_session_pool == 0)
+        return std::make_shared<TSession>(self, std::move(shard->socket));
 
-    return session;
+    // Take an idle session from the session pool of the shard
+    TSession* session = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(shard->pool_lock);
+        if (!shard->pool.empty())
+        {
+            session = shard->pool.back();
+            shard->pool.pop_back();
+        }
+    }
+
+    if (session != nullptr)
+    {
+        session->Reuse(self, std::move(shard->socket));
+
+        // Moved out socket might lose its executor, so the next accept gets a new one
+        shard->socket = asio::ip::tcp::socket(*shard->service->service());
+    }
+    else
+        session = new TSession(self, std::move(shard->socket));
+
+    // The last owner of the session returns it into the session pool
+    return std::shared_ptr<TSession>(session, RecycleSession);
 }
 
 template <class TServer, class TSession>
-inline void TCPServer<TServer, TSession>::UnregisterSession(const CppCommon::UUID& id)
+inline void TCPServer<TServer, TSession>::RecycleSession(TSession* session)
 {
-    // Try to find the unregistered session
-    auto it = _sessions.find(id);
-    if (it != _sessions.end())
+    // Pooled session should not keep its server alive
+    auto server = std::move(session->_server);
+
+    if (server->IsStarted() && session->Recycle())
     {
-        // Call the session disconnected handler
-        onDisconnected(it->second);
+        Shard* shard = server->_shards[session->_shard].get();
+        std::lock_guard<std::mutex> locker(shard->pool_lock);
+        if (shard->pool.size() < server->_session_pool)
+        {
+            shard->pool.push_back(session);
+            return;
+        }
+    }
 
-        // Erase the session
-        _sessions.erase(it);
+    delete session;
+}
+
+template <class TServer, class TSession>
+inline void TCPServer<TServer, TSession>::ClearSessionPools()
+{
+    for (auto& shard : _shards)
+    {
+        std::vector<TSession*> pool;
+        {
+            std::lock_guard<std::mutex> locker(shard->pool_lock);
+            pool.swap(shard->pool);
+        }
+        for (auto session : pool)
+            delete session;
     }
 }
 
 template <class TServer, class TSession>
-inline void TCPServer<TServer, TSession>::ClearBuffers()
+inline std::shared_ptr<TSession> TCPServer<TServer, TSession>::RegisterSession(Shard* shard)
 {
-    std::lock_guard<std::mutex> locker(_multicast_lock);
+    // Apply socket options to the accepted shard socket
+    if (!_socket_options.empty())
+    {
+        asio::error_code ec;
+        _socket_options.Apply(shard->socket, ec);
+        if (ec)
+            SendError(ec);
+    }
+
+    // Create a new session with the accepted shard socket
+    auto self(this->shared_from_this());
+    auto session = CreateSession(shard);
+    GenerateId(shard, *session);
+    ++shard->sessions_count;
+
+    // Dispatch the register routine into the shard
+    auto register_handler = [this, self, shard, session]() mutable
+    {
+        // Register the session
+        {
+            std::lock_guard<std::mutex> locker(shard->sessions_lock);
+            shard->sessions.Insert(session->key(), session);
+        }
+
+        // Connect a new session
+        session->Connect();
+
+        // Call a new session connected handler
+        onConnected(session);
+    };
+    if (shard->strand_required)
+        shard->strand.dispatch(register_handler);
+    else
+        shard->service->Dispatch(register_handler);
 
-    _multicast_buffer.clear();
+    return session;
+}
+
+template <class TServer, class TSession>
+inline void TCPServer<TServer, TSession>::UnregisterSession(size_t shard_index, uint64_t key)
+{
+    Shard* shard = _shards[shard_index].get();
+
+    // Dispatch the unregister routine into the shard
+    auto self(this->shared_from_this());
+    auto unregister_handler = [this, self, shard, key]()
+    {
+        // Try to find the unregistered session
+        auto session = shard->sessions.Find(key);
+        if (session)
+        {
+            // Call the session disconnected handler
+            onDisconnected(session);
+
+            // Erase the session
+            {
+                std::lock_guard<std::mutex> locker(shard->sessions_lock);
+                shard->sessions.Erase(key);
+            }
+            --shard->sessions_count;
+        }
+    };
+    if (shard->strand_required)
+        shard->strand.dispatch(unregister_handler);
+    else
+        unregister_handler();
 }
 
 template <class TServer, class TSession>
@@ -11,37 +11,95 @@ namespace Asio {
 
 template <class TServer, class TSession>
 inline TCPSession<TServer, TSession>::TCPSession(std::shared_ptr<TCPServer<TServer, TSession>> server, asio::ip::tcp::socket&& socket)
-    : _id(CppCommon::UUID::Generate()),
+    : _id(CppCommon::UUID::Nil()),
+      _key(0),
       _server(server),
+      _shard(server->AcceptingShard()),
+      _service(server->service(_shard)),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
       _socket(std::move(socket)),
       _connected(false),
-      _bytes_sent(0),
-      _bytes_received(0),
       _reciving(false),
+      _idle_receive(server->idle_receive()),
       _sending(false),
-      _recive_buffer(CHUNK + 1),
-      _send_buffer_flush_offset(0)
+      _send_scheduled(false),
+      _corked(0),
+      _socket_corked(false),
+      _send_buffer_high(server->send_buffer_high()),
+      _send_buffer_low(server->send_buffer_low()),
+      _slow_consumer_policy(server->slow_consumer_policy()),
+      _send_buffer_overflow(false),
+      _send_buffer_full(false),
+      _speculative_io(server->speculative_io()),
+      _speculative_receiving(false),
+      _speculative_sending(false),
+      _zero_copy_waiting(false),
+      _idle_timer([this]() { ScheduleIdleCheck(); }),
+      _idle_timed(false),
+      _lifetime_expired(false),
+      _connect_time(0),
+      _read_time(0),
+      _write_time(0)
 {
+    // Count pending bytes of all sessions if the server send buffer is limited
+    if (server->send_buffer_limit() > 0)
+        _send_queue.SetupTotal(&server->_send_buffer_size);
+}
+
+template <class TServer, class TSession>
+inline TCPSession<TServer, TSession>::~TCPSession()
+{
+    // Released session could be never disconnected, so its idle timer leaves the timing wheel here
+    _service->CancelTimer(_idle_timer);
+
+    // Zero copy sends of the never disconnected session keep their buffers in the service
+    _service->LingerZeroCopy(_zero_copy, _socket);
 }
 
 template <class TServer, class TSession>
 inline void TCPSession<TServer, TSession>::Connect()
 {
-    // Reset statistic
-    _bytes_sent = 0;
-    _bytes_received = 0;
+    auto self(this->shared_from_this());
+    auto connect_handler = [this, self]()
+    {
+        // Reset statistic
+        _statistics.Reset();
 
-    // Update the connected flag
-    _connected = true;
+        // Switch the socket into the non-blocking mode for speculative I/O
+        if (_speculative_io)
+        {
+            asio::error_code ec;
+            _socket.non_blocking(true, ec);
+            if (ec)
+                _speculative_io = false;
+        }
 
-    // Call the session connected handler
-    onConnected();
+        // Open the zero copy send mode for the connected socket
+        if (_zero_copy.threshold() > 0)
+            _zero_copy.Open(_socket);
+
+        // Update the connected flag
+        _connected = true;
 
-    // Call the empty send buffer handler
-    onEmpty();
+        // Start idle timeouts
+        StartIdleTimer();
 
-    // Try to receive something from the client
-    TryReceive();
+        // Call the session connected handler
+        onConnected();
+
+        // Call the empty send buffer handler
+        onEmpty();
+
+        // Try to receive something from the client
+        TryReceive();
+    };
+
+    // Dispatch the connect routine into the session strand
+    if (_strand_required)
+        _strand.dispatch(connect_handler);
+    else
+        connect_handler();
 }
 
 template <class TServer, class TSession>
@@ -56,9 +114,19 @@ inline bool TCPSession<TServer, TSession>::Disconnect(bool dispatch)
         if (!IsConnected())
             return;
 
+        // Zero copy sends which are still in flight keep their buffers in the service
+        _service->LingerZeroCopy(_zero_copy, _socket);
+
         // Close the session socket
         _socket.close();
 
+        // Stop idle timeouts
+        if (_idle_timed)
+        {
+            _idle_timed = false;
+            _service->CancelTimer(_idle_timer);
+        }
+
         // Clear receive/send buffers
         ClearBuffers();
 
@@ -69,18 +137,40 @@ inline bool TCPSession<TServer, TSession>::Disconnect(bool dispatch)
         onDisconnected();
 
         // Unregister the session
-        _server->UnregisterSession(id());
+        _server->UnregisterSession(_shard, key());
     };
 
     // Dispatch or post the disconnect routine
-    if (dispatch)
-        service()->Dispatch(disconnect);
+    if (_strand_required)
+    {
+        if (dispatch)
+            _strand.dispatch(disconnect);
+        else
+            _strand.post(disconnect);
+    }
     else
-        service()->Post(disconnect);
+    {
+        if (dispatch)
+            service()->Dispatch(disconnect);
+        else
+            service()->Post(disconnect);
+    }
 
     return true;
 }
 
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy)
+{
+    assert((low <= high) && "Send buffer low watermark should not be greater than the high watermark!");
+    if (low > high)
+        throw CppCommon::ArgumentException("Send buffer low watermark should not be greater than the high watermark!");
+
+    _send_buffer_high = high;
+    _send_buffer_low = low;
+    _slow_consumer_policy = policy;
+}
+
 template <class TServer, class TSession>
 inline size_t TCPSession<TServer, TSession>::Send(const void* buffer, size_t size)
 {
@@ -92,27 +182,196 @@ inline size_t TCPSession<TServer, TSession>::Send(const void* buffer, size_t siz
     if (!IsConnected())
         return 0;
 
-    size_t result;
+    // Apply the slow consumer policy to the new data
+    if (!CheckSendBuffer(size))
+        return 0;
+
+    // Send the data directly from the session thread
+    if (IsInStrand())
     {
-        std::lock_guard<std::mutex> locker(_send_lock);
+        size_t result = _send_queue.PushDirect(buffer, size);
+        TrySend();
+        return result;
+    }
+
+    // Copy the buffer into the send queue and schedule the send routine
+    size_t result = _send_queue.Push(buffer, size);
+    ScheduleSend();
 
-        // Fill the main send buffer
-        const uint8_t* bytes = (const uint8_t*)buffer;
-        _send_buffer_main.insert(_send_buffer_main.end(), bytes, bytes + size);
-        result = _send_buffer_main.size();
+    return result;
+}
+
+template <class TServer, class TSession>
+inline size_t TCPSession<TServer, TSession>::Send(const SharedBuffer& buffer)
+{
+    assert(!buffer.empty() && "Shared buffer should not be empty!");
+    if (buffer.empty())
+        return 0;
+
+    if (!IsConnected())
+        return 0;
+
+    // Apply the slow consumer policy to the new data
+    if (!CheckSendBuffer(buffer.size()))
+        return 0;
+
+    // Send the data directly from the session thread
+    if (IsInStrand())
+    {
+        size_t result = _send_queue.PushDirect(buffer);
+        TrySend();
+        return result;
     }
 
-    // Dispatch the send routine
-    auto self(this->shared_from_this());
-    service()->Dispatch([this, self]()
+    // Queue the shared buffer and schedule the send routine
+    size_t result = _send_queue.Push(buffer);
+    ScheduleSend();
+
+    return result;
+}
+
+template <class TServer, class TSession>
+inline size_t TCPSession<TServer, TSession>::Send(const std::vector<SharedBuffer>& buffers)
+{
+    assert(!buffers.empty() && "Shared buffers vector should not be empty!");
+    if (buffers.empty())
+        return 0;
+
+    if (!IsConnected())
+        return 0;
+
+    // Apply the slow consumer policy to the new data
+    size_t size = 0;
+    for (auto& buffer : buffers)
+        size += buffer.size();
+    if (!CheckSendBuffer(size))
+        return 0;
+
+    // Send the data directly from the session thread
+    if (IsInStrand())
+    {
+        size_t result = 0;
+        for (auto& buffer : buffers)
+            result = _send_queue.PushDirect(buffer);
+        TrySend();
+        return result;
+    }
+
+    // Queue all shared buffers and schedule the send routine once
+    size_t result = 0;
+    for (auto& buffer : buffers)
+        result = _send_queue.Push(buffer);
+    ScheduleSend();
+
+    return result;
+}
+
+template <class TServer, class TSession>
+inline size_t TCPSession<TServer, TSession>::SendFile(const SharedFile& file, uint64_t offset, uint64_t size)
+{
+    if (!file)
+        return 0;
+
+    if (!IsConnected())
+        return 0;
+
+    // Send the file till its end
+    if (size == 0)
+        size = (offset < file.size()) ? (file.size() - offset) : 0;
+    if (size == 0)
+        return 0;
+
+    // Queue the file region directly from the session thread
+    if (IsInStrand())
     {
-        // Try to send the main buffer
+        size_t result = _send_queue.PushDirect(file, offset, (size_t)size);
         TrySend();
-    });
+        return result;
+    }
+
+    // Queue the file region and schedule the send routine
+    size_t result = _send_queue.Push(file, offset, (size_t)size);
+    ScheduleSend();
 
     return result;
 }
 
+template <class TServer, class TSession>
+inline size_t TCPSession<TServer, TSession>::SendFrame(const void* buffer, size_t size)
+{
+    // Encode the length prefix
+    uint8_t prefix[8];
+    size_t prefix_size = _framer.Encode(size, prefix);
+    if (prefix_size == 0)
+    {
+        // The peer would disconnect on the oversize message
+        SendError(asio::error::message_size);
+        return 0;
+    }
+
+    // Copy small messages with the length prefix on the stack
+    if ((prefix_size + size) <= CHUNK)
+    {
+        uint8_t frame[CHUNK];
+        std::memcpy(frame, prefix, prefix_size);
+        if (size > 0)
+            std::memcpy(frame + prefix_size, buffer, size);
+        return Send(frame, prefix_size + size);
+    }
+
+    // Copy large messages with the length prefix into a shared buffer
+    std::vector<uint8_t> frame(prefix_size + size);
+    std::memcpy(frame.data(), prefix, prefix_size);
+    std::memcpy(frame.data() + prefix_size, buffer, size);
+    return Send(SharedBuffer(std::move(frame)));
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::Uncork()
+{
+    assert((_corked > 0) && "Session send buffer is not corked!");
+
+    // Only the last balanced call writes the collected data
+    int corked = _corked;
+    do
+    {
+        if (corked <= 0)
+            return;
+    } while (!_corked.compare_exchange_weak(corked, corked - 1));
+    if (corked > 1)
+        return;
+
+    if (!IsConnected())
+        return;
+
+    // Write the collected data right away from the session thread
+    if (IsInStrand())
+        TrySend();
+    else
+        ScheduleSend();
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::ScheduleSend()
+{
+    // Schedule only one send routine for all buffers queued before it runs
+    if (_send_scheduled.exchange(true))
+        return;
+
+    auto self(this->shared_from_this());
+    auto send_handler = [this, self]()
+    {
+        _send_scheduled = false;
+
+        // Try to send the send queue
+        TrySend();
+    };
+    if (_strand_required)
+        _strand.post(send_handler);
+    else
+        service()->Post(send_handler);
+}
+
 template <class TServer, class TSession>
 inline void TCPSession<TServer, TSession>::TryReceive()
 {
@@ -122,70 +381,207 @@ inline void TCPSession<TServer, TSession>::TryReceive()
     if (!IsConnected())
         return;
 
+    // Receive data into the ring in the receive ring mode
+    if (_receive_ring.enabled())
+    {
+        TryReceiveRing();
+        return;
+    }
+
     _reciving = true;
     auto self(this->shared_from_this());
-    _socket.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), [this, self](std::error_code ec, std::size_t size)
+
+    // Wait for incoming data without the receive buffer in the idle receive mode
+    if (_idle_receive && _recive_buffer.empty())
+    {
+        auto async_wait_handler = [this, self](std::error_code ec)
+        {
+            _reciving = false;
+
+            if (!IsConnected())
+                return;
+
+            // Borrow the receive buffer and read the incoming data
+            if (!ec)
+            {
+                _recive_buffer.Acquire(_service->buffer_pool());
+                TryReceive();
+            }
+            else
+            {
+                SendError(ec);
+                Disconnect(true);
+            }
+        };
+        if (_strand_required)
+            _socket.async_wait(asio::ip::tcp::socket::wait_read, _strand.wrap(MakeAllocHandler(_receive_storage, async_wait_handler)));
+        else
+            _socket.async_wait(asio::ip::tcp::socket::wait_read, MakeAllocHandler(_receive_storage, async_wait_handler));
+        return;
+    }
+
+    // Borrow the receive buffer from the service buffer pool
+    _recive_buffer.Acquire(_service->buffer_pool());
+
+    auto async_receive_handler = [this, self](std::error_code ec, std::size_t size)
     {
         _reciving = false;
 
         if (!IsConnected())
+        {
+            _recive_buffer.Release();
             return;
+        }
+
+        bool full = false;
 
         // Received some data from the client
         if (size > 0)
         {
             // Update statistic
-            _bytes_received += size;
-            _server->_bytes_received += size;
+            _statistics.Received(size);
+            _server->_shards[_shard]->statistics.Received(size);
+
+            // Update the last read time
+            _read_time = _service->timer_time();
 
-            // Call the buffer received handler
-            onReceived(_recive_buffer.data(), size);
+            // Call the buffer received handler or parse received messages
+            if (!_framer.enabled())
+                onReceived(_recive_buffer.data(), size);
+            else if (!_framer.Process(_recive_buffer.data(), size, [this](const uint8_t* message, size_t message_size) { onReceivedMessage(message, message_size); }))
+                ec = asio::error::message_size;
 
-            // If the receive buffer is full increase its size
-            if (_recive_buffer.size() == size)
-                _recive_buffer.resize(2 * size);
+            // Grow or shrink the receive buffer
+            full = (size == _recive_buffer.size());
+            _recive_buffer.Update(size);
         }
 
+        // Return the receive buffer into the pool while waiting for more data
+        if (_idle_receive && !full)
+            _recive_buffer.Release();
+
         // Try to receive again if the session is valid
         if (!ec)
             TryReceive();
         else
         {
+            _recive_buffer.Release();
             SendError(ec);
             Disconnect(true);
         }
-    });
+    };
+
+    // Try to read the available data right away
+    if (_speculative_io && !_speculative_receiving)
+    {
+        asio::error_code ec;
+        size_t size = _socket.read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), ec);
+        if (!ec)
+        {
+            // Handle the data in place and leave the next read to the asynchronous operation
+            _speculative_receiving = true;
+            async_receive_handler(ec, size);
+            _speculative_receiving = false;
+            return;
+        }
+    }
+
+    if (_strand_required)
+        _socket.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), _strand.wrap(MakeAllocHandler(_receive_storage, async_receive_handler)));
+    else
+        _socket.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), MakeAllocHandler(_receive_storage, async_receive_handler));
 }
 
 template <class TServer, class TSession>
-inline void TCPSession<TServer, TSession>::TrySend()
+inline void TCPSession<TServer, TSession>::TryReceiveRing()
 {
-    if (_sending)
-        return;
+    _reciving = true;
+    auto self(this->shared_from_this());
+    auto async_receive_handler = [this, self](std::error_code ec, std::size_t size)
+    {
+        _reciving = false;
 
+        if (!IsConnected())
+            return;
+
+        // Received some data from the client
+        if (size > 0)
+        {
+            // Update statistic
+            _statistics.Received(size);
+            _server->_shards[_shard]->statistics.Received(size);
+
+            // Update the last read time
+            _read_time = _service->timer_time();
+
+            // Call the ring received handler or parse received messages in place
+            _receive_ring.Commit(size);
+            if (!_framer.enabled())
+                onReceivedRing(_receive_ring.data(), _receive_ring.size());
+            else
+            {
+                size_t parsed;
+                if (_framer.Parse(_receive_ring.data(), _receive_ring.size(), [this](const uint8_t* message, size_t message_size) { onReceivedMessage(message, message_size); }, parsed))
+                    _receive_ring.Consume(parsed);
+                else
+                    ec = asio::error::message_size;
+            }
+
+            // Nothing more could be received into the full ring
+            if (!ec && IsConnected() && _receive_ring.full())
+                ec = asio::error::no_buffer_space;
+        }
+
+        // Try to receive again if the session is valid
+        if (!ec)
+            TryReceive();
+        else
+        {
+            SendError(ec);
+            Disconnect(true);
+        }
+    };
+
+    // Read into the free space of the receive ring
+    asio::mutable_buffer buffer = _receive_ring.Prepare();
+    if (_strand_required)
+        _socket.async_read_some(asio::buffer(buffer), _strand.wrap(MakeAllocHandler(_receive_storage, async_receive_handler)));
+    else
+        _socket.async_read_some(asio::buffer(buffer), MakeAllocHandler(_receive_storage, async_receive_handler));
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::TrySend()
+{
     if (!IsConnected())
         return;
 
-    // Swap send buffers
-    if (_send_buffer_flush.empty())
-    {
-        std::lock_guard<std::mutex> locker(_send_lock);
+    // Apply the slow consumer policy to the send buffer
+    if (_send_buffer_overflow)
+        HandleSendBufferOverflow();
 
-        // Swap flush and main buffers
-        _send_buffer_flush.swap(_send_buffer_main);
-        _send_buffer_flush_offset = 0;
+    // Collect sent data until the session is uncorked
+    if (_corked > 0)
+    {
+        CorkSocket(true);
+        return;
     }
 
-    // Check if the flush buffer is empty
-    if (_send_buffer_flush.empty())
+    if (_sending)
+        return;
+
+    // Move queued buffers into the flush part
+    if (!_send_queue.Flush())
     {
         // Nothing to send...
+        CorkSocket(false);
+        HandleSendBufferDrain(_send_queue.buffered());
         return;
     }
 
     _sending = true;
     auto self(this->shared_from_this());
-    asio::async_write(_socket, asio::buffer(_send_buffer_flush.data() + _send_buffer_flush_offset, _send_buffer_flush.size() - _send_buffer_flush_offset), [this, self](std::error_code ec, std::size_t size)
+    auto async_write_handler = [this, self](std::error_code ec, std::size_t size)
     {
         _sending = false;
 
@@ -198,25 +594,24 @@ inline void TCPSession<TServer, TSession>::TrySend()
         if (size > 0)
         {
             // Update statistic
-            _bytes_sent += size;
-            _server->_bytes_sent += size;
+            _statistics.Sent(size);
+            _server->_shards[_shard]->statistics.Sent(size);
 
-            // Call the buffer sent handler
-            onSent(size, _send_buffer_flush.size() - size);
+            // Update the last write time
+            _write_time = _service->timer_time();
 
-            // Increase the flush buffer offset
-            _send_buffer_flush_offset += size;
+            // Consume the written data from the send queue
+            _send_queue.Consume(size);
+            size_t pending = _send_queue.size();
 
-            // Successfully send the whole flush buffer
-            if (_send_buffer_flush_offset == _send_buffer_flush.size())
-            {
-                // Clear the flush buffer
-                _send_buffer_flush.clear();
-                _send_buffer_flush_offset = 0;
+            // Stop sending operation if the send queue is empty
+            resume = (pending > 0);
 
-                // Stop sending operation
-                resume = false;
-            }
+            // Call the buffer sent handler
+            onSent(size, pending);
+
+            // Check the send buffer low watermark
+            HandleSendBufferDrain(_send_queue.buffered());
         }
 
         // Try to send again if the session is valid
@@ -225,29 +620,335 @@ inline void TCPSession<TServer, TSession>::TrySend()
             if (resume)
                 TrySend();
             else
+            {
+                // Push the tail of the last write held by the corked socket
+                if (_corked == 0)
+                    CorkSocket(false);
                 onEmpty();
+            }
         }
         else
         {
             SendError(ec);
             Disconnect(true);
         }
-    });
+    };
+
+    // Write the file region of the flush part when the socket is ready
+    if (_send_queue.file())
+    {
+        auto async_wait_handler = [this, self, async_write_handler](std::error_code ec)
+        {
+            size_t size = 0;
+            if (!ec && IsConnected())
+            {
+                asio::error_code error;
+                size = _send_queue.file().Send(_socket, _send_queue.file_offset(), _send_queue.flush_size(), error);
+                if (error != asio::error::would_block)
+                    ec = error;
+            }
+            async_write_handler(ec, size);
+        };
+        if (_strand_required)
+            _socket.async_wait(asio::ip::tcp::socket::wait_write, _strand.wrap(MakeAllocHandler(_send_storage, async_wait_handler)));
+        else
+            _socket.async_wait(asio::ip::tcp::socket::wait_write, MakeAllocHandler(_send_storage, async_wait_handler));
+        return;
+    }
+
+    // Write the large flush part with zero copy when the socket is ready
+    if (_zero_copy.Check(_send_queue.flush_size()))
+    {
+        auto async_wait_handler = [this, self, async_write_handler](std::error_code ec)
+        {
+            size_t size = 0;
+            if (!ec && IsConnected())
+            {
+                asio::error_code error;
+                size = _zero_copy.Send(_socket, _send_queue.buffers(), _send_queue.Pin(), error);
+                if (error != asio::error::would_block)
+                    ec = error;
+                TryComplete();
+            }
+            async_write_handler(ec, size);
+        };
+        if (_strand_required)
+            _socket.async_wait(asio::ip::tcp::socket::wait_write, _strand.wrap(MakeAllocHandler(_send_storage, async_wait_handler)));
+        else
+            _socket.async_wait(asio::ip::tcp::socket::wait_write, MakeAllocHandler(_send_storage, async_wait_handler));
+        return;
+    }
+
+    // Try to write the flush part right away
+    if (_speculative_io && !_speculative_sending)
+    {
+        asio::error_code ec;
+        size_t size = _socket.write_some(_send_queue.buffers(), ec);
+        if (!ec)
+        {
+            // Complete the write in place and leave the rest to the asynchronous operation
+            _speculative_sending = true;
+            async_write_handler(ec, size);
+            _speculative_sending = false;
+            return;
+        }
+    }
+
+    if (_strand_required)
+        asio::async_write(_socket, ConstBuffersView(_send_queue.buffers()), _strand.wrap(MakeAllocHandler(_send_storage, async_write_handler)));
+    else
+        asio::async_write(_socket, ConstBuffersView(_send_queue.buffers()), MakeAllocHandler(_send_storage, async_write_handler));
 }
 
 template <class TServer, class TSession>
-inline void TCPSession<TServer, TSession>::ClearBuffers()
+inline void TCPSession<TServer, TSession>::TryComplete()
+{
+    // Release buffers of completed zero copy sends
+    if ((_zero_copy.Complete(_socket) == 0) || _zero_copy_waiting)
+        return;
+
+    // Wait for the rest of completions in the socket error queue
+    _zero_copy_waiting = true;
+    auto self(this->shared_from_this());
+    auto async_wait_handler = [this, self](std::error_code ec)
+    {
+        _zero_copy_waiting = false;
+
+        if (!ec && IsConnected())
+            TryComplete();
+    };
+    if (_strand_required)
+        _socket.async_wait(asio::ip::tcp::socket::wait_error, _strand.wrap(async_wait_handler));
+    else
+        _socket.async_wait(asio::ip::tcp::socket::wait_error, async_wait_handler);
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::CorkSocket(bool enable)
 {
-    // Clear send buffers
+    if (_socket_corked == enable)
+        return;
+
+    // Corking the socket is only a hint, so its failure is ignored
+    _socket_corked = SocketOptions::Cork(_socket, enable) && enable;
+}
+
+template <class TServer, class TSession>
+inline bool TCPSession<TServer, TSession>::CheckSendBuffer(size_t size)
+{
+    size_t limit = _server->_send_buffer_limit;
+    if ((_send_buffer_high == 0) && (limit == 0))
+        return true;
+
+    // Check the send buffer high watermark and the server send buffer limit
+    if (((_send_buffer_high == 0) || ((_send_queue.buffered() + size) <= _send_buffer_high)) &&
+        ((limit == 0) || ((_server->_send_buffer_size + size) <= limit)))
+        return true;
+
+    // Schedule the slow consumer policy for the send routine
+    _send_buffer_overflow = true;
+
+    switch (_slow_consumer_policy)
     {
-        std::lock_guard<std::mutex> locker(_send_lock);
+        case SlowConsumerPolicy::DropOldest:
+            // The oldest pending data will be dropped by the send routine
+            return true;
+        case SlowConsumerPolicy::Disconnect:
+            Disconnect(false);
+            return false;
+        default:
+            // Notify about the rejected data from the send routine
+            ScheduleSend();
+            return false;
+    }
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::HandleSendBufferOverflow()
+{
+    _send_buffer_overflow = false;
+
+    // Drop the oldest pending data over the high watermark and the server send buffer limit
+    if (_slow_consumer_policy == SlowConsumerPolicy::DropOldest)
+    {
+        size_t pending = _send_queue.buffered();
+        size_t excess = ((_send_buffer_high > 0) && (pending > _send_buffer_high)) ? (pending - _send_buffer_high) : 0;
+        size_t limit = _server->_send_buffer_limit;
+        size_t total = _server->_send_buffer_size;
+        if ((limit > 0) && (total > limit))
+            excess = std::max(excess, total - limit);
+        if (excess > 0)
+            _send_queue.Drop(excess);
+    }
 
-        _send_buffer_main.clear();
-        _send_buffer_flush.clear();
-        _send_buffer_flush_offset = 0;
+    // Call the send buffer high watermark handler
+    if (!_send_buffer_full)
+    {
+        _send_buffer_full = true;
+        onSendBufferHigh();
     }
 }
 
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::HandleSendBufferDrain(size_t pending)
+{
+    // Call the send buffer low watermark handler
+    if (_send_buffer_full && (pending <= _send_buffer_low))
+    {
+        _send_buffer_full = false;
+        onSendBufferLow();
+    }
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::StartIdleTimer()
+{
+    uint64_t read = _server->_read_timeout;
+    uint64_t write = _server->_write_timeout;
+    uint64_t lifetime = _server->_lifetime;
+
+    _idle_timed = ((read > 0) || (write > 0) || (lifetime > 0));
+    if (!_idle_timed)
+        return;
+
+    // Idle timer handler should not revive the session which is released under the timing wheel lock
+    _idle_self = this->shared_from_this();
+
+    // Arm the idle timer to the nearest timeout, the timer refreshes the service time
+    uint64_t timeout = std::numeric_limits<uint64_t>::max();
+    if (read > 0)
+        timeout = std::min(timeout, read);
+    if (write > 0)
+        timeout = std::min(timeout, write);
+    if (lifetime > 0)
+        timeout = std::min(timeout, lifetime);
+    _service->ArmTimer(_idle_timer, timeout);
+
+    // Start the idle time and the lifetime
+    _lifetime_expired = false;
+    _connect_time = _read_time = _write_time = _service->timer_time();
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::ScheduleIdleCheck()
+{
+    // The idle timer expires under the timing wheel lock, so the check routine is posted
+    auto self(_idle_self.lock());
+    if (!self)
+        return;
+
+    auto idle_handler = [this, self]() { CheckIdle(); };
+    if (_strand_required)
+        _strand.post(idle_handler);
+    else
+        _service->Post(idle_handler);
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::CheckIdle()
+{
+    if (!IsConnected() || !_idle_timed)
+        return;
+
+    auto session = std::static_pointer_cast<TSession>(this->shared_from_this());
+    uint64_t now = _service->timer_time();
+    uint64_t next = std::numeric_limits<uint64_t>::max();
+
+    // Check the read idle timeout
+    uint64_t timeout = _server->_read_timeout;
+    if (timeout > 0)
+    {
+        if (now >= (_read_time + timeout))
+        {
+            _read_time = now;
+            _server->onIdle(session, IdleTimeout::Read);
+        }
+        next = std::min(next, _read_time + timeout);
+    }
+
+    // Check the write idle timeout
+    timeout = _server->_write_timeout;
+    if ((timeout > 0) && IsConnected())
+    {
+        if (now >= (_write_time + timeout))
+        {
+            _write_time = now;
+            _server->onIdle(session, IdleTimeout::Write);
+        }
+        next = std::min(next, _write_time + timeout);
+    }
+
+    // Check the lifetime
+    timeout = _server->_lifetime;
+    if ((timeout > 0) && !_lifetime_expired && IsConnected())
+    {
+        if (now >= (_connect_time + timeout))
+        {
+            _lifetime_expired = true;
+            _server->onIdle(session, IdleTimeout::Lifetime);
+        }
+        else
+            next = std::min(next, _connect_time + timeout);
+    }
+
+    // Wait for the nearest idle timeout
+    if (IsConnected() && (next != std::numeric_limits<uint64_t>::max()))
+        _service->ArmTimer(_idle_timer, next - std::min(next, now));
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::ClearBuffers()
+{
+    // Clear the send queue
+    _send_queue.Clear();
+    _send_buffer_overflow = false;
+    _send_buffer_full = false;
+
+    // Release buffers of pending zero copy sends
+    _zero_copy.Close();
+    _socket_corked = false;
+
+    // Drop the split message tail
+    _framer.Reset();
+}
+
+template <class TServer, class TSession>
+inline bool TCPSession<TServer, TSession>::Recycle()
+{
+    // Pooled session should not be reached by its idle timer
+    _idle_timed = false;
+    _service->CancelTimer(_idle_timer);
+
+    // Return the receive buffer into the buffer pool of the service
+    _recive_buffer.Release();
+
+    // Drop data sent after the disconnect, so it never reaches the next peer
+    ClearBuffers();
+
+    return true;
+}
+
+template <class TServer, class TSession>
+inline void TCPSession<TServer, TSession>::Reuse(std::shared_ptr<TCPServer<TServer, TSession>> server, asio::ip::tcp::socket&& socket)
+{
+    _server = server;
+    _socket = std::move(socket);
+
+    // Reset the connection state, send & receive buffers keep their memory
+    _reciving = false;
+    _sending = false;
+    _send_scheduled = false;
+    _corked = 0;
+    _socket_corked = false;
+    _speculative_receiving = false;
+    _speculative_sending = false;
+    _zero_copy_waiting = false;
+    _receive_ring.Clear();
+
+    // Call the session recycled handler
+    onRecycled();
+}
+
 template <class TServer, class TSession>
 inline void TCPSession<TServer, TSession>::SendError(std::error_code ec)
 {
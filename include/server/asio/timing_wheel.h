@@ -0,0 +1,154 @@
+/*!
+    \file timing_wheel.h
+    \brief Timing wheel definition
+    \author Ivan Shynkarenka
+    \date 07.04.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_TIMING_WHEEL_H
+#define CPPSERVER_ASIO_TIMING_WHEEL_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace CppServer {
+namespace Asio {
+
+//! Timing wheel
+/*!
+    Hierarchical timing wheel keeps timers in 4 levels of 256 slots each.
+    The first level keeps timers which expire during the next 256 ticks one
+    slot per tick. Each next level keeps 256 times longer timeouts and its
+    slots are cascaded into the lower level when the wheel reaches them.
+    Timers are intrusive list nodes, so arming, re-arming and canceling
+    a timer are O(1) and never allocate memory. Timeouts longer than
+    2^32 ticks are cascaded from the last level till their deadline.
+
+    Timer handlers are called when the wheel is advanced to their deadline
+    ticks. Handlers could arm and cancel any timers of the wheel.
+
+    Not thread-safe.
+*/
+class TimingWheel
+{
+    struct Link
+    {
+        Link* prev;
+        Link* next;
+
+        Link() noexcept : prev(nullptr), next(nullptr) {}
+    };
+
+public:
+    //! Count of bits of the level slot index
+    static const size_t LEVEL_BITS = 8;
+    //! Count of slots in each level
+    static const size_t LEVEL_SLOTS = 1 << LEVEL_BITS;
+    //! Count of levels
+    static const size_t LEVELS = 4;
+
+    //! Timing wheel timer
+    /*!
+        Timer should be canceled before it is destroyed.
+    */
+    class Timer : private Link
+    {
+        friend class TimingWheel;
+
+    public:
+        //! Initialize the timer with a given expiration handler
+        /*!
+            \param handler - Expiration handler
+        */
+        explicit Timer(std::function<void()> handler = nullptr) : _deadline(0), _handler(std::move(handler)) {}
+        Timer(const Timer&) = delete;
+        Timer(Timer&&) = delete;
+        ~Timer() { assert(!armed() && "Timer should be canceled before it is destroyed!"); }
+
+        Timer& operator=(const Timer&) = delete;
+        Timer& operator=(Timer&&) = delete;
+
+        //! Is the timer armed?
+        bool armed() const noexcept { return (next != nullptr); }
+        //! Get the timer deadline tick
+        uint64_t deadline() const noexcept { return _deadline; }
+
+        //! Setup the expiration handler
+        /*!
+            \param handler - Expiration handler
+        */
+        void Setup(std::function<void()> handler) { _handler = std::move(handler); }
+
+    private:
+        uint64_t _deadline;
+        std::function<void()> _handler;
+    };
+
+    //! Initialize the timing wheel with a given current tick
+    /*!
+        \param now - Current tick (default is 0)
+    */
+    explicit TimingWheel(uint64_t now = 0);
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel(TimingWheel&&) = delete;
+    ~TimingWheel();
+
+    TimingWheel& operator=(const TimingWheel&) = delete;
+    TimingWheel& operator=(TimingWheel&&) = delete;
+
+    //! Get the current tick
+    uint64_t now() const noexcept { return _now; }
+    //! Get the count of armed timers
+    size_t size() const noexcept { return _size; }
+    //! Is the timing wheel empty?
+    bool empty() const noexcept { return (_size == 0); }
+
+    //! Arm or re-arm the given timer
+    /*!
+        The timer which is already armed is moved to the new deadline.
+        Deadlines which are not later than the current tick expire
+        with the next tick.
+
+        \param timer - Timer to arm
+        \param deadline - Deadline tick
+    */
+    void Arm(Timer& timer, uint64_t deadline) noexcept;
+    //! Cancel the given timer
+    /*!
+        \param timer - Timer to cancel
+        \return 'true' if the timer was canceled, 'false' if the timer is not armed
+    */
+    bool Cancel(Timer& timer) noexcept;
+
+    //! Advance the wheel to the given tick and call handlers of all expired timers
+    /*!
+        The wheel which has no armed timers jumps to the given tick at once.
+
+        \param now - New current tick (ignored if it is not later than the current tick)
+        \return Count of expired timers
+    */
+    size_t Advance(uint64_t now);
+
+private:
+    Link _slots[LEVELS][LEVEL_SLOTS];
+    uint64_t _now;
+    size_t _size;
+
+    //! Insert the timer into the slot of its deadline
+    void Insert(Timer& timer) noexcept;
+    //! Cascade the slot of the given level into lower levels
+    void Cascade(size_t level, size_t slot) noexcept;
+
+    //! Attach the node to the tail of the given slot list
+    static void Attach(Link& slot, Link& node) noexcept;
+    //! Detach the node from its slot list
+    static void Detach(Link& node) noexcept;
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_TIMING_WHEEL_H
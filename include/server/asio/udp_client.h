@@ -9,6 +9,7 @@
 #ifndef CPPSERVER_ASIO_UDP_CLIENT_H
 #define CPPSERVER_ASIO_UDP_CLIENT_H
 
+#include "handler_allocator.h"
 #include "service.h"
 
 #include "system/uuid.h"
@@ -205,9 +206,10 @@ private:
     uint64_t _bytes_received;
     // Receive endpoint
     asio::ip::udp::endpoint _recive_endpoint;
-    // Receive buffer
+    // Receive buffer & handler storage
     bool _reciving;
     std::vector<uint8_t> _recive_buffer;
+    HandlerStorage _recive_storage;
     // Additional options
     bool _multicast;
     bool _reuse_address;
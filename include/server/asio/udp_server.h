@@ -9,7 +9,12 @@
 #ifndef CPPSERVER_ASIO_UDP_SERVER_H
 #define CPPSERVER_ASIO_UDP_SERVER_H
 
+#include "handler_allocator.h"
 #include "service.h"
+#include "statistics.h"
+
+#include <memory>
+#include <vector>
 
 namespace CppServer {
 namespace Asio {
@@ -18,6 +23,12 @@ namespace Asio {
 /*!
     UDP server is used to send or multicast datagrams to UDP endpoints.
 
+    UDP server could receive datagrams with several sockets bound to the
+    same endpoint with SO_REUSEPORT, one per Asio service, so the OS kernel
+    spreads incoming datagrams among all services. In this case receive
+    notifications of different services are called in parallel. Datagrams
+    are sent with the socket of the first service.
+
     Thread-safe.
 */
 class UDPServer : public std::enable_shared_from_this<UDPServer>
@@ -43,6 +54,35 @@ public:
         \param endpoint - Server UDP endpoint
     */
     explicit UDPServer(std::shared_ptr<Service> service, const asio::ip::udp::endpoint& endpoint);
+    //! Initialize UDP server with a given Asio services, protocol and port number
+    /*!
+        Each Asio service receives datagrams with its own SO_REUSEPORT socket.
+        If SO_REUSEPORT is not supported only the first Asio service is used.
+
+        \param services - Asio services
+        \param protocol - Protocol type
+        \param port - Port number
+    */
+    explicit UDPServer(const std::vector<std::shared_ptr<Service>>& services, InternetProtocol protocol, int port);
+    //! Initialize UDP server with a given Asio services, IP address and port number
+    /*!
+        Each Asio service receives datagrams with its own SO_REUSEPORT socket.
+        If SO_REUSEPORT is not supported only the first Asio service is used.
+
+        \param services - Asio services
+        \param address - IP address
+        \param port - Port number
+    */
+    explicit UDPServer(const std::vector<std::shared_ptr<Service>>& services, const std::string& address, int port);
+    //! Initialize UDP server with a given Asio services and endpoint
+    /*!
+        Each Asio service receives datagrams with its own SO_REUSEPORT socket.
+        If SO_REUSEPORT is not supported only the first Asio service is used.
+
+        \param services - Asio services
+        \param endpoint - Server UDP endpoint
+    */
+    explicit UDPServer(const std::vector<std::shared_ptr<Service>>& services, const asio::ip::udp::endpoint& endpoint);
     UDPServer(const UDPServer&) = delete;
     UDPServer(UDPServer&&) = default;
     virtual ~UDPServer() = default;
@@ -52,19 +92,28 @@ public:
 
     //! Get the Asio service
     std::shared_ptr<Service>& service() noexcept { return _service; }
+    //! Get the number of server receivers
+    size_t receivers() const noexcept { return _receivers.size(); }
     //! Get the server endpoint
     asio::ip::udp::endpoint& endpoint() noexcept { return _endpoint; }
     //! Get the server multicast endpoint
     asio::ip::udp::endpoint& multicast_endpoint() noexcept { return _multicast_endpoint; }
 
     //! Get the number datagrams sent by this server
-    uint64_t datagrams_sent() const noexcept { return _datagrams_sent; }
+    uint64_t datagrams_sent() const noexcept { return statistics().messages_sent; }
     //! Get the number datagrams received by this server
-    uint64_t datagrams_received() const noexcept { return _datagrams_received; }
+    uint64_t datagrams_received() const noexcept { return statistics().messages_received; }
     //! Get the number of bytes sent by this server
-    uint64_t bytes_sent() const noexcept { return _bytes_sent; }
+    uint64_t bytes_sent() const noexcept { return statistics().bytes_sent; }
     //! Get the number of bytes received by this server
-    uint64_t bytes_received() const noexcept { return _bytes_received; }
+    uint64_t bytes_received() const noexcept { return statistics().bytes_received; }
+    //! Get the statistics snapshot of this server
+    /*!
+        Server counters are kept separately for each receiver socket, sent
+        datagrams are counted by the first one. Datagrams are counted as
+        messages of the snapshot.
+    */
+    Statistics statistics() const noexcept;
 
     //! Is the server started?
     bool IsStarted() const noexcept { return _started; }
@@ -167,26 +216,46 @@ protected:
     virtual void onError(int error, const std::string& category, const std::string& message) {}
 
 private:
+    // Server receiver
+    struct Receiver
+    {
+        // Receiver Asio service & socket
+        std::shared_ptr<Service> service;
+        asio::ip::udp::socket socket;
+        // Receive endpoint, buffer & handler storage
+        asio::ip::udp::endpoint recive_endpoint;
+        bool reciving;
+        std::vector<uint8_t> recive_buffer;
+        HandlerStorage recive_storage;
+        // Receiver statistic
+        StatisticsShard statistics;
+
+        explicit Receiver(std::shared_ptr<Service> service);
+    };
+
     // Asio service
     std::shared_ptr<Service> _service;
-    // Server endpoint & socket
+    // Server receivers
+    std::vector<std::unique_ptr<Receiver>> _receivers;
+    // Server endpoint
     asio::ip::udp::endpoint _endpoint;
-    asio::ip::udp::socket _socket;
     std::atomic<bool> _started;
-    // Server statistic
-    uint64_t _datagrams_sent;
-    uint64_t _datagrams_received;
-    uint64_t _bytes_sent;
-    uint64_t _bytes_received;
-    // Multicast & receive endpoint
+    // Multicast endpoint
     asio::ip::udp::endpoint _multicast_endpoint;
-    asio::ip::udp::endpoint _recive_endpoint;
-    // Receive buffer
-    bool _reciving;
-    std::vector<uint8_t> _recive_buffer;
 
+    //! Create server receivers for the given Asio services
+    void CreateReceivers(const std::vector<std::shared_ptr<Service>>& services);
+
+    //! Open the receiver socket and start receiving datagrams
+    /*!
+        \param receiver - Server receiver
+    */
+    void Open(Receiver* receiver);
     //! Try to receive new datagram
-    void TryReceive();
+    /*!
+        \param receiver - Server receiver
+    */
+    void TryReceive(Receiver* receiver);
 
     //! Send error notification
     void SendError(std::error_code ec);
@@ -9,19 +9,47 @@
 namespace CppServer {
 namespace Asio {
 
+template <class TServer, class TSession>
+inline WebSocketServer<TServer, TSession>::Shard::Shard(std::shared_ptr<Service> service)
+    : service(service),
+      strand(*service->service()),
+      strand_required(service->IsStrandRequired()),
+      sessions_count(0),
+      sessions_key(0)
+{
+}
+
 template <class TServer, class TSession>
 inline WebSocketServer<TServer, TSession>::WebSocketServer(std::shared_ptr<Service> service, InternetProtocol protocol, int port)
-    : _service(service),
+    : WebSocketServer(std::vector<std::shared_ptr<Service>>({ service }), protocol, port)
+{
+}
+
+template <class TServer, class TSession>
+inline WebSocketServer<TServer, TSession>::WebSocketServer(std::shared_ptr<Service> service, const std::string& address, int port)
+    : WebSocketServer(std::vector<std::shared_ptr<Service>>({ service }), address, port)
+{
+}
+
+template <class TServer, class TSession>
+inline WebSocketServer<TServer, TSession>::WebSocketServer(std::shared_ptr<Service> service, const asio::ip::tcp::endpoint& endpoint)
+    : WebSocketServer(std::vector<std::shared_ptr<Service>>({ service }), endpoint)
+{
+}
+
+template <class TServer, class TSession>
+inline WebSocketServer<TServer, TSession>::WebSocketServer(const std::vector<std::shared_ptr<Service>>& services, InternetProtocol protocol, int port, ShardPolicy policy)
+    : _service(services.empty() ? nullptr : services.front()),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
+      _shard_policy(policy),
+      _shard_next(0),
+      _id_policy(IdPolicy::Sequential),
+      _session_key(0),
       _initialized(false),
-      _started(false),
-      _messages_sent(0),
-      _messages_received(0),
-      _bytes_sent(0),
-      _bytes_received(0)
+      _started(false)
 {
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
-        throw CppCommon::ArgumentException("ASIO service is invalid!");
+    CreateShards(services);
 
     switch (protocol)
     {
@@ -37,18 +65,18 @@ inline WebSocketServer<TServer, TSession>::WebSocketServer(std::shared_ptr<Servi
 }
 
 template <class TServer, class TSession>
-inline WebSocketServer<TServer, TSession>::WebSocketServer(std::shared_ptr<Service> service, const std::string& address, int port)
-    : _service(service),
+inline WebSocketServer<TServer, TSession>::WebSocketServer(const std::vector<std::shared_ptr<Service>>& services, const std::string& address, int port, ShardPolicy policy)
+    : _service(services.empty() ? nullptr : services.front()),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
+      _shard_policy(policy),
+      _shard_next(0),
+      _id_policy(IdPolicy::Sequential),
+      _session_key(0),
       _initialized(false),
-      _started(false),
-      _messages_sent(0),
-      _messages_received(0),
-      _bytes_sent(0),
-      _bytes_received(0)
+      _started(false)
 {
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
-        throw CppCommon::ArgumentException("ASIO service is invalid!");
+    CreateShards(services);
 
     _endpoint = asio::ip::tcp::endpoint(asio::ip::address::from_string(address), port);
 
@@ -56,23 +84,45 @@ inline WebSocketServer<TServer, TSession>::WebSocketServer(std::shared_ptr<Servi
 }
 
 template <class TServer, class TSession>
-inline WebSocketServer<TServer, TSession>::WebSocketServer(std::shared_ptr<Service> service, const asio::ip::tcp::endpoint& endpoint)
-    : _service(service),
+inline WebSocketServer<TServer, TSession>::WebSocketServer(const std::vector<std::shared_ptr<Service>>& services, const asio::ip::tcp::endpoint& endpoint, ShardPolicy policy)
+    : _service(services.empty() ? nullptr : services.front()),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
+      _shard_policy(policy),
+      _shard_next(0),
+      _id_policy(IdPolicy::Sequential),
+      _session_key(0),
       _endpoint(endpoint),
       _initialized(false),
-      _started(false),
-      _messages_sent(0),
-      _messages_received(0),
-      _bytes_sent(0),
-      _bytes_received(0)
+      _started(false)
 {
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
-        throw CppCommon::ArgumentException("ASIO service is invalid!");
+    CreateShards(services);
 
     InitAsio();
 }
 
+template <class TServer, class TSession>
+inline void WebSocketServer<TServer, TSession>::CreateShards(const std::vector<std::shared_ptr<Service>>& services)
+{
+    for (auto& service : services)
+    {
+        assert((service != nullptr) && "ASIO service is invalid!");
+        if (service == nullptr)
+            throw CppCommon::ArgumentException("ASIO service is invalid!");
+
+        _shards.emplace_back(std::make_unique<Shard>(service));
+    }
+}
+
+template <class TServer, class TSession>
+inline uint64_t WebSocketServer<TServer, TSession>::current_sessions() const noexcept
+{
+    uint64_t result = 0;
+    for (auto& shard : _shards)
+        result += shard->sessions_count;
+    return result;
+}
+
 template <class TServer, class TSession>
 inline void WebSocketServer<TServer, TSession>::InitAsio()
 {
@@ -92,6 +142,23 @@ inline void WebSocketServer<TServer, TSession>::InitAsio()
     _initialized = true;
 }
 
+template <class TServer, class TSession>
+inline Statistics WebSocketServer<TServer, TSession>::statistics() const noexcept
+{
+    Statistics result;
+    for (auto& shard : _shards)
+        shard->statistics.Collect(result);
+    return result;
+}
+
+template <class TServer, class TSession>
+inline Statistics WebSocketServer<TServer, TSession>::statistics(size_t shard) const noexcept
+{
+    Statistics result;
+    _shards[shard]->statistics.Collect(result);
+    return result;
+}
+
 template <class TServer, class TSession>
 inline bool WebSocketServer<TServer, TSession>::Start()
 {
@@ -105,7 +172,7 @@ inline bool WebSocketServer<TServer, TSession>::Start()
 
     // Post the start routine
     auto self(this->shared_from_this());
-    _service->service()->post([this, self]()
+    auto start_handler = [this, self]()
     {
         websocketpp::lib::error_code ec;
 
@@ -114,8 +181,8 @@ inline bool WebSocketServer<TServer, TSession>::Start()
         _core.set_error_channels(websocketpp::log::elevel::none);
 
         // Setup WebSocket server core handlers
+        // (close handler is set up for each connection to route it into the session shard)
         _core.set_open_handler([this](websocketpp::connection_hdl connection) { RegisterSession(connection); });
-        _core.set_close_handler([this](websocketpp::connection_hdl connection) { UnregisterSession(connection); });
 
         // Start WebSocket server core
         _core.listen(_endpoint, ec);
@@ -127,10 +194,8 @@ inline bool WebSocketServer<TServer, TSession>::Start()
         }
 
         // Reset statistic
-        _messages_sent = 0;
-        _messages_received = 0;
-        _bytes_sent = 0;
-        _bytes_received = 0;
+        for (auto& shard : _shards)
+            shard->statistics.Reset();
 
         // Update the started flag
         _started = true;
@@ -146,7 +211,11 @@ inline bool WebSocketServer<TServer, TSession>::Start()
             Stop();
             return;
         }
-    });
+    };
+    if (_strand_required)
+        _strand.post(start_handler);
+    else
+        _service->Post(start_handler);
 
     return true;
 }
@@ -160,7 +229,7 @@ inline bool WebSocketServer<TServer, TSession>::Stop()
 
     // Post the stopped routine
     auto self(this->shared_from_this());
-    _service->service()->post([this, self]()
+    auto stop_handler = [this, self]()
     {
         // Stop WebSocket server
         websocketpp::lib::error_code ec;
@@ -179,7 +248,11 @@ inline bool WebSocketServer<TServer, TSession>::Stop()
 
         // Call the server stopped handler
         onStopped();
-    });
+    };
+    if (_strand_required)
+        _strand.post(stop_handler);
+    else
+        _service->Post(stop_handler);
 
     return true;
 }
@@ -207,15 +280,19 @@ inline bool WebSocketServer<TServer, TSession>::Multicast(const void* buffer, si
     if (!IsStarted())
         return false;
 
+    for (auto& shard : _shards)
     {
-        std::lock_guard<std::mutex> locker(_multicast_lock);
+        {
+            std::lock_guard<std::mutex> locker(shard->multicast_lock);
+
+            // Fill the shard multicast buffer
+            std::vector<uint8_t> message((const uint8_t*)buffer, ((const uint8_t*)buffer) + size);
+            shard->multicast_buffer.emplace_back(std::make_tuple(message, opcode));
+        }
 
-        // Fill the multicast buffer
-        std::vector<uint8_t> message((const uint8_t*)buffer, ((const uint8_t*)buffer) + size);
-        _multicast_buffer.emplace_back(std::make_tuple(message, opcode));
+        MulticastAll(shard.get());
     }
 
-    MulticastAll();
     return true;
 }
 
@@ -225,14 +302,18 @@ inline bool WebSocketServer<TServer, TSession>::Multicast(const std::string& tex
     if (!IsStarted())
         return false;
 
+    for (auto& shard : _shards)
     {
-        std::lock_guard<std::mutex> locker(_multicast_lock);
+        {
+            std::lock_guard<std::mutex> locker(shard->multicast_lock);
+
+            // Fill the shard multicast buffer
+            shard->multicast_text.emplace_back(std::make_tuple(text, opcode));
+        }
 
-        // Fill the multicast buffer
-        _multicast_text.emplace_back(std::make_tuple(text, opcode));
+        MulticastAll(shard.get());
     }
 
-    MulticastAll();
     return true;
 }
 
@@ -242,42 +323,65 @@ inline bool WebSocketServer<TServer, TSession>::Multicast(const WebSocketMessage
     if (!IsStarted())
         return false;
 
+    for (auto& shard : _shards)
     {
-        std::lock_guard<std::mutex> locker(_multicast_lock);
+        {
+            std::lock_guard<std::mutex> locker(shard->multicast_lock);
 
-        // Fill the multicast buffer
-        _multicast_messages.push_back(message);
+            // Fill the shard multicast buffer
+            shard->multicast_messages.push_back(message);
+        }
+
+        MulticastAll(shard.get());
     }
 
-    MulticastAll();
     return true;
 }
 
 template <class TServer, class TSession>
-inline void WebSocketServer<TServer, TSession>::MulticastAll()
+inline void WebSocketServer<TServer, TSession>::MulticastAll(Shard* shard)
 {
-    // Dispatch the multicast routine
+    // Dispatch the multicast routine into the shard
     auto self(this->shared_from_this());
-    _service->Dispatch([this, self]()
+    auto multicast_handler = [this, self, shard]()
     {
-        std::lock_guard<std::mutex> locker(_multicast_lock);
+        std::lock_guard<std::mutex> locker(shard->multicast_lock);
 
-        // Multicast all sessions
-        for (auto& session : _sessions)
+        // Multicast all shard sessions
+        for (auto& session : shard->sessions)
         {
-            for (auto& message : _multicast_buffer)
-                session.second->Send(std::get<0>(message).data(), std::get<0>(message).size(), std::get<1>(message));
-            for (auto& text : _multicast_text)
-                session.second->Send(std::get<0>(text), std::get<1>(text));
-            for (auto& message : _multicast_messages)
-                session.second->Send(message);
+            for (auto& message : shard->multicast_buffer)
+                session->Send(std::get<0>(message).data(), std::get<0>(message).size(), std::get<1>(message));
+            for (auto& text : shard->multicast_text)
+                session->Send(std::get<0>(text), std::get<1>(text));
+            for (auto& message : shard->multicast_messages)
+                session->Send(message);
         }
 
         // Clear the multicast buffers
-        _multicast_buffer.clear();
-        _multicast_text.clear();
-        _multicast_messages.clear();
-    });
+        shard->multicast_buffer.clear();
+        shard->multicast_text.clear();
+        shard->multicast_messages.clear();
+    };
+    if (shard->strand_required)
+        shard->strand.dispatch(multicast_handler);
+    else
+        shard->service->Dispatch(multicast_handler);
+}
+
+template <class TServer, class TSession>
+inline std::shared_ptr<TSession> WebSocketServer<TServer, TSession>::FindSession(uint64_t key)
+{
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> locker(shard->sessions_lock);
+
+        auto session = shard->sessions.Find(key);
+        if (session)
+            return session;
+    }
+
+    return nullptr;
 }
 
 template <class TServer, class TSession>
@@ -286,74 +390,168 @@ inline bool WebSocketServer<TServer, TSession>::DisconnectAll()
     if (!IsStarted())
         return false;
 
-    // Dispatch the disconnect routine
     auto self(this->shared_from_this());
-    _service->Dispatch([this, self]()
+    for (auto& shard_ptr : _shards)
     {
-        // Disconnect all sessions
-        for (auto& session : _sessions)
-            session.second->Disconnect();
-    });
+        Shard* shard = shard_ptr.get();
+
+        // Dispatch the disconnect routine into the shard
+        auto disconnect_all_handler = [this, self, shard]()
+        {
+            // Disconnect all shard sessions
+            for (auto& session : shard->sessions)
+                session->Disconnect();
+        };
+        if (shard->strand_required)
+            shard->strand.dispatch(disconnect_all_handler);
+        else
+            shard->service->Dispatch(disconnect_all_handler);
+    }
 
     return true;
 }
 
+template <class TServer, class TSession>
+inline size_t WebSocketServer<TServer, TSession>::SelectShard()
+{
+    switch (_shard_policy)
+    {
+        case ShardPolicy::LeastLoaded:
+        {
+            size_t result = 0;
+            for (size_t i = 1; i < _shards.size(); ++i)
+                if (_shards[i]->sessions_count < _shards[result]->sessions_count)
+                    result = i;
+            return result;
+        }
+        case ShardPolicy::RoundRobin:
+        default:
+            return _shard_next++ % _shards.size();
+    }
+}
+
+template <class TServer, class TSession>
+inline void WebSocketServer<TServer, TSession>::GenerateId(size_t shard_index, TSession& session)
+{
+    Shard* shard = _shards[shard_index].get();
+
+    // Generate the session key
+    if (_id_policy == IdPolicy::ShardSequential)
+        session._key = ((uint64_t)(shard_index + 1) << SHARD_KEY_SHIFT) | ++shard->sessions_key;
+    else
+        session._key = ++_session_key;
+
+    // Generate the session Id
+    if (_id_policy == IdPolicy::UUID)
+        session._id = CppCommon::UUID::Generate();
+    else
+        session._id = MakeId(session._key);
+}
+
 template <class TServer, class TSession>
 inline std::shared_ptr<TSession> WebSocketServer<TServer, TSession>::RegisterSession(websocketpp::connection_hdl connection)
 {
-    // Create and register a new session
+    size_t shard_index = SelectShard();
+    Shard* shard = _shards[shard_index].get();
+
+    // Create and connect a new session
+    // (connection handlers must be set up before the open handler returns)
     auto self(this->shared_from_this());
     auto session = std::make_shared<TSession>(self);
-    _connections.insert(std::make_pair(connection, session));
-    _sessions.insert(std::make_pair(session->id(), session));
-
-    // Connect a new session
+    session->_shard = shard_index;
+    GenerateId(shard_index, *session);
     session->Connect(connection);
+    ++shard->sessions_count;
+
+    // Route the connection close notification into the session shard
+    uint64_t key = session->key();
+    WebSocketServerCore::connection_ptr con = _core.get_con_from_hdl(connection);
+    con->set_close_handler([this, shard_index, key](websocketpp::connection_hdl connection) { CloseSession(shard_index, key); });
+
+    // Dispatch the register routine into the shard
+    auto register_handler = [this, self, shard, session]() mutable
+    {
+        // Register a new session
+        {
+            std::lock_guard<std::mutex> locker(shard->sessions_lock);
+            shard->sessions.Insert(session->key(), session);
+        }
 
-    // Call a new session connected handler
-    onConnected(session);
+        // Call a new session connected handler
+        onConnected(session);
+    };
+    if (shard->strand_required)
+        shard->strand.dispatch(register_handler);
+    else
+        shard->service->Dispatch(register_handler);
 
     return session;
 }
 
 template <class TServer, class TSession>
-inline void WebSocketServer<TServer, TSession>::UnregisterSession(websocketpp::connection_hdl connection)
+inline void WebSocketServer<TServer, TSession>::CloseSession(size_t shard_index, uint64_t key)
 {
-    // Try to find the unregistered connection
-    auto it = _connections.find(connection);
-    if (it != _connections.end())
+    Shard* shard = _shards[shard_index].get();
+
+    // Dispatch the close routine into the shard
+    auto self(this->shared_from_this());
+    auto close_handler = [this, self, shard, key]()
     {
-        // Call the session disconnected handler
-        it->second->Disconnected();
-    }
+        // Try to find the closed session
+        auto session = shard->sessions.Find(key);
+        if (session)
+        {
+            // Call the session disconnected handler
+            session->Disconnected();
+        }
+    };
+    if (shard->strand_required)
+        shard->strand.dispatch(close_handler);
+    else
+        shard->service->Dispatch(close_handler);
 }
 
 template <class TServer, class TSession>
-inline void WebSocketServer<TServer, TSession>::UnregisterSession(const CppCommon::UUID& id)
+inline void WebSocketServer<TServer, TSession>::UnregisterSession(size_t shard_index, uint64_t key)
 {
-    // Try to find the unregistered session
-    auto it = _sessions.find(id);
-    if (it != _sessions.end())
-    {
-        // Call the session disconnected handler
-        onDisconnected(it->second);
+    Shard* shard = _shards[shard_index].get();
 
-        // Erase the connection
-        _connections.erase(_connections.find(it->second->connection()));
-
-        // Erase the session
-        _sessions.erase(it);
-    }
+    // Dispatch the unregister routine into the shard
+    auto self(this->shared_from_this());
+    auto unregister_handler = [this, self, shard, key]()
+    {
+        // Try to find the unregistered session
+        auto session = shard->sessions.Find(key);
+        if (session)
+        {
+            // Call the session disconnected handler
+            onDisconnected(session);
+
+            // Erase the session
+            {
+                std::lock_guard<std::mutex> locker(shard->sessions_lock);
+                shard->sessions.Erase(key);
+            }
+            --shard->sessions_count;
+        }
+    };
+    if (shard->strand_required)
+        shard->strand.dispatch(unregister_handler);
+    else
+        shard->service->Dispatch(unregister_handler);
 }
 
 template <class TServer, class TSession>
 inline void WebSocketServer<TServer, TSession>::ClearBuffers()
 {
-    std::lock_guard<std::mutex> locker(_multicast_lock);
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> locker(shard->multicast_lock);
 
-    _multicast_buffer.clear();
-    _multicast_text.clear();
-    _multicast_messages.clear();
+        shard->multicast_buffer.clear();
+        shard->multicast_text.clear();
+        shard->multicast_messages.clear();
+    }
 }
 
 template <class TServer, class TSession>
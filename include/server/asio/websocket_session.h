@@ -10,6 +10,7 @@
 #define CPPSERVER_ASIO_WEBSOCKET_SESSION_H
 
 #include "service.h"
+#include "statistics.h"
 #include "websocket.h"
 
 #include "system/uuid.h"
@@ -23,6 +24,8 @@ class WebSocketServer;
 //! WebSocket session
 /*!
     WebSocket session is used to read and write data from the connected WebSocket client.
+    All session handlers are serialized through the WebSocket connection
+    strand if the Asio service is running in several working threads.
 
     Thread-safe.
 */
@@ -47,6 +50,12 @@ public:
 
     //! Get the session Id
     const CppCommon::UUID& id() const noexcept { return _id; }
+    //! Get the session key
+    /*!
+        Session key is a compact 64-bit identifier of the session unique
+        inside its server. It is used to find the session in the server.
+    */
+    uint64_t key() const noexcept { return _key; }
 
     //! Get the Asio service
     std::shared_ptr<Service>& service() noexcept { return _server->service(); }
@@ -56,13 +65,13 @@ public:
     websocketpp::connection_hdl& connection() noexcept { return _connection; }
 
     //! Get the number messages sent by this session
-    uint64_t messages_sent() const noexcept { return _messages_sent; }
+    uint64_t messages_sent() const noexcept { return _statistics.messages_sent(); }
     //! Get the number messages received by this session
-    uint64_t messages_received() const noexcept { return _messages_received; }
+    uint64_t messages_received() const noexcept { return _statistics.messages_received(); }
     //! Get the number of bytes sent by this session
-    uint64_t bytes_sent() const noexcept { return _bytes_sent; }
+    uint64_t bytes_sent() const noexcept { return _statistics.bytes_sent(); }
     //! Get the number of bytes received by this session
-    uint64_t bytes_received() const noexcept { return _bytes_received; }
+    uint64_t bytes_received() const noexcept { return _statistics.bytes_received(); }
 
     //! Is the session connected?
     bool IsConnected() const noexcept { return _connected; }
@@ -118,17 +127,16 @@ protected:
     virtual void onError(int error, const std::string& category, const std::string& message) {}
 
 private:
-    // Session Id
+    // Session Id & key
     CppCommon::UUID _id;
-    // Session server & connection
+    uint64_t _key;
+    // Session server, shard & connection
     std::shared_ptr<WebSocketServer<TServer, TSession>> _server;
+    size_t _shard;
     websocketpp::connection_hdl _connection;
     std::atomic<bool> _connected;
     // Session statistic
-    uint64_t _messages_sent;
-    uint64_t _messages_received;
-    uint64_t _bytes_sent;
-    uint64_t _bytes_received;
+    SessionStatistics<std::atomic<uint64_t>> _statistics;
 
     //! Connect the session
     /*!
@@ -11,13 +11,11 @@ namespace Asio {
 
 template <class TServer, class TSession>
 inline WebSocketSession<TServer, TSession>::WebSocketSession(std::shared_ptr<WebSocketServer<TServer, TSession>> server)
-    : _id(CppCommon::UUID::Generate()),
+    : _id(CppCommon::UUID::Nil()),
+      _key(0),
       _server(server),
-      _connected(false),
-      _messages_sent(0),
-      _messages_received(0),
-      _bytes_sent(0),
-      _bytes_received(0)
+      _shard(0),
+      _connected(false)
 {
 }
 
@@ -31,10 +29,8 @@ inline void WebSocketSession<TServer, TSession>::Connect(websocketpp::connection
         size_t size = message->get_raw_payload().size();
 
         // Update statistic
-        ++_messages_received;
-        ++_server->_messages_received;
-        _bytes_received += size;
-        _server->_bytes_received += size;
+        _statistics.Received(size, 1);
+        _server->_shards[_shard]->statistics.Received(size, 1);
 
         // Call the message received handler
         onReceived(message);
@@ -51,10 +47,7 @@ inline void WebSocketSession<TServer, TSession>::Connect(websocketpp::connection
     _connection = connection;
 
     // Reset statistic
-    _messages_sent = 0;
-    _messages_received = 0;
-    _bytes_sent = 0;
-    _bytes_received = 0;
+    _statistics.Reset();
 
     // Update the connected flag
     _connected = true;
@@ -98,7 +91,7 @@ inline void WebSocketSession<TServer, TSession>::Disconnected()
     onDisconnected();
 
     // Unregister the session
-    _server->UnregisterSession(id());
+    _server->UnregisterSession(_shard, key());
 }
 
 template <class TServer, class TSession>
@@ -121,10 +114,8 @@ inline size_t WebSocketSession<TServer, TSession>::Send(const void* buffer, size
     }
 
     // Update statistic
-    ++_messages_sent;
-    ++_server->_messages_sent;
-    _bytes_sent += size;
-    _server->_bytes_sent += size;
+    _statistics.Sent(size, 1);
+    _server->_shards[_shard]->statistics.Sent(size, 1);
 
     return size;
 }
@@ -146,10 +137,8 @@ inline size_t WebSocketSession<TServer, TSession>::Send(const std::string& text,
     size_t size = text.size();
 
     // Update statistic
-    ++_messages_sent;
-    ++_server->_messages_sent;
-    _bytes_sent += size;
-    _server->_bytes_sent += size;
+    _statistics.Sent(size, 1);
+    _server->_shards[_shard]->statistics.Sent(size, 1);
 
     return size;
 }
@@ -171,10 +160,8 @@ inline size_t WebSocketSession<TServer, TSession>::Send(const WebSocketMessage&
     size_t size = message->get_raw_payload().size();
 
     // Update statistic
-    ++_messages_sent;
-    ++_server->_messages_sent;
-    _bytes_sent += size;
-    _server->_bytes_sent += size;
+    _statistics.Sent(size, 1);
+    _server->_shards[_shard]->statistics.Sent(size, 1);
 
     return size;
 }
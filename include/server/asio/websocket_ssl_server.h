@@ -9,9 +9,10 @@
 #ifndef CPPSERVER_ASIO_WEBSOCKET_SSL_SERVER_H
 #define CPPSERVER_ASIO_WEBSOCKET_SSL_SERVER_H
 
+#include "session_registry.h"
 #include "websocket_ssl_session.h"
 
-#include <map>
+#include <memory>
 #include <mutex>
 #include <tuple>
 #include <vector>
@@ -26,6 +27,14 @@ class WebSocketSSLSession;
 /*!
     WebSocket SSL server is used to connect, disconnect and manage WebSocket sessions.
 
+    WebSocket SSL server could be sharded over several Asio services. WebSocket
+    server core binds all its connections to a single Asio service, so the
+    core (acceptor and sessions I/O) runs in the first service, while the
+    sessions registry is distributed among all services according to the
+    shard policy. Each shard keeps its own sessions registry which is
+    modified only from the shard service, so server session notifications
+    of different shards are called in parallel.
+
     Thread-safe.
 */
 template <class TServer, class TSession>
@@ -58,6 +67,32 @@ public:
         \param endpoint - Server endpoint
     */
     explicit WebSocketSSLServer(std::shared_ptr<Service> service, std::shared_ptr<asio::ssl::context> context, const asio::ip::tcp::endpoint& endpoint);
+    //! Initialize sharded WebSocket server with a given Asio services, SSL context, protocol and port number
+    /*!
+        \param services - Asio services (the first one is used to run WebSocket server core)
+        \param context - SSL context
+        \param protocol - Protocol type
+        \param port - Port number
+        \param policy - Shard policy (default is ShardPolicy::RoundRobin)
+    */
+    explicit WebSocketSSLServer(const std::vector<std::shared_ptr<Service>>& services, std::shared_ptr<asio::ssl::context> context, InternetProtocol protocol, int port, ShardPolicy policy = ShardPolicy::RoundRobin);
+    //! Initialize sharded WebSocket server with a given Asio services, SSL context, IP address and port number
+    /*!
+        \param services - Asio services (the first one is used to run WebSocket server core)
+        \param context - SSL context
+        \param address - IP address
+        \param port - Port number
+        \param policy - Shard policy (default is ShardPolicy::RoundRobin)
+    */
+    explicit WebSocketSSLServer(const std::vector<std::shared_ptr<Service>>& services, std::shared_ptr<asio::ssl::context> context, const std::string& address, int port, ShardPolicy policy = ShardPolicy::RoundRobin);
+    //! Initialize sharded WebSocket server with a given Asio services, SSL context and endpoint
+    /*!
+        \param services - Asio services (the first one is used to run WebSocket server core)
+        \param context - SSL context
+        \param endpoint - Server endpoint
+        \param policy - Shard policy (default is ShardPolicy::RoundRobin)
+    */
+    explicit WebSocketSSLServer(const std::vector<std::shared_ptr<Service>>& services, std::shared_ptr<asio::ssl::context> context, const asio::ip::tcp::endpoint& endpoint, ShardPolicy policy = ShardPolicy::RoundRobin);
     WebSocketSSLServer(const WebSocketSSLServer&) = delete;
     WebSocketSSLServer(WebSocketSSLServer&&) = default;
     virtual ~WebSocketSSLServer() = default;
@@ -67,6 +102,14 @@ public:
 
     //! Get the Asio service
     std::shared_ptr<Service>& service() noexcept { return _service; }
+    //! Get the Asio service of the given shard
+    std::shared_ptr<Service>& service(size_t shard) noexcept { return _shards[shard]->service; }
+    //! Get the number of server shards
+    size_t shards() const noexcept { return _shards.size(); }
+    //! Get the shard policy
+    ShardPolicy shard_policy() const noexcept { return _shard_policy; }
+    //! Get the id policy of new sessions
+    IdPolicy id_policy() const noexcept { return _id_policy; }
     //! Get the server SSL context
     std::shared_ptr<asio::ssl::context>& context() noexcept { return _context; }
     //! Get the server endpoint
@@ -75,15 +118,23 @@ public:
     WebSocketSSLServerCore& core() noexcept { return _core; }
 
     //! Get the number of sessions currently connected to this server
-    uint64_t current_sessions() const noexcept { return _sessions.size(); }
+    uint64_t current_sessions() const noexcept;
     //! Get the number messages sent by this server
-    uint64_t messages_sent() const noexcept { return _messages_sent; }
+    uint64_t messages_sent() const noexcept { return statistics().messages_sent; }
     //! Get the number messages received by this server
-    uint64_t messages_received() const noexcept { return _messages_received; }
+    uint64_t messages_received() const noexcept { return statistics().messages_received; }
     //! Get the number of bytes sent by this server
-    uint64_t bytes_sent() const noexcept { return _bytes_sent; }
+    uint64_t bytes_sent() const noexcept { return statistics().bytes_sent; }
     //! Get the number of bytes received by this server
-    uint64_t bytes_received() const noexcept { return _bytes_received; }
+    uint64_t bytes_received() const noexcept { return statistics().bytes_received; }
+    //! Get the statistics snapshot of this server
+    /*!
+        Server counters are kept separately for each shard and updated only
+        by sessions of that shard. Snapshot aggregates counters of all shards.
+    */
+    Statistics statistics() const noexcept;
+    //! Get the statistics snapshot of the given shard
+    Statistics statistics(size_t shard) const noexcept;
 
     //! Is the server started?
     bool IsStarted() const noexcept { return _started; }
@@ -104,6 +155,17 @@ public:
     */
     bool Restart();
 
+    //! Setup the id policy of new sessions
+    /*!
+        By default sessions get monotonic 64-bit keys with UUID Ids made
+        from them. Random UUID Ids should be requested explicitly with
+        IdPolicy::UUID. The policy should be setup before the server
+        is started.
+
+        \param policy - Id policy
+    */
+    void SetupIdPolicy(IdPolicy policy) noexcept { _id_policy = policy; }
+
     //! Multicast data to all connected sessions
     /*!
         \param buffer - Buffer to send
@@ -126,6 +188,13 @@ public:
     */
     bool Multicast(const WebSocketSSLMessage& message);
 
+    //! Find the connected session with the given key
+    /*!
+        \param key - Session key
+        \return Connected session or 'nullptr' if the session with the given key is not connected
+    */
+    std::shared_ptr<TSession> FindSession(uint64_t key);
+
     //! Disconnect all connected sessions
     /*!
         \return 'true' if all sessions were successfully disconnected, 'false' if the server it not started
@@ -140,11 +209,15 @@ protected:
 
     //! Handle new session connected notification
     /*!
+        Notification is called in the Asio service of the session shard.
+
         \param session - Connected session
     */
     virtual void onConnected(std::shared_ptr<TSession>& session) {}
     //! Handle session disconnected notification
     /*!
+        Notification is called in the Asio service of the session shard.
+
         \param session - Disconnected session
     */
     virtual void onDisconnected(std::shared_ptr<TSession>& session) {}
@@ -158,49 +231,85 @@ protected:
     virtual void onError(int error, const std::string& category, const std::string& message) {}
 
 private:
-    // Asio service
+    // Server shard
+    struct Shard
+    {
+        // Shard Asio service & strand
+        std::shared_ptr<Service> service;
+        asio::io_service::strand strand;
+        bool strand_required;
+        // Shard sessions
+        std::atomic<size_t> sessions_count;
+        std::atomic<uint64_t> sessions_key;
+        std::mutex sessions_lock;
+        SessionRegistry<TSession> sessions;
+        // Shard multicast buffer
+        std::mutex multicast_lock;
+        std::vector<std::tuple<std::vector<uint8_t>, websocketpp::frame::opcode::value>> multicast_buffer;
+        std::vector<std::tuple<std::string, websocketpp::frame::opcode::value>> multicast_text;
+        std::vector<WebSocketSSLMessage> multicast_messages;
+        // Shard statistic
+        StatisticsShard statistics;
+
+        explicit Shard(std::shared_ptr<Service> service);
+    };
+
+    // Asio service & strand
     std::shared_ptr<Service> _service;
+    asio::io_service::strand _strand;
+    bool _strand_required;
+    // Server shards
+    std::vector<std::unique_ptr<Shard>> _shards;
+    ShardPolicy _shard_policy;
+    std::atomic<size_t> _shard_next;
+    // Server session ids
+    IdPolicy _id_policy;
+    std::atomic<uint64_t> _session_key;
     // Server SSL context, endpoint & core
     std::shared_ptr<asio::ssl::context> _context;
     asio::ip::tcp::endpoint _endpoint;
     WebSocketSSLServerCore _core;
     std::atomic<bool> _initialized;
     std::atomic<bool> _started;
-    // Server statistic
-    uint64_t _messages_sent;
-    uint64_t _messages_received;
-    uint64_t _bytes_sent;
-    uint64_t _bytes_received;
-    // Server sessions
-    std::map<websocketpp::connection_hdl, std::shared_ptr<TSession>, std::owner_less<websocketpp::connection_hdl>> _connections;
-    std::map<CppCommon::UUID, std::shared_ptr<TSession>> _sessions;
-    // Multicast buffer
-    std::mutex _multicast_lock;
-    std::vector<std::tuple<std::vector<uint8_t>, websocketpp::frame::opcode::value>> _multicast_buffer;
-    std::vector<std::tuple<std::string, websocketpp::frame::opcode::value>> _multicast_text;
-    std::vector<WebSocketSSLMessage> _multicast_messages;
+
+    //! Create server shards for the given Asio services
+    void CreateShards(const std::vector<std::shared_ptr<Service>>& services);
+    //! Select the shard for a new connected session
+    size_t SelectShard();
 
     //! Initialize Asio
     void InitAsio();
 
+    //! Generate the key & Id of a new session
+    /*!
+        \param shard - Session shard
+        \param session - New session
+    */
+    void GenerateId(size_t shard, TSession& session);
+
     //! Register a new session
     /*
         \param connection - WebSocket connection
     */
     std::shared_ptr<TSession> RegisterSession(websocketpp::connection_hdl connection);
-    //! Unregister the given session
+    //! Close the given session
     /*!
-        \param connection - Session connection
+        \param shard - Session shard
+        \param key - Session key
     */
-    void UnregisterSession(websocketpp::connection_hdl connection);
+    void CloseSession(size_t shard, uint64_t key);
     //! Unregister the given session
     /*!
-        \param id - Session Id
+        \param shard - Session shard
+        \param key - Session key
     */
-    void UnregisterSession(const CppCommon::UUID& id);
+    void UnregisterSession(size_t shard, uint64_t key);
 
-    //! Multicast all
-    void MulticastAll();
+    //! Multicast all pending data of the given shard
+    /*!
+        \param shard - Server shard
+    */
+    void MulticastAll(Shard* shard);
 
     //! Clear multicast buffer
     void ClearBuffers();
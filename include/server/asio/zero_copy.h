@@ -0,0 +1,202 @@
+/*!
+    \file zero_copy.h
+    \brief Zero copy send definition
+    \author Ivan Shynkarenka
+    \date 29.03.2017
+    \copyright MIT License
+*/
+
+#ifndef CPPSERVER_ASIO_ZERO_COPY_H
+#define CPPSERVER_ASIO_ZERO_COPY_H
+
+#include "asio.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace CppServer {
+namespace Asio {
+
+class ZeroCopyLinger;
+
+//! Zero copy send
+/*!
+    Zero copy send writes buffers into the socket with MSG_ZEROCOPY flag,
+    so the kernel transmits them right from the user memory instead of
+    copying them into the socket buffer. The memory must stay unchanged
+    until the kernel reports the send completion into the socket error
+    queue, so each send keeps the storage holder of its buffers until the
+    completion arrives.
+
+    Zero copy send is supported on Linux 4.14 and later. On other platforms
+    or older kernels the socket cannot be opened in the zero copy mode and
+    callers should fall back to normal sends. The kernel might also copy
+    the buffers anyway (e.g. over the loopback interface), in this case
+    deferred copies are more expensive than normal sends, so the zero copy
+    mode is disabled after the first copied completion.
+
+    The kernel might still transmit the buffers after the socket is closed,
+    so sends which are waiting for the completion when the socket is closing
+    should linger in the zero copy linger (see ZeroCopyLinger).
+
+    Not thread-safe.
+*/
+class ZeroCopy
+{
+    friend class ZeroCopyLinger;
+
+public:
+    ZeroCopy() noexcept : _threshold(0), _sequence(0), _enabled(false) {}
+    ZeroCopy(const ZeroCopy&) = delete;
+    ZeroCopy(ZeroCopy&&) = delete;
+    ~ZeroCopy() = default;
+
+    ZeroCopy& operator=(const ZeroCopy&) = delete;
+    ZeroCopy& operator=(ZeroCopy&&) = delete;
+
+    //! Get the minimal size of buffers to send with zero copy (0 if the zero copy mode is disabled)
+    size_t threshold() const noexcept { return _threshold; }
+    //! Get the count of sends which are waiting for the kernel completion
+    size_t pending() const noexcept { return _pending.size(); }
+
+    //! Is the zero copy mode enabled for the opened socket?
+    bool enabled() const noexcept { return _enabled; }
+    //! Should the given count of bytes be sent with zero copy?
+    bool Check(size_t size) const noexcept { return _enabled && (size >= _threshold); }
+
+    //! Setup the minimal size of buffers to send with zero copy
+    /*!
+        \param threshold - Minimal size of buffers to send with zero copy (0 to disable the zero copy mode)
+    */
+    void Setup(size_t threshold) noexcept { _threshold = threshold; }
+
+    //! Open the zero copy mode for the given connected socket
+    /*!
+        \param socket - Connected socket
+        \return 'true' if the zero copy mode was successfully opened, 'false' if the kernel does not support it
+    */
+    bool Open(asio::ip::tcp::socket& socket);
+    //! Close the zero copy mode and release all pending buffers
+    void Close();
+    //! Close the zero copy mode and move sends which are still waiting for the completion into the given linger
+    /*!
+        Should be called before the socket is closed. If some sends are still
+        waiting for the completion, the socket is shut down and its duplicated
+        descriptor lingers together with storage holders of these sends.
+
+        \param socket - Closing socket
+        \param linger - Zero copy linger
+        \return 'true' if the linger has got its first lingering socket, 'false' otherwise
+    */
+    bool Linger(asio::ip::tcp::socket& socket, ZeroCopyLinger& linger);
+
+    //! Send the given buffers with zero copy
+    /*!
+        The storage holder is kept until the kernel reports the completion
+        of the send. The method never blocks and returns
+        asio::error::would_block if the socket is not ready for writing.
+        If the kernel is out of the memory to pin the buffers, they are
+        sent with a normal copy.
+
+        \param socket - Socket to write into
+        \param buffers - Buffers sequence to send
+        \param holder - Storage holder of the buffers
+        \param ec - Error code
+        \return Count of written bytes
+    */
+    size_t Send(asio::ip::tcp::socket& socket, const std::vector<asio::const_buffer>& buffers, const std::shared_ptr<const void>& holder, asio::error_code& ec);
+
+    //! Read completions from the socket error queue and release completed buffers
+    /*!
+        \param socket - Socket to read completions from
+        \return Count of sends which are still waiting for the completion
+    */
+    size_t Complete(asio::ip::tcp::socket& socket);
+
+private:
+    // Send waiting for the kernel completion
+    struct Pending
+    {
+        uint32_t sequence;
+        std::shared_ptr<const void> holder;
+    };
+
+    size_t _threshold;
+    uint32_t _sequence;
+    bool _enabled;
+    std::deque<Pending> _pending;
+
+    //! Read completions from the socket error queue and release completed sends
+    /*!
+        \param descriptor - Socket descriptor
+        \param pending - Sends waiting for the completion
+        \return 'true' if the kernel has copied some of completed sends, 'false' otherwise
+    */
+    static bool Receive(int descriptor, std::deque<Pending>& pending);
+    //! Release pending sends in the given completed range
+    static void Release(std::deque<Pending>& pending, uint32_t first, uint32_t last);
+};
+
+//! Zero copy linger
+/*!
+    Zero copy linger keeps duplicated descriptors of closed sockets together
+    with storage holders of their sends which are still waiting for the kernel
+    completion. Each poll reads completions of all lingering sockets and
+    finally closes a socket when all its sends are completed. The kernel
+    completes sends when the data is acknowledged by the peer or when the
+    connection is reset or timed out.
+
+    Sockets which are still lingering when the linger is destroyed are closed
+    and their buffers are released.
+
+    Thread-safe.
+*/
+class ZeroCopyLinger
+{
+    friend class ZeroCopy;
+
+public:
+    ZeroCopyLinger() = default;
+    ZeroCopyLinger(const ZeroCopyLinger&) = delete;
+    ZeroCopyLinger(ZeroCopyLinger&&) = delete;
+    ~ZeroCopyLinger();
+
+    ZeroCopyLinger& operator=(const ZeroCopyLinger&) = delete;
+    ZeroCopyLinger& operator=(ZeroCopyLinger&&) = delete;
+
+    //! Get the count of lingering sockets
+    size_t size() const;
+
+    //! Read completions of all lingering sockets and close completed ones
+    /*!
+        \return Count of sockets which are still lingering
+    */
+    size_t Poll();
+
+private:
+    // Closed socket waiting for completions
+    struct Socket
+    {
+        int descriptor;
+        std::deque<ZeroCopy::Pending> pending;
+    };
+
+    mutable std::mutex _lock;
+    std::vector<Socket> _sockets;
+
+    //! Add the closed socket with its pending sends
+    /*!
+        \param descriptor - Duplicated socket descriptor
+        \param pending - Sends waiting for the completion
+        \return 'true' if it is the first lingering socket, 'false' otherwise
+    */
+    bool Add(int descriptor, std::deque<ZeroCopy::Pending>&& pending);
+};
+
+} // namespace Asio
+} // namespace CppServer
+
+#endif // CPPSERVER_ASIO_ZERO_COPY_H
@@ -0,0 +1,323 @@
+//
+// Created by Ivan Shynkarenka on 25.03.2017
+//
+
+#include "server/asio/service.h"
+#include "server/asio/ssl_client.h"
+#include "server/asio/ssl_server.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "server/asio/websocket_client.h"
+#include "server/asio/websocket_server.h"
+#include "threads/thread.h"
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#if defined(linux) || defined(__linux) || defined(__linux__)
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+std::atomic<uint64_t> total_connected(0);
+std::atomic<uint64_t> total_errors(0);
+std::atomic<uint64_t> total_received(0);
+
+class IdleTCPSession;
+
+class IdleTCPServer : public TCPServer<IdleTCPServer, IdleTCPSession>
+{
+public:
+    using TCPServer<IdleTCPServer, IdleTCPSession>::TCPServer;
+
+protected:
+    void onConnected(std::shared_ptr<IdleTCPSession>& session) override { ++total_connected; }
+    void onDisconnected(std::shared_ptr<IdleTCPSession>& session) override { --total_connected; }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class IdleTCPSession : public TCPSession<IdleTCPServer, IdleTCPSession>
+{
+public:
+    using TCPSession<IdleTCPServer, IdleTCPSession>::TCPSession;
+
+protected:
+    void onReceived(const void* buffer, size_t size) override { total_received += size; }
+};
+
+class IdleTCPClient : public TCPClient
+{
+public:
+    using TCPClient::TCPClient;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class IdleSSLSession;
+
+class IdleSSLServer : public SSLServer<IdleSSLServer, IdleSSLSession>
+{
+public:
+    using SSLServer<IdleSSLServer, IdleSSLSession>::SSLServer;
+
+protected:
+    void onConnected(std::shared_ptr<IdleSSLSession>& session) override { ++total_connected; }
+    void onDisconnected(std::shared_ptr<IdleSSLSession>& session) override { --total_connected; }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class IdleSSLSession : public SSLSession<IdleSSLServer, IdleSSLSession>
+{
+public:
+    using SSLSession<IdleSSLServer, IdleSSLSession>::SSLSession;
+
+protected:
+    void onReceived(const void* buffer, size_t size) override { total_received += size; }
+};
+
+class IdleSSLClient : public SSLClient
+{
+public:
+    using SSLClient::SSLClient;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class IdleWebSocketSession;
+
+class IdleWebSocketServer : public WebSocketServer<IdleWebSocketServer, IdleWebSocketSession>
+{
+public:
+    using WebSocketServer<IdleWebSocketServer, IdleWebSocketSession>::WebSocketServer;
+
+protected:
+    void onConnected(std::shared_ptr<IdleWebSocketSession>& session) override { ++total_connected; }
+    void onDisconnected(std::shared_ptr<IdleWebSocketSession>& session) override { --total_connected; }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class IdleWebSocketSession : public WebSocketSession<IdleWebSocketServer, IdleWebSocketSession>
+{
+public:
+    using WebSocketSession<IdleWebSocketServer, IdleWebSocketSession>::WebSocketSession;
+
+protected:
+    void onReceived(const WebSocketMessage& message) override { total_received += message->get_payload().size(); }
+};
+
+class IdleWebSocketClient : public WebSocketClient
+{
+public:
+    using WebSocketClient::WebSocketClient;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+uint64_t ResidentMemory()
+{
+#if defined(linux) || defined(__linux) || defined(__linux__)
+#if defined(__GLIBC__)
+    // Return freed memory of previous measurements to the OS
+    malloc_trim(0);
+#endif
+
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+struct MemoryResult
+{
+    uint64_t resident = 0;
+    uint64_t borrowed = 0;
+    uint64_t allocated = 0;
+    // Memory of idle connections after a burst of received data
+    uint64_t burst_resident = 0;
+    uint64_t burst_allocated = 0;
+};
+
+template <class TServer, class TClient>
+MemoryResult Measure(const std::shared_ptr<Service>& service, uint64_t resident, std::shared_ptr<TServer> server, const std::vector<std::shared_ptr<TClient>>& clients, size_t burst)
+{
+    MemoryResult result;
+
+    // Start the server
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    // Connect all clients
+    for (auto& client : clients)
+        client->Connect();
+    while (total_connected < clients.size())
+        CppCommon::Thread::Yield();
+
+    // Let all connections become idle
+    CppCommon::Thread::Sleep(1000);
+
+    result.resident = ResidentMemory() - resident;
+    result.borrowed = service->buffer_pool().borrowed();
+    result.allocated = service->buffer_pool().allocated();
+
+    // Send a burst of data from all clients at once
+    std::vector<uint8_t> data(burst, 0);
+    total_received = 0;
+    for (auto& client : clients)
+        client->Send(data.data(), data.size());
+    while (total_received < clients.size() * burst)
+        CppCommon::Thread::Yield();
+
+    // Let all connections become idle again
+    CppCommon::Thread::Sleep(1000);
+
+    result.burst_resident = ResidentMemory() - resident;
+    result.burst_allocated = service->buffer_pool().allocated();
+
+    // Disconnect all clients
+    for (auto& client : clients)
+        client->Disconnect();
+    while (total_connected > 0)
+        CppCommon::Thread::Yield();
+
+    // Stop the server
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    // Stop Asio service
+    service->Stop();
+    while (service->IsStarted())
+        CppCommon::Thread::Yield();
+
+    return result;
+}
+
+void Report(const std::string& name, const MemoryResult& result, int clients_count)
+{
+    std::cout << name << " resident memory per connection: " << result.resident / clients_count << " bytes" << std::endl;
+    std::cout << name << " receive buffers per connection: " << result.borrowed / clients_count << " bytes" << std::endl;
+    std::cout << name << " buffer pool memory per connection: " << result.allocated / clients_count << " bytes" << std::endl;
+    std::cout << name << " resident memory per connection after burst: " << result.burst_resident / clients_count << " bytes" << std::endl;
+    std::cout << name << " buffer pool memory per connection after burst: " << result.burst_allocated / clients_count << " bytes" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port (TCP, SSL and WebSocket servers use three subsequent ports). Default: %default");
+    parser.add_option("-c", "--clients").action("store").type("int").set_default(1000).help("Count of idle connections. Default: %default");
+    parser.add_option("-b", "--burst").action("store").type("int").set_default(65536).help("Burst size sent by each connection. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Idle connections parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    int clients_count = options.get("clients");
+    int burst = options.get("burst");
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "Idle connections: " << clients_count << std::endl;
+    std::cout << "Burst size: " << burst << std::endl;
+
+    // Create and prepare SSL contexts
+    auto server_context = std::make_shared<asio::ssl::context>(asio::ssl::context::sslv23);
+    server_context->set_options(asio::ssl::context::default_workarounds | asio::ssl::context::no_sslv2 | asio::ssl::context::single_dh_use);
+    server_context->set_password_callback([](std::size_t max_length, asio::ssl::context::password_purpose purpose) -> std::string { return "qwerty"; });
+    server_context->use_certificate_chain_file("../tools/certificates/server.pem");
+    server_context->use_private_key_file("../tools/certificates/server.pem", asio::ssl::context::pem);
+    server_context->use_tmp_dh_file("../tools/certificates/dh4096.pem");
+    auto client_context = std::make_shared<asio::ssl::context>(asio::ssl::context::sslv23);
+    client_context->set_verify_mode(asio::ssl::verify_peer);
+    client_context->load_verify_file("../tools/certificates/ca.pem");
+
+    std::cout << std::endl;
+
+    // Measure idle TCP connections with regular and idle receive modes
+    MemoryResult tcp_results[2];
+    for (int idle = 0; idle < 2; ++idle)
+    {
+        std::cout << "TCP " << (idle ? "idle receive" : "regular receive") << " connections...";
+        uint64_t resident = ResidentMemory();
+        auto service = std::make_shared<Service>();
+        service->Start();
+        auto server = std::make_shared<IdleTCPServer>(service, InternetProtocol::IPv4, port);
+        server->SetupIdleReceive(idle != 0);
+        std::vector<std::shared_ptr<IdleTCPClient>> clients;
+        for (int i = 0; i < clients_count; ++i)
+        {
+            auto client = std::make_shared<IdleTCPClient>(service, address, port);
+            client->SetupIdleReceive(idle != 0);
+            clients.emplace_back(client);
+        }
+        tcp_results[idle] = Measure(service, resident, server, clients, burst);
+        std::cout << "Done!" << std::endl;
+    }
+
+    // Measure idle SSL connections
+    std::cout << "SSL connections...";
+    MemoryResult ssl_result;
+    {
+        uint64_t resident = ResidentMemory();
+        auto service = std::make_shared<Service>();
+        service->Start();
+        auto server = std::make_shared<IdleSSLServer>(service, server_context, InternetProtocol::IPv4, port + 1);
+        std::vector<std::shared_ptr<IdleSSLClient>> clients;
+        for (int i = 0; i < clients_count; ++i)
+            clients.emplace_back(std::make_shared<IdleSSLClient>(service, client_context, address, port + 1));
+        ssl_result = Measure(service, resident, server, clients, burst);
+    }
+    std::cout << "Done!" << std::endl;
+
+    // Measure idle WebSocket connections
+    std::cout << "WebSocket connections...";
+    MemoryResult websocket_result;
+    {
+        uint64_t resident = ResidentMemory();
+        auto service = std::make_shared<Service>();
+        service->Start();
+        std::string uri = "ws://" + address + ":" + std::to_string(port + 2);
+        auto server = std::make_shared<IdleWebSocketServer>(service, InternetProtocol::IPv4, port + 2);
+        std::vector<std::shared_ptr<IdleWebSocketClient>> clients;
+        for (int i = 0; i < clients_count; ++i)
+            clients.emplace_back(std::make_shared<IdleWebSocketClient>(service, uri));
+        websocket_result = Measure(service, resident, server, clients, burst);
+    }
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    std::cout << "Memory is measured for both client and server sides of each connection" << std::endl;
+    Report("TCP", tcp_results[0], clients_count);
+    Report("TCP idle receive", tcp_results[1], clients_count);
+    Report("SSL", ssl_result, clients_count);
+    Report("WebSocket", websocket_result, clients_count);
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
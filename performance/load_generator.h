@@ -0,0 +1,336 @@
+/*!
+    \file load_generator.h
+    \brief Load generator harness for performance clients
+    \author Ivan Shynkarenka
+    \date 03.04.2017
+    \copyright MIT License
+*/
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "time/timestamp.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+//! Latency histogram
+/*!
+    HDR-style histogram of latencies in nanoseconds. Values are recorded into
+    logarithmic buckets each split into linear sub-buckets, so any value is
+    recorded with at most 0.1% relative error (3 significant digits) and
+    the histogram size does not depend on the recorded range.
+
+    Not thread-safe. Each working thread should record into its own histogram
+    and all of them should be merged for the report.
+*/
+class LatencyHistogram
+{
+public:
+    //! Count of sub-bucket bits (2048 sub-buckets for 3 significant digits)
+    static const int SUB_BUCKET_BITS = 11;
+    static const uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+    static const uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+
+    LatencyHistogram()
+        : _counts((64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_HALF + SUB_BUCKET_HALF, 0),
+          _count(0), _sum(0), _min(std::numeric_limits<uint64_t>::max()), _max(0)
+    {}
+
+    //! Get the count of recorded values
+    uint64_t count() const noexcept { return _count; }
+    //! Get the minimal recorded value
+    uint64_t min() const noexcept { return (_count > 0) ? _min : 0; }
+    //! Get the maximal recorded value
+    uint64_t max() const noexcept { return _max; }
+    //! Get the mean of recorded values
+    uint64_t mean() const noexcept { return (_count > 0) ? (_sum / _count) : 0; }
+
+    //! Record the given value
+    void Record(uint64_t value)
+    {
+        ++_counts[Index(value)];
+        ++_count;
+        _sum += value;
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+    }
+
+    //! Merge the given histogram into this one
+    void Merge(const LatencyHistogram& histogram)
+    {
+        for (size_t i = 0; i < _counts.size(); ++i)
+            _counts[i] += histogram._counts[i];
+        _count += histogram._count;
+        _sum += histogram._sum;
+        _min = std::min(_min, histogram._min);
+        _max = std::max(_max, histogram._max);
+    }
+
+    //! Get the value at the given percentile
+    /*!
+        \param percentile - Percentile in range [0, 100]
+        \return The highest value equivalent to the recorded value at the given percentile
+    */
+    uint64_t Percentile(double percentile) const
+    {
+        if (_count == 0)
+            return 0;
+
+        uint64_t target = (uint64_t)std::ceil(percentile * _count / 100.0);
+        target = std::max(target, (uint64_t)1);
+
+        uint64_t total = 0;
+        for (size_t i = 0; i < _counts.size(); ++i)
+        {
+            total += _counts[i];
+            if (total >= target)
+                return std::min(HighestEquivalent(i), _max);
+        }
+        return _max;
+    }
+
+    //! Report latency percentiles into the given stream
+    void Report(std::ostream& stream) const
+    {
+        stream << "Latency samples: " << count() << std::endl;
+        stream << "Latency min: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(min()) << std::endl;
+        stream << "Latency mean: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(mean()) << std::endl;
+        stream << "Latency p50: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(Percentile(50.0)) << std::endl;
+        stream << "Latency p99: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(Percentile(99.0)) << std::endl;
+        stream << "Latency p99.9: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(Percentile(99.9)) << std::endl;
+        stream << "Latency max: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(max()) << std::endl;
+    }
+
+private:
+    std::vector<uint64_t> _counts;
+    uint64_t _count;
+    uint64_t _sum;
+    uint64_t _min;
+    uint64_t _max;
+
+    // Values below the sub-bucket count are recorded exactly, larger values keep their top sub-bucket bits
+    static size_t Index(uint64_t value) noexcept
+    {
+        int shift = 0;
+        while ((value >> shift) >= SUB_BUCKET_COUNT)
+            ++shift;
+        return (size_t)(shift * SUB_BUCKET_HALF + (value >> shift));
+    }
+
+    static uint64_t HighestEquivalent(size_t index) noexcept
+    {
+        int shift = (index < SUB_BUCKET_COUNT) ? 0 : (int)(index / SUB_BUCKET_HALF) - 1;
+        uint64_t lowest = (index - shift * SUB_BUCKET_HALF) << shift;
+        return lowest + (1ull << shift) - 1;
+    }
+};
+
+//! Message stamp
+/*!
+    Echo messages carry the timestamp of their intended send time in the
+    first bytes, so the latency is measured without any per-message state
+    on the client side and lost or reordered datagrams are handled as well.
+*/
+struct MessageStamp
+{
+    //! Minimal message size to keep the stamp
+    static const size_t SIZE = sizeof(uint64_t);
+
+    //! Write the given timestamp into the message buffer
+    static void Write(void* buffer, uint64_t timestamp) noexcept { std::memcpy(buffer, &timestamp, SIZE); }
+    //! Read the timestamp from the message buffer
+    static uint64_t Read(const void* buffer) noexcept { uint64_t timestamp; std::memcpy(&timestamp, buffer, SIZE); return timestamp; }
+};
+
+//! Message stream
+/*!
+    Stream protocols (TCP, SSL) could receive echoed messages split or
+    coalesced in any way. Message stream splits received data into messages
+    of the fixed size and extracts their stamps.
+
+    Not thread-safe.
+*/
+class MessageStream
+{
+public:
+    explicit MessageStream(size_t size) : _size(size), _offset(0) {}
+
+    //! Receive the stream data and call the given handler with stamps of all completed messages
+    template <typename THandler>
+    void Receive(const void* buffer, size_t size, THandler&& handler)
+    {
+        const uint8_t* data = (const uint8_t*)buffer;
+        while (size > 0)
+        {
+            // Collect the stamp or skip the message payload
+            size_t chunk = (_offset < MessageStamp::SIZE) ? std::min(MessageStamp::SIZE - _offset, size) : std::min(_size - _offset, size);
+            if (_offset < MessageStamp::SIZE)
+                std::memcpy(_stamp + _offset, data, chunk);
+            data += chunk;
+            size -= chunk;
+            _offset += chunk;
+
+            // Completed message
+            if (_offset == _size)
+            {
+                _offset = 0;
+                handler(MessageStamp::Read(_stamp));
+            }
+        }
+    }
+
+private:
+    size_t _size;
+    size_t _offset;
+    uint8_t _stamp[MessageStamp::SIZE];
+};
+
+//! Load generator
+/*!
+    Load generator drives a single performance client in one of two modes:
+
+    Closed loop mode (rate is 0) sends the next message only when the previous
+    one is echoed back, so the measured latency is the round-trip time of a
+    single message.
+
+    Open loop mode sends messages at the given target rate regardless of
+    received responses. Each message is stamped with its intended send time
+    from the fixed schedule, so any delay of the client or the server is
+    accounted in the latency of all messages scheduled during it instead of
+    being hidden by the coordinated omission of the closed loop.
+
+    Latencies are recorded into the histogram of the client Asio service.
+    All load generator methods should be called from the client Asio service
+    with a single working thread.
+*/
+class LoadGenerator
+{
+public:
+    //! Drain timeout to wait for lost responses after the last message sent
+    static const uint64_t DRAIN_TIMEOUT = 1000000000;
+
+    //! Initialize load generator
+    /*!
+        \param service - Asio service of the client
+        \param histogram - Latency histogram of the client Asio service
+        \param rate - Target rate of the client in messages per second (0 for the closed loop mode)
+        \param messages - Count of messages to send
+    */
+    LoadGenerator(std::shared_ptr<CppServer::Asio::Service> service, LatencyHistogram& histogram, double rate, uint64_t messages)
+        : _timer(*service->service()),
+          _histogram(histogram),
+          _interval((rate > 0) ? (1000000000.0 / rate) : 0.0),
+          _messages(messages),
+          _sent(0),
+          _received(0),
+          _start(0),
+          _finished(false)
+    {}
+
+    //! Get the count of sent messages
+    uint64_t sent() const noexcept { return _sent; }
+    //! Get the count of received messages
+    uint64_t received() const noexcept { return _received; }
+
+    //! Start sending messages
+    /*!
+        \param send - Send handler called with the stamp of each message
+        \param finish - Finish handler called when all messages are received or the drain timeout expired
+    */
+    void Start(std::function<void(uint64_t)> send, std::function<void()> finish)
+    {
+        _send = send;
+        _finish = finish;
+        _sent = 0;
+        _received = 0;
+        _finished = false;
+        _start = CppCommon::Timestamp::nano();
+
+        if (_messages == 0)
+            Finish();
+        else if (_interval > 0)
+            Schedule();
+        else
+            Send(_start);
+    }
+
+    //! Stop sending messages
+    void Stop()
+    {
+        asio::error_code ec;
+        _timer.cancel(ec);
+    }
+
+    //! Handle the echoed message with the given stamp
+    void Received(uint64_t stamp)
+    {
+        uint64_t timestamp = CppCommon::Timestamp::nano();
+        _histogram.Record((timestamp > stamp) ? (timestamp - stamp) : 0);
+        ++_received;
+
+        if (_received >= _messages)
+            Finish();
+        else if ((_interval == 0) && (_sent < _messages))
+            Send(timestamp);
+    }
+
+private:
+    asio::steady_timer _timer;
+    LatencyHistogram& _histogram;
+    double _interval;
+    uint64_t _messages;
+    uint64_t _sent;
+    uint64_t _received;
+    uint64_t _start;
+    bool _finished;
+    std::function<void(uint64_t)> _send;
+    std::function<void()> _finish;
+
+    uint64_t Intended(uint64_t index) const noexcept { return _start + (uint64_t)(index * _interval); }
+
+    void Send(uint64_t stamp)
+    {
+        ++_sent;
+        _send(stamp);
+    }
+
+    void Schedule()
+    {
+        // Send all messages which are due according to the schedule
+        uint64_t timestamp = CppCommon::Timestamp::nano();
+        while ((_sent < _messages) && (Intended(_sent) <= timestamp))
+            Send(Intended(_sent));
+
+        // Wait for the next message or for the drain timeout
+        uint64_t next = (_sent < _messages) ? Intended(_sent) : (timestamp + DRAIN_TIMEOUT);
+        _timer.expires_from_now(std::chrono::nanoseconds(next - timestamp));
+        _timer.async_wait([this](const asio::error_code& ec)
+        {
+            if (ec || _finished)
+                return;
+
+            if (_sent < _messages)
+                Schedule();
+            else
+                Finish();
+        });
+    }
+
+    void Finish()
+    {
+        if (_finished)
+            return;
+
+        _finished = true;
+        Stop();
+        if (_finish)
+            _finish();
+    }
+};
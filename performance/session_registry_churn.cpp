@@ -0,0 +1,171 @@
+//
+// Created by Ivan Shynkarenka on 23.03.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/session_registry.h"
+#include "system/uuid.h"
+#include "time/timestamp.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+struct DummySession
+{
+    CppCommon::UUID id;
+    uint64_t key;
+    uint64_t bytes;
+
+    DummySession(uint64_t k) : id(CppCommon::UUID::Generate()), key(k), bytes(0) {}
+};
+
+struct ChurnResult
+{
+    uint64_t register_time = 0;
+    uint64_t find_time = 0;
+    uint64_t iterate_time = 0;
+    uint64_t unregister_time = 0;
+    uint64_t checksum = 0;
+};
+
+ChurnResult ChurnMap(const std::vector<std::shared_ptr<DummySession>>& sessions, const std::vector<size_t>& order, int rounds)
+{
+    ChurnResult result;
+    std::map<CppCommon::UUID, std::shared_ptr<DummySession>> registry;
+
+    for (int round = 0; round < rounds; ++round)
+    {
+        uint64_t timestamp = CppCommon::Timestamp::nano();
+        for (auto& session : sessions)
+            registry.insert(std::make_pair(session->id, session));
+        result.register_time += CppCommon::Timestamp::nano() - timestamp;
+
+        timestamp = CppCommon::Timestamp::nano();
+        for (auto index : order)
+        {
+            auto it = registry.find(sessions[index]->id);
+            if (it != registry.end())
+                result.checksum += it->second->key;
+        }
+        result.find_time += CppCommon::Timestamp::nano() - timestamp;
+
+        timestamp = CppCommon::Timestamp::nano();
+        for (auto& session : registry)
+            ++session.second->bytes;
+        result.iterate_time += CppCommon::Timestamp::nano() - timestamp;
+
+        timestamp = CppCommon::Timestamp::nano();
+        for (auto index : order)
+            registry.erase(sessions[index]->id);
+        result.unregister_time += CppCommon::Timestamp::nano() - timestamp;
+    }
+
+    return result;
+}
+
+ChurnResult ChurnRegistry(const std::vector<std::shared_ptr<DummySession>>& sessions, const std::vector<size_t>& order, int rounds)
+{
+    ChurnResult result;
+    SessionRegistry<DummySession> registry;
+
+    for (int round = 0; round < rounds; ++round)
+    {
+        uint64_t timestamp = CppCommon::Timestamp::nano();
+        for (auto& session : sessions)
+            registry.Insert(session->key, session);
+        result.register_time += CppCommon::Timestamp::nano() - timestamp;
+
+        timestamp = CppCommon::Timestamp::nano();
+        for (auto index : order)
+        {
+            auto session = registry.Find(sessions[index]->key);
+            if (session)
+                result.checksum += session->key;
+        }
+        result.find_time += CppCommon::Timestamp::nano() - timestamp;
+
+        timestamp = CppCommon::Timestamp::nano();
+        for (auto& session : registry)
+            ++session->bytes;
+        result.iterate_time += CppCommon::Timestamp::nano() - timestamp;
+
+        timestamp = CppCommon::Timestamp::nano();
+        for (auto index : order)
+            registry.Erase(sessions[index]->key);
+        result.unregister_time += CppCommon::Timestamp::nano() - timestamp;
+    }
+
+    return result;
+}
+
+void Report(const std::string& name, const ChurnResult& result, uint64_t operations)
+{
+    std::cout << name << " register: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(result.register_time) << " (" << operations * 1000000000 / std::max(result.register_time, (uint64_t)1) << " ops/s)" << std::endl;
+    std::cout << name << " find: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(result.find_time) << " (" << operations * 1000000000 / std::max(result.find_time, (uint64_t)1) << " ops/s)" << std::endl;
+    std::cout << name << " iterate: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(result.iterate_time) << " (" << operations * 1000000000 / std::max(result.iterate_time, (uint64_t)1) << " ops/s)" << std::endl;
+    std::cout << name << " unregister: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(result.unregister_time) << " (" << operations * 1000000000 / std::max(result.unregister_time, (uint64_t)1) << " ops/s)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-s", "--sessions").action("store").type("int").set_default(100000).help("Count of registered sessions. Default: %default");
+    parser.add_option("-r", "--rounds").action("store").type("int").set_default(10).help("Count of register/unregister rounds. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Churn parameters
+    int sessions_count = options.get("sessions");
+    int rounds = options.get("rounds");
+
+    std::cout << "Sessions: " << sessions_count << std::endl;
+    std::cout << "Rounds: " << rounds << std::endl;
+
+    std::cout << std::endl;
+
+    // Prepare dummy sessions and a random order of lookups and unregistrations
+    std::vector<std::shared_ptr<DummySession>> sessions;
+    std::vector<size_t> order;
+    for (int i = 0; i < sessions_count; ++i)
+    {
+        sessions.push_back(std::make_shared<DummySession>(i + 1));
+        order.push_back(i);
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(0));
+
+    std::cout << "UUID map churn...";
+    ChurnResult map_result = ChurnMap(sessions, order, rounds);
+    std::cout << "Done!" << std::endl;
+
+    std::cout << "Session registry churn...";
+    ChurnResult registry_result = ChurnRegistry(sessions, order, rounds);
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    uint64_t operations = (uint64_t)sessions_count * rounds;
+
+    std::cout << "Total operations: " << operations << std::endl;
+    Report("UUID map", map_result, operations);
+    Report("Session registry", registry_result, operations);
+    std::cout << "Checksum: " << ((map_result.checksum == registry_result.checksum) ? "OK" : "FAILED") << std::endl;
+
+    return 0;
+}
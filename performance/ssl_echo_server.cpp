@@ -48,6 +48,16 @@ int main(int argc, char** argv)
 
     parser.add_option("-h", "--help").help("Show help");
     parser.add_option("-p", "--port").action("store").type("int").set_default(3333).help("Server port. Default: %default");
+    parser.add_option("--nodelay").action("store").type("int").set_default(-1).help("Disable the Nagle algorithm (TCP_NODELAY, 0 or 1). Default: system default");
+    parser.add_option("--sndbuf").action("store").type("int").set_default(0).help("Socket send buffer size (SO_SNDBUF). Default: system default");
+    parser.add_option("--rcvbuf").action("store").type("int").set_default(0).help("Socket receive buffer size (SO_RCVBUF). Default: system default");
+    parser.add_option("--quickack").action("store").type("int").set_default(-1).help("Enable quick acknowledgements (TCP_QUICKACK, 0 or 1). Default: system default");
+    parser.add_option("--lowat").action("store").type("int").set_default(0).help("Limit of unsent bytes in the socket send buffer (TCP_NOTSENT_LOWAT). Default: system default");
+    parser.add_option("--keepalive").action("store").type("int").set_default(-1).help("Enable TCP keep-alive (SO_KEEPALIVE, 0 or 1). Default: system default");
+    parser.add_option("--keepidle").action("store").type("int").set_default(0).help("Keep-alive idle time in seconds (TCP_KEEPIDLE). Default: system default");
+    parser.add_option("--keepintvl").action("store").type("int").set_default(0).help("Keep-alive probes interval in seconds (TCP_KEEPINTVL). Default: system default");
+    parser.add_option("--keepcnt").action("store").type("int").set_default(0).help("Keep-alive probes count (TCP_KEEPCNT). Default: system default");
+    parser.add_option("--congestion").set_default("").help("Congestion control algorithm (TCP_CONGESTION). Default: system default");
 
     optparse::Values options = parser.parse_args(argc, argv);
 
@@ -61,7 +71,21 @@ int main(int argc, char** argv)
     // Server port
     int port = options.get("port");
 
+    // Socket options
+    SocketOptions socket_options;
+    socket_options.no_delay = options.get("nodelay");
+    socket_options.send_buffer_size = options.get("sndbuf");
+    socket_options.receive_buffer_size = options.get("rcvbuf");
+    socket_options.quick_ack = options.get("quickack");
+    socket_options.not_sent_lowat = options.get("lowat");
+    socket_options.keep_alive = options.get("keepalive");
+    socket_options.keep_alive_idle = options.get("keepidle");
+    socket_options.keep_alive_interval = options.get("keepintvl");
+    socket_options.keep_alive_count = options.get("keepcnt");
+    socket_options.congestion_control = std::string(options.get("congestion"));
+
     std::cout << "Server port: " << port << std::endl;
+    std::cout << "Socket options: " << socket_options << std::endl;
 
     // Create a new Asio service
     auto service = std::make_shared<Service>();
@@ -81,6 +105,7 @@ int main(int argc, char** argv)
 
     // Create a new echo server
     auto server = std::make_shared<EchoServer>(service, context, InternetProtocol::IPv4, port);
+    server->SetupSocketOptions(socket_options);
 
     // Start the server
     std::cout << "Server starting...";
@@ -0,0 +1,199 @@
+//
+// Created by Ivan Shynkarenka on 20.03.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "system/cpu.h"
+#include "threads/thread.h"
+#include "time/timestamp.h"
+
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+std::atomic<uint64_t> total_accepts(0);
+std::atomic<uint64_t> total_errors(0);
+
+class StormSession;
+
+class StormServer : public TCPServer<StormServer, StormSession>
+{
+public:
+    using TCPServer<StormServer, StormSession>::TCPServer;
+
+protected:
+    void onConnected(std::shared_ptr<StormSession>& session) override
+    {
+        ++total_accepts;
+    }
+
+    void onError(int error, const std::string& category, const std::string& message) override
+    {
+        std::cout << "Server caught an error with code " << error << " and category '" << category << "': " << message << std::endl;
+        ++total_errors;
+    }
+};
+
+class StormSession : public TCPSession<StormServer, StormSession>
+{
+public:
+    using TCPSession<StormServer, StormSession>::TCPSession;
+};
+
+class StormClient : public TCPClient
+{
+public:
+    using TCPClient::TCPClient;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override
+    {
+        std::cout << "Client caught an error with code " << error << " and category '" << category << "': " << message << std::endl;
+        ++total_errors;
+    }
+};
+
+uint64_t Storm(const std::vector<std::shared_ptr<Service>>& server_services, const std::vector<std::shared_ptr<Service>>& client_services, const std::string& address, int port, ShardPolicy policy, int clients_count, int rounds_count)
+{
+    // Create and start the storm server
+    auto server = std::make_shared<StormServer>(server_services, InternetProtocol::IPv4, port, policy);
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    // Create storm clients
+    std::vector<std::shared_ptr<StormClient>> clients;
+    for (int i = 0; i < clients_count; ++i)
+    {
+        auto client = std::make_shared<StormClient>(client_services[i % client_services.size()], address, port);
+        clients.emplace_back(client);
+    }
+
+    total_accepts = 0;
+
+    uint64_t timestamp_start = CppCommon::Timestamp::nano();
+
+    for (int round = 0; round < rounds_count; ++round)
+    {
+        // Connect all clients at once
+        for (auto& client : clients)
+            client->Connect();
+
+        // Wait for all connections accepted
+        while (total_accepts < (uint64_t)((round + 1) * clients_count))
+            CppCommon::Thread::Yield();
+
+        // Disconnect all clients
+        for (auto& client : clients)
+        {
+            while (!client->IsConnected())
+                CppCommon::Thread::Yield();
+            client->Disconnect();
+        }
+        for (auto& client : clients)
+            while (client->IsConnected())
+                CppCommon::Thread::Yield();
+        while (server->current_sessions() > 0)
+            CppCommon::Thread::Yield();
+    }
+
+    uint64_t timestamp_stop = CppCommon::Timestamp::nano();
+
+    // Stop the storm server
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    return timestamp_stop - timestamp_start;
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port. Default: %default");
+    parser.add_option("-t", "--threads").action("store").type("int").set_default(CppCommon::CPU::LogicalCores()).help("Count of server listeners / working threads. Default: %default");
+    parser.add_option("-c", "--clients").action("store").type("int").set_default(1000).help("Count of simultaneously connecting clients. Default: %default");
+    parser.add_option("-r", "--rounds").action("store").type("int").set_default(10).help("Count of connection storm rounds. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Storm parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    int threads_count = options.get("threads");
+    int clients_count = options.get("clients");
+    int rounds_count = options.get("rounds");
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "Working threads: " << threads_count << std::endl;
+    std::cout << "Connecting clients: " << clients_count << std::endl;
+    std::cout << "Storm rounds: " << rounds_count << std::endl;
+
+    // Create Asio services for the server shards and clients
+    std::vector<std::shared_ptr<Service>> server_services;
+    std::vector<std::shared_ptr<Service>> client_services;
+    for (int i = 0; i < threads_count; ++i)
+    {
+        server_services.emplace_back(std::make_shared<Service>());
+        client_services.emplace_back(std::make_shared<Service>());
+    }
+
+    // Start Asio services
+    std::cout << "Asio services starting...";
+    for (auto& service : server_services)
+        service->Start();
+    for (auto& service : client_services)
+        service->Start();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    uint64_t total_connections = (uint64_t)clients_count * rounds_count;
+
+    // Accept all connections with a single listener
+    std::cout << "Single listener storm...";
+    uint64_t single_time = Storm(server_services, client_services, address, port, ShardPolicy::RoundRobin, clients_count, rounds_count);
+    std::cout << "Done!" << std::endl;
+
+    // Accept all connections with SO_REUSEPORT listeners in each shard
+    std::cout << "SO_REUSEPORT listeners storm...";
+    uint64_t reuse_port_time = Storm(server_services, client_services, address, port, ShardPolicy::ReusePort, clients_count, rounds_count);
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio services
+    std::cout << "Asio services stopping...";
+    for (auto& service : client_services)
+        service->Stop();
+    for (auto& service : server_services)
+        service->Stop();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    std::cout << "Total connections: " << total_connections << std::endl;
+    std::cout << "Single listener time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(single_time) << std::endl;
+    std::cout << "Single listener throughput: " << total_connections * 1000000000 / single_time << " accepts per second" << std::endl;
+    std::cout << threads_count << " SO_REUSEPORT listeners time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(reuse_port_time) << std::endl;
+    std::cout << threads_count << " SO_REUSEPORT listeners throughput: " << total_connections * 1000000000 / reuse_port_time << " accepts per second" << std::endl;
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+//
+// Created by Ivan Shynkarenka on 06.04.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "threads/thread.h"
+#include "time/timestamp.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+std::vector<uint8_t> message;
+
+std::atomic<uint64_t> server_allocations(0);
+std::atomic<uint64_t> client_allocations(0);
+std::atomic<uint64_t> total_messages(0);
+std::atomic<uint64_t> total_errors(0);
+
+// Allocation counter of the current thread
+thread_local std::atomic<uint64_t>* allocations = nullptr;
+
+// Count heap allocations of Asio service threads
+void* operator new(size_t size)
+{
+    if (allocations != nullptr)
+        ++(*allocations);
+    void* result = std::malloc((size > 0) ? size : 1);
+    if (result == nullptr)
+        throw std::bad_alloc();
+    return result;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t size) noexcept { std::free(ptr); }
+
+class CountingService : public Service
+{
+public:
+    explicit CountingService(std::atomic<uint64_t>& counter) : _counter(counter) {}
+
+protected:
+    void onThreadInitialize() override { allocations = &_counter; }
+    void onThreadCleanup() override { allocations = nullptr; }
+
+private:
+    std::atomic<uint64_t>& _counter;
+};
+
+class EchoSession;
+
+class EchoServer : public TCPServer<EchoServer, EchoSession>
+{
+public:
+    using TCPServer<EchoServer, EchoSession>::TCPServer;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class EchoSession : public TCPSession<EchoServer, EchoSession>
+{
+public:
+    using TCPSession<EchoServer, EchoSession>::TCPSession;
+
+protected:
+    void onReceived(const void* buffer, size_t size) override { Send(buffer, size); }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class EchoClient : public TCPClient
+{
+public:
+    explicit EchoClient(std::shared_ptr<Service> service, const std::string& address, int port)
+        : TCPClient(service, address, port),
+          _received(0)
+    {
+    }
+
+protected:
+    void onConnected() override
+    {
+        _received = 0;
+        Send(message.data(), message.size());
+    }
+
+    void onReceived(const void* buffer, size_t size) override
+    {
+        // Send the next message when the whole message is echoed back
+        _received += size;
+        while (_received >= message.size())
+        {
+            _received -= message.size();
+            ++total_messages;
+            Send(message.data(), message.size());
+        }
+    }
+
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+
+private:
+    size_t _received;
+};
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port. Default: %default");
+    parser.add_option("-c", "--clients").action("store").type("int").set_default(10).help("Count of working clients. Default: %default");
+    parser.add_option("-s", "--size").action("store").type("int").set_default(32).help("Single message size. Default: %default");
+    parser.add_option("-w", "--warmup").action("store").type("int").set_default(1).help("Warmup time in seconds. Default: %default");
+    parser.add_option("-z", "--seconds").action("store").type("int").set_default(5).help("Measurement time in seconds. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Echo parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    int clients_count = options.get("clients");
+    int size = options.get("size");
+    int warmup = options.get("warmup");
+    int seconds = options.get("seconds");
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "Working clients: " << clients_count << std::endl;
+    std::cout << "Message size: " << size << std::endl;
+    std::cout << "Warmup time: " << warmup << std::endl;
+    std::cout << "Measurement time: " << seconds << std::endl;
+
+    // Prepare a message to send
+    message.resize(size, 0);
+
+    // Create and start Asio services
+    std::cout << "Asio services starting...";
+    auto server_service = std::make_shared<CountingService>(server_allocations);
+    auto client_service = std::make_shared<CountingService>(client_allocations);
+    server_service->Start();
+    client_service->Start();
+    std::cout << "Done!" << std::endl;
+
+    // Create and start the echo server
+    std::cout << "Server starting...";
+    auto server = std::make_shared<EchoServer>(server_service, InternetProtocol::IPv4, port);
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Create and connect echo clients
+    std::cout << "Clients connecting...";
+    std::vector<std::shared_ptr<EchoClient>> clients;
+    for (int i = 0; i < clients_count; ++i)
+    {
+        auto client = std::make_shared<EchoClient>(client_service, address, port);
+        client->Connect();
+        clients.emplace_back(client);
+    }
+    for (auto& client : clients)
+        while (!client->IsConnected())
+            CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Warm up receive buffers, send queues and handler storages
+    std::cout << "Warming up...";
+    CppCommon::Thread::Sleep(warmup * 1000);
+    std::cout << "Done!" << std::endl;
+
+    // Measure steady state echo traffic
+    std::cout << "Measuring...";
+    uint64_t server_allocations_start = server_allocations;
+    uint64_t client_allocations_start = client_allocations;
+    uint64_t messages_start = total_messages;
+    uint64_t timestamp_start = CppCommon::Timestamp::nano();
+    CppCommon::Thread::Sleep(seconds * 1000);
+    uint64_t timestamp_stop = CppCommon::Timestamp::nano();
+    uint64_t messages = total_messages - messages_start;
+    uint64_t server_total = server_allocations - server_allocations_start;
+    uint64_t client_total = client_allocations - client_allocations_start;
+    std::cout << "Done!" << std::endl;
+
+    // Disconnect echo clients
+    std::cout << "Clients disconnecting...";
+    for (auto& client : clients)
+        client->Disconnect();
+    for (auto& client : clients)
+        while (client->IsConnected())
+            CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Stop the echo server
+    std::cout << "Server stopping...";
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio services
+    std::cout << "Asio services stopping...";
+    client_service->Stop();
+    server_service->Stop();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    std::cout << "Total time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(timestamp_stop - timestamp_start) << std::endl;
+    std::cout << "Total messages: " << messages << std::endl;
+    std::cout << "Server allocations: " << server_total << std::endl;
+    std::cout << "Server allocations per message: " << ((messages > 0) ? ((double)server_total / messages) : 0.0) << std::endl;
+    std::cout << "Client allocations: " << client_total << std::endl;
+    std::cout << "Client allocations per message: " << ((messages > 0) ? ((double)client_total / messages) : 0.0) << std::endl;
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
@@ -2,6 +2,8 @@
 // Created by Ivan Shynkarenka on 15.03.2017
 //
 
+#include "load_generator.h"
+
 #include "benchmark/reporter_console.h"
 #include "server/asio/service.h"
 #include "server/asio/tcp_client.h"
@@ -9,6 +11,7 @@
 #include "threads/thread.h"
 #include "time/timestamp.h"
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <vector>
@@ -29,16 +32,24 @@ std::atomic<uint64_t> total_messages(0);
 class EchoClient : public TCPClient
 {
 public:
-    explicit EchoClient(std::shared_ptr<Service> service, const std::string& address, int port, int messages)
-        : TCPClient(service, address, port)
+    explicit EchoClient(std::shared_ptr<Service> service, LatencyHistogram& histogram, const std::string& address, int port, double rate, int messages)
+        : TCPClient(service, address, port),
+          _generator(service, histogram, rate, messages),
+          _stream(message.size()),
+          _message(message)
     {
-        _messages = messages;
     }
 
 protected:
     void onConnected() override
     {
-        SendMessage();
+        _stream = MessageStream(_message.size());
+        _generator.Start([this](uint64_t stamp) { SendMessage(stamp); }, [this]() { Disconnect(); });
+    }
+
+    void onDisconnected() override
+    {
+        _generator.Stop();
     }
 
     void onReceived(const void* buffer, size_t size) override
@@ -46,7 +57,7 @@ protected:
         timestamp_stop = CppCommon::Timestamp::nano();
         total_bytes += size;
 
-        SendMessage();
+        _stream.Receive(buffer, size, [this](uint64_t stamp) { _generator.Received(stamp); });
     }
 
     void onError(int error, const std::string& category, const std::string& message) override
@@ -56,14 +67,14 @@ protected:
     }
 
 private:
-    int _messages;
+    LoadGenerator _generator;
+    MessageStream _stream;
+    std::vector<uint8_t> _message;
 
-    void SendMessage()
+    void SendMessage(uint64_t stamp)
     {
-        if (_messages-- > 0)
-            Send(message.data(), message.size());
-        else
-            Disconnect();
+        MessageStamp::Write(_message.data(), stamp);
+        Send(_message.data(), _message.size());
     }
 };
 
@@ -78,6 +89,20 @@ int main(int argc, char** argv)
     parser.add_option("-c", "--clients").action("store").type("int").set_default(100).help("Count of working clients. Default: %default");
     parser.add_option("-m", "--messages").action("store").type("int").set_default(1000000).help("Count of messages to send. Default: %default");
     parser.add_option("-s", "--size").action("store").type("int").set_default(32).help("Single message size. Default: %default");
+    parser.add_option("-r", "--rate").action("store").type("int").set_default(0).help("Target rate of messages per second of all clients (0 for the closed loop mode). Default: %default");
+    parser.add_option("--nodelay").action("store").type("int").set_default(-1).help("Disable the Nagle algorithm (TCP_NODELAY, 0 or 1). Default: system default");
+    parser.add_option("--sndbuf").action("store").type("int").set_default(0).help("Socket send buffer size (SO_SNDBUF). Default: system default");
+    parser.add_option("--rcvbuf").action("store").type("int").set_default(0).help("Socket receive buffer size (SO_RCVBUF). Default: system default");
+    parser.add_option("--quickack").action("store").type("int").set_default(-1).help("Enable quick acknowledgements (TCP_QUICKACK, 0 or 1). Default: system default");
+    parser.add_option("--lowat").action("store").type("int").set_default(0).help("Limit of unsent bytes in the socket send buffer (TCP_NOTSENT_LOWAT). Default: system default");
+    parser.add_option("--keepalive").action("store").type("int").set_default(-1).help("Enable TCP keep-alive (SO_KEEPALIVE, 0 or 1). Default: system default");
+    parser.add_option("--keepidle").action("store").type("int").set_default(0).help("Keep-alive idle time in seconds (TCP_KEEPIDLE). Default: system default");
+    parser.add_option("--keepintvl").action("store").type("int").set_default(0).help("Keep-alive probes interval in seconds (TCP_KEEPINTVL). Default: system default");
+    parser.add_option("--keepcnt").action("store").type("int").set_default(0).help("Keep-alive probes count (TCP_KEEPCNT). Default: system default");
+    parser.add_option("--congestion").set_default("").help("Congestion control algorithm (TCP_CONGESTION). Default: system default");
+    parser.add_option("--busypoll").action("store").type("int").set_default(0).help("Busy poll time in microseconds (SO_BUSY_POLL). Default: system default");
+    parser.add_option("--speculative").action("store").type("int").set_default(0).help("Enable the speculative I/O mode (0 or 1). Default: %default");
+    parser.add_option("--zerocopy").action("store").type("int").set_default(0).help("Minimal size of pending data to send with zero copy (MSG_ZEROCOPY, 0 to disable). Default: %default");
 
     optparse::Values options = parser.parse_args(argc, argv);
 
@@ -94,7 +119,28 @@ int main(int argc, char** argv)
     int threads_count = options.get("threads");
     int clients_count = options.get("clients");
     int messages_count = options.get("messages");
-    int message_size = options.get("size");
+    int message_size = std::max((int)options.get("size"), (int)MessageStamp::SIZE);
+    int messages_rate = options.get("rate");
+
+    // Socket options
+    SocketOptions socket_options;
+    socket_options.no_delay = options.get("nodelay");
+    socket_options.send_buffer_size = options.get("sndbuf");
+    socket_options.receive_buffer_size = options.get("rcvbuf");
+    socket_options.quick_ack = options.get("quickack");
+    socket_options.not_sent_lowat = options.get("lowat");
+    socket_options.keep_alive = options.get("keepalive");
+    socket_options.keep_alive_idle = options.get("keepidle");
+    socket_options.keep_alive_interval = options.get("keepintvl");
+    socket_options.keep_alive_count = options.get("keepcnt");
+    socket_options.congestion_control = std::string(options.get("congestion"));
+    socket_options.busy_poll = options.get("busypoll");
+
+    // Speculative I/O mode
+    bool speculative = ((int)options.get("speculative") != 0);
+
+    // Zero copy send mode
+    size_t zero_copy = (int)options.get("zerocopy");
 
     std::cout << "Server address: " << address << std::endl;
     std::cout << "Server port: " << port << std::endl;
@@ -102,6 +148,10 @@ int main(int argc, char** argv)
     std::cout << "Working clients: " << clients_count << std::endl;
     std::cout << "Messages to send: " << messages_count << std::endl;
     std::cout << "Message size: " << message_size << std::endl;
+    std::cout << "Messages rate: " << ((messages_rate > 0) ? std::to_string(messages_rate) + " messages per second" : "closed loop") << std::endl;
+    std::cout << "Socket options: " << socket_options << std::endl;
+    std::cout << "Speculative I/O: " << (speculative ? "enabled" : "disabled") << std::endl;
+    std::cout << "Zero copy threshold: " << zero_copy << std::endl;
 
     // Prepare a message to send
     message.resize(message_size, 0);
@@ -120,11 +170,17 @@ int main(int argc, char** argv)
         service->Start();
     std::cout << "Done!" << std::endl;
 
+    // Create latency histograms for all Asio services
+    std::vector<LatencyHistogram> histograms(services.size());
+
     // Create echo clients
     std::vector<std::shared_ptr<EchoClient>> clients;
     for (int i = 0; i < clients_count; ++i)
     {
-        auto client = std::make_shared<EchoClient>(services[i % services.size()], address, port, messages_count / clients_count);
+        auto client = std::make_shared<EchoClient>(services[i % services.size()], histograms[i % services.size()], address, port, (double)messages_rate / clients_count, messages_count / clients_count);
+        client->SetupSocketOptions(socket_options);
+        client->SetupSpeculativeIO(speculative);
+        client->SetupZeroCopy(zero_copy);
         clients.emplace_back(client);
     }
 
@@ -166,5 +222,13 @@ int main(int argc, char** argv)
     std::cout << "Messages throughput: " << total_messages * 1000000000 / (timestamp_stop - timestamp_start) << " messages per second" << std::endl;
     std::cout << "Errors: " << total_errors << std::endl;
 
+    std::cout << std::endl;
+
+    // Report latency percentiles of all Asio services
+    LatencyHistogram latency;
+    for (auto& histogram : histograms)
+        latency.Merge(histogram);
+    latency.Report(std::cout);
+
     return 0;
 }
@@ -4,13 +4,19 @@
 
 #include "server/asio/service.h"
 #include "server/asio/tcp_server.h"
+#include "time/timestamp.h"
 
+#include <ctime>
 #include <iostream>
+#include <vector>
 
 #include "../../modules/cpp-optparse/OptionParser.h"
 
 using namespace CppServer::Asio;
 
+// Zero copy send threshold of echo sessions
+size_t zero_copy_threshold = 0;
+
 class EchoSession;
 
 class EchoServer : public TCPServer<EchoServer, EchoSession>
@@ -27,7 +33,11 @@ public:
 class EchoSession : public TCPSession<EchoServer, EchoSession>
 {
 public:
-    using TCPSession<EchoServer, EchoSession>::TCPSession;
+    explicit EchoSession(std::shared_ptr<TCPServer<EchoServer, EchoSession>> server, asio::ip::tcp::socket&& socket)
+        : TCPSession<EchoServer, EchoSession>(server, std::move(socket))
+    {
+        SetupZeroCopy(zero_copy_threshold);
+    }
 
 protected:
     void onReceived(const void* buffer, size_t size) override
@@ -48,6 +58,23 @@ int main(int argc, char** argv)
 
     parser.add_option("-h", "--help").help("Show help");
     parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port. Default: %default");
+    parser.add_option("-t", "--threads").action("store").type("int").set_default(1).help("Count of working threads. Default: %default");
+    parser.add_option("--pinned").action("store").type("int").set_default(0).help("Create one pinned Asio service per physical core instead of working threads (0 or 1). Default: %default");
+    parser.add_option("--polling").action("store").type("int").set_default(0).help("Start the service in the polling mode (0 or 1). Default: %default");
+    parser.add_option("--spin").action("store").type("int").set_default(0).help("Spin budget of the adaptive polling mode in microseconds (0 to poll without blocking). Default: %default");
+    parser.add_option("--nodelay").action("store").type("int").set_default(-1).help("Disable the Nagle algorithm (TCP_NODELAY, 0 or 1). Default: system default");
+    parser.add_option("--sndbuf").action("store").type("int").set_default(0).help("Socket send buffer size (SO_SNDBUF). Default: system default");
+    parser.add_option("--rcvbuf").action("store").type("int").set_default(0).help("Socket receive buffer size (SO_RCVBUF). Default: system default");
+    parser.add_option("--quickack").action("store").type("int").set_default(-1).help("Enable quick acknowledgements (TCP_QUICKACK, 0 or 1). Default: system default");
+    parser.add_option("--lowat").action("store").type("int").set_default(0).help("Limit of unsent bytes in the socket send buffer (TCP_NOTSENT_LOWAT). Default: system default");
+    parser.add_option("--keepalive").action("store").type("int").set_default(-1).help("Enable TCP keep-alive (SO_KEEPALIVE, 0 or 1). Default: system default");
+    parser.add_option("--keepidle").action("store").type("int").set_default(0).help("Keep-alive idle time in seconds (TCP_KEEPIDLE). Default: system default");
+    parser.add_option("--keepintvl").action("store").type("int").set_default(0).help("Keep-alive probes interval in seconds (TCP_KEEPINTVL). Default: system default");
+    parser.add_option("--keepcnt").action("store").type("int").set_default(0).help("Keep-alive probes count (TCP_KEEPCNT). Default: system default");
+    parser.add_option("--congestion").set_default("").help("Congestion control algorithm (TCP_CONGESTION). Default: system default");
+    parser.add_option("--busypoll").action("store").type("int").set_default(0).help("Busy poll time in microseconds (SO_BUSY_POLL). Default: system default");
+    parser.add_option("--speculative").action("store").type("int").set_default(0).help("Enable the speculative I/O mode (0 or 1). Default: %default");
+    parser.add_option("--zerocopy").action("store").type("int").set_default(0).help("Minimal size of pending data to send with zero copy (MSG_ZEROCOPY, 0 to disable). Default: %default");
 
     optparse::Values options = parser.parse_args(argc, argv);
 
@@ -60,19 +87,68 @@ int main(int argc, char** argv)
 
     // Server port
     int port = options.get("port");
+    int threads = options.get("threads");
+    bool pinned = ((int)options.get("pinned") != 0);
+
+    // Service polling mode
+    bool polling = ((int)options.get("polling") != 0);
+    int spin_budget = options.get("spin");
+
+    // Socket options
+    SocketOptions socket_options;
+    socket_options.no_delay = options.get("nodelay");
+    socket_options.send_buffer_size = options.get("sndbuf");
+    socket_options.receive_buffer_size = options.get("rcvbuf");
+    socket_options.quick_ack = options.get("quickack");
+    socket_options.not_sent_lowat = options.get("lowat");
+    socket_options.keep_alive = options.get("keepalive");
+    socket_options.keep_alive_idle = options.get("keepidle");
+    socket_options.keep_alive_interval = options.get("keepintvl");
+    socket_options.keep_alive_count = options.get("keepcnt");
+    socket_options.congestion_control = std::string(options.get("congestion"));
+    socket_options.busy_poll = options.get("busypoll");
+
+    // Speculative I/O mode
+    bool speculative = ((int)options.get("speculative") != 0);
+
+    // Zero copy send mode
+    zero_copy_threshold = (int)options.get("zerocopy");
 
     std::cout << "Server port: " << port << std::endl;
-
-    // Create a new Asio service
-    auto service = std::make_shared<Service>();
-
-    // Start the service
-    std::cout << "Asio service starting...";
-    service->Start();
+    if (pinned)
+        std::cout << "Pinned services: " << Service::PhysicalCores().size() << std::endl;
+    else
+        std::cout << "Working threads: " << threads << std::endl;
+    std::cout << "Polling mode: " << (polling ? ((spin_budget > 0) ? "adaptive" : "enabled") : "disabled") << std::endl;
+    if (polling && (spin_budget > 0))
+        std::cout << "Spin budget: " << spin_budget << " us" << std::endl;
+    std::cout << "Socket options: " << socket_options << std::endl;
+    std::cout << "Speculative I/O: " << (speculative ? "enabled" : "disabled") << std::endl;
+    std::cout << "Zero copy threshold: " << zero_copy_threshold << std::endl;
+
+    // Create new Asio services
+    std::vector<std::shared_ptr<Service>> services;
+    if (pinned)
+        services = Service::CreatePinned();
+    else
+        services.emplace_back(std::make_shared<Service>(threads));
+
+    // Start services
+    std::cout << "Asio services starting...";
+    for (auto& service : services)
+    {
+        service->SetupAdaptivePolling(spin_budget);
+        service->Start(polling);
+    }
     std::cout << "Done!" << std::endl;
 
+    uint64_t timestamp_start = CppCommon::Timestamp::nano();
+    std::clock_t clock_start = std::clock();
+
     // Create a new echo server
-    auto server = std::make_shared<EchoServer>(service, InternetProtocol::IPv4, port);
+    auto server = std::make_shared<EchoServer>(services, InternetProtocol::IPv4, port);
+    server->SetupSocketOptions(socket_options);
+    server->SetupSpeculativeIO(speculative);
 
     // Start the server
     std::cout << "Server starting...";
@@ -103,10 +179,19 @@ int main(int argc, char** argv)
     server->Stop();
     std::cout << "Done!" << std::endl;
 
-    // Stop the service
-    std::cout << "Asio service stopping...";
-    service->Stop();
+    // Stop services
+    std::cout << "Asio services stopping...";
+    for (auto& service : services)
+        service->Stop();
     std::cout << "Done!" << std::endl;
 
+    // Report the CPU usage of the server process
+    double elapsed = (CppCommon::Timestamp::nano() - timestamp_start) / 1000000000.0;
+    double cpu = (double)(std::clock() - clock_start) / CLOCKS_PER_SEC;
+    std::cout << std::endl;
+    std::cout << "Total time: " << elapsed << " s" << std::endl;
+    std::cout << "CPU time: " << cpu << " s" << std::endl;
+    std::cout << "CPU usage: " << ((elapsed > 0) ? (100.0 * cpu / elapsed) : 0.0) << "%" << std::endl;
+
     return 0;
 }
@@ -0,0 +1,322 @@
+//
+// Created by Ivan Shynkarenka on 26.03.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/ssl_client.h"
+#include "server/asio/ssl_server.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "threads/thread.h"
+#include "time/timestamp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+// Message framing mode of the echo sessions
+bool framing = false;
+// Receive ring mode of the echo sessions
+bool ring = false;
+size_t ring_capacity = 0;
+
+std::vector<uint8_t> message;
+uint64_t messages_window = 0;
+uint64_t messages_count = 0;
+
+std::atomic<uint64_t> total_messages(0);
+std::atomic<uint64_t> total_errors(0);
+
+class FramedTCPSession;
+
+class FramedTCPServer : public TCPServer<FramedTCPServer, FramedTCPSession>
+{
+public:
+    using TCPServer<FramedTCPServer, FramedTCPSession>::TCPServer;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class FramedTCPSession : public TCPSession<FramedTCPServer, FramedTCPSession>
+{
+public:
+    explicit FramedTCPSession(std::shared_ptr<TCPServer<FramedTCPServer, FramedTCPSession>> server, asio::ip::tcp::socket&& socket)
+        : TCPSession<FramedTCPServer, FramedTCPSession>(server, std::move(socket))
+    {
+        if (framing)
+            SetupFraming();
+        if (ring)
+            SetupReceiveRing(ring_capacity);
+    }
+
+protected:
+    void onReceived(const void* buffer, size_t size) override { Send(buffer, size); }
+    void onReceivedMessage(const void* buffer, size_t size) override { SendFrame(buffer, size); }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class FramedSSLSession;
+
+class FramedSSLServer : public SSLServer<FramedSSLServer, FramedSSLSession>
+{
+public:
+    using SSLServer<FramedSSLServer, FramedSSLSession>::SSLServer;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class FramedSSLSession : public SSLSession<FramedSSLServer, FramedSSLSession>
+{
+public:
+    explicit FramedSSLSession(std::shared_ptr<SSLServer<FramedSSLServer, FramedSSLSession>> server, asio::ip::tcp::socket&& socket, std::shared_ptr<asio::ssl::context> context)
+        : SSLSession<FramedSSLServer, FramedSSLSession>(server, std::move(socket), context)
+    {
+        SetupFraming();
+    }
+
+protected:
+    void onReceivedMessage(const void* buffer, size_t size) override { SendFrame(buffer, size); }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+template <class TClient>
+class FramedClient : public TClient
+{
+public:
+    using TClient::TClient;
+
+    bool done() const noexcept { return _received >= messages_count; }
+
+protected:
+    void onReceived(const void* buffer, size_t size) override
+    {
+        // Count complete raw messages in the received stream
+        _bytes += size;
+        uint64_t received = _bytes / message.size();
+        while (_received < received)
+            Complete();
+    }
+
+    void onReceivedMessage(const void* buffer, size_t size) override { Complete(); }
+
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+
+    void SendWindow()
+    {
+        while ((_sent < messages_window) && (_sent < messages_count))
+            Send();
+    }
+
+private:
+    uint64_t _sent = 0;
+    uint64_t _received = 0;
+    uint64_t _bytes = 0;
+
+    void Send()
+    {
+        ++_sent;
+        if (framing)
+            TClient::SendFrame(message.data(), message.size());
+        else
+            TClient::Send(message.data(), message.size());
+    }
+
+    void Complete()
+    {
+        ++_received;
+        ++total_messages;
+        if (_sent < messages_count)
+            Send();
+    }
+};
+
+class FramedTCPClient : public FramedClient<TCPClient>
+{
+public:
+    explicit FramedTCPClient(std::shared_ptr<Service> service, const std::string& address, int port)
+        : FramedClient<TCPClient>(service, address, port)
+    {
+        if (framing)
+            SetupFraming();
+        if (ring)
+            SetupReceiveRing(ring_capacity);
+    }
+
+protected:
+    void onConnected() override { SendWindow(); }
+};
+
+class FramedSSLClient : public FramedClient<SSLClient>
+{
+public:
+    explicit FramedSSLClient(std::shared_ptr<Service> service, std::shared_ptr<asio::ssl::context> context, const std::string& address, int port)
+        : FramedClient<SSLClient>(service, context, address, port)
+    {
+        SetupFraming();
+    }
+
+protected:
+    void onHandshaked() override { SendWindow(); }
+};
+
+template <class TServer, class TClient>
+uint64_t Run(std::shared_ptr<TServer> server, const std::vector<std::shared_ptr<TClient>>& clients)
+{
+    total_messages = 0;
+
+    // Start the server
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    uint64_t timestamp_start = CppCommon::Timestamp::nano();
+
+    // Connect clients and wait for all messages echoed
+    for (auto& client : clients)
+        client->Connect();
+    for (auto& client : clients)
+        while (!client->done() && (total_errors == 0))
+            CppCommon::Thread::Yield();
+
+    uint64_t timestamp_stop = CppCommon::Timestamp::nano();
+
+    // Disconnect clients
+    for (auto& client : clients)
+        client->Disconnect();
+    for (auto& client : clients)
+        while (client->IsConnected())
+            CppCommon::Thread::Yield();
+
+    // Stop the server
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    return timestamp_stop - timestamp_start;
+}
+
+void Report(const std::string& name, uint64_t messages, uint64_t time)
+{
+    std::cout << name << " time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(time) << std::endl;
+    std::cout << name << " throughput: " << messages * 1000000000 / time << " messages per second" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port (TCP and SSL servers use two subsequent ports). Default: %default");
+    parser.add_option("-c", "--clients").action("store").type("int").set_default(10).help("Count of working clients. Default: %default");
+    parser.add_option("-m", "--messages").action("store").type("int").set_default(1000000).help("Count of messages echoed by each client. Default: %default");
+    parser.add_option("-w", "--window").action("store").type("int").set_default(100).help("Count of messages in flight for each client. Default: %default");
+    parser.add_option("-s", "--size").action("store").type("int").set_default(32).help("Single message size. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Framed messages parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    int clients_count = options.get("clients");
+    messages_count = (int)options.get("messages");
+    messages_window = (int)options.get("window");
+    int message_size = options.get("size");
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "Working clients: " << clients_count << std::endl;
+    std::cout << "Messages per client: " << messages_count << std::endl;
+    std::cout << "Messages window: " << messages_window << std::endl;
+    std::cout << "Message size: " << message_size << std::endl;
+
+    message.resize(message_size, 'x');
+
+    // Receive ring should fit the whole window of framed messages
+    ring_capacity = std::max((size_t)(messages_window * (message_size + 8)), (size_t)CHUNK);
+
+    // Create and prepare SSL contexts
+    auto server_context = std::make_shared<asio::ssl::context>(asio::ssl::context::sslv23);
+    server_context->set_options(asio::ssl::context::default_workarounds | asio::ssl::context::no_sslv2 | asio::ssl::context::single_dh_use);
+    server_context->set_password_callback([](std::size_t max_length, asio::ssl::context::password_purpose purpose) -> std::string { return "qwerty"; });
+    server_context->use_certificate_chain_file("../tools/certificates/server.pem");
+    server_context->use_private_key_file("../tools/certificates/server.pem", asio::ssl::context::pem);
+    server_context->use_tmp_dh_file("../tools/certificates/dh4096.pem");
+    auto client_context = std::make_shared<asio::ssl::context>(asio::ssl::context::sslv23);
+    client_context->set_verify_mode(asio::ssl::verify_peer);
+    client_context->load_verify_file("../tools/certificates/ca.pem");
+
+    // Create and start Asio service
+    std::cout << "Asio service starting...";
+    auto service = std::make_shared<Service>();
+    service->Start();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    // Echo raw and framed messages over TCP
+    const char* tcp_modes[3] = { "raw", "framed", "framed ring" };
+    uint64_t tcp_times[3];
+    uint64_t tcp_messages[3];
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        framing = (mode != 0);
+        ring = (mode == 2);
+        std::cout << "TCP " << tcp_modes[mode] << " messages...";
+        auto server = std::make_shared<FramedTCPServer>(service, InternetProtocol::IPv4, port);
+        std::vector<std::shared_ptr<FramedTCPClient>> clients;
+        for (int i = 0; i < clients_count; ++i)
+            clients.emplace_back(std::make_shared<FramedTCPClient>(service, address, port));
+        tcp_times[mode] = Run(server, clients);
+        tcp_messages[mode] = total_messages;
+        std::cout << "Done!" << std::endl;
+    }
+
+    // Echo framed messages over SSL
+    std::cout << "SSL framed messages...";
+    framing = true;
+    ring = false;
+    uint64_t ssl_time;
+    uint64_t ssl_messages;
+    {
+        auto server = std::make_shared<FramedSSLServer>(service, server_context, InternetProtocol::IPv4, port + 1);
+        std::vector<std::shared_ptr<FramedSSLClient>> clients;
+        for (int i = 0; i < clients_count; ++i)
+            clients.emplace_back(std::make_shared<FramedSSLClient>(service, client_context, address, port + 1));
+        ssl_time = Run(server, clients);
+        ssl_messages = total_messages;
+    }
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio service
+    std::cout << "Asio service stopping...";
+    service->Stop();
+    while (service->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    Report("TCP raw messages", tcp_messages[0], tcp_times[0]);
+    Report("TCP framed messages", tcp_messages[1], tcp_times[1]);
+    Report("TCP framed ring messages", tcp_messages[2], tcp_times[2]);
+    Report("SSL framed messages", ssl_messages, ssl_time);
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
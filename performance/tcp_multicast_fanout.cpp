@@ -0,0 +1,210 @@
+//
+// Created by Ivan Shynkarenka on 21.03.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "system/cpu.h"
+#include "threads/thread.h"
+#include "time/timestamp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+std::atomic<uint64_t> total_received(0);
+std::atomic<uint64_t> total_errors(0);
+
+class FanoutSession;
+
+class FanoutServer : public TCPServer<FanoutServer, FanoutSession>
+{
+public:
+    using TCPServer<FanoutServer, FanoutSession>::TCPServer;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override
+    {
+        std::cout << "Server caught an error with code " << error << " and category '" << category << "': " << message << std::endl;
+        ++total_errors;
+    }
+};
+
+class FanoutSession : public TCPSession<FanoutServer, FanoutSession>
+{
+public:
+    using TCPSession<FanoutServer, FanoutSession>::TCPSession;
+};
+
+class FanoutClient : public TCPClient
+{
+public:
+    using TCPClient::TCPClient;
+
+protected:
+    void onReceived(const void* buffer, size_t size) override
+    {
+        total_received += size;
+    }
+
+    void onError(int error, const std::string& category, const std::string& message) override
+    {
+        std::cout << "Client caught an error with code " << error << " and category '" << category << "': " << message << std::endl;
+        ++total_errors;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port. Default: %default");
+    parser.add_option("-t", "--threads").action("store").type("int").set_default(CppCommon::CPU::LogicalCores()).help("Count of server shards / working threads. Default: %default");
+    parser.add_option("-c", "--clients").action("store").type("int").set_default(1000).help("Maximal count of connected sessions. Default: %default");
+    parser.add_option("-m", "--messages").action("store").type("int").set_default(100).help("Count of multicast messages for each sessions count. Default: %default");
+    parser.add_option("-s", "--size").action("store").type("int").set_default(32768).help("Single multicast message size. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Fan-out parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    int threads_count = options.get("threads");
+    int clients_count = options.get("clients");
+    int messages_count = options.get("messages");
+    int message_size = options.get("size");
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "Working threads: " << threads_count << std::endl;
+    std::cout << "Maximal sessions: " << clients_count << std::endl;
+    std::cout << "Messages: " << messages_count << std::endl;
+    std::cout << "Message size: " << message_size << std::endl;
+
+    // Prepare the multicast message
+    std::vector<uint8_t> message(message_size, 0);
+
+    // Create Asio services for the server shards and clients
+    std::vector<std::shared_ptr<Service>> server_services;
+    std::vector<std::shared_ptr<Service>> client_services;
+    for (int i = 0; i < threads_count; ++i)
+    {
+        server_services.emplace_back(std::make_shared<Service>());
+        client_services.emplace_back(std::make_shared<Service>());
+    }
+
+    // Start Asio services
+    std::cout << "Asio services starting...";
+    for (auto& service : server_services)
+        service->Start();
+    for (auto& service : client_services)
+        service->Start();
+    std::cout << "Done!" << std::endl;
+
+    // Create and start the fan-out server
+    std::cout << "Server starting...";
+    auto server = std::make_shared<FanoutServer>(server_services, InternetProtocol::IPv4, port);
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    // Measure fan-out for 1, 10, 100, ... connected sessions
+    std::vector<int> steps;
+    for (int sessions = 1; sessions < clients_count; sessions *= 10)
+        steps.push_back(sessions);
+    steps.push_back(clients_count);
+
+    std::vector<std::shared_ptr<FanoutClient>> clients;
+    for (int sessions : steps)
+    {
+        // Connect more clients
+        while ((int)clients.size() < sessions)
+        {
+            auto client = std::make_shared<FanoutClient>(client_services[clients.size() % client_services.size()], address, port);
+            client->Connect();
+            clients.emplace_back(client);
+        }
+        for (auto& client : clients)
+            while (!client->IsConnected())
+                CppCommon::Thread::Yield();
+        while (server->current_sessions() < (size_t)sessions)
+            CppCommon::Thread::Yield();
+
+        uint64_t total_time = 0;
+        uint64_t max_time = 0;
+
+        for (int i = 0; i < messages_count; ++i)
+        {
+            uint64_t expected = total_received + (uint64_t)sessions * message_size;
+
+            uint64_t timestamp_start = CppCommon::Timestamp::nano();
+
+            // Multicast the message to all connected sessions
+            server->Multicast(message.data(), message.size());
+
+            // Wait for the last byte received by the last client
+            while (total_received < expected)
+                CppCommon::Thread::Yield();
+
+            uint64_t timestamp_stop = CppCommon::Timestamp::nano();
+
+            total_time += timestamp_stop - timestamp_start;
+            max_time = std::max(max_time, timestamp_stop - timestamp_start);
+        }
+
+        std::cout << "Sessions: " << sessions << std::endl;
+        std::cout << "Average time-to-last-byte: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(total_time / messages_count) << std::endl;
+        std::cout << "Maximal time-to-last-byte: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(max_time) << std::endl;
+        std::cout << "Multicast throughput: " << (uint64_t)sessions * message_size * messages_count * 1000000000 / total_time << " bytes per second" << std::endl;
+        std::cout << std::endl;
+    }
+
+    // Disconnect clients
+    std::cout << "Clients disconnecting...";
+    for (auto& client : clients)
+        client->Disconnect();
+    for (auto& client : clients)
+        while (client->IsConnected())
+            CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Stop the fan-out server
+    std::cout << "Server stopping...";
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio services
+    std::cout << "Asio services stopping...";
+    for (auto& service : client_services)
+        service->Stop();
+    for (auto& service : server_services)
+        service->Stop();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,267 @@
+//
+// Created by Ivan Shynkarenka on 31.03.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "threads/thread.h"
+#include "time/timestamp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+// Cork mode of the server sessions
+bool cork = false;
+
+const size_t header_size = 16;
+const size_t trailer_size = 8;
+size_t body_size = 0;
+size_t response_size = 0;
+uint64_t responses_window = 0;
+uint64_t responses_count = 0;
+
+SharedBuffer body;
+
+std::atomic<uint64_t> total_responses(0);
+std::atomic<uint64_t> total_writes(0);
+std::atomic<uint64_t> total_errors(0);
+
+class MultipartSession;
+
+class MultipartServer : public TCPServer<MultipartServer, MultipartSession>
+{
+public:
+    using TCPServer<MultipartServer, MultipartSession>::TCPServer;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class MultipartSession : public TCPSession<MultipartServer, MultipartSession>
+{
+public:
+    using TCPSession<MultipartServer, MultipartSession>::TCPSession;
+
+protected:
+    void onReceived(const void* buffer, size_t size) override
+    {
+        // Each request byte is answered with a header, a body and a trailer
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (cork)
+                Cork();
+            Send(std::string(header_size, 'h'));
+            Send(body);
+            Send(std::string(trailer_size, 't'));
+            if (cork)
+                Uncork();
+        }
+    }
+
+    void onSent(size_t sent, size_t pending) override { ++total_writes; }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class MultipartClient : public TCPClient
+{
+public:
+    using TCPClient::TCPClient;
+
+    std::atomic<bool> done{false};
+
+protected:
+    void onConnected() override
+    {
+        _received = 0;
+        _requested = 0;
+        SendRequests(responses_window);
+    }
+
+    void onReceived(const void* buffer, size_t size) override
+    {
+        _received += size;
+        uint64_t responses = _received / response_size;
+        _received %= response_size;
+        total_responses += responses;
+
+        // Keep the window of requests in flight
+        SendRequests(responses);
+        if (total_responses >= responses_count)
+            done = true;
+    }
+
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+
+private:
+    uint64_t _received;
+    uint64_t _requested;
+
+    void SendRequests(uint64_t count)
+    {
+        count = std::min(count, responses_count - _requested);
+        if (count == 0)
+            return;
+        _requested += count;
+        Send(std::string(count, 'r'));
+    }
+};
+
+uint64_t SentSegments()
+{
+#if defined(linux) || defined(__linux) || defined(__linux__)
+    // System wide count of sent TCP segments (OutSegs field of the Tcp line)
+    std::ifstream snmp("/proc/net/snmp");
+    std::string header;
+    std::string values;
+    while (std::getline(snmp, header) && std::getline(snmp, values))
+    {
+        if (header.compare(0, 4, "Tcp:") != 0)
+            continue;
+
+        std::istringstream names(header);
+        std::istringstream numbers(values);
+        std::string name;
+        std::string number;
+        while ((names >> name) && (numbers >> number))
+            if (name == "OutSegs")
+                return std::stoull(number);
+    }
+#endif
+    return 0;
+}
+
+struct Result
+{
+    uint64_t time;
+    uint64_t writes;
+    uint64_t segments;
+};
+
+Result Run(std::shared_ptr<Service> service, const std::string& address, int port)
+{
+    total_responses = 0;
+    total_writes = 0;
+
+    SocketOptions options;
+    options.no_delay = 1;
+
+    // Start the server
+    auto server = std::make_shared<MultipartServer>(service, InternetProtocol::IPv4, port);
+    server->SetupSocketOptions(options);
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    uint64_t segments_start = SentSegments();
+    uint64_t timestamp_start = CppCommon::Timestamp::nano();
+
+    // Connect the client and wait for all responses received
+    auto client = std::make_shared<MultipartClient>(service, address, port);
+    client->SetupSocketOptions(options);
+    client->Connect();
+    while (!client->done && (total_errors == 0))
+        CppCommon::Thread::Yield();
+
+    uint64_t timestamp_stop = CppCommon::Timestamp::nano();
+    uint64_t segments_stop = SentSegments();
+
+    // Disconnect the client
+    client->Disconnect();
+    while (client->IsConnected())
+        CppCommon::Thread::Yield();
+
+    // Stop the server
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    return Result{ timestamp_stop - timestamp_start, total_writes, segments_stop - segments_start };
+}
+
+void Report(const std::string& name, const Result& result)
+{
+    std::cout << name << " time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(result.time) << std::endl;
+    std::cout << name << " responses throughput: " << responses_count * 1000000000 / result.time << " responses per second" << std::endl;
+    std::cout << name << " server writes: " << result.writes << " (" << (double)result.writes / responses_count << " per response)" << std::endl;
+    std::cout << name << " TCP segments: " << result.segments << " (" << (double)result.segments / responses_count << " per response)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port. Default: %default");
+    parser.add_option("-b", "--body").action("store").type("int").set_default(256).help("Response body size. Default: %default");
+    parser.add_option("-w", "--window").action("store").type("int").set_default(1).help("Count of requests in flight. Default: %default");
+    parser.add_option("-c", "--count").action("store").type("int").set_default(100000).help("Count of responses. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Multipart parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    body_size = options.get("body");
+    responses_window = options.get("window");
+    responses_count = options.get("count");
+    response_size = header_size + body_size + trailer_size;
+    body = SharedBuffer(std::string(body_size, 'b'));
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "Response parts: " << header_size << " + " << body_size << " + " << trailer_size << " bytes" << std::endl;
+    std::cout << "Responses window: " << responses_window << std::endl;
+    std::cout << "Responses count: " << responses_count << std::endl;
+
+    // Create and start Asio service
+    std::cout << "Asio service starting...";
+    auto service = std::make_shared<Service>();
+    service->Start();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    std::cout << "Separate Send() calls...";
+    cork = false;
+    Result separate = Run(service, address, port);
+    std::cout << "Done!" << std::endl;
+
+    std::cout << "Corked Send() calls...";
+    cork = true;
+    Result corked = Run(service, address, port);
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio service
+    std::cout << "Asio service stopping...";
+    service->Stop();
+    while (service->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    Report("Separate", separate);
+    Report("Corked", corked);
+    std::cout << "TCP segments are counted system wide from /proc/net/snmp and include acknowledgements" << std::endl;
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
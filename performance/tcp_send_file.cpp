@@ -0,0 +1,209 @@
+//
+// Created by Ivan Shynkarenka on 28.03.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "threads/thread.h"
+#include "time/timestamp.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+// Send file mode of the server sessions
+bool send_file = false;
+
+std::string file_path;
+uint64_t file_size = 0;
+
+std::atomic<uint64_t> total_received(0);
+std::atomic<uint64_t> total_errors(0);
+
+class FileSession;
+
+class FileServer : public TCPServer<FileServer, FileSession>
+{
+public:
+    using TCPServer<FileServer, FileSession>::TCPServer;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class FileSession : public TCPSession<FileServer, FileSession>
+{
+public:
+    using TCPSession<FileServer, FileSession>::TCPSession;
+
+protected:
+    void onConnected() override
+    {
+        if (send_file)
+        {
+            // Send the file directly from the page cache
+            SendFile(file_path);
+        }
+        else
+        {
+            // Read the file into the memory and send it
+            std::vector<char> data(file_size);
+            std::ifstream file(file_path, std::ios::binary);
+            file.read(data.data(), data.size());
+            Send(data.data(), data.size());
+        }
+    }
+
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class FileClient : public TCPClient
+{
+public:
+    using TCPClient::TCPClient;
+
+protected:
+    void onReceived(const void* buffer, size_t size) override { total_received += size; }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+uint64_t PeakMemory()
+{
+#if defined(linux) || defined(__linux) || defined(__linux__)
+    // Peak resident memory in kilobytes
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::stoull(line.substr(6)) * 1024;
+#endif
+    return 0;
+}
+
+uint64_t Run(std::shared_ptr<Service> service, const std::string& address, int port)
+{
+    total_received = 0;
+
+    // Start the server
+    auto server = std::make_shared<FileServer>(service, InternetProtocol::IPv4, port);
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    uint64_t timestamp_start = CppCommon::Timestamp::nano();
+
+    // Connect the client and wait for the whole file received
+    auto client = std::make_shared<FileClient>(service, address, port);
+    client->Connect();
+    while ((total_received < file_size) && (total_errors == 0))
+        CppCommon::Thread::Yield();
+
+    uint64_t timestamp_stop = CppCommon::Timestamp::nano();
+
+    // Disconnect the client
+    client->Disconnect();
+    while (client->IsConnected())
+        CppCommon::Thread::Yield();
+
+    // Stop the server
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    return timestamp_stop - timestamp_start;
+}
+
+void Report(const std::string& name, uint64_t time, uint64_t memory)
+{
+    std::cout << name << " time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(time) << std::endl;
+    std::cout << name << " throughput: " << file_size * 1000000000 / time / (1024 * 1024) << " megabytes per second" << std::endl;
+    std::cout << name << " peak resident memory: " << memory / (1024 * 1024) << " megabytes" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port. Default: %default");
+    parser.add_option("-f", "--file").set_default("tcp_send_file.tmp").help("Temporary file path. Default: %default");
+    parser.add_option("-s", "--size").action("store").type("int").set_default(1024).help("File size in megabytes. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Send file parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    file_path = std::string(options.get("file"));
+    file_size = (uint64_t)(int)options.get("size") * 1024 * 1024;
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "File path: " << file_path << std::endl;
+    std::cout << "File size: " << file_size / (1024 * 1024) << " megabytes" << std::endl;
+
+    // Create the temporary file
+    std::cout << "File creating...";
+    {
+        std::vector<char> chunk(1024 * 1024, 'x');
+        std::ofstream file(file_path, std::ios::binary);
+        for (uint64_t i = 0; i < file_size; i += chunk.size())
+            file.write(chunk.data(), chunk.size());
+    }
+    std::cout << "Done!" << std::endl;
+
+    // Create and start Asio service
+    std::cout << "Asio service starting...";
+    auto service = std::make_shared<Service>();
+    service->Start();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    // Peak memory only grows, so send the file without loading it first
+    std::cout << "SendFile()...";
+    send_file = true;
+    uint64_t send_file_time = Run(service, address, port);
+    uint64_t send_file_memory = PeakMemory();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << "Read and Send()...";
+    send_file = false;
+    uint64_t read_send_time = Run(service, address, port);
+    uint64_t read_send_memory = PeakMemory();
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio service
+    std::cout << "Asio service stopping...";
+    service->Stop();
+    while (service->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Remove the temporary file
+    std::remove(file_path.c_str());
+
+    std::cout << std::endl;
+
+    Report("SendFile()", send_file_time, send_file_memory);
+    Report("Read and Send()", read_send_time, read_send_memory);
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+//
+// Created by Ivan Shynkarenka on 22.03.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "threads/thread.h"
+#include "time/timestamp.h"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+std::atomic<uint64_t> total_received(0);
+std::atomic<uint64_t> total_errors(0);
+
+class SinkSession;
+
+class SinkServer : public TCPServer<SinkServer, SinkSession>
+{
+public:
+    using TCPServer<SinkServer, SinkSession>::TCPServer;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override
+    {
+        std::cout << "Server caught an error with code " << error << " and category '" << category << "': " << message << std::endl;
+        ++total_errors;
+    }
+};
+
+class SinkSession : public TCPSession<SinkServer, SinkSession>
+{
+public:
+    using TCPSession<SinkServer, SinkSession>::TCPSession;
+
+protected:
+    void onReceived(const void* buffer, size_t size) override
+    {
+        total_received += size;
+    }
+};
+
+class ProducerClient : public TCPClient
+{
+public:
+    using TCPClient::TCPClient;
+
+    //! Send data with a mutex and a dispatched handler for each call
+    /*!
+        Reproduces the send path with a locked send buffer and a separate
+        Asio handler for every call to compare with the lock-free one.
+    */
+    void SendLocked(const void* buffer, size_t size)
+    {
+        {
+            std::lock_guard<std::mutex> locker(_lock);
+
+            const uint8_t* bytes = (const uint8_t*)buffer;
+            _buffer.insert(_buffer.end(), bytes, bytes + size);
+        }
+
+        auto self(this->shared_from_this());
+        service()->Dispatch([this, self]()
+        {
+            std::lock_guard<std::mutex> locker(_lock);
+
+            if (!_buffer.empty())
+            {
+                Send(_buffer.data(), _buffer.size());
+                _buffer.clear();
+            }
+        });
+    }
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override
+    {
+        std::cout << "Client caught an error with code " << error << " and category '" << category << "': " << message << std::endl;
+        ++total_errors;
+    }
+
+private:
+    std::mutex _lock;
+    std::vector<uint8_t> _buffer;
+};
+
+uint64_t Produce(std::shared_ptr<ProducerClient>& client, bool locked, int producers_count, int messages_count, const std::vector<uint8_t>& message)
+{
+    uint64_t expected = total_received + (uint64_t)producers_count * messages_count * message.size();
+
+    uint64_t timestamp_start = CppCommon::Timestamp::nano();
+
+    // Start producer threads
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producers_count; ++i)
+    {
+        producers.emplace_back(CppCommon::Thread::Start([&client, locked, messages_count, &message]()
+        {
+            for (int j = 0; j < messages_count; ++j)
+            {
+                if (locked)
+                    client->SendLocked(message.data(), message.size());
+                else
+                    client->Send(message.data(), message.size());
+            }
+        }));
+    }
+
+    // Wait for all producer threads
+    for (auto& producer : producers)
+        producer.join();
+
+    // Wait for all data received by the server
+    while (total_received < expected)
+        CppCommon::Thread::Yield();
+
+    uint64_t timestamp_stop = CppCommon::Timestamp::nano();
+
+    return timestamp_stop - timestamp_start;
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port. Default: %default");
+    parser.add_option("-t", "--producers").action("store").type("int").set_default(4).help("Count of producer threads. Default: %default");
+    parser.add_option("-m", "--messages").action("store").type("int").set_default(1000000).help("Count of messages sent by each producer. Default: %default");
+    parser.add_option("-s", "--size").action("store").type("int").set_default(32).help("Single message size. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Producers parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    int producers_count = options.get("producers");
+    int messages_count = options.get("messages");
+    int message_size = options.get("size");
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "Producers: " << producers_count << std::endl;
+    std::cout << "Messages: " << messages_count << std::endl;
+    std::cout << "Message size: " << message_size << std::endl;
+
+    // Prepare a message to send
+    std::vector<uint8_t> message(message_size, 0);
+
+    // Create Asio services
+    auto server_service = std::make_shared<Service>();
+    auto client_service = std::make_shared<Service>();
+
+    // Start Asio services
+    std::cout << "Asio services starting...";
+    server_service->Start();
+    client_service->Start();
+    std::cout << "Done!" << std::endl;
+
+    // Create and start the sink server
+    std::cout << "Server starting...";
+    auto server = std::make_shared<SinkServer>(server_service, InternetProtocol::IPv4, port);
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Create and connect the producer client
+    std::cout << "Client connecting...";
+    auto client = std::make_shared<ProducerClient>(client_service, address, port);
+    client->Connect();
+    while (!client->IsConnected())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    // Send messages with the locked send path
+    std::cout << "Locked send...";
+    uint64_t locked_time = Produce(client, true, producers_count, messages_count, message);
+    std::cout << "Done!" << std::endl;
+
+    // Send messages with the lock-free send path
+    std::cout << "Lock-free send...";
+    uint64_t lock_free_time = Produce(client, false, producers_count, messages_count, message);
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    // Disconnect the producer client
+    std::cout << "Client disconnecting...";
+    client->Disconnect();
+    while (client->IsConnected())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Stop the sink server
+    std::cout << "Server stopping...";
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio services
+    std::cout << "Asio services stopping...";
+    client_service->Stop();
+    server_service->Stop();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    uint64_t total_messages = (uint64_t)producers_count * messages_count;
+
+    std::cout << "Total messages: " << total_messages << std::endl;
+    std::cout << "Locked send time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(locked_time) << std::endl;
+    std::cout << "Locked send throughput: " << total_messages * 1000000000 / locked_time << " messages per second" << std::endl;
+    std::cout << "Lock-free send time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(lock_free_time) << std::endl;
+    std::cout << "Lock-free send throughput: " << total_messages * 1000000000 / lock_free_time << " messages per second" << std::endl;
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+//
+// Created by Ivan Shynkarenka on 01.04.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/tcp_client.h"
+#include "server/asio/tcp_server.h"
+#include "threads/thread.h"
+#include "time/timestamp.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+std::atomic<uint64_t> total_allocations(0);
+std::atomic<uint64_t> total_greetings(0);
+std::atomic<uint64_t> total_errors(0);
+
+// Count all heap allocations of the process
+void* operator new(size_t size)
+{
+    ++total_allocations;
+    void* result = std::malloc((size > 0) ? size : 1);
+    if (result == nullptr)
+        throw std::bad_alloc();
+    return result;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t size) noexcept { std::free(ptr); }
+
+class ChurnSession;
+
+class ChurnServer : public TCPServer<ChurnServer, ChurnSession>
+{
+public:
+    using TCPServer<ChurnServer, ChurnSession>::TCPServer;
+
+protected:
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class ChurnSession : public TCPSession<ChurnServer, ChurnSession>
+{
+public:
+    using TCPSession<ChurnServer, ChurnSession>::TCPSession;
+
+protected:
+    void onConnected() override { Send("greeting"); }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+class ChurnClient : public TCPClient
+{
+public:
+    using TCPClient::TCPClient;
+
+protected:
+    void onReceived(const void* buffer, size_t size) override { ++total_greetings; }
+    void onError(int error, const std::string& category, const std::string& message) override { ++total_errors; }
+};
+
+struct Result
+{
+    uint64_t time;
+    uint64_t allocations;
+};
+
+Result Churn(std::shared_ptr<Service> server_service, std::shared_ptr<Service> client_service, const std::string& address, int port, size_t pool, int clients_count, int rounds_count)
+{
+    // Create and start the churn server with the given session pool
+    auto server = std::make_shared<ChurnServer>(server_service, InternetProtocol::IPv4, port);
+    server->SetupSessionPool(pool);
+    server->Start();
+    while (!server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    // Create churn clients
+    std::vector<std::shared_ptr<ChurnClient>> clients;
+    for (int i = 0; i < clients_count; ++i)
+        clients.emplace_back(std::make_shared<ChurnClient>(client_service, address, port));
+
+    total_greetings = 0;
+
+    uint64_t allocations_start = total_allocations;
+    uint64_t timestamp_start = CppCommon::Timestamp::nano();
+
+    for (int round = 0; round < rounds_count; ++round)
+    {
+        // Connect all clients at once
+        for (auto& client : clients)
+            client->Connect();
+
+        // Wait for greetings from all sessions
+        while ((total_greetings < (uint64_t)((round + 1) * clients_count)) && (total_errors == 0))
+            CppCommon::Thread::Yield();
+
+        // Disconnect all clients
+        for (auto& client : clients)
+            client->Disconnect();
+        for (auto& client : clients)
+            while (client->IsConnected())
+                CppCommon::Thread::Yield();
+        while (server->current_sessions() > 0)
+            CppCommon::Thread::Yield();
+    }
+
+    uint64_t timestamp_stop = CppCommon::Timestamp::nano();
+    uint64_t allocations_stop = total_allocations;
+
+    // Stop the churn server
+    server->Stop();
+    while (server->IsStarted())
+        CppCommon::Thread::Yield();
+
+    return Result{ timestamp_stop - timestamp_start, allocations_stop - allocations_start };
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-a", "--address").set_default("127.0.0.1").help("Server address. Default: %default");
+    parser.add_option("-p", "--port").action("store").type("int").set_default(1111).help("Server port. Default: %default");
+    parser.add_option("-c", "--clients").action("store").type("int").set_default(100).help("Count of simultaneously connecting clients. Default: %default");
+    parser.add_option("-r", "--rounds").action("store").type("int").set_default(100).help("Count of connect/disconnect rounds. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Session pool parameters
+    std::string address(options.get("address"));
+    int port = options.get("port");
+    int clients_count = options.get("clients");
+    int rounds_count = options.get("rounds");
+
+    std::cout << "Server address: " << address << std::endl;
+    std::cout << "Server port: " << port << std::endl;
+    std::cout << "Connecting clients: " << clients_count << std::endl;
+    std::cout << "Connection rounds: " << rounds_count << std::endl;
+
+    // Create and start Asio services
+    std::cout << "Asio services starting...";
+    auto server_service = std::make_shared<Service>();
+    auto client_service = std::make_shared<Service>();
+    server_service->Start();
+    client_service->Start();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    uint64_t total_connections = (uint64_t)clients_count * rounds_count;
+
+    std::cout << "Connection churn without the session pool...";
+    Result created = Churn(server_service, client_service, address, port, 0, clients_count, rounds_count);
+    std::cout << "Done!" << std::endl;
+
+    std::cout << "Connection churn with the session pool...";
+    Result pooled = Churn(server_service, client_service, address, port, clients_count, clients_count, rounds_count);
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio services
+    std::cout << "Asio services stopping...";
+    client_service->Stop();
+    server_service->Stop();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    std::cout << "Total connections: " << total_connections << std::endl;
+    std::cout << "Created sessions time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(created.time) << std::endl;
+    std::cout << "Created sessions throughput: " << total_connections * 1000000000 / created.time << " connections per second" << std::endl;
+    std::cout << "Created sessions allocations: " << created.allocations / total_connections << " per connection" << std::endl;
+    std::cout << "Pooled sessions time: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(pooled.time) << std::endl;
+    std::cout << "Pooled sessions throughput: " << total_connections * 1000000000 / pooled.time << " connections per second" << std::endl;
+    std::cout << "Pooled sessions allocations: " << pooled.allocations / total_connections << " per connection" << std::endl;
+    std::cout << "Errors: " << total_errors << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+//
+// Created by Ivan Shynkarenka on 07.04.2017
+//
+
+#include "benchmark/reporter_console.h"
+#include "server/asio/service.h"
+#include "server/asio/timing_wheel.h"
+#include "time/timestamp.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../../modules/cpp-optparse/OptionParser.h"
+
+using namespace CppServer::Asio;
+
+struct RearmResult
+{
+    uint64_t arm_time = 0;
+    uint64_t rearm_time = 0;
+    uint64_t cancel_time = 0;
+    uint64_t handlers = 0;
+};
+
+// Each connection re-arms its own Asio timer on each received message
+RearmResult RearmSteadyTimers(const std::vector<size_t>& messages, size_t connections, uint64_t timeout)
+{
+    RearmResult result;
+    asio::io_service io_service;
+    std::vector<std::unique_ptr<asio::steady_timer>> timers;
+    auto timer_handler = [&result](const asio::error_code& ec) { ++result.handlers; };
+
+    uint64_t timestamp = CppCommon::Timestamp::nano();
+    for (size_t i = 0; i < connections; ++i)
+    {
+        timers.emplace_back(new asio::steady_timer(io_service));
+        timers.back()->expires_from_now(std::chrono::milliseconds(timeout));
+        timers.back()->async_wait(timer_handler);
+    }
+    result.arm_time = CppCommon::Timestamp::nano() - timestamp;
+
+    // Re-arming cancels the pending wait, so canceled handlers are run in batches
+    timestamp = CppCommon::Timestamp::nano();
+    size_t count = 0;
+    for (auto index : messages)
+    {
+        timers[index]->expires_from_now(std::chrono::milliseconds(timeout));
+        timers[index]->async_wait(timer_handler);
+        if ((++count % 1024) == 0)
+            io_service.poll();
+    }
+    io_service.poll();
+    result.rearm_time = CppCommon::Timestamp::nano() - timestamp;
+
+    timestamp = CppCommon::Timestamp::nano();
+    for (auto& timer : timers)
+        timer->cancel();
+    io_service.poll();
+    result.cancel_time = CppCommon::Timestamp::nano() - timestamp;
+
+    return result;
+}
+
+// Each connection re-arms its own timer in the service timing wheel on each received message
+RearmResult RearmServiceWheel(const std::shared_ptr<Service>& service, const std::vector<size_t>& messages, size_t connections, uint64_t timeout)
+{
+    RearmResult result;
+    std::vector<std::unique_ptr<TimingWheel::Timer>> timers;
+
+    uint64_t timestamp = CppCommon::Timestamp::nano();
+    for (size_t i = 0; i < connections; ++i)
+    {
+        timers.emplace_back(new TimingWheel::Timer([&result]() { ++result.handlers; }));
+        service->ArmTimer(*timers.back(), timeout);
+    }
+    result.arm_time = CppCommon::Timestamp::nano() - timestamp;
+
+    timestamp = CppCommon::Timestamp::nano();
+    for (auto index : messages)
+        service->ArmTimer(*timers[index], timeout);
+    result.rearm_time = CppCommon::Timestamp::nano() - timestamp;
+
+    timestamp = CppCommon::Timestamp::nano();
+    for (auto& timer : timers)
+        service->CancelTimer(*timer);
+    result.cancel_time = CppCommon::Timestamp::nano() - timestamp;
+
+    return result;
+}
+
+// Each connection stamps the coarse service time on each received message
+// and the timing wheel timer is armed once for the whole timeout
+RearmResult RearmLazyStamp(const std::shared_ptr<Service>& service, const std::vector<size_t>& messages, size_t connections, uint64_t timeout)
+{
+    RearmResult result;
+    std::vector<std::unique_ptr<TimingWheel::Timer>> timers;
+    std::vector<uint64_t> stamps(connections, 0);
+
+    uint64_t timestamp = CppCommon::Timestamp::nano();
+    for (size_t i = 0; i < connections; ++i)
+    {
+        timers.emplace_back(new TimingWheel::Timer([&result]() { ++result.handlers; }));
+        service->ArmTimer(*timers.back(), timeout);
+        stamps[i] = service->timer_time();
+    }
+    result.arm_time = CppCommon::Timestamp::nano() - timestamp;
+
+    timestamp = CppCommon::Timestamp::nano();
+    for (auto index : messages)
+        stamps[index] = service->timer_time();
+    result.rearm_time = CppCommon::Timestamp::nano() - timestamp;
+
+    timestamp = CppCommon::Timestamp::nano();
+    for (auto& timer : timers)
+        service->CancelTimer(*timer);
+    result.cancel_time = CppCommon::Timestamp::nano() - timestamp;
+
+    return result;
+}
+
+void Report(const std::string& name, const RearmResult& result, size_t connections, size_t messages)
+{
+    std::cout << name << " arm: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(result.arm_time / std::max(connections, (size_t)1)) << " per connection" << std::endl;
+    std::cout << name << " re-arm: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(result.rearm_time / std::max(messages, (size_t)1)) << " per message (" << (uint64_t)messages * 1000000000 / std::max(result.rearm_time, (uint64_t)1) << " msg/s)" << std::endl;
+    std::cout << name << " cancel: " << CppBenchmark::ReporterConsole::GenerateTimePeriod(result.cancel_time / std::max(connections, (size_t)1)) << " per connection" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    auto parser = optparse::OptionParser().version("1.0.0.0");
+
+    parser.add_option("-h", "--help").help("Show help");
+    parser.add_option("-c", "--connections").action("store").type("int").set_default(100000).help("Count of connections. Default: %default");
+    parser.add_option("-m", "--messages").action("store").type("int").set_default(10000000).help("Count of received messages. Default: %default");
+    parser.add_option("-t", "--timeout").action("store").type("int").set_default(60000).help("Idle timeout in milliseconds. Default: %default");
+    parser.add_option("-r", "--resolution").action("store").type("int").set_default(100).help("Timing wheel resolution in milliseconds. Default: %default");
+
+    optparse::Values options = parser.parse_args(argc, argv);
+
+    // Print help
+    if (options.get("help"))
+    {
+        parser.print_help();
+        parser.exit();
+    }
+
+    // Re-arm parameters
+    int connections = options.get("connections");
+    int messages_count = options.get("messages");
+    int timeout = options.get("timeout");
+    int resolution = options.get("resolution");
+
+    std::cout << "Connections: " << connections << std::endl;
+    std::cout << "Messages: " << messages_count << std::endl;
+    std::cout << "Idle timeout: " << timeout << " ms" << std::endl;
+    std::cout << "Timing wheel resolution: " << resolution << " ms" << std::endl;
+
+    std::cout << std::endl;
+
+    // Prepare a random order of connections which receive messages
+    std::vector<size_t> messages;
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<size_t> distribution(0, connections - 1);
+    for (int i = 0; i < messages_count; ++i)
+        messages.push_back(distribution(generator));
+
+    // Create and start Asio service with the timing wheel
+    std::cout << "Asio service starting...";
+    auto service = std::make_shared<Service>();
+    service->SetupTimingWheel(resolution);
+    service->Start();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << "Asio steady timers re-arm...";
+    RearmResult timers_result = RearmSteadyTimers(messages, connections, timeout);
+    std::cout << "Done!" << std::endl;
+
+    std::cout << "Service timing wheel re-arm...";
+    RearmResult wheel_result = RearmServiceWheel(service, messages, connections, timeout);
+    std::cout << "Done!" << std::endl;
+
+    std::cout << "Lazy activity stamp...";
+    RearmResult lazy_result = RearmLazyStamp(service, messages, connections, timeout);
+    std::cout << "Done!" << std::endl;
+
+    // Stop Asio service
+    std::cout << "Asio service stopping...";
+    service->Stop();
+    std::cout << "Done!" << std::endl;
+
+    std::cout << std::endl;
+
+    Report("Asio steady timers", timers_result, connections, messages.size());
+    Report("Service timing wheel", wheel_result, connections, messages.size());
+    Report("Lazy activity stamp", lazy_result, connections, messages.size());
+    std::cout << "Canceled Asio timer handlers: " << timers_result.handlers << std::endl;
+    std::cout << "Expired timing wheel handlers: " << (wheel_result.handlers + lazy_result.handlers) << std::endl;
+
+    return 0;
+}
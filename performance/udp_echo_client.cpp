@@ -2,6 +2,8 @@
 // Created by Ivan Shynkarenka on 15.03.2017
 //
 
+#include "load_generator.h"
+
 #include "benchmark/reporter_console.h"
 #include "server/asio/service.h"
 #include "server/asio/udp_client.h"
@@ -9,6 +11,7 @@
 #include "threads/thread.h"
 #include "time/timestamp.h"
 
+#include <algorithm>
 #include <atomic>
 #include <iostream>
 #include <vector>
@@ -29,16 +32,22 @@ std::atomic<uint64_t> total_messages(0);
 class EchoClient : public UDPClient
 {
 public:
-    explicit EchoClient(std::shared_ptr<Service> service, const std::string& address, int port, int messages)
-        : UDPClient(service, address, port)
+    explicit EchoClient(std::shared_ptr<Service> service, LatencyHistogram& histogram, const std::string& address, int port, double rate, int messages)
+        : UDPClient(service, address, port),
+          _generator(service, histogram, rate, messages),
+          _message(message)
     {
-        _messages = messages;
     }
 
 protected:
     void onConnected() override
     {
-        SendMessage();
+        _generator.Start([this](uint64_t stamp) { SendMessage(stamp); }, [this]() { Disconnect(); });
+    }
+
+    void onDisconnected() override
+    {
+        _generator.Stop();
     }
 
     void onReceived(const asio::ip::udp::endpoint& endpoint, const void* buffer, size_t size) override
@@ -47,7 +56,8 @@ protected:
         total_bytes += size;
         ++total_messages;
 
-        SendMessage();
+        if (size >= MessageStamp::SIZE)
+            _generator.Received(MessageStamp::Read(buffer));
     }
 
     void onError(int error, const std::string& category, const std::string& message) override
@@ -57,14 +67,13 @@ protected:
     }
 
 private:
-    int _messages;
+    LoadGenerator _generator;
+    std::vector<uint8_t> _message;
 
-    void SendMessage()
+    void SendMessage(uint64_t stamp)
     {
-        if (_messages-- > 0)
-            Send(message.data(), message.size());
-        else
-            Disconnect();
+        MessageStamp::Write(_message.data(), stamp);
+        Send(_message.data(), _message.size());
     }
 };
 
@@ -79,6 +88,7 @@ int main(int argc, char** argv)
     parser.add_option("-c", "--clients").action("store").type("int").set_default(100).help("Count of working clients. Default: %default");
     parser.add_option("-m", "--messages").action("store").type("int").set_default(1000000).help("Count of messages to send. Default: %default");
     parser.add_option("-s", "--size").action("store").type("int").set_default(32).help("Single message size. Default: %default");
+    parser.add_option("-r", "--rate").action("store").type("int").set_default(0).help("Target rate of messages per second of all clients (0 for the closed loop mode). Default: %default");
 
     optparse::Values options = parser.parse_args(argc, argv);
 
@@ -95,7 +105,8 @@ int main(int argc, char** argv)
     int threads_count = options.get("threads");
     int clients_count = options.get("clients");
     int messages_count = options.get("messages");
-    int message_size = options.get("size");
+    int message_size = std::max((int)options.get("size"), (int)MessageStamp::SIZE);
+    int messages_rate = options.get("rate");
 
     std::cout << "Server address: " << address << std::endl;
     std::cout << "Server port: " << port << std::endl;
@@ -103,6 +114,7 @@ int main(int argc, char** argv)
     std::cout << "Working clients: " << clients_count << std::endl;
     std::cout << "Messages to send: " << messages_count << std::endl;
     std::cout << "Message size: " << message_size << std::endl;
+    std::cout << "Messages rate: " << ((messages_rate > 0) ? std::to_string(messages_rate) + " messages per second" : "closed loop") << std::endl;
 
     // Prepare a message to send
     message.resize(message_size, 0);
@@ -121,11 +133,14 @@ int main(int argc, char** argv)
         service->Start();
     std::cout << "Done!" << std::endl;
 
+    // Create latency histograms for all Asio services
+    std::vector<LatencyHistogram> histograms(services.size());
+
     // Create echo clients
     std::vector<std::shared_ptr<EchoClient>> clients;
     for (int i = 0; i < clients_count; ++i)
     {
-        auto client = std::make_shared<EchoClient>(services[i % services.size()], address, port, messages_count / clients_count);
+        auto client = std::make_shared<EchoClient>(services[i % services.size()], histograms[i % services.size()], address, port, (double)messages_rate / clients_count, messages_count / clients_count);
         clients.emplace_back(client);
     }
 
@@ -165,5 +180,14 @@ int main(int argc, char** argv)
     std::cout << "Messages throughput: " << total_messages * 1000000000 / (timestamp_stop - timestamp_start) << " messages per second" << std::endl;
     std::cout << "Errors: " << total_errors << std::endl;
 
+    std::cout << std::endl;
+
+    // Report latency percentiles of all Asio services
+    LatencyHistogram latency;
+    for (auto& histogram : histograms)
+        latency.Merge(histogram);
+    latency.Report(std::cout);
+    std::cout << "Lost messages: " << (uint64_t)(messages_count / clients_count) * clients_count - latency.count() << std::endl;
+
     return 0;
 }
@@ -8,6 +8,9 @@
 
 #include "server/asio/asio.h"
 
+#include <array>
+#include <atomic>
+
 namespace CppServer {
 namespace Asio {
 
@@ -24,5 +27,81 @@ std::ostream& operator<<(std::ostream& stream, InternetProtocol protocol)
     }
 }
 
+std::ostream& operator<<(std::ostream& stream, ShardPolicy policy)
+{
+    switch (policy)
+    {
+        case ShardPolicy::RoundRobin:
+            return stream << "RoundRobin";
+        case ShardPolicy::LeastLoaded:
+            return stream << "LeastLoaded";
+        case ShardPolicy::ReusePort:
+            return stream << "ReusePort";
+        default:
+            return stream << "<unknown>";
+    }
+}
+
+std::ostream& operator<<(std::ostream& stream, IdPolicy policy)
+{
+    switch (policy)
+    {
+        case IdPolicy::Sequential:
+            return stream << "Sequential";
+        case IdPolicy::ShardSequential:
+            return stream << "ShardSequential";
+        case IdPolicy::UUID:
+            return stream << "UUID";
+        default:
+            return stream << "<unknown>";
+    }
+}
+
+std::ostream& operator<<(std::ostream& stream, SlowConsumerPolicy policy)
+{
+    switch (policy)
+    {
+        case SlowConsumerPolicy::Reject:
+            return stream << "Reject";
+        case SlowConsumerPolicy::DropOldest:
+            return stream << "DropOldest";
+        case SlowConsumerPolicy::Disconnect:
+            return stream << "Disconnect";
+        default:
+            return stream << "<unknown>";
+    }
+}
+
+std::ostream& operator<<(std::ostream& stream, IdleTimeout timeout)
+{
+    switch (timeout)
+    {
+        case IdleTimeout::Read:
+            return stream << "Read";
+        case IdleTimeout::Write:
+            return stream << "Write";
+        case IdleTimeout::Lifetime:
+            return stream << "Lifetime";
+        default:
+            return stream << "<unknown>";
+    }
+}
+
+uint64_t GenerateKey()
+{
+    static std::atomic<uint64_t> key(0);
+    return ++key;
+}
+
+CppCommon::UUID MakeId(uint64_t key)
+{
+    // Store the key in the big-endian order into the last UUID bytes
+    std::array<uint8_t, 16> data;
+    data.fill(0);
+    for (size_t i = 0; i < 8; ++i)
+        data[15 - i] = (uint8_t)(key >> (8 * i));
+    return CppCommon::UUID(data);
+}
+
 } // namespace Asio
 } // namespace CppServer
@@ -0,0 +1,228 @@
+/*!
+    \file buffer_pool.cpp
+    \brief Buffer pool implementation
+    \author Ivan Shynkarenka
+    \date 25.03.2017
+    \copyright MIT License
+*/
+
+#include "server/asio/buffer_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace CppServer {
+namespace Asio {
+
+BufferPool::BufferPool()
+    : _allocated(0),
+      _borrowed(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    // Free all cached buffers which are not carved from slabs
+    for (size_t i = 0; i < CLASSES; ++i)
+    {
+        if ((CHUNK << i) < SLAB)
+            continue;
+
+        for (auto buffer : _classes[i].free)
+            delete[] buffer;
+    }
+}
+
+size_t BufferPool::Capacity(size_t size) noexcept
+{
+    size_t index = Index(size);
+    return (index < CLASSES) ? (CHUNK << index) : size;
+}
+
+size_t BufferPool::Index(size_t size) noexcept
+{
+    size_t index = 0;
+    while ((index < CLASSES) && ((CHUNK << index) < size))
+        ++index;
+    return index;
+}
+
+uint8_t* BufferPool::Acquire(size_t size)
+{
+    _borrowed += size;
+
+    // Allocate too large buffers directly
+    size_t index = Index(size);
+    if (index == CLASSES)
+    {
+        _allocated += size;
+        return new uint8_t[size];
+    }
+
+    SizeClass& size_class = _classes[index];
+    std::lock_guard<std::mutex> locker(size_class.lock);
+
+    // Allocate large size class buffers separately
+    if (size >= SLAB)
+    {
+        // Reuse a cached buffer
+        if (!size_class.free.empty())
+        {
+            uint8_t* buffer = size_class.free.back();
+            size_class.free.pop_back();
+            return buffer;
+        }
+
+        _allocated += size;
+        return new uint8_t[size];
+    }
+
+    // Carve a new slab into free buffers
+    if (size_class.partial.empty())
+    {
+        uint8_t* memory = new uint8_t[SLAB];
+        _allocated += SLAB;
+        Slab& slab = size_class.slabs[memory];
+        slab.memory.reset(memory);
+        for (size_t offset = SLAB; offset >= size; offset -= size)
+            slab.free.push_back(memory + offset - size);
+        AddPartial(size_class, slab);
+        ++size_class.empty;
+    }
+
+    // Lend a free buffer of the most recently used slab
+    Slab& slab = *size_class.partial.back();
+    if (slab.free.size() == (SLAB / size))
+        --size_class.empty;
+    uint8_t* buffer = slab.free.back();
+    slab.free.pop_back();
+    if (slab.free.empty())
+        RemovePartial(size_class, slab);
+    return buffer;
+}
+
+void BufferPool::Release(uint8_t* buffer, size_t size)
+{
+    if (buffer == nullptr)
+        return;
+
+    _borrowed -= size;
+
+    // Free too large buffers directly
+    size_t index = Index(size);
+    if (index == CLASSES)
+    {
+        _allocated -= size;
+        delete[] buffer;
+        return;
+    }
+
+    SizeClass& size_class = _classes[index];
+    std::lock_guard<std::mutex> locker(size_class.lock);
+
+    // Free large size class buffers over the cache limit
+    if (size >= SLAB)
+    {
+        if (size_class.free.size() >= CACHED)
+        {
+            _allocated -= size;
+            delete[] buffer;
+        }
+        else
+            size_class.free.push_back(buffer);
+        return;
+    }
+
+    // Find the slab of the buffer
+    auto it = size_class.slabs.upper_bound(buffer);
+    assert((it != size_class.slabs.begin()) && "Buffer is not carved from slabs of the pool!");
+    Slab& slab = (--it)->second;
+
+    if (slab.free.empty())
+        AddPartial(size_class, slab);
+    slab.free.push_back(buffer);
+
+    // Return the fully free slab to the heap over the retention limit
+    if (slab.free.size() == (SLAB / size))
+    {
+        if (size_class.empty >= RETAINED)
+        {
+            RemovePartial(size_class, slab);
+            size_class.slabs.erase(it);
+            _allocated -= SLAB;
+        }
+        else
+            ++size_class.empty;
+    }
+}
+
+void BufferPool::AddPartial(SizeClass& size_class, Slab& slab)
+{
+    slab.index = size_class.partial.size();
+    size_class.partial.push_back(&slab);
+}
+
+void BufferPool::RemovePartial(SizeClass& size_class, Slab& slab)
+{
+    Slab* last = size_class.partial.back();
+    last->index = slab.index;
+    size_class.partial[slab.index] = last;
+    size_class.partial.pop_back();
+}
+
+void ReceiveBuffer::Acquire(BufferPool& pool)
+{
+    if (_data != nullptr)
+        return;
+
+    _pool = &pool;
+    _size = BufferPool::Capacity(_capacity);
+    _data = _pool->Acquire(_size);
+}
+
+void ReceiveBuffer::Release()
+{
+    if (_data == nullptr)
+        return;
+
+    _pool->Release(_data, _size);
+    _data = nullptr;
+    _size = 0;
+}
+
+void ReceiveBuffer::Update(size_t size)
+{
+    // Grow the buffer after the full read
+    if (size == _size)
+    {
+        _peak = 0;
+        _reads = 0;
+        Reacquire(2 * _size);
+        return;
+    }
+
+    // Shrink the buffer back if the whole window of reads used only a quarter of it
+    _peak = std::max(_peak, size);
+    if (++_reads < WINDOW)
+        return;
+
+    if ((_size > CHUNK) && ((4 * _peak) <= _size))
+        Reacquire(std::max(CHUNK, 2 * _peak));
+
+    _peak = 0;
+    _reads = 0;
+}
+
+void ReceiveBuffer::Reacquire(size_t capacity)
+{
+    _capacity = BufferPool::Capacity(capacity);
+    if (_data == nullptr)
+        return;
+
+    BufferPool& pool = *_pool;
+    Release();
+    Acquire(pool);
+}
+
+} // namespace Asio
+} // namespace CppServer
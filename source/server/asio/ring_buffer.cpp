@@ -0,0 +1,169 @@
+/*!
+    \file ring_buffer.cpp
+    \brief Ring buffer implementation
+    \author Ivan Shynkarenka
+    \date 30.03.2017
+    \copyright MIT License
+*/
+
+#include "server/asio/ring_buffer.h"
+
+#include "errors/exceptions.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(linux) || defined(__linux) || defined(__linux__)
+#include <sys/mman.h>
+#endif
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace CppServer {
+namespace Asio {
+
+RingBuffer::RingBuffer(RingBuffer&& buffer) noexcept
+    : _buffer(buffer._buffer),
+      _capacity(buffer._capacity),
+      _mirrored(buffer._mirrored),
+      _head(buffer._head),
+      _size(buffer._size)
+{
+    buffer._buffer = nullptr;
+    buffer._mirrored = false;
+    buffer._head = 0;
+    buffer._size = 0;
+}
+
+RingBuffer& RingBuffer::operator=(RingBuffer&& buffer) noexcept
+{
+    if (this != &buffer)
+    {
+        Unmap();
+        _buffer = buffer._buffer;
+        _capacity = buffer._capacity;
+        _mirrored = buffer._mirrored;
+        _head = buffer._head;
+        _size = buffer._size;
+        buffer._buffer = nullptr;
+        buffer._mirrored = false;
+        buffer._head = 0;
+        buffer._size = 0;
+    }
+    return *this;
+}
+
+void RingBuffer::Setup(size_t capacity)
+{
+    Unmap();
+    Clear();
+
+    // Both copies of the mirrored ring should be aligned to the memory page
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    size_t page = (size_t)::sysconf(_SC_PAGESIZE);
+#else
+    size_t page = 4096;
+#endif
+    _capacity = ((capacity + page - 1) / page) * page;
+}
+
+asio::mutable_buffer RingBuffer::Prepare()
+{
+    if (_capacity == 0)
+        return asio::mutable_buffer();
+
+    if (_buffer == nullptr)
+        Map();
+
+    // Move the unconsumed data to the beginning of the linear buffer
+    if (!_mirrored && (_head > 0))
+    {
+        std::memmove(_buffer, _buffer + _head, _size);
+        _head = 0;
+    }
+
+    return asio::mutable_buffer(_buffer + _head + _size, _capacity - _size);
+}
+
+void RingBuffer::Commit(size_t size)
+{
+    assert((size <= (_capacity - _size)) && "Committed size should not be greater than the free space of the ring!");
+    if (size > (_capacity - _size))
+        throw CppCommon::ArgumentException("Committed size should not be greater than the free space of the ring!");
+
+    _size += size;
+}
+
+void RingBuffer::Consume(size_t size)
+{
+    assert((size <= _size) && "Consumed size should not be greater than the unconsumed data size!");
+    if (size > _size)
+        throw CppCommon::ArgumentException("Consumed size should not be greater than the unconsumed data size!");
+
+    _size -= size;
+    _head += size;
+
+    // Start from the beginning of the ring when all data is consumed
+    if (_size == 0)
+        _head = 0;
+    else if (_head >= _capacity)
+        _head -= _capacity;
+}
+
+void RingBuffer::Map()
+{
+#if defined(linux) || defined(__linux) || defined(__linux__)
+    int fd = ::memfd_create("cppserver-ring", MFD_CLOEXEC);
+    if (fd >= 0)
+    {
+        if (::ftruncate(fd, (off_t)_capacity) == 0)
+        {
+            // Reserve the address space for both copies of the ring
+            void* address = ::mmap(nullptr, 2 * _capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (address != MAP_FAILED)
+            {
+                // Map the same memory file into both halves of the reserved space
+                uint8_t* buffer = (uint8_t*)address;
+                if ((::mmap(buffer, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED) &&
+                    (::mmap(buffer + _capacity, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED))
+                {
+                    _buffer = buffer;
+                    _mirrored = true;
+                }
+                else
+                    ::munmap(address, 2 * _capacity);
+            }
+        }
+
+        // Mappings keep the memory file alive
+        ::close(fd);
+    }
+    if (_mirrored)
+        return;
+#endif
+
+    // Fall back to the linear buffer
+    _buffer = new uint8_t[_capacity];
+}
+
+void RingBuffer::Unmap()
+{
+    if (_buffer == nullptr)
+        return;
+
+#if defined(linux) || defined(__linux) || defined(__linux__)
+    if (_mirrored)
+        ::munmap(_buffer, 2 * _capacity);
+    else
+        delete[] _buffer;
+#else
+    delete[] _buffer;
+#endif
+
+    _buffer = nullptr;
+    _mirrored = false;
+}
+
+} // namespace Asio
+} // namespace CppServer
@@ -0,0 +1,444 @@
+/*!
+    \file send_queue.cpp
+    \brief Send queue implementation
+    \author Ivan Shynkarenka
+    \date 21.03.2017
+    \copyright MIT License
+*/
+
+#include "server/asio/send_queue.h"
+
+#include <cstring>
+#include <new>
+
+namespace CppServer {
+namespace Asio {
+
+SendQueue::~SendQueue()
+{
+    // Release all nodes left in the producers list
+    Clear();
+}
+
+size_t SendQueue::Push(const void* buffer, size_t size)
+{
+    if (size == 0)
+        return _size;
+
+    // Copy large buffers into their own shared buffer
+    if (size > CHUNK)
+        return Push(SharedBuffer(buffer, size));
+
+    // Create a new node with the copied bytes
+    Node* node = new (::operator new(sizeof(Node) + size)) Node();
+    node->size = size;
+    std::memcpy(node->data(), buffer, size);
+
+    size_t result = Increase(size);
+    Link(node);
+    return result;
+}
+
+size_t SendQueue::Push(const SharedBuffer& buffer)
+{
+    if (buffer.empty())
+        return _size;
+
+    // Create a new node with the shared buffer
+    Node* node = new (::operator new(sizeof(Node))) Node();
+    node->shared = buffer;
+    node->size = buffer.size();
+
+    size_t result = Increase(buffer.size());
+    Link(node);
+    return result;
+}
+
+size_t SendQueue::Push(const SharedFile& file, uint64_t offset, size_t size)
+{
+    if (!file || (size == 0))
+        return _size;
+
+    // Create a new node with the file region
+    Node* node = new (::operator new(sizeof(Node))) Node();
+    node->file = file;
+    node->offset = offset;
+    node->size = size;
+
+    size_t result = Increase(size, true);
+    Link(node);
+    return result;
+}
+
+size_t SendQueue::PushDirect(const void* buffer, size_t size)
+{
+    if (size == 0)
+        return _size;
+
+    // Keep the order with buffers pushed by producers
+    Drain();
+
+    // Copy large buffers into their own shared buffer
+    if (size > CHUNK)
+        Append(SharedBuffer(buffer, size));
+    else
+        Append(buffer, size);
+
+    return Increase(size);
+}
+
+size_t SendQueue::PushDirect(const SharedBuffer& buffer)
+{
+    if (buffer.empty())
+        return _size;
+
+    // Keep the order with buffers pushed by producers
+    Drain();
+
+    Append(buffer);
+
+    return Increase(buffer.size());
+}
+
+size_t SendQueue::PushDirect(const SharedFile& file, uint64_t offset, size_t size)
+{
+    if (!file || (size == 0))
+        return _size;
+
+    // Keep the order with buffers pushed by producers
+    Drain();
+
+    Append(file, offset, size);
+
+    return Increase(size, true);
+}
+
+bool SendQueue::Flush()
+{
+    // Check if the flush part is still pending
+    if (_flush_offset < _flush_size)
+        return true;
+
+    // Drain the producers list into the main part
+    Drain();
+
+    // Check if the main part is empty
+    if (_main_segments.empty())
+        return false;
+
+    _flush_size = 0;
+    _flush_offset = 0;
+
+    // Flush the oldest file region alone
+    if (_main_segments.front().file)
+    {
+        const Segment& segment = _main_segments.front();
+        _flush_file = _main_files[segment.index].file;
+        _flush_file_offset = _main_files[segment.index].offset;
+        _flush_size = segment.size;
+        Remove(1);
+        return true;
+    }
+
+    // Find buffers queued before the first file region
+    size_t count = _main_segments.size();
+    if (!_main_files.empty())
+    {
+        count = 0;
+        while (!_main_segments[count].file)
+            ++count;
+    }
+
+    if (count == _main_segments.size())
+    {
+        // Swap flush and main parts
+        _flush_bytes.swap(_main_bytes);
+        _flush_shared.swap(_main_shared);
+    }
+    else
+    {
+        // Copy buffers queued before the file region
+        size_t bytes = 0;
+        size_t shared = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (_main_segments[i].shared)
+                ++shared;
+            else
+                bytes += _main_segments[i].size;
+        }
+        _flush_bytes.assign(_main_bytes.begin(), _main_bytes.begin() + bytes);
+        _flush_shared.assign(_main_shared.begin(), _main_shared.begin() + shared);
+    }
+
+    // Prepare the flush buffers sequence
+    _flush_buffers.clear();
+    _flush_buffers.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Segment& segment = _main_segments[i];
+        if (segment.shared)
+            _flush_buffers.push_back(_flush_shared[segment.index].buffer());
+        else
+            _flush_buffers.push_back(asio::const_buffer(_flush_bytes.data() + segment.index, segment.size));
+        _flush_size += segment.size;
+    }
+
+    // Clear the main part
+    if (count == _main_segments.size())
+    {
+        _main_bytes.clear();
+        _main_shared.clear();
+        _main_segments.clear();
+    }
+    else
+        Remove(count);
+
+    return true;
+}
+
+std::shared_ptr<const void> SendQueue::Pin()
+{
+    if (!_flush_holder)
+    {
+        // Moved vectors keep their storage, so the flush buffers sequence stays valid
+        auto pinned = std::make_shared<Pinned>();
+        pinned->bytes = std::move(_flush_bytes);
+        pinned->shared = std::move(_flush_shared);
+        _flush_bytes.clear();
+        _flush_shared.clear();
+        _flush_holder = pinned;
+    }
+    return _flush_holder;
+}
+
+bool SendQueue::Consume(size_t size)
+{
+    Decrease(size, _flush_file.valid());
+    _flush_offset += size;
+
+    // Successfully written the whole flush part
+    if (_flush_offset >= _flush_size)
+    {
+        _flush_bytes.clear();
+        _flush_shared.clear();
+        _flush_buffers.clear();
+        _flush_size = 0;
+        _flush_offset = 0;
+        _flush_file = SharedFile();
+        _flush_file_offset = 0;
+        _flush_holder.reset();
+        return true;
+    }
+
+    // Skip written buffers from the flush buffers sequence
+    auto it = _flush_buffers.begin();
+    while ((size > 0) && (it != _flush_buffers.end()))
+    {
+        size_t buffer_size = asio::buffer_size(*it);
+        if (size < buffer_size)
+        {
+            *it = *it + size;
+            break;
+        }
+        size -= buffer_size;
+        ++it;
+    }
+    _flush_buffers.erase(_flush_buffers.begin(), it);
+
+    return false;
+}
+
+size_t SendQueue::Drop(size_t size)
+{
+    // Keep the order with buffers pushed by producers
+    Drain();
+
+    // Find the oldest segments to drop
+    size_t dropped = 0;
+    size_t files = 0;
+    size_t count = 0;
+    while ((dropped < size) && (count < _main_segments.size()))
+    {
+        const Segment& segment = _main_segments[count++];
+        if (segment.file)
+            files += segment.size;
+        else
+            dropped += segment.size;
+    }
+
+    // Keep file regions which are not followed by dropped buffers
+    while ((count > 0) && _main_segments[count - 1].file)
+        files -= _main_segments[--count].size;
+    if (count == 0)
+        return 0;
+
+    Remove(count);
+
+    Decrease(dropped);
+    Decrease(files, true);
+    return dropped + files;
+}
+
+size_t SendQueue::Clear()
+{
+    size_t pending = 0;
+    size_t files = 0;
+
+    // Release the producers list
+    Node* node = _head.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr)
+    {
+        Node* next = node->next;
+        if (node->file)
+            files += node->size;
+        else
+            pending += node->size;
+        node->~Node();
+        ::operator delete(node);
+        node = next;
+    }
+
+    // Clear main and flush parts
+    for (auto& segment : _main_segments)
+    {
+        if (segment.file)
+            files += segment.size;
+        else
+            pending += segment.size;
+    }
+    if (_flush_file)
+        files += _flush_size - _flush_offset;
+    else
+        pending += _flush_size - _flush_offset;
+    Decrease(pending);
+    Decrease(files, true);
+
+    _main_bytes.clear();
+    _main_shared.clear();
+    _main_files.clear();
+    _main_segments.clear();
+    _flush_bytes.clear();
+    _flush_shared.clear();
+    _flush_buffers.clear();
+    _flush_size = 0;
+    _flush_offset = 0;
+    _flush_file = SharedFile();
+    _flush_file_offset = 0;
+    _flush_holder.reset();
+
+    return pending + files;
+}
+
+size_t SendQueue::Increase(size_t size, bool file)
+{
+    if (file)
+        _files += size;
+    else if (_total != nullptr)
+        *_total += size;
+    return (_size += size);
+}
+
+void SendQueue::Decrease(size_t size, bool file)
+{
+    if (file)
+        _files -= size;
+    else if (_total != nullptr)
+        *_total -= size;
+    _size -= size;
+}
+
+void SendQueue::Link(Node* node)
+{
+    Node* head = _head.load(std::memory_order_relaxed);
+    do
+    {
+        node->next = head;
+    } while (!_head.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void SendQueue::Drain()
+{
+    // Take all nodes from the producers list at once
+    Node* node = _head.exchange(nullptr, std::memory_order_acquire);
+    if (node == nullptr)
+        return;
+
+    // Reverse the list to restore the order of pushes
+    Node* reversed = nullptr;
+    while (node != nullptr)
+    {
+        Node* next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+    }
+
+    // Move nodes into the main part
+    node = reversed;
+    while (node != nullptr)
+    {
+        Node* next = node->next;
+        if (node->file)
+            Append(node->file, node->offset, node->size);
+        else if (!node->shared.empty())
+            Append(node->shared);
+        else
+            Append(node->data(), node->size);
+        node->~Node();
+        ::operator delete(node);
+        node = next;
+    }
+}
+
+void SendQueue::Append(const void* buffer, size_t size)
+{
+    // Coalesce with the previous copied segment
+    if (!_main_segments.empty() && !_main_segments.back().shared && !_main_segments.back().file)
+        _main_segments.back().size += size;
+    else
+        _main_segments.push_back(Segment{ _main_bytes.size(), size, false, false });
+
+    const uint8_t* bytes = (const uint8_t*)buffer;
+    _main_bytes.insert(_main_bytes.end(), bytes, bytes + size);
+}
+
+void SendQueue::Append(const SharedBuffer& buffer)
+{
+    _main_segments.push_back(Segment{ _main_shared.size(), buffer.size(), true, false });
+    _main_shared.push_back(buffer);
+}
+
+void SendQueue::Append(const SharedFile& file, uint64_t offset, size_t size)
+{
+    _main_segments.push_back(Segment{ _main_files.size(), size, false, true });
+    _main_files.push_back(FileRegion{ file, offset });
+}
+
+void SendQueue::Remove(size_t count)
+{
+    size_t bytes = 0;
+    size_t shared = 0;
+    size_t files = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Segment& segment = _main_segments[i];
+        if (segment.file)
+            ++files;
+        else if (segment.shared)
+            ++shared;
+        else
+            bytes += segment.size;
+    }
+
+    // Removed segments are always at the beginning of the main part storages
+    _main_bytes.erase(_main_bytes.begin(), _main_bytes.begin() + bytes);
+    _main_shared.erase(_main_shared.begin(), _main_shared.begin() + shared);
+    _main_files.erase(_main_files.begin(), _main_files.begin() + files);
+    _main_segments.erase(_main_segments.begin(), _main_segments.begin() + count);
+    for (auto& segment : _main_segments)
+        segment.index -= segment.file ? files : (segment.shared ? shared : bytes);
+}
+
+} // namespace Asio
+} // namespace CppServer
@@ -9,22 +9,157 @@
 #include "server/asio/service.h"
 
 #include "errors/fatal.h"
+#include "time/timestamp.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+#if defined(linux) || defined(__linux) || defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#elif defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#endif
 
 namespace CppServer {
 namespace Asio {
 
-Service::Service()
-    : _service(std::make_shared<asio::io_service>()),
-      _started(false)
+//! Service thread instrument
+/*!
+    Service thread instrument is updated only by its working thread.
+*/
+struct Service::Instrument
+{
+    // Busy and idle time
+    std::atomic<uint64_t> busy_time;
+    std::atomic<uint64_t> idle_time;
+    // Handlers run time, queue depth and loop lag histograms
+    ServiceHistogramRecorder handler_time;
+    ServiceHistogramRecorder queue_depth;
+    ServiceHistogramRecorder loop_lag;
+
+    // Sampling window of the thread CPU clock
+    bool window;
+    bool window_cpu_valid;
+    uint64_t window_time;
+    uint64_t window_cpu;
+    uint64_t window_busy;
+
+    Instrument() : busy_time(0), idle_time(0), window(false), window_cpu_valid(false), window_time(0), window_cpu(0), window_busy(0) {}
+
+    void Handler(uint64_t time) noexcept
+    {
+        handler_time.Record(time);
+    }
+
+    void Busy(uint64_t time) noexcept
+    {
+        busy_time.store(busy_time.load(std::memory_order_relaxed) + time, std::memory_order_relaxed);
+    }
+
+    void Idle(uint64_t time) noexcept
+    {
+        idle_time.store(idle_time.load(std::memory_order_relaxed) + time, std::memory_order_relaxed);
+    }
+
+    void Reset() noexcept
+    {
+        busy_time.store(0, std::memory_order_relaxed);
+        idle_time.store(0, std::memory_order_relaxed);
+        handler_time.Reset();
+        queue_depth.Reset();
+        loop_lag.Reset();
+        window = false;
+    }
+
+    void Open(uint64_t time, uint64_t cpu, bool cpu_valid) noexcept
+    {
+        window = true;
+        window_cpu_valid = cpu_valid;
+        window_time = time;
+        window_cpu = cpu;
+        window_busy = 0;
+    }
+
+    void Close(uint64_t time, uint64_t cpu, bool cpu_valid) noexcept
+    {
+        if (!window)
+            return;
+
+        // Split the window into busy and idle time with the thread CPU clock
+        // or with run time of polled handlers if the clock is not available
+        uint64_t elapsed = time - window_time;
+        uint64_t busy = (cpu_valid && window_cpu_valid) ? (cpu - window_cpu) : window_busy;
+        busy = std::min(busy, elapsed);
+        Busy(busy);
+        Idle(elapsed - busy);
+        window = false;
+    }
+};
+
+namespace {
+
+// Sampling interval of the thread CPU clock in nanoseconds
+const uint64_t SAMPLE_INTERVAL = 1000000;
+
+// Get the CPU time of the current thread in nanoseconds
+bool ThreadTime(uint64_t& time) noexcept
+{
+#if (defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)) && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec timestamp;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &timestamp) != 0)
+        return false;
+    time = (uint64_t)timestamp.tv_sec * 1000000000 + (uint64_t)timestamp.tv_nsec;
+    return true;
+#else
+    (void)time;
+    return false;
+#endif
+}
+
+} // namespace
+
+Service::Service(int threads)
+    : _service(std::make_shared<asio::io_service>(threads)),
+      _threads_count(threads),
+      _started(false),
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _probe_interval(0),
+      _spin_budget(0),
+      _zero_copy_timer([this]() { PollZeroCopy(); }),
+      _timer_resolution(100),
+      _timer_time(0),
+      _timer_start(asio::steady_timer::clock_type::now()),
+      _timer_chain(0),
+      _timer_ticking(false)
 {
     assert((_service != nullptr) && "ASIO service is invalid!");
     if (_service == nullptr)
         throw CppCommon::ArgumentException("ASIO service is invalid!");
+
+    assert((threads > 0) && "Working threads count should be greater than zero!");
+    if (threads <= 0)
+        throw CppCommon::ArgumentException("Working threads count should be greater than zero!");
 }
 
 Service::Service(std::shared_ptr<asio::io_service> service)
     : _service(service),
-      _started(false)
+      _threads_count(1),
+      _started(false),
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _probe_interval(0),
+      _spin_budget(0),
+      _zero_copy_timer([this]() { PollZeroCopy(); }),
+      _timer_resolution(100),
+      _timer_time(0),
+      _timer_start(asio::steady_timer::clock_type::now()),
+      _timer_chain(0),
+      _timer_ticking(false)
 {
     assert((_service != nullptr) && "ASIO service is invalid!");
     if (_service == nullptr)
@@ -33,28 +168,256 @@ Service::Service(std::shared_ptr<asio::io_service> service)
     _started = !service->stopped();
 }
 
+BufferPool& Service::buffer_pool() noexcept
+{
+    // Pinned working threads lend buffers from their local buffer pools
+    WorkingThread& thread = CurrentThread();
+    if ((thread.service == this) && !_affinity.empty() && (thread.index < _buffer_pools.size()) && _buffer_pools[thread.index])
+        return *_buffer_pools[thread.index];
+
+    return *_buffer_pool;
+}
+
+ServiceStatistics Service::statistics() const
+{
+    ServiceStatistics result;
+    for (auto& instrument : _instruments)
+    {
+        ServiceThreadStatistics thread;
+        thread.busy_time = instrument->busy_time.load(std::memory_order_relaxed);
+        thread.idle_time = instrument->idle_time.load(std::memory_order_relaxed);
+        instrument->handler_time.Collect(thread.handler_time);
+        instrument->queue_depth.Collect(thread.queue_depth);
+        instrument->loop_lag.Collect(thread.loop_lag);
+        result.total += thread;
+        result.threads.push_back(thread);
+    }
+    return result;
+}
+
+void Service::SetupInstrumentation(bool enable, int probe_interval)
+{
+    assert(!IsStarted() && "Asio service instrumentation should be setup before the service is started!");
+    if (IsStarted())
+        throw CppCommon::ArgumentException("Asio service instrumentation should be setup before the service is started!");
+
+    assert((probe_interval >= 0) && "Loop lag probe interval should not be negative!");
+    if (probe_interval < 0)
+        throw CppCommon::ArgumentException("Loop lag probe interval should not be negative!");
+
+    _instruments.clear();
+    _probe_interval = enable ? probe_interval : 0;
+
+    // Create instruments for all service working threads
+    if (enable)
+        for (int i = 0; i < _threads_count; ++i)
+            _instruments.emplace_back(std::make_shared<Instrument>());
+}
+
+void Service::SetupAdaptivePolling(int spin_budget)
+{
+    assert(!IsStarted() && "Asio service adaptive polling should be setup before the service is started!");
+    if (IsStarted())
+        throw CppCommon::ArgumentException("Asio service adaptive polling should be setup before the service is started!");
+
+    assert((spin_budget >= 0) && "Spin budget should not be negative!");
+    if (spin_budget < 0)
+        throw CppCommon::ArgumentException("Spin budget should not be negative!");
+
+    _spin_budget = spin_budget;
+}
+
+void Service::SetupAffinity(const std::vector<CPUSet>& affinity)
+{
+    assert(!IsStarted() && "Asio service affinity should be setup before the service is started!");
+    if (IsStarted())
+        throw CppCommon::ArgumentException("Asio service affinity should be setup before the service is started!");
+
+    for (auto& cores : affinity)
+    {
+        assert(!cores.empty() && "CPU core set should not be empty!");
+        if (cores.empty())
+            throw CppCommon::ArgumentException("CPU core set should not be empty!");
+
+        for (int core : cores)
+        {
+            assert((core >= 0) && "CPU core index should not be negative!");
+            if (core < 0)
+                throw CppCommon::ArgumentException("CPU core index should not be negative!");
+        }
+    }
+
+    _affinity = affinity;
+
+    // Local buffer pools are never destroyed before the service, because
+    // receive buffers lent from them could be released after the service stop
+    if (!_affinity.empty() && (_buffer_pools.size() < (size_t)_threads_count))
+        _buffer_pools.resize(_threads_count);
+}
+
+void Service::SetupTimingWheel(int resolution)
+{
+    assert(!IsStarted() && "Asio service timing wheel should be setup before the service is started!");
+    if (IsStarted())
+        throw CppCommon::ArgumentException("Asio service timing wheel should be setup before the service is started!");
+
+    assert((resolution > 0) && "Timing wheel resolution should be greater than zero!");
+    if (resolution <= 0)
+        throw CppCommon::ArgumentException("Timing wheel resolution should be greater than zero!");
+
+    std::lock_guard<std::mutex> locker(_timer_lock);
+
+    assert(_timer_wheel.empty() && "Timing wheel should be setup before any timer is armed!");
+    if (!_timer_wheel.empty())
+        throw CppCommon::ArgumentException("Timing wheel should be setup before any timer is armed!");
+
+    _timer_resolution = resolution;
+}
+
+void Service::ArmTimer(TimingWheel::Timer& timer, uint64_t timeout)
+{
+    std::lock_guard<std::mutex> locker(_timer_lock);
+
+    // Refresh the coarse time and move the idle wheel to the current tick
+    uint64_t now = TimerTick();
+    _timer_time.store(now * _timer_resolution, std::memory_order_relaxed);
+    if (_timer_wheel.empty())
+        _timer_wheel.Advance(now);
+
+    // Round up the timeout to the timing wheel ticks
+    uint64_t ticks = std::max((timeout + _timer_resolution - 1) / _timer_resolution, (uint64_t)1);
+    _timer_wheel.Arm(timer, std::max(now, _timer_wheel.now()) + ticks);
+
+    if (!_timer_ticking)
+        StartTicking();
+}
+
+bool Service::CancelTimer(TimingWheel::Timer& timer)
+{
+    std::lock_guard<std::mutex> locker(_timer_lock);
+    return _timer_wheel.Cancel(timer);
+}
+
+void Service::LingerZeroCopy(ZeroCopy& zero_copy, asio::ip::tcp::socket& socket)
+{
+    // Start polling when the first socket lingers
+    if (zero_copy.Linger(socket, _zero_copy_linger))
+        ArmTimer(_zero_copy_timer, _timer_resolution);
+}
+
+std::vector<Service::CPUSet> Service::PhysicalCores()
+{
+    std::vector<CPUSet> result;
+
+#if defined(linux) || defined(__linux) || defined(__linux__)
+    // Logical cores allowed for the process
+    int count = std::max((int)::sysconf(_SC_NPROCESSORS_CONF), 1);
+    cpu_set_t* allowed = CPU_ALLOC(count);
+    size_t size = CPU_ALLOC_SIZE(count);
+    bool restricted = (::sched_getaffinity(0, size, allowed) == 0);
+
+    // Group logical cores by the package and the first hyper-thread sibling
+    std::map<std::pair<int, int>, CPUSet> cores;
+    for (int i = 0; i < count; ++i)
+    {
+        if (restricted && !CPU_ISSET_S(i, size, allowed))
+            continue;
+
+        int package = -1;
+        int core = i;
+        char path[128];
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", i);
+        FILE* file = std::fopen(path, "r");
+        if (file != nullptr)
+        {
+            if (std::fscanf(file, "%d", &package) != 1)
+                package = -1;
+            std::fclose(file);
+        }
+        // Siblings list starts with the lowest sibling, e.g. "0,4" or "0-1"
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", i);
+        file = std::fopen(path, "r");
+        if (file != nullptr)
+        {
+            if (std::fscanf(file, "%d", &core) != 1)
+                core = i;
+            std::fclose(file);
+        }
+
+        cores[std::make_pair(package, core)].push_back(i);
+    }
+    CPU_FREE(allowed);
+
+    for (auto& core : cores)
+        result.push_back(core.second);
+#elif defined(_WIN32) || defined(_WIN64)
+    DWORD length = 0;
+    ::GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length);
+    std::vector<uint8_t> buffer(length);
+    if ((length > 0) && ::GetLogicalProcessorInformationEx(RelationProcessorCore, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)buffer.data(), &length))
+    {
+        for (DWORD offset = 0; offset < length;)
+        {
+            auto info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(buffer.data() + offset);
+            CPUSet cores;
+            for (WORD group = 0; group < info->Processor.GroupCount; ++group)
+                for (int i = 0; i < (int)(sizeof(KAFFINITY) * 8); ++i)
+                    if (info->Processor.GroupMask[group].Mask & ((KAFFINITY)1 << i))
+                        cores.push_back(info->Processor.GroupMask[group].Group * 64 + i);
+            if (!cores.empty())
+                result.push_back(cores);
+            offset += info->Size;
+        }
+    }
+#endif
+
+    // Fall back to a single logical core for each core set
+    if (result.empty())
+        for (int i = 0; i < std::max(CppCommon::CPU::LogicalCores(), 1); ++i)
+            result.push_back({ i });
+
+    return result;
+}
+
 bool Service::Start(bool polling)
 {
     assert(!IsStarted() && "Asio service is already started!");
     if (IsStarted())
         return false;
 
+    // Reset instruments
+    for (auto& instrument : _instruments)
+        instrument->Reset();
+
+    // Create the loop lag probe timer
+    if (_probe_interval > 0)
+        _probe_timer = std::make_shared<asio::steady_timer>(*_service);
+
+    // Resume ticking the timing wheel with timers armed before the start
+    {
+        std::lock_guard<std::mutex> locker(_timer_lock);
+        if (!_timer_wheel.empty() && !_timer_ticking)
+            StartTicking();
+    }
+
+    // Update the started flag before working threads start, polling loops run while it is set
+    _started = true;
+
     // Post the started routine
     auto self(this->shared_from_this());
     _service->post([this, self]()
     {
-        if (IsStarted())
-            return;
-
-         // Update the started flag
-        _started = true;
+        // Start loop lag probes
+        if (_probe_timer)
+            Probe();
 
         // Call the service started handler
         onStarted();
     });
 
-    // Start the service thread
-    _thread = CppCommon::Thread::Start([this, polling]() { ServiceLoop(polling); });
+    // Start service working threads
+    for (int i = 0; i < _threads_count; ++i)
+        _threads.emplace_back(CppCommon::Thread::Start([this, polling, i]() { ServiceLoop(polling, (size_t)i); }));
 
     return true;
 }
@@ -72,6 +435,25 @@ bool Service::Stop()
         if (!IsStarted())
             return;
 
+        // Stop loop lag probes
+        if (_probe_timer)
+        {
+            asio::error_code ec;
+            _probe_timer->cancel(ec);
+        }
+
+        // Stop ticking the timing wheel
+        {
+            std::lock_guard<std::mutex> locker(_timer_lock);
+            ++_timer_chain;
+            _timer_ticking = false;
+            if (_timer_ticker)
+            {
+                asio::error_code ec;
+                _timer_ticker->cancel(ec);
+            }
+        }
+
         // Stop the Asio service
         _service->stop();
 
@@ -82,8 +464,13 @@ bool Service::Stop()
         onStopped();
     });
 
-    // Wait for service thread
-    _thread.join();
+    // Wait for all service working threads
+    for (auto& thread : _threads)
+        thread.join();
+    _threads.clear();
+
+    // Destroy the loop lag probe timer
+    _probe_timer.reset();
 
     return true;
 }
@@ -96,11 +483,31 @@ bool Service::Restart()
     return Start();
 }
 
-void Service::ServiceLoop(bool polling)
+void Service::ServiceLoop(bool polling, size_t thread)
 {
+    CurrentThread() = { this, thread };
+
+    // Pin the working thread and create its local buffer pool after pinning,
+    // so the pool memory is allocated on the local NUMA node
+    if (!_affinity.empty())
+    {
+        std::error_code ec = PinThread(_affinity[thread % _affinity.size()]);
+        if (ec)
+            SendError(ec);
+        if ((thread < _buffer_pools.size()) && !_buffer_pools[thread])
+            _buffer_pools[thread] = std::make_shared<BufferPool>();
+    }
+
     // Call the initialize thread handler
     onThreadInitialize();
 
+    // Instrument of the service thread
+    Instrument* instrument = (thread < _instruments.size()) ? _instruments[thread].get() : nullptr;
+
+    // Spin budget and the last activity time of the adaptive polling mode
+    const uint64_t spin_budget = (uint64_t)_spin_budget * 1000;
+    uint64_t activity = CppCommon::Timestamp::nano();
+
     try
     {
         asio::io_service::work work(*_service);
@@ -114,15 +521,42 @@ void Service::ServiceLoop(bool polling)
                 if (polling)
                 {
                     // Poll all pending handlers
-                    _service->poll();
+                    size_t count = (instrument != nullptr) ? PollInstrumented(*instrument) : _service->poll();
+
+                    // Block until the next ready handler if the spin budget is exhausted
+                    if (spin_budget > 0)
+                    {
+                        uint64_t timestamp = CppCommon::Timestamp::nano();
+                        if (count > 0)
+                            activity = timestamp;
+                        else if ((timestamp - activity) >= spin_budget)
+                        {
+                            if (instrument != nullptr)
+                                WaitInstrumented(*instrument, false);
+                            else
+                                _service->run_one();
+                            activity = CppCommon::Timestamp::nano();
+                            continue;
+                        }
+                    }
 
                     // Call the idle handler
-                    onIdle();
+                    if (instrument != nullptr)
+                    {
+                        uint64_t timestamp = CppCommon::Timestamp::nano();
+                        onIdle();
+                        instrument->Idle(CppCommon::Timestamp::nano() - timestamp);
+                    }
+                    else
+                        onIdle();
                 }
                 else
                 {
                     // Run all pending handlers
-                    _service->run();
+                    if (instrument != nullptr)
+                        while (WaitInstrumented(*instrument, true) > 0);
+                    else
+                        _service->run();
                     break;
                 }
             }
@@ -153,6 +587,212 @@ void Service::ServiceLoop(bool polling)
 
     // Call the cleanup thread handler
     onThreadCleanup();
+
+    CurrentThread() = { nullptr, 0 };
+}
+
+size_t Service::WaitInstrumented(Instrument& instrument, bool contiguous)
+{
+    uint64_t start = CppCommon::Timestamp::nano();
+
+    // Contiguous waits are timed by the sampling window until the sampling interval expires
+    if (contiguous && instrument.window && ((start - instrument.window_time) < SAMPLE_INTERVAL))
+    {
+        if (_service->run_one() == 0)
+        {
+            uint64_t cpu_stop = 0;
+            bool cpu = ThreadTime(cpu_stop);
+            instrument.Close(CppCommon::Timestamp::nano(), cpu_stop, cpu);
+            return 0;
+        }
+
+        // Run all other ready handlers
+        return 1 + PollInstrumented(instrument, 1);
+    }
+
+    // Close the sampling window and wait for ready handlers and run the first one
+    uint64_t cpu_start = 0;
+    bool cpu = ThreadTime(cpu_start);
+    instrument.Close(start, cpu_start, cpu);
+    if (_service->run_one() == 0)
+        return 0;
+    uint64_t stop = CppCommon::Timestamp::nano();
+    uint64_t cpu_stop = 0;
+    cpu = cpu && ThreadTime(cpu_stop);
+
+    // The wait takes no CPU time, so the first handler is timed with the thread CPU clock
+    uint64_t elapsed = stop - start;
+    if (cpu)
+    {
+        uint64_t busy = std::min(cpu_stop - cpu_start, elapsed);
+        instrument.Handler(busy);
+        instrument.Busy(busy);
+        instrument.Idle(elapsed - busy);
+    }
+    else
+        instrument.Idle(elapsed);
+
+    // Open the next sampling window of contiguous waits
+    if (contiguous)
+        instrument.Open(stop, cpu_stop, cpu);
+
+    // Run all other ready handlers
+    return 1 + PollInstrumented(instrument, 1);
+}
+
+size_t Service::PollInstrumented(Instrument& instrument, size_t depth)
+{
+    // Poll all ready handlers one by one
+    size_t count = 0;
+    uint64_t start = CppCommon::Timestamp::nano();
+    for (;;)
+    {
+        size_t polled = _service->poll_one();
+        uint64_t stop = CppCommon::Timestamp::nano();
+        if (polled == 0)
+        {
+            if (!instrument.window)
+                instrument.Idle(stop - start);
+            break;
+        }
+        instrument.Handler(stop - start);
+        if (instrument.window)
+            instrument.window_busy += stop - start;
+        else
+            instrument.Busy(stop - start);
+        start = stop;
+        ++count;
+    }
+
+    // Update the count of handlers run at once
+    if ((depth + count) > 0)
+        instrument.queue_depth.Record(depth + count);
+
+    return count;
+}
+
+void Service::Probe()
+{
+    // Post the probe handler with its post time after the probe interval
+    _probe_timer->expires_from_now(std::chrono::milliseconds(_probe_interval));
+    _probe_timer->async_wait([this](const asio::error_code& ec)
+    {
+        if (ec)
+            return;
+
+        uint64_t timestamp = CppCommon::Timestamp::nano();
+        _service->post([this, timestamp]()
+        {
+            // Update the loop lag of the service thread which runs the probe
+            WorkingThread& thread = CurrentThread();
+            if ((thread.service == this) && (thread.index < _instruments.size()))
+                _instruments[thread.index]->loop_lag.Record(CppCommon::Timestamp::nano() - timestamp);
+        });
+
+        Probe();
+    });
+}
+
+uint64_t Service::TimerTick() const
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(asio::steady_timer::clock_type::now() - _timer_start).count() / _timer_resolution;
+}
+
+void Service::StartTicking()
+{
+    if (!_timer_ticker)
+        _timer_ticker = std::make_shared<asio::steady_timer>(*_service);
+
+    // Start a new ticking chain, handlers of the previous chain are ignored
+    _timer_ticking = true;
+    ScheduleTick(++_timer_chain);
+}
+
+void Service::ScheduleTick(uint64_t chain)
+{
+    // Tick at the start of the next timing wheel tick without the drift
+    _timer_ticker->expires_at(_timer_start + std::chrono::milliseconds((TimerTick() + 1) * _timer_resolution));
+    _timer_ticker->async_wait([this, chain](const asio::error_code& ec)
+    {
+        if (!ec)
+            Tick(chain);
+    });
+}
+
+void Service::Tick(uint64_t chain)
+{
+    std::lock_guard<std::mutex> locker(_timer_lock);
+
+    if (chain != _timer_chain)
+        return;
+
+    // Update the coarse time and expire timers
+    uint64_t now = TimerTick();
+    _timer_time.store(now * _timer_resolution, std::memory_order_relaxed);
+    _timer_wheel.Advance(now);
+
+    // Stop ticking the empty timing wheel
+    if (_timer_wheel.empty())
+    {
+        _timer_ticking = false;
+        return;
+    }
+
+    ScheduleTick(chain);
+}
+
+void Service::PollZeroCopy()
+{
+    // Called under the timing wheel lock, so the timer is re-armed right in the wheel
+    if (_zero_copy_linger.Poll() > 0)
+        _timer_wheel.Arm(_zero_copy_timer, _timer_wheel.now() + 1);
+}
+
+Service::WorkingThread& Service::CurrentThread() noexcept
+{
+    static thread_local WorkingThread thread = { nullptr, 0 };
+    return thread;
+}
+
+std::error_code Service::PinThread(const CPUSet& cores)
+{
+#if defined(linux) || defined(__linux) || defined(__linux__)
+    // Dynamically sized CPU set is not limited by CPU_SETSIZE
+    int count = *std::max_element(cores.begin(), cores.end()) + 1;
+    cpu_set_t* set = CPU_ALLOC(count);
+    size_t size = CPU_ALLOC_SIZE(count);
+    CPU_ZERO_S(size, set);
+    for (int core : cores)
+        CPU_SET_S(core, size, set);
+    int result = ::pthread_setaffinity_np(::pthread_self(), size, set);
+    CPU_FREE(set);
+    return std::error_code(result, std::system_category());
+#elif defined(_WIN32) || defined(_WIN64)
+    // Windows thread is pinned within the processor group of the first core
+    GROUP_AFFINITY affinity = {};
+    affinity.Group = (WORD)(cores.front() / 64);
+    for (int core : cores)
+        if ((core / 64) == affinity.Group)
+            affinity.Mask |= (KAFFINITY)1 << (core % 64);
+    if (!::SetThreadGroupAffinity(::GetCurrentThread(), &affinity, nullptr))
+        return std::error_code(::GetLastError(), std::system_category());
+    return std::error_code();
+#else
+    // Other platforms support affinity masks of the first 64 cores only
+    std::bitset<64> mask;
+    for (int core : cores)
+        if (core < 64)
+            mask.set(core);
+    try
+    {
+        CppCommon::Thread::SetAffinity(mask);
+    }
+    catch (const std::exception&)
+    {
+        return std::make_error_code(std::errc::invalid_argument);
+    }
+    return std::error_code();
+#endif
 }
 
 void Service::SendError(std::error_code ec)
@@ -0,0 +1,87 @@
+/*!
+    \file shared_buffer.cpp
+    \brief Shared buffer implementation
+    \author Ivan Shynkarenka
+    \date 21.03.2017
+    \copyright MIT License
+*/
+
+#include "server/asio/shared_buffer.h"
+
+#include "errors/exceptions.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace CppServer {
+namespace Asio {
+
+SharedBuffer::SharedBuffer(const void* buffer, size_t size)
+    : _data(nullptr),
+      _size(0)
+{
+    assert(((buffer != nullptr) || (size == 0)) && "Pointer to the buffer should not be equal to 'nullptr'!");
+    if ((buffer == nullptr) && (size > 0))
+        throw CppCommon::ArgumentException("Pointer to the buffer should not be equal to 'nullptr'!");
+
+    if (size > 0)
+    {
+        auto storage = std::shared_ptr<uint8_t>(new uint8_t[size], std::default_delete<uint8_t[]>());
+        std::memcpy(storage.get(), buffer, size);
+        _data = storage.get();
+        _size = size;
+        _holder = std::move(storage);
+    }
+}
+
+SharedBuffer::SharedBuffer(std::vector<uint8_t>&& bytes)
+    : _data(nullptr),
+      _size(0)
+{
+    if (!bytes.empty())
+    {
+        auto storage = std::make_shared<std::vector<uint8_t>>(std::move(bytes));
+        _data = storage->data();
+        _size = storage->size();
+        _holder = std::move(storage);
+    }
+}
+
+SharedBuffer::SharedBuffer(std::string&& text)
+    : _data(nullptr),
+      _size(0)
+{
+    if (!text.empty())
+    {
+        auto storage = std::make_shared<std::string>(std::move(text));
+        _data = (const uint8_t*)storage->data();
+        _size = storage->size();
+        _holder = std::move(storage);
+    }
+}
+
+SharedBuffer::SharedBuffer(std::shared_ptr<const void> holder, const void* buffer, size_t size)
+    : _holder(std::move(holder)),
+      _data((const uint8_t*)buffer),
+      _size(size)
+{
+    assert(((buffer != nullptr) || (size == 0)) && "Pointer to the buffer should not be equal to 'nullptr'!");
+    if ((buffer == nullptr) && (size > 0))
+        throw CppCommon::ArgumentException("Pointer to the buffer should not be equal to 'nullptr'!");
+}
+
+SharedBuffer SharedBuffer::Slice(size_t offset, size_t size) const
+{
+    assert(((offset + size) <= _size) && "Slice should be inside the shared buffer!");
+    if ((offset + size) > _size)
+        throw CppCommon::ArgumentException("Slice should be inside the shared buffer!");
+
+    SharedBuffer result;
+    result._holder = _holder;
+    result._data = _data + offset;
+    result._size = size;
+    return result;
+}
+
+} // namespace Asio
+} // namespace CppServer
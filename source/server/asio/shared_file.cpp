@@ -0,0 +1,183 @@
+/*!
+    \file shared_file.cpp
+    \brief Shared file implementation
+    \author Ivan Shynkarenka
+    \date 28.03.2017
+    \copyright MIT License
+*/
+
+#include "server/asio/shared_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined(_WIN32) || defined(_WIN64)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(linux) || defined(__linux) || defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+namespace CppServer {
+namespace Asio {
+
+//! @cond INTERNALS
+
+class SharedFile::Impl
+{
+public:
+    explicit Impl(int fd) : _fd(fd) {}
+    Impl(const Impl&) = delete;
+    Impl(Impl&&) = delete;
+    ~Impl()
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        _close(_fd);
+#else
+        ::close(_fd);
+#endif
+    }
+
+    Impl& operator=(const Impl&) = delete;
+    Impl& operator=(Impl&&) = delete;
+
+    int fd() const noexcept { return _fd; }
+
+    //! Read the file region into the given buffer
+    size_t Read(uint64_t offset, void* buffer, size_t size, asio::error_code& ec)
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        // Windows has no positional read for file descriptors
+        std::lock_guard<std::mutex> locker(_lock);
+        if (_lseeki64(_fd, (__int64)offset, SEEK_SET) < 0)
+        {
+            ec = asio::error_code(errno, asio::error::get_system_category());
+            return 0;
+        }
+        int result = _read(_fd, buffer, (unsigned)std::min(size, (size_t)0x7FFFFFFF));
+#else
+        ssize_t result;
+        do
+        {
+            result = ::pread(_fd, buffer, size, (off_t)offset);
+        } while ((result < 0) && (errno == EINTR));
+#endif
+        if (result < 0)
+        {
+            ec = asio::error_code(errno, asio::error::get_system_category());
+            return 0;
+        }
+        return (size_t)result;
+    }
+
+private:
+    int _fd;
+#if defined(_WIN32) || defined(_WIN64)
+    std::mutex _lock;
+#endif
+};
+
+//! @endcond
+
+SharedFile::SharedFile(const std::string& path)
+    : _size(0)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    int fd = _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+    if (fd >= 0)
+        Attach(fd);
+}
+
+SharedFile::SharedFile(int fd)
+    : _size(0)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    int duplicate = _dup(fd);
+#else
+    int duplicate = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+#endif
+    if (duplicate >= 0)
+        Attach(duplicate);
+}
+
+void SharedFile::Attach(int fd)
+{
+    _file = std::make_shared<Impl>(fd);
+
+    // Get the file size
+#if defined(_WIN32) || defined(_WIN64)
+    struct _stat64 status;
+    if (_fstat64(fd, &status) == 0)
+        _size = (uint64_t)status.st_size;
+#else
+    struct stat status;
+    if (::fstat(fd, &status) == 0)
+        _size = (uint64_t)status.st_size;
+#endif
+}
+
+size_t SharedFile::Send(asio::ip::tcp::socket& socket, uint64_t offset, size_t size, asio::error_code& ec) const
+{
+    ec.clear();
+
+    if (!valid())
+    {
+        ec = asio::error::bad_descriptor;
+        return 0;
+    }
+
+    if (size == 0)
+        return 0;
+
+    // Never block the socket thread
+    if (!socket.native_non_blocking())
+    {
+        socket.native_non_blocking(true, ec);
+        if (ec)
+            return 0;
+    }
+
+#if defined(linux) || defined(__linux) || defined(__linux__)
+    // Write the file region directly from the page cache
+    off_t position = (off_t)offset;
+    ssize_t result;
+    do
+    {
+        result = ::sendfile(socket.native_handle(), _file->fd(), &position, size);
+    } while ((result < 0) && (errno == EINTR));
+    if (result < 0)
+    {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            ec = asio::error::would_block;
+        else
+            ec = asio::error_code(errno, asio::error::get_system_category());
+        return 0;
+    }
+#else
+    // Read the file region by chunks into a temporary buffer
+    uint8_t buffer[8 * CHUNK];
+    size_t count = _file->Read(offset, buffer, std::min(size, sizeof(buffer)), ec);
+    if (ec)
+        return 0;
+    size_t result = (count > 0) ? socket.write_some(asio::buffer(buffer, count), ec) : 0;
+    if (ec)
+        return 0;
+#endif
+
+    // The file was truncated after the region was queued
+    if (result == 0)
+        ec = asio::error_code(EIO, asio::error::get_system_category());
+
+    return (size_t)result;
+}
+
+} // namespace Asio
+} // namespace CppServer
@@ -0,0 +1,172 @@
+/*!
+    \file socket_options.cpp
+    \brief Socket options implementation
+    \author Ivan Shynkarenka
+    \date 27.03.2017
+    \copyright MIT License
+*/
+
+#include "server/asio/socket_options.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+namespace CppServer {
+namespace Asio {
+
+namespace {
+
+#if defined(TCP_QUICKACK)
+typedef asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_QUICKACK> QuickAck;
+#endif
+#if defined(TCP_CORK)
+typedef asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_CORK> CorkOption;
+#endif
+#if defined(TCP_NOTSENT_LOWAT)
+typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_NOTSENT_LOWAT> NotSentLowat;
+#endif
+#if defined(TCP_KEEPIDLE)
+typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPIDLE> KeepAliveIdle;
+#elif defined(TCP_KEEPALIVE) && !defined(_WIN32) && !defined(_WIN64)
+// macOS names the keep-alive idle time option TCP_KEEPALIVE
+typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPALIVE> KeepAliveIdle;
+#define CPPSERVER_ASIO_KEEPIDLE
+#endif
+#if defined(TCP_KEEPINTVL)
+typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPINTVL> KeepAliveInterval;
+#endif
+#if defined(TCP_KEEPCNT)
+typedef asio::detail::socket_option::integer<IPPROTO_TCP, TCP_KEEPCNT> KeepAliveCount;
+#endif
+#if defined(SO_BUSY_POLL)
+typedef asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL> BusyPoll;
+#endif
+
+} // namespace
+
+bool SocketOptions::empty() const noexcept
+{
+    return (no_delay < 0) &&
+           (send_buffer_size == 0) &&
+           (receive_buffer_size == 0) &&
+           (quick_ack < 0) &&
+           (not_sent_lowat == 0) &&
+           (keep_alive < 0) &&
+           (keep_alive_idle == 0) &&
+           (keep_alive_interval == 0) &&
+           (keep_alive_count == 0) &&
+           congestion_control.empty() &&
+           (busy_poll == 0);
+}
+
+void SocketOptions::Apply(asio::ip::tcp::socket::lowest_layer_type& socket, asio::error_code& ec) const
+{
+    ec.clear();
+
+    if (!ec && (no_delay >= 0))
+        socket.set_option(asio::ip::tcp::no_delay(no_delay != 0), ec);
+    if (!ec && (send_buffer_size > 0))
+        socket.set_option(asio::socket_base::send_buffer_size(send_buffer_size), ec);
+    if (!ec && (receive_buffer_size > 0))
+        socket.set_option(asio::socket_base::receive_buffer_size(receive_buffer_size), ec);
+#if defined(TCP_QUICKACK)
+    // Linux resets TCP_QUICKACK by its own heuristics, so the option is
+    // a hint for the first acknowledgements of the connection only
+    if (!ec && (quick_ack >= 0))
+        socket.set_option(QuickAck(quick_ack != 0), ec);
+#endif
+#if defined(TCP_NOTSENT_LOWAT)
+    if (!ec && (not_sent_lowat > 0))
+        socket.set_option(NotSentLowat(not_sent_lowat), ec);
+#endif
+    if (!ec && (keep_alive >= 0))
+        socket.set_option(asio::socket_base::keep_alive(keep_alive != 0), ec);
+#if defined(TCP_KEEPIDLE) || defined(CPPSERVER_ASIO_KEEPIDLE)
+    if (!ec && (keep_alive_idle > 0))
+        socket.set_option(KeepAliveIdle(keep_alive_idle), ec);
+#endif
+#if defined(TCP_KEEPINTVL)
+    if (!ec && (keep_alive_interval > 0))
+        socket.set_option(KeepAliveInterval(keep_alive_interval), ec);
+#endif
+#if defined(TCP_KEEPCNT)
+    if (!ec && (keep_alive_count > 0))
+        socket.set_option(KeepAliveCount(keep_alive_count), ec);
+#endif
+#if defined(TCP_CONGESTION)
+    // Congestion control algorithm is a string option not covered by Asio socket options
+    if (!ec && !congestion_control.empty())
+    {
+        if (::setsockopt(socket.native_handle(), IPPROTO_TCP, TCP_CONGESTION, congestion_control.data(), (socklen_t)congestion_control.size()) != 0)
+            ec = asio::error_code(errno, asio::error::get_system_category());
+    }
+#endif
+#if defined(SO_BUSY_POLL)
+    // Busy polling of the device queue is applied to blocking receives and
+    // epoll waits of the socket. Raising it above the system limit requires
+    // CAP_NET_ADMIN capability.
+    if (!ec && (busy_poll > 0))
+        socket.set_option(BusyPoll(busy_poll), ec);
+#endif
+}
+
+void SocketOptions::Apply(asio::ip::tcp::acceptor& acceptor, asio::error_code& ec) const
+{
+    ec.clear();
+
+    if (!ec && (send_buffer_size > 0))
+        acceptor.set_option(asio::socket_base::send_buffer_size(send_buffer_size), ec);
+    if (!ec && (receive_buffer_size > 0))
+        acceptor.set_option(asio::socket_base::receive_buffer_size(receive_buffer_size), ec);
+}
+
+bool SocketOptions::Cork(asio::ip::tcp::socket::lowest_layer_type& socket, bool enable)
+{
+#if defined(TCP_CORK)
+    asio::error_code ec;
+    socket.set_option(CorkOption(enable), ec);
+    return !ec;
+#else
+    return false;
+#endif
+}
+
+std::ostream& operator<<(std::ostream& stream, const SocketOptions& options)
+{
+    if (options.empty())
+        return stream << "<default>";
+
+    const char* separator = "";
+    auto option = [&stream, &separator](const char* name) -> std::ostream& { stream << separator << name << '='; separator = " "; return stream; };
+
+    if (options.no_delay >= 0)
+        option("TCP_NODELAY") << options.no_delay;
+    if (options.send_buffer_size > 0)
+        option("SO_SNDBUF") << options.send_buffer_size;
+    if (options.receive_buffer_size > 0)
+        option("SO_RCVBUF") << options.receive_buffer_size;
+    if (options.quick_ack >= 0)
+        option("TCP_QUICKACK") << options.quick_ack;
+    if (options.not_sent_lowat > 0)
+        option("TCP_NOTSENT_LOWAT") << options.not_sent_lowat;
+    if (options.keep_alive >= 0)
+        option("SO_KEEPALIVE") << options.keep_alive;
+    if (options.keep_alive_idle > 0)
+        option("TCP_KEEPIDLE") << options.keep_alive_idle;
+    if (options.keep_alive_interval > 0)
+        option("TCP_KEEPINTVL") << options.keep_alive_interval;
+    if (options.keep_alive_count > 0)
+        option("TCP_KEEPCNT") << options.keep_alive_count;
+    if (!options.congestion_control.empty())
+        option("TCP_CONGESTION") << options.congestion_control;
+    if (options.busy_poll > 0)
+        option("SO_BUSY_POLL") << options.busy_poll;
+    return stream;
+}
+
+} // namespace Asio
+} // namespace CppServer
@@ -8,7 +8,7 @@
 
 #include "server/asio/ssl_client.h"
 
-#include <mutex>
+#include <cstring>
 #include <vector>
 
 namespace CppServer {
@@ -22,6 +22,8 @@ public:
     Impl(const CppCommon::UUID& id, std::shared_ptr<Service> service, std::shared_ptr<asio::ssl::context> context, const std::string& address, int port)
         : _id(id),
           _service(service),
+          _strand(*_service->service()),
+          _strand_required(_service->IsStrandRequired()),
           _context(context),
           _endpoint(asio::ip::tcp::endpoint(asio::ip::address::from_string(address), port)),
           _stream(*_service->service(), *_context),
@@ -33,8 +35,11 @@ public:
           _bytes_received(0),
           _reciving(false),
           _sending(false),
-          _recive_buffer(CHUNK + 1),
-          _send_buffer_flush_offset(0)
+          _send_scheduled(false),
+          _corked(0),
+          _socket_corked(false),
+          _send_buffer_overflow(false),
+          _send_buffer_full(false)
     {
         assert((service != nullptr) && "ASIO service is invalid!");
         if (service == nullptr)
@@ -48,6 +53,8 @@ public:
     Impl(const CppCommon::UUID& id, std::shared_ptr<Service> service, std::shared_ptr<asio::ssl::context> context, const asio::ip::tcp::endpoint& endpoint)
         : _id(id),
           _service(service),
+          _strand(*_service->service()),
+          _strand_required(_service->IsStrandRequired()),
           _context(context),
           _endpoint(endpoint),
           _stream(*_service->service(), *_context),
@@ -59,8 +66,11 @@ public:
           _bytes_received(0),
           _reciving(false),
           _sending(false),
-          _recive_buffer(CHUNK + 1),
-          _send_buffer_flush_offset(0)
+          _send_scheduled(false),
+          _corked(0),
+          _socket_corked(false),
+          _send_buffer_overflow(false),
+          _send_buffer_full(false)
     {
         assert((service != nullptr) && "ASIO service is invalid!");
         if (service == nullptr)
@@ -88,6 +98,7 @@ public:
 
     uint64_t& bytes_sent() noexcept { return _bytes_sent; }
     uint64_t& bytes_received() noexcept { return _bytes_received; }
+    std::atomic<int>& corked() noexcept { return _corked; }
 
     bool IsConnected() const noexcept { return _connected; }
     bool IsHandshaked() const noexcept { return _handshaked; }
@@ -101,14 +112,14 @@ public:
 
         // Post the connect routine
         auto self(this->shared_from_this());
-        _service->service()->post([this, self]()
+        auto connect_handler = [this, self]()
         {
             if (IsConnected() || IsHandshaked() || _connecting || _handshaking)
                 return;
 
             // Connect the client socket
             _connecting = true;
-            socket().async_connect(_endpoint, [this, self](std::error_code ec)
+            auto async_connect_handler = [this, self](std::error_code ec)
             {
                 _connecting = false;
 
@@ -121,6 +132,9 @@ public:
                     _bytes_sent = 0;
                     _bytes_received = 0;
 
+                    // Drop data left in the receive ring by the previous connection
+                    _client->_receive_ring.Clear();
+
                     // Update the connected flag
                     _connected = true;
 
@@ -129,7 +143,7 @@ public:
 
                     // Perform SSL handshake
                     _handshaking = true;
-                    _stream.async_handshake(asio::ssl::stream_base::client, [this, self](std::error_code ec)
+                    auto async_handshake_handler = [this, self](std::error_code ec)
                     {
                         _handshaking = false;
 
@@ -156,7 +170,11 @@ public:
                             SendError(ec);
                             Disconnect(true);
                         }
-                    });
+                    };
+                    if (_strand_required)
+                        _stream.async_handshake(asio::ssl::stream_base::client, _strand.wrap(async_handshake_handler));
+                    else
+                        _stream.async_handshake(asio::ssl::stream_base::client, async_handshake_handler);
                 }
                 else
                 {
@@ -164,8 +182,29 @@ public:
                     SendError(ec);
                     onDisconnected();
                 }
-            });
-        });
+            };
+
+            // Apply socket options to the opened client socket
+            if (!_client->_socket_options.empty())
+            {
+                asio::error_code ec;
+                if (!socket().is_open())
+                    socket().open(_endpoint.protocol(), ec);
+                if (!ec)
+                    _client->_socket_options.Apply(socket(), ec);
+                if (ec)
+                    SendError(ec);
+            }
+
+            if (_strand_required)
+                socket().async_connect(_endpoint, _strand.wrap(async_connect_handler));
+            else
+                socket().async_connect(_endpoint, async_connect_handler);
+        };
+        if (_strand_required)
+            _strand.post(connect_handler);
+        else
+            _service->Post(connect_handler);
 
         return true;
     }
@@ -201,10 +240,20 @@ public:
         };
 
         // Dispatch or post the disconnect routine
-        if (dispatch)
-            _service->Dispatch(disconnect);
+        if (_strand_required)
+        {
+            if (dispatch)
+                _strand.dispatch(disconnect);
+            else
+                _strand.post(disconnect);
+        }
         else
-            _service->Post(disconnect);
+        {
+            if (dispatch)
+                _service->Dispatch(disconnect);
+            else
+                _service->Post(disconnect);
+        }
 
         return true;
     }
@@ -219,35 +268,126 @@ public:
         if (!IsHandshaked())
             return 0;
 
-        size_t result;
+        // Apply the slow consumer policy to the new data
+        if (!CheckSendBuffer(size))
+            return 0;
+
+        // Send the data directly from the client thread
+        if (IsInStrand())
         {
-            std::lock_guard<std::mutex> locker(_send_lock);
+            size_t result = _send_queue.PushDirect(buffer, size);
+            TrySend();
+            return result;
+        }
+
+        // Copy the buffer into the send queue and schedule the send routine
+        size_t result = _send_queue.Push(buffer, size);
+        ScheduleSend();
+
+        return result;
+    }
 
-            // Fill the main send buffer
-            const uint8_t* bytes = (const uint8_t*)buffer;
-            _send_buffer_main.insert(_send_buffer_main.end(), bytes, bytes + size);
-            result = _send_buffer_main.size();
+    size_t Send(const SharedBuffer& buffer)
+    {
+        assert(!buffer.empty() && "Shared buffer should not be empty!");
+        if (buffer.empty())
+            return 0;
+
+        if (!IsHandshaked())
+            return 0;
+
+        // Apply the slow consumer policy to the new data
+        if (!CheckSendBuffer(buffer.size()))
+            return 0;
+
+        // Send the data directly from the client thread
+        if (IsInStrand())
+        {
+            size_t result = _send_queue.PushDirect(buffer);
+            TrySend();
+            return result;
         }
 
-        // Dispatch the send routine
-        auto self(this->shared_from_this());
-        _service->Dispatch([this, self]()
+        // Queue the shared buffer and schedule the send routine
+        size_t result = _send_queue.Push(buffer);
+        ScheduleSend();
+
+        return result;
+    }
+
+    size_t Send(const std::vector<SharedBuffer>& buffers)
+    {
+        assert(!buffers.empty() && "Shared buffers vector should not be empty!");
+        if (buffers.empty())
+            return 0;
+
+        if (!IsHandshaked())
+            return 0;
+
+        // Apply the slow consumer policy to the new data
+        size_t size = 0;
+        for (auto& buffer : buffers)
+            size += buffer.size();
+        if (!CheckSendBuffer(size))
+            return 0;
+
+        // Send the data directly from the client thread
+        if (IsInStrand())
         {
-            // Try to send the main buffer
+            size_t result = 0;
+            for (auto& buffer : buffers)
+                result = _send_queue.PushDirect(buffer);
             TrySend();
-        });
+            return result;
+        }
+
+        // Queue all shared buffers and schedule the send routine once
+        size_t result = 0;
+        for (auto& buffer : buffers)
+            result = _send_queue.Push(buffer);
+        ScheduleSend();
 
         return result;
     }
 
+    void Cork() noexcept { ++_corked; }
+
+    void Uncork()
+    {
+        assert((_corked > 0) && "Client send buffer is not corked!");
+
+        // Only the last balanced call writes the collected data
+        int corked = _corked;
+        do
+        {
+            if (corked <= 0)
+                return;
+        } while (!_corked.compare_exchange_weak(corked, corked - 1));
+        if (corked > 1)
+            return;
+
+        if (!IsHandshaked())
+            return;
+
+        // Write the collected data right away from the client thread
+        if (IsInStrand())
+            TrySend();
+        else
+            ScheduleSend();
+    }
+
 protected:
     void onConnected() { _client->onConnected(); }
     void onHandshaked() { _client->onHandshaked(); }
     void onDisconnected() { _client->onDisconnected(); }
     void onReset() { _client->onReset(); }
     void onReceived(const void* buffer, size_t size) { _client->onReceived(buffer, size); }
+    void onReceivedMessage(const void* buffer, size_t size) { _client->onReceivedMessage(buffer, size); }
+    void onReceivedRing(const void* buffer, size_t size) { _client->onReceivedRing(buffer, size); }
     void onSent(size_t sent, size_t pending) { _client->onSent(sent, pending); }
     void onEmpty() { _client->onEmpty(); }
+    void onSendBufferHigh() { _client->onSendBufferHigh(); }
+    void onSendBufferLow() { _client->onSendBufferLow(); }
     void onError(int error, const std::string& category, const std::string& message) { _client->onError(error, category, message); }
 
 private:
@@ -255,8 +395,10 @@ private:
     CppCommon::UUID _id;
     // SSL client
     std::shared_ptr<SSLClient> _client;
-    // Asio service
+    // Asio service & strand
     std::shared_ptr<Service> _service;
+    asio::io_service::strand _strand;
+    bool _strand_required;
     // Server SSL context, endpoint & client stream
     std::shared_ptr<asio::ssl::context> _context;
     asio::ip::tcp::endpoint _endpoint;
@@ -270,13 +412,20 @@ private:
     uint64_t _bytes_received;
     // Receive buffer & cache
     bool _reciving;
-    std::vector<uint8_t> _recive_buffer;
-    // Send buffer & cache
+    ReceiveBuffer _recive_buffer;
+    // Send queue
     bool _sending;
-    std::mutex _send_lock;
-    std::vector<uint8_t> _send_buffer_main;
-    std::vector<uint8_t> _send_buffer_flush;
-    size_t _send_buffer_flush_offset;
+    std::atomic<bool> _send_scheduled;
+    SendQueue _send_queue;
+    // Handler storages of receive and send operations
+    HandlerStorage _receive_storage;
+    HandlerStorage _send_storage;
+    // Send batching
+    std::atomic<int> _corked;
+    bool _socket_corked;
+    // Send buffer state
+    std::atomic<bool> _send_buffer_overflow;
+    bool _send_buffer_full;
 
     void TryReceive()
     {
@@ -286,14 +435,28 @@ private:
         if (!IsHandshaked())
             return;
 
+        // Receive data into the ring in the receive ring mode
+        if (_client->_receive_ring.enabled())
+        {
+            TryReceiveRing();
+            return;
+        }
+
         _reciving = true;
         auto self(this->shared_from_this());
-        _stream.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), [this, self](std::error_code ec, std::size_t size)
+
+        // Borrow the receive buffer from the service buffer pool
+        _recive_buffer.Acquire(_service->buffer_pool());
+
+        auto async_receive_handler = [this, self](std::error_code ec, std::size_t size)
         {
             _reciving = false;
 
             if (!IsHandshaked())
+            {
+                _recive_buffer.Release();
                 return;
+            }
 
             // Received some data from the client
             if (size > 0)
@@ -301,12 +464,14 @@ private:
                 // Update statistic
                 _bytes_received += size;
 
-                // Call the buffer received handler
-                onReceived(_recive_buffer.data(), size);
+                // Call the buffer received handler or parse received messages
+                if (!_client->_framer.enabled())
+                    onReceived(_recive_buffer.data(), size);
+                else if (!_client->_framer.Process(_recive_buffer.data(), size, [this](const uint8_t* message, size_t message_size) { onReceivedMessage(message, message_size); }))
+                    ec = asio::error::message_size;
 
-                // If the receive buffer is full increase its size
-                if (_recive_buffer.size() == size)
-                    _recive_buffer.resize(2 * size);
+                // Grow or shrink the receive buffer
+                _recive_buffer.Update(size);
             }
 
             // Try to receive again if the session is valid
@@ -314,40 +479,126 @@ private:
                 TryReceive();
             else
             {
+                _recive_buffer.Release();
                 SendError(ec);
                 Disconnect(true);
             }
-        });
+        };
+        if (_strand_required)
+            _stream.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), _strand.wrap(MakeAllocHandler(_receive_storage, async_receive_handler)));
+        else
+            _stream.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), MakeAllocHandler(_receive_storage, async_receive_handler));
     }
 
-    void TrySend()
+    void TryReceiveRing()
     {
-        if (_sending)
+        _reciving = true;
+        auto self(this->shared_from_this());
+        auto async_receive_handler = [this, self](std::error_code ec, std::size_t size)
+        {
+            _reciving = false;
+
+            if (!IsHandshaked())
+                return;
+
+            // Received some data from the server
+            if (size > 0)
+            {
+                // Update statistic
+                _bytes_received += size;
+
+                // Call the ring received handler or parse received messages in place
+                _client->_receive_ring.Commit(size);
+                if (!_client->_framer.enabled())
+                    onReceivedRing(_client->_receive_ring.data(), _client->_receive_ring.size());
+                else
+                {
+                    size_t parsed;
+                    if (_client->_framer.Parse(_client->_receive_ring.data(), _client->_receive_ring.size(), [this](const uint8_t* message, size_t message_size) { onReceivedMessage(message, message_size); }, parsed))
+                        _client->_receive_ring.Consume(parsed);
+                    else
+                        ec = asio::error::message_size;
+                }
+
+                // Nothing more could be received into the full ring
+                if (!ec && IsHandshaked() && _client->_receive_ring.full())
+                    ec = asio::error::no_buffer_space;
+            }
+
+            // Try to receive again if the client is valid
+            if (!ec)
+                TryReceive();
+            else
+            {
+                SendError(ec);
+                Disconnect(true);
+            }
+        };
+
+        // Read into the free space of the receive ring
+        asio::mutable_buffer buffer = _client->_receive_ring.Prepare();
+        if (_strand_required)
+            _stream.async_read_some(asio::buffer(buffer), _strand.wrap(MakeAllocHandler(_receive_storage, async_receive_handler)));
+        else
+            _stream.async_read_some(asio::buffer(buffer), MakeAllocHandler(_receive_storage, async_receive_handler));
+    }
+
+    bool IsInStrand()
+    {
+        return _strand_required ? _strand.running_in_this_thread() : _service->IsServiceThread();
+    }
+
+    void ScheduleSend()
+    {
+        // Schedule only one send routine for all buffers queued before it runs
+        if (_send_scheduled.exchange(true))
             return;
 
+        auto self(this->shared_from_this());
+        auto send_handler = [this, self]()
+        {
+            _send_scheduled = false;
+
+            // Try to send the send queue
+            TrySend();
+        };
+        if (_strand_required)
+            _strand.post(send_handler);
+        else
+            _service->Post(send_handler);
+    }
+
+    void TrySend()
+    {
         if (!IsHandshaked())
             return;
 
-        // Swap send buffers
-        if (_send_buffer_flush.empty())
-        {
-            std::lock_guard<std::mutex> locker(_send_lock);
+        // Apply the slow consumer policy to the send buffer
+        if (_send_buffer_overflow)
+            HandleSendBufferOverflow();
 
-            // Swap flush and main buffers
-            _send_buffer_flush.swap(_send_buffer_main);
-            _send_buffer_flush_offset = 0;
+        // Collect sent data until the client is uncorked
+        if (_corked > 0)
+        {
+            CorkSocket(true);
+            return;
         }
 
-        // Check if the flush buffer is empty
-        if (_send_buffer_flush.empty())
+        if (_sending)
+            return;
+
+        // Move queued buffers into the flush part
+        if (!_send_queue.Flush())
         {
             // Nothing to send...
+            CorkSocket(false);
+            HandleSendBufferDrain(_send_queue.size());
             return;
         }
 
         _sending = true;
         auto self(this->shared_from_this());
-        asio::async_write(_stream, asio::buffer(_send_buffer_flush.data() + _send_buffer_flush_offset, _send_buffer_flush.size() - _send_buffer_flush_offset), [this, self](std::error_code ec, std::size_t size)
+        auto async_write_handler = [this, self](std::error_code ec, std::size_t size)
         {
             _sending = false;
 
@@ -362,22 +613,18 @@ private:
                 // Update statistic
                 _bytes_sent += size;
 
-                // Call the buffer sent handler
-                onSent(size, _send_buffer_flush.size() - size);
+                // Consume the written data from the send queue
+                _send_queue.Consume(size);
+                size_t pending = _send_queue.size();
 
-                // Increase the flush buffer offset
-                _send_buffer_flush_offset += size;
+                // Stop sending operation if the send queue is empty
+                resume = (pending > 0);
 
-                // Successfully send the whole flush buffer
-                if (_send_buffer_flush_offset == _send_buffer_flush.size())
-                {
-                    // Clear the flush buffer
-                    _send_buffer_flush.clear();
-                    _send_buffer_flush_offset = 0;
+                // Call the buffer sent handler
+                onSent(size, pending);
 
-                    // Stop sending operation
-                    resume = false;
-                }
+                // Check the send buffer low watermark
+                HandleSendBufferDrain(pending);
             }
 
             // Try to send again if the session is valid
@@ -386,28 +633,103 @@ private:
                 if (resume)
                     TrySend();
                 else
+                {
+                    // Push the tail of the last write held by the corked socket
+                    if (_corked == 0)
+                        CorkSocket(false);
                     onEmpty();
+                }
             }
             else
             {
                 SendError(ec);
                 Disconnect(true);
             }
-        });
+        };
+        if (_strand_required)
+            asio::async_write(_stream, ConstBuffersView(_send_queue.buffers()), _strand.wrap(MakeAllocHandler(_send_storage, async_write_handler)));
+        else
+            asio::async_write(_stream, ConstBuffersView(_send_queue.buffers()), MakeAllocHandler(_send_storage, async_write_handler));
     }
 
-    void ClearBuffers()
+    void CorkSocket(bool enable)
+    {
+        if (_socket_corked == enable)
+            return;
+
+        // Corking the socket is only a hint, so its failure is ignored
+        _socket_corked = SocketOptions::Cork(_stream.lowest_layer(), enable) && enable;
+    }
+
+    bool CheckSendBuffer(size_t size)
+    {
+        if (_client->_send_buffer_high == 0)
+            return true;
+
+        // Check the send buffer high watermark
+        if ((_send_queue.size() + size) <= _client->_send_buffer_high)
+            return true;
+
+        // Schedule the slow consumer policy for the send routine
+        _send_buffer_overflow = true;
+
+        switch (_client->_slow_consumer_policy)
+        {
+            case SlowConsumerPolicy::DropOldest:
+                // The oldest pending data will be dropped by the send routine
+                return true;
+            case SlowConsumerPolicy::Disconnect:
+                Disconnect(false);
+                return false;
+            default:
+                // Notify about the rejected data from the send routine
+                ScheduleSend();
+                return false;
+        }
+    }
+
+    void HandleSendBufferOverflow()
     {
-        // Clear send buffers
+        _send_buffer_overflow = false;
+
+        // Drop the oldest pending data over the high watermark
+        if (_client->_slow_consumer_policy == SlowConsumerPolicy::DropOldest)
+        {
+            size_t pending = _send_queue.size();
+            if (pending > _client->_send_buffer_high)
+                _send_queue.Drop(pending - _client->_send_buffer_high);
+        }
+
+        // Call the send buffer high watermark handler
+        if (!_send_buffer_full)
         {
-            std::lock_guard<std::mutex> locker(_send_lock);
+            _send_buffer_full = true;
+            onSendBufferHigh();
+        }
+    }
 
-            _send_buffer_main.clear();
-            _send_buffer_flush.clear();
-            _send_buffer_flush_offset = 0;
+    void HandleSendBufferDrain(size_t pending)
+    {
+        // Call the send buffer low watermark handler
+        if (_send_buffer_full && (pending <= _client->_send_buffer_low))
+        {
+            _send_buffer_full = false;
+            onSendBufferLow();
         }
     }
 
+    void ClearBuffers()
+    {
+        // Clear the send queue
+        _send_queue.Clear();
+        _send_buffer_overflow = false;
+        _send_buffer_full = false;
+        _socket_corked = false;
+
+        // Drop the split message tail
+        _client->_framer.Reset();
+    }
+
     void SendError(std::error_code ec)
     {
         // Skip Asio disconnect errors
@@ -436,19 +758,34 @@ private:
 //! @endcond
 
 SSLClient::SSLClient(std::shared_ptr<Service> service, std::shared_ptr<asio::ssl::context> context, const std::string& address, int port)
-    : _id(CppCommon::UUID::Generate()),
+    : _key(GenerateKey()),
+      _id(MakeId(_key)),
+      _send_buffer_high(0),
+      _send_buffer_low(0),
+      _slow_consumer_policy(SlowConsumerPolicy::Reject),
       _pimpl(std::make_shared<Impl>(_id, service, context, address, port))
 {
 }
 
 SSLClient::SSLClient(std::shared_ptr<Service> service, std::shared_ptr<asio::ssl::context> context, const asio::ip::tcp::endpoint& endpoint)
-    : _id(CppCommon::UUID::Generate()),
+    : _key(GenerateKey()),
+      _id(MakeId(_key)),
+      _send_buffer_high(0),
+      _send_buffer_low(0),
+      _slow_consumer_policy(SlowConsumerPolicy::Reject),
       _pimpl(std::make_shared<Impl>(_id, service, context, endpoint))
 {
 }
 
 SSLClient::SSLClient(SSLClient&& client)
-    : _id(std::move(client._id)),
+    : _key(client._key),
+      _id(std::move(client._id)),
+      _framer(std::move(client._framer)),
+      _receive_ring(std::move(client._receive_ring)),
+      _send_buffer_high(client._send_buffer_high),
+      _send_buffer_low(client._send_buffer_low),
+      _slow_consumer_policy(client._slow_consumer_policy),
+      _socket_options(std::move(client._socket_options)),
       _pimpl(std::move(client._pimpl))
 {
 }
@@ -459,7 +796,14 @@ SSLClient::~SSLClient()
 
 SSLClient& SSLClient::operator=(SSLClient&& client)
 {
+    _key = client._key;
     _id = std::move(client._id);
+    _framer = std::move(client._framer);
+    _receive_ring = std::move(client._receive_ring);
+    _send_buffer_high = client._send_buffer_high;
+    _send_buffer_low = client._send_buffer_low;
+    _slow_consumer_policy = client._slow_consumer_policy;
+    _socket_options = std::move(client._socket_options);
     _pimpl = std::move(client._pimpl);
     return *this;
 }
@@ -499,6 +843,11 @@ uint64_t SSLClient::bytes_received() const noexcept
     return _pimpl->bytes_received();
 }
 
+bool SSLClient::corked() const noexcept
+{
+    return (_pimpl->corked() > 0);
+}
+
 bool SSLClient::IsConnected() const noexcept
 {
     return _pimpl->IsConnected();
@@ -531,18 +880,86 @@ bool SSLClient::Reconnect()
     return Connect();
 }
 
+void SSLClient::SetupIdPolicy(IdPolicy policy)
+{
+    _id = (policy == IdPolicy::UUID) ? CppCommon::UUID::Generate() : MakeId(_key);
+}
+
+void SSLClient::SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy)
+{
+    assert((low <= high) && "Send buffer low watermark should not be greater than the high watermark!");
+    if (low > high)
+        throw CppCommon::ArgumentException("Send buffer low watermark should not be greater than the high watermark!");
+
+    _send_buffer_high = high;
+    _send_buffer_low = low;
+    _slow_consumer_policy = policy;
+}
+
 size_t SSLClient::Send(const void* buffer, size_t size)
 {
     return _pimpl->Send(buffer, size);
 }
 
+size_t SSLClient::Send(const SharedBuffer& buffer)
+{
+    return _pimpl->Send(buffer);
+}
+
+size_t SSLClient::Send(const std::vector<SharedBuffer>& buffers)
+{
+    return _pimpl->Send(buffers);
+}
+
+void SSLClient::Cork() noexcept
+{
+    _pimpl->Cork();
+}
+
+void SSLClient::Uncork()
+{
+    _pimpl->Uncork();
+}
+
+size_t SSLClient::SendFrame(const void* buffer, size_t size)
+{
+    // Encode the length prefix
+    uint8_t prefix[8];
+    size_t prefix_size = _framer.Encode(size, prefix);
+    if (prefix_size == 0)
+    {
+        // The peer would disconnect on the oversize message
+        std::error_code ec = asio::error::message_size;
+        onError(ec.value(), ec.category().name(), ec.message());
+        return 0;
+    }
+
+    // Copy small messages with the length prefix on the stack
+    if ((prefix_size + size) <= CHUNK)
+    {
+        uint8_t frame[CHUNK];
+        std::memcpy(frame, prefix, prefix_size);
+        if (size > 0)
+            std::memcpy(frame + prefix_size, buffer, size);
+        return Send(frame, prefix_size + size);
+    }
+
+    // Copy large messages with the length prefix into a shared buffer
+    std::vector<uint8_t> frame(prefix_size + size);
+    std::memcpy(frame.data(), prefix, prefix_size);
+    std::memcpy(frame.data() + prefix_size, buffer, size);
+    return Send(SharedBuffer(std::move(frame)));
+}
+
 void SSLClient::onReset()
 {
     size_t bytes_sent = _pimpl->bytes_sent();
     size_t bytes_received = _pimpl->bytes_received();
-    _pimpl = std::make_shared<Impl>(_pimpl->id(), _pimpl->service(), _pimpl->context(), _pimpl->endpoint());
+    int corked = _pimpl->corked();
+    _pimpl = std::make_shared<Impl>(_id, _pimpl->service(), _pimpl->context(), _pimpl->endpoint());
     _pimpl->bytes_sent() = bytes_sent;
     _pimpl->bytes_received() = bytes_received;
+    _pimpl->corked() = corked;
 }
 
 } // namespace Asio
@@ -8,12 +8,17 @@
 
 #include "server/asio/tcp_client.h"
 
+#include <cstring>
+
 namespace CppServer {
 namespace Asio {
 
 TCPClient::TCPClient(std::shared_ptr<Service> service, const std::string& address, int port)
-    : _id(CppCommon::UUID::Generate()),
+    : _key(GenerateKey()),
+      _id(MakeId(_key)),
       _service(service),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
       _endpoint(asio::ip::tcp::endpoint(asio::ip::address::from_string(address), port)),
       _socket(*_service->service()),
       _connecting(false),
@@ -21,9 +26,20 @@ TCPClient::TCPClient(std::shared_ptr<Service> service, const std::string& addres
       _bytes_sent(0),
       _bytes_received(0),
       _reciving(false),
+      _idle_receive(false),
       _sending(false),
-      _recive_buffer(CHUNK + 1),
-      _send_buffer_flush_offset(0)
+      _send_scheduled(false),
+      _corked(0),
+      _socket_corked(false),
+      _send_buffer_high(0),
+      _send_buffer_low(0),
+      _slow_consumer_policy(SlowConsumerPolicy::Reject),
+      _send_buffer_overflow(false),
+      _send_buffer_full(false),
+      _speculative_io(false),
+      _speculative_receiving(false),
+      _speculative_sending(false),
+      _zero_copy_waiting(false)
 {
     assert((service != nullptr) && "ASIO service is invalid!");
     if (service == nullptr)
@@ -31,8 +47,11 @@ TCPClient::TCPClient(std::shared_ptr<Service> service, const std::string& addres
 }
 
 TCPClient::TCPClient(std::shared_ptr<Service> service, const asio::ip::tcp::endpoint& endpoint)
-    : _id(CppCommon::UUID::Generate()),
+    : _key(GenerateKey()),
+      _id(MakeId(_key)),
       _service(service),
+      _strand(*_service->service()),
+      _strand_required(_service->IsStrandRequired()),
       _endpoint(endpoint),
       _socket(*_service->service()),
       _connecting(false),
@@ -40,15 +59,32 @@ TCPClient::TCPClient(std::shared_ptr<Service> service, const asio::ip::tcp::endp
       _bytes_sent(0),
       _bytes_received(0),
       _reciving(false),
+      _idle_receive(false),
       _sending(false),
-      _recive_buffer(CHUNK + 1),
-      _send_buffer_flush_offset(0)
+      _send_scheduled(false),
+      _corked(0),
+      _socket_corked(false),
+      _send_buffer_high(0),
+      _send_buffer_low(0),
+      _slow_consumer_policy(SlowConsumerPolicy::Reject),
+      _send_buffer_overflow(false),
+      _send_buffer_full(false),
+      _speculative_io(false),
+      _speculative_receiving(false),
+      _speculative_sending(false),
+      _zero_copy_waiting(false)
 {
     assert((service != nullptr) && "ASIO service is invalid!");
     if (service == nullptr)
         throw CppCommon::ArgumentException("ASIO service is invalid!");
 }
 
+TCPClient::~TCPClient()
+{
+    // Zero copy sends of the never disconnected client keep their buffers in the service
+    _service->LingerZeroCopy(_zero_copy, _socket);
+}
+
 bool TCPClient::Connect()
 {
     if (IsConnected())
@@ -56,14 +92,14 @@ bool TCPClient::Connect()
 
     // Post the connect routine
     auto self(this->shared_from_this());
-    _service->service()->post([this, self]()
+    auto connect_handler = [this, self]()
     {
         if (IsConnected() || _connecting)
             return;
 
         // Connect the client socket
         _connecting = true;
-        _socket.async_connect(_endpoint, [this, self](std::error_code ec)
+        auto async_connect_handler = [this, self](std::error_code ec)
         {
             _connecting = false;
 
@@ -73,6 +109,22 @@ bool TCPClient::Connect()
                 _bytes_sent = 0;
                 _bytes_received = 0;
 
+                // Drop data left in the receive ring by the previous connection
+                _receive_ring.Clear();
+
+                // Switch the socket into the non-blocking mode for speculative I/O
+                if (_speculative_io)
+                {
+                    asio::error_code error;
+                    _socket.non_blocking(true, error);
+                    if (error)
+                        _speculative_io = false;
+                }
+
+                // Open the zero copy send mode for the connected socket
+                if (_zero_copy.threshold() > 0)
+                    _zero_copy.Open(_socket);
+
                 // Update the connected flag
                 _connected = true;
 
@@ -91,8 +143,29 @@ bool TCPClient::Connect()
                 SendError(ec);
                 onDisconnected();
             }
-        });
-    });
+        };
+
+        // Apply socket options to the opened client socket
+        if (!_socket_options.empty())
+        {
+            asio::error_code ec;
+            if (!_socket.is_open())
+                _socket.open(_endpoint.protocol(), ec);
+            if (!ec)
+                _socket_options.Apply(_socket, ec);
+            if (ec)
+                SendError(ec);
+        }
+
+        if (_strand_required)
+            _socket.async_connect(_endpoint, _strand.wrap(async_connect_handler));
+        else
+            _socket.async_connect(_endpoint, async_connect_handler);
+    };
+    if (_strand_required)
+        _strand.post(connect_handler);
+    else
+        _service->Post(connect_handler);
 
     return true;
 }
@@ -108,6 +181,9 @@ bool TCPClient::Disconnect(bool dispatch)
         if (!IsConnected())
             return;
 
+        // Zero copy sends which are still in flight keep their buffers in the service
+        _service->LingerZeroCopy(_zero_copy, _socket);
+
         // Close the client socket
         _socket.close();
 
@@ -122,10 +198,20 @@ bool TCPClient::Disconnect(bool dispatch)
     };
 
     // Dispatch or post the disconnect routine
-    if (dispatch)
-        _service->Dispatch(disconnect);
+    if (_strand_required)
+    {
+        if (dispatch)
+            _strand.dispatch(disconnect);
+        else
+            _strand.post(disconnect);
+    }
     else
-        _service->Post(disconnect);
+    {
+        if (dispatch)
+            _service->Dispatch(disconnect);
+        else
+            _service->Post(disconnect);
+    }
 
     return true;
 }
@@ -141,6 +227,22 @@ bool TCPClient::Reconnect()
     return Connect();
 }
 
+void TCPClient::SetupIdPolicy(IdPolicy policy)
+{
+    _id = (policy == IdPolicy::UUID) ? CppCommon::UUID::Generate() : MakeId(_key);
+}
+
+void TCPClient::SetupSendBufferWatermarks(size_t high, size_t low, SlowConsumerPolicy policy)
+{
+    assert((low <= high) && "Send buffer low watermark should not be greater than the high watermark!");
+    if (low > high)
+        throw CppCommon::ArgumentException("Send buffer low watermark should not be greater than the high watermark!");
+
+    _send_buffer_high = high;
+    _send_buffer_low = low;
+    _slow_consumer_policy = policy;
+}
+
 size_t TCPClient::Send(const void* buffer, size_t size)
 {
     assert((buffer != nullptr) && "Pointer to the buffer should not be equal to 'nullptr'!");
@@ -151,27 +253,190 @@ size_t TCPClient::Send(const void* buffer, size_t size)
     if (!IsConnected())
         return 0;
 
-    size_t result;
+    // Apply the slow consumer policy to the new data
+    if (!CheckSendBuffer(size))
+        return 0;
+
+    // Send the data directly from the client thread
+    if (IsInStrand())
     {
-        std::lock_guard<std::mutex> locker(_send_lock);
+        size_t result = _send_queue.PushDirect(buffer, size);
+        TrySend();
+        return result;
+    }
+
+    // Copy the buffer into the send queue and schedule the send routine
+    size_t result = _send_queue.Push(buffer, size);
+    ScheduleSend();
+
+    return result;
+}
 
-        // Fill the main send buffer
-        const uint8_t* bytes = (const uint8_t*)buffer;
-        _send_buffer_main.insert(_send_buffer_main.end(), bytes, bytes + size);
-        result = _send_buffer_main.size();
+size_t TCPClient::Send(const SharedBuffer& buffer)
+{
+    assert(!buffer.empty() && "Shared buffer should not be empty!");
+    if (buffer.empty())
+        return 0;
+
+    if (!IsConnected())
+        return 0;
+
+    // Apply the slow consumer policy to the new data
+    if (!CheckSendBuffer(buffer.size()))
+        return 0;
+
+    // Send the data directly from the client thread
+    if (IsInStrand())
+    {
+        size_t result = _send_queue.PushDirect(buffer);
+        TrySend();
+        return result;
     }
 
-    // Dispatch the send routine
-    auto self(this->shared_from_this());
-    _service->Dispatch([this, self]()
+    // Queue the shared buffer and schedule the send routine
+    size_t result = _send_queue.Push(buffer);
+    ScheduleSend();
+
+    return result;
+}
+
+size_t TCPClient::Send(const std::vector<SharedBuffer>& buffers)
+{
+    assert(!buffers.empty() && "Shared buffers vector should not be empty!");
+    if (buffers.empty())
+        return 0;
+
+    if (!IsConnected())
+        return 0;
+
+    // Apply the slow consumer policy to the new data
+    size_t size = 0;
+    for (auto& buffer : buffers)
+        size += buffer.size();
+    if (!CheckSendBuffer(size))
+        return 0;
+
+    // Send the data directly from the client thread
+    if (IsInStrand())
     {
-        // Try to send the main buffer
+        size_t result = 0;
+        for (auto& buffer : buffers)
+            result = _send_queue.PushDirect(buffer);
         TrySend();
-    });
+        return result;
+    }
+
+    // Queue all shared buffers and schedule the send routine once
+    size_t result = 0;
+    for (auto& buffer : buffers)
+        result = _send_queue.Push(buffer);
+    ScheduleSend();
 
     return result;
 }
 
+size_t TCPClient::SendFile(const SharedFile& file, uint64_t offset, uint64_t size)
+{
+    if (!file)
+        return 0;
+
+    if (!IsConnected())
+        return 0;
+
+    // Send the file till its end
+    if (size == 0)
+        size = (offset < file.size()) ? (file.size() - offset) : 0;
+    if (size == 0)
+        return 0;
+
+    // Queue the file region directly from the client thread
+    if (IsInStrand())
+    {
+        size_t result = _send_queue.PushDirect(file, offset, (size_t)size);
+        TrySend();
+        return result;
+    }
+
+    // Queue the file region and schedule the send routine
+    size_t result = _send_queue.Push(file, offset, (size_t)size);
+    ScheduleSend();
+
+    return result;
+}
+
+size_t TCPClient::SendFrame(const void* buffer, size_t size)
+{
+    // Encode the length prefix
+    uint8_t prefix[8];
+    size_t prefix_size = _framer.Encode(size, prefix);
+    if (prefix_size == 0)
+    {
+        // The peer would disconnect on the oversize message
+        SendError(asio::error::message_size);
+        return 0;
+    }
+
+    // Copy small messages with the length prefix on the stack
+    if ((prefix_size + size) <= CHUNK)
+    {
+        uint8_t frame[CHUNK];
+        std::memcpy(frame, prefix, prefix_size);
+        if (size > 0)
+            std::memcpy(frame + prefix_size, buffer, size);
+        return Send(frame, prefix_size + size);
+    }
+
+    // Copy large messages with the length prefix into a shared buffer
+    std::vector<uint8_t> frame(prefix_size + size);
+    std::memcpy(frame.data(), prefix, prefix_size);
+    std::memcpy(frame.data() + prefix_size, buffer, size);
+    return Send(SharedBuffer(std::move(frame)));
+}
+
+void TCPClient::Uncork()
+{
+    assert((_corked > 0) && "Client send buffer is not corked!");
+
+    // Only the last balanced call writes the collected data
+    int corked = _corked;
+    do
+    {
+        if (corked <= 0)
+            return;
+    } while (!_corked.compare_exchange_weak(corked, corked - 1));
+    if (corked > 1)
+        return;
+
+    if (!IsConnected())
+        return;
+
+    // Write the collected data right away from the client thread
+    if (IsInStrand())
+        TrySend();
+    else
+        ScheduleSend();
+}
+
+void TCPClient::ScheduleSend()
+{
+    // Schedule only one send routine for all buffers queued before it runs
+    if (_send_scheduled.exchange(true))
+        return;
+
+    auto self(this->shared_from_this());
+    auto send_handler = [this, self]()
+    {
+        _send_scheduled = false;
+
+        // Try to send the send queue
+        TrySend();
+    };
+    if (_strand_required)
+        _strand.post(send_handler);
+    else
+        _service->Post(send_handler);
+}
+
 void TCPClient::TryReceive()
 {
     if (_reciving)
@@ -180,14 +445,59 @@ void TCPClient::TryReceive()
     if (!IsConnected())
         return;
 
+    // Receive data into the ring in the receive ring mode
+    if (_receive_ring.enabled())
+    {
+        TryReceiveRing();
+        return;
+    }
+
     _reciving = true;
     auto self(this->shared_from_this());
-    _socket.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), [this, self](std::error_code ec, std::size_t size)
+
+    // Wait for incoming data without the receive buffer in the idle receive mode
+    if (_idle_receive && _recive_buffer.empty())
+    {
+        auto async_wait_handler = [this, self](std::error_code ec)
+        {
+            _reciving = false;
+
+            if (!IsConnected())
+                return;
+
+            // Borrow the receive buffer and read the incoming data
+            if (!ec)
+            {
+                _recive_buffer.Acquire(_service->buffer_pool());
+                TryReceive();
+            }
+            else
+            {
+                SendError(ec);
+                Disconnect(true);
+            }
+        };
+        if (_strand_required)
+            _socket.async_wait(asio::ip::tcp::socket::wait_read, _strand.wrap(MakeAllocHandler(_receive_storage, async_wait_handler)));
+        else
+            _socket.async_wait(asio::ip::tcp::socket::wait_read, MakeAllocHandler(_receive_storage, async_wait_handler));
+        return;
+    }
+
+    // Borrow the receive buffer from the service buffer pool
+    _recive_buffer.Acquire(_service->buffer_pool());
+
+    auto async_receive_handler = [this, self](std::error_code ec, std::size_t size)
     {
         _reciving = false;
 
         if (!IsConnected())
+        {
+            _recive_buffer.Release();
             return;
+        }
+
+        bool full = false;
 
         // Received some data from the client
         if (size > 0)
@@ -195,53 +505,137 @@ void TCPClient::TryReceive()
             // Update statistic
             _bytes_received += size;
 
-            // Call the buffer received handler
-            onReceived(_recive_buffer.data(), size);
+            // Call the buffer received handler or parse received messages
+            if (!_framer.enabled())
+                onReceived(_recive_buffer.data(), size);
+            else if (!_framer.Process(_recive_buffer.data(), size, [this](const uint8_t* message, size_t message_size) { onReceivedMessage(message, message_size); }))
+                ec = asio::error::message_size;
 
-            // If the receive buffer is full increase its size
-            if (_recive_buffer.size() == size)
-                _recive_buffer.resize(2 * size);
+            // Grow or shrink the receive buffer
+            full = (size == _recive_buffer.size());
+            _recive_buffer.Update(size);
         }
 
+        // Return the receive buffer into the pool while waiting for more data
+        if (_idle_receive && !full)
+            _recive_buffer.Release();
+
         // Try to receive again if the session is valid
         if (!ec)
             TryReceive();
         else
         {
+            _recive_buffer.Release();
             SendError(ec);
             Disconnect(true);
         }
-    });
+    };
+
+    // Try to read the available data right away
+    if (_speculative_io && !_speculative_receiving)
+    {
+        asio::error_code ec;
+        size_t size = _socket.read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), ec);
+        if (!ec)
+        {
+            // Handle the data in place and leave the next read to the asynchronous operation
+            _speculative_receiving = true;
+            async_receive_handler(ec, size);
+            _speculative_receiving = false;
+            return;
+        }
+    }
+
+    if (_strand_required)
+        _socket.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), _strand.wrap(MakeAllocHandler(_receive_storage, async_receive_handler)));
+    else
+        _socket.async_read_some(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), MakeAllocHandler(_receive_storage, async_receive_handler));
 }
 
-void TCPClient::TrySend()
+void TCPClient::TryReceiveRing()
 {
-    if (_sending)
-        return;
+    _reciving = true;
+    auto self(this->shared_from_this());
+    auto async_receive_handler = [this, self](std::error_code ec, std::size_t size)
+    {
+        _reciving = false;
+
+        if (!IsConnected())
+            return;
 
+        // Received some data from the server
+        if (size > 0)
+        {
+            // Update statistic
+            _bytes_received += size;
+
+            // Call the ring received handler or parse received messages in place
+            _receive_ring.Commit(size);
+            if (!_framer.enabled())
+                onReceivedRing(_receive_ring.data(), _receive_ring.size());
+            else
+            {
+                size_t parsed;
+                if (_framer.Parse(_receive_ring.data(), _receive_ring.size(), [this](const uint8_t* message, size_t message_size) { onReceivedMessage(message, message_size); }, parsed))
+                    _receive_ring.Consume(parsed);
+                else
+                    ec = asio::error::message_size;
+            }
+
+            // Nothing more could be received into the full ring
+            if (!ec && IsConnected() && _receive_ring.full())
+                ec = asio::error::no_buffer_space;
+        }
+
+        // Try to receive again if the client is valid
+        if (!ec)
+            TryReceive();
+        else
+        {
+            SendError(ec);
+            Disconnect(true);
+        }
+    };
+
+    // Read into the free space of the receive ring
+    asio::mutable_buffer buffer = _receive_ring.Prepare();
+    if (_strand_required)
+        _socket.async_read_some(asio::buffer(buffer), _strand.wrap(MakeAllocHandler(_receive_storage, async_receive_handler)));
+    else
+        _socket.async_read_some(asio::buffer(buffer), MakeAllocHandler(_receive_storage, async_receive_handler));
+}
+
+void TCPClient::TrySend()
+{
     if (!IsConnected())
         return;
 
-    // Swap send buffers
-    if (_send_buffer_flush.empty())
-    {
-        std::lock_guard<std::mutex> locker(_send_lock);
+    // Apply the slow consumer policy to the send buffer
+    if (_send_buffer_overflow)
+        HandleSendBufferOverflow();
 
-        // Swap flush and main buffers
-        _send_buffer_flush.swap(_send_buffer_main);
-        _send_buffer_flush_offset = 0;
+    // Collect sent data until the client is uncorked
+    if (_corked > 0)
+    {
+        CorkSocket(true);
+        return;
     }
 
-    // Check if the flush buffer is empty
-    if (_send_buffer_flush.empty())
+    if (_sending)
+        return;
+
+    // Move queued buffers into the flush part
+    if (!_send_queue.Flush())
     {
         // Nothing to send...
+        CorkSocket(false);
+        HandleSendBufferDrain(_send_queue.buffered());
         return;
     }
 
     _sending = true;
     auto self(this->shared_from_this());
-    asio::async_write(_socket, asio::buffer(_send_buffer_flush.data() + _send_buffer_flush_offset, _send_buffer_flush.size() - _send_buffer_flush_offset), [this, self](std::error_code ec, std::size_t size)
+    auto async_write_handler = [this, self](std::error_code ec, std::size_t size)
     {
         _sending = false;
 
@@ -256,22 +650,18 @@ void TCPClient::TrySend()
             // Update statistic
             _bytes_sent += size;
 
-            // Call the buffer sent handler
-            onSent(size, _send_buffer_flush.size() - size);
+            // Consume the written data from the send queue
+            _send_queue.Consume(size);
+            size_t pending = _send_queue.size();
 
-            // Increase the flush buffer offset
-            _send_buffer_flush_offset += size;
+            // Stop sending operation if the send queue is empty
+            resume = (pending > 0);
 
-            // Successfully send the whole flush buffer
-            if (_send_buffer_flush_offset == _send_buffer_flush.size())
-            {
-                // Clear the flush buffer
-                _send_buffer_flush.clear();
-                _send_buffer_flush_offset = 0;
+            // Call the buffer sent handler
+            onSent(size, pending);
 
-                // Stop sending operation
-                resume = false;
-            }
+            // Check the send buffer low watermark
+            HandleSendBufferDrain(_send_queue.buffered());
         }
 
         // Try to send again if the session is valid
@@ -280,28 +670,189 @@ void TCPClient::TrySend()
             if (resume)
                 TrySend();
             else
+            {
+                // Push the tail of the last write held by the corked socket
+                if (_corked == 0)
+                    CorkSocket(false);
                 onEmpty();
+            }
         }
         else
         {
             SendError(ec);
             Disconnect(true);
         }
-    });
+    };
+
+    // Write the file region of the flush part when the socket is ready
+    if (_send_queue.file())
+    {
+        auto async_wait_handler = [this, self, async_write_handler](std::error_code ec)
+        {
+            size_t size = 0;
+            if (!ec && IsConnected())
+            {
+                asio::error_code error;
+                size = _send_queue.file().Send(_socket, _send_queue.file_offset(), _send_queue.flush_size(), error);
+                if (error != asio::error::would_block)
+                    ec = error;
+            }
+            async_write_handler(ec, size);
+        };
+        if (_strand_required)
+            _socket.async_wait(asio::ip::tcp::socket::wait_write, _strand.wrap(MakeAllocHandler(_send_storage, async_wait_handler)));
+        else
+            _socket.async_wait(asio::ip::tcp::socket::wait_write, MakeAllocHandler(_send_storage, async_wait_handler));
+        return;
+    }
+
+    // Write the large flush part with zero copy when the socket is ready
+    if (_zero_copy.Check(_send_queue.flush_size()))
+    {
+        auto async_wait_handler = [this, self, async_write_handler](std::error_code ec)
+        {
+            size_t size = 0;
+            if (!ec && IsConnected())
+            {
+                asio::error_code error;
+                size = _zero_copy.Send(_socket, _send_queue.buffers(), _send_queue.Pin(), error);
+                if (error != asio::error::would_block)
+                    ec = error;
+                TryComplete();
+            }
+            async_write_handler(ec, size);
+        };
+        if (_strand_required)
+            _socket.async_wait(asio::ip::tcp::socket::wait_write, _strand.wrap(MakeAllocHandler(_send_storage, async_wait_handler)));
+        else
+            _socket.async_wait(asio::ip::tcp::socket::wait_write, MakeAllocHandler(_send_storage, async_wait_handler));
+        return;
+    }
+
+    // Try to write the flush part right away
+    if (_speculative_io && !_speculative_sending)
+    {
+        asio::error_code ec;
+        size_t size = _socket.write_some(_send_queue.buffers(), ec);
+        if (!ec)
+        {
+            // Complete the write in place and leave the rest to the asynchronous operation
+            _speculative_sending = true;
+            async_write_handler(ec, size);
+            _speculative_sending = false;
+            return;
+        }
+    }
+
+    if (_strand_required)
+        asio::async_write(_socket, ConstBuffersView(_send_queue.buffers()), _strand.wrap(MakeAllocHandler(_send_storage, async_write_handler)));
+    else
+        asio::async_write(_socket, ConstBuffersView(_send_queue.buffers()), MakeAllocHandler(_send_storage, async_write_handler));
 }
 
-void TCPClient::ClearBuffers()
+void TCPClient::TryComplete()
 {
-    // Clear send buffers
+    // Release buffers of completed zero copy sends
+    if ((_zero_copy.Complete(_socket) == 0) || _zero_copy_waiting)
+        return;
+
+    // Wait for the rest of completions in the socket error queue
+    _zero_copy_waiting = true;
+    auto self(this->shared_from_this());
+    auto async_wait_handler = [this, self](std::error_code ec)
     {
-        std::lock_guard<std::mutex> locker(_send_lock);
+        _zero_copy_waiting = false;
 
-        _send_buffer_main.clear();
-        _send_buffer_flush.clear();
-        _send_buffer_flush_offset = 0;
+        if (!ec && IsConnected())
+            TryComplete();
+    };
+    if (_strand_required)
+        _socket.async_wait(asio::ip::tcp::socket::wait_error, _strand.wrap(async_wait_handler));
+    else
+        _socket.async_wait(asio::ip::tcp::socket::wait_error, async_wait_handler);
+}
+
+void TCPClient::CorkSocket(bool enable)
+{
+    if (_socket_corked == enable)
+        return;
+
+    // Corking the socket is only a hint, so its failure is ignored
+    _socket_corked = SocketOptions::Cork(_socket, enable) && enable;
+}
+
+bool TCPClient::CheckSendBuffer(size_t size)
+{
+    if (_send_buffer_high == 0)
+        return true;
+
+    // Check the send buffer high watermark
+    if ((_send_queue.buffered() + size) <= _send_buffer_high)
+        return true;
+
+    // Schedule the slow consumer policy for the send routine
+    _send_buffer_overflow = true;
+
+    switch (_slow_consumer_policy)
+    {
+        case SlowConsumerPolicy::DropOldest:
+            // The oldest pending data will be dropped by the send routine
+            return true;
+        case SlowConsumerPolicy::Disconnect:
+            Disconnect(false);
+            return false;
+        default:
+            // Notify about the rejected data from the send routine
+            ScheduleSend();
+            return false;
+    }
+}
+
+void TCPClient::HandleSendBufferOverflow()
+{
+    _send_buffer_overflow = false;
+
+    // Drop the oldest pending data over the high watermark
+    if (_slow_consumer_policy == SlowConsumerPolicy::DropOldest)
+    {
+        size_t pending = _send_queue.buffered();
+        if (pending > _send_buffer_high)
+            _send_queue.Drop(pending - _send_buffer_high);
+    }
+
+    // Call the send buffer high watermark handler
+    if (!_send_buffer_full)
+    {
+        _send_buffer_full = true;
+        onSendBufferHigh();
+    }
+}
+
+void TCPClient::HandleSendBufferDrain(size_t pending)
+{
+    // Call the send buffer low watermark handler
+    if (_send_buffer_full && (pending <= _send_buffer_low))
+    {
+        _send_buffer_full = false;
+        onSendBufferLow();
     }
 }
 
+void TCPClient::ClearBuffers()
+{
+    // Clear the send queue
+    _send_queue.Clear();
+    _send_buffer_overflow = false;
+    _send_buffer_full = false;
+
+    // Release buffers of pending zero copy sends
+    _zero_copy.Close();
+    _socket_corked = false;
+
+    // Drop the split message tail
+    _framer.Reset();
+}
+
 void TCPClient::SendError(std::error_code ec)
 {
     // Skip Asio disconnect errors
@@ -0,0 +1,152 @@
+/*!
+    \file timing_wheel.cpp
+    \brief Timing wheel implementation
+    \author Ivan Shynkarenka
+    \date 07.04.2017
+    \copyright MIT License
+*/
+
+#include "server/asio/timing_wheel.h"
+
+#include <algorithm>
+
+namespace CppServer {
+namespace Asio {
+
+TimingWheel::TimingWheel(uint64_t now) : _now(now), _size(0)
+{
+    for (auto& level : _slots)
+        for (auto& slot : level)
+            slot.prev = slot.next = &slot;
+}
+
+TimingWheel::~TimingWheel()
+{
+    // Disarm all remaining timers
+    for (auto& level : _slots)
+        for (auto& slot : level)
+            while (slot.next != &slot)
+                Detach(*slot.next);
+}
+
+void TimingWheel::Arm(Timer& timer, uint64_t deadline) noexcept
+{
+    if (timer.armed())
+        Detach(timer);
+    else
+        ++_size;
+
+    // The current tick is already expired, so the earliest deadline is the next tick
+    timer._deadline = std::max(deadline, _now + 1);
+    Insert(timer);
+}
+
+bool TimingWheel::Cancel(Timer& timer) noexcept
+{
+    if (!timer.armed())
+        return false;
+
+    Detach(timer);
+    --_size;
+    return true;
+}
+
+size_t TimingWheel::Advance(uint64_t now)
+{
+    size_t expired = 0;
+    while (_now < now)
+    {
+        // Jump over ticks without armed timers
+        if (_size == 0)
+        {
+            _now = now;
+            break;
+        }
+
+        ++_now;
+
+        // Cascade slots of higher levels reached by the wrapped lower levels
+        for (size_t level = 1; level < LEVELS; ++level)
+        {
+            if ((_now & ((1ull << (LEVEL_BITS * level)) - 1)) != 0)
+                break;
+            Cascade(level, (size_t)((_now >> (LEVEL_BITS * level)) & (LEVEL_SLOTS - 1)));
+        }
+
+        // Expire all timers of the current tick
+        Link& slot = _slots[0][_now & (LEVEL_SLOTS - 1)];
+        while (slot.next != &slot)
+        {
+            Timer& timer = static_cast<Timer&>(*slot.next);
+            Detach(timer);
+            --_size;
+            ++expired;
+
+            // Call the timer expiration handler
+            if (timer._handler)
+                timer._handler();
+        }
+    }
+    return expired;
+}
+
+void TimingWheel::Insert(Timer& timer) noexcept
+{
+    // Timeouts longer than the last level are placed at its end and cascaded again
+    const uint64_t max = (1ull << (LEVEL_BITS * LEVELS)) - 1;
+    uint64_t deadline = timer._deadline;
+    uint64_t delta = deadline - std::min(deadline, _now);
+    if (delta > max)
+    {
+        deadline = _now + max;
+        delta = max;
+    }
+
+    // Find the lowest level which covers the timeout
+    size_t level = 0;
+    while ((level < (LEVELS - 1)) && (delta >= (1ull << (LEVEL_BITS * (level + 1)))))
+        ++level;
+
+    Attach(_slots[level][(deadline >> (LEVEL_BITS * level)) & (LEVEL_SLOTS - 1)], timer);
+}
+
+void TimingWheel::Cascade(size_t level, size_t slot) noexcept
+{
+    Link& head = _slots[level][slot];
+    if (head.next == &head)
+        return;
+
+    // Detach all timers of the slot and insert them again into lower levels
+    Link list;
+    list.next = head.next;
+    list.prev = head.prev;
+    list.next->prev = &list;
+    list.prev->next = &list;
+    head.prev = head.next = &head;
+
+    while (list.next != &list)
+    {
+        Timer& timer = static_cast<Timer&>(*list.next);
+        Detach(timer);
+        Insert(timer);
+    }
+}
+
+void TimingWheel::Attach(Link& slot, Link& node) noexcept
+{
+    node.prev = slot.prev;
+    node.next = &slot;
+    slot.prev->next = &node;
+    slot.prev = &node;
+}
+
+void TimingWheel::Detach(Link& node) noexcept
+{
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = nullptr;
+    node.next = nullptr;
+}
+
+} // namespace Asio
+} // namespace CppServer
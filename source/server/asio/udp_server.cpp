@@ -11,20 +11,34 @@
 namespace CppServer {
 namespace Asio {
 
+UDPServer::Receiver::Receiver(std::shared_ptr<Service> service)
+    : service(service),
+      socket(*service->service()),
+      reciving(false),
+      recive_buffer(CHUNK + 1)
+{
+}
+
 UDPServer::UDPServer(std::shared_ptr<Service> service, InternetProtocol protocol, int port)
-    : _service(service),
-      _socket(*_service->service()),
-      _started(false),
-      _datagrams_sent(0),
-      _datagrams_received(0),
-      _bytes_sent(0),
-      _bytes_received(0),
-      _reciving(false),
-      _recive_buffer(CHUNK + 1)
-{
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
-        throw CppCommon::ArgumentException("ASIO service is invalid!");
+    : UDPServer(std::vector<std::shared_ptr<Service>>({ service }), protocol, port)
+{
+}
+
+UDPServer::UDPServer(std::shared_ptr<Service> service, const std::string& address, int port)
+    : UDPServer(std::vector<std::shared_ptr<Service>>({ service }), address, port)
+{
+}
+
+UDPServer::UDPServer(std::shared_ptr<Service> service, const asio::ip::udp::endpoint& endpoint)
+    : UDPServer(std::vector<std::shared_ptr<Service>>({ service }), endpoint)
+{
+}
+
+UDPServer::UDPServer(const std::vector<std::shared_ptr<Service>>& services, InternetProtocol protocol, int port)
+    : _service(services.empty() ? nullptr : services.front()),
+      _started(false)
+{
+    CreateReceivers(services);
 
     switch (protocol)
     {
@@ -37,39 +51,50 @@ UDPServer::UDPServer(std::shared_ptr<Service> service, InternetProtocol protocol
     }
 }
 
-UDPServer::UDPServer(std::shared_ptr<Service> service, const std::string& address, int port)
-    : _service(service),
-      _socket(*_service->service()),
-      _started(false),
-      _datagrams_sent(0),
-      _datagrams_received(0),
-      _bytes_sent(0),
-      _bytes_received(0),
-      _reciving(false),
-      _recive_buffer(CHUNK + 1)
-{
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
-        throw CppCommon::ArgumentException("ASIO service is invalid!");
+UDPServer::UDPServer(const std::vector<std::shared_ptr<Service>>& services, const std::string& address, int port)
+    : _service(services.empty() ? nullptr : services.front()),
+      _started(false)
+{
+    CreateReceivers(services);
 
     _endpoint = asio::ip::udp::endpoint(asio::ip::address::from_string(address), port);
 }
 
-UDPServer::UDPServer(std::shared_ptr<Service> service, const asio::ip::udp::endpoint& endpoint)
-    : _service(service),
+UDPServer::UDPServer(const std::vector<std::shared_ptr<Service>>& services, const asio::ip::udp::endpoint& endpoint)
+    : _service(services.empty() ? nullptr : services.front()),
       _endpoint(endpoint),
-      _socket(*_service->service()),
-      _started(false),
-      _datagrams_sent(0),
-      _datagrams_received(0),
-      _bytes_sent(0),
-      _bytes_received(0),
-      _reciving(false),
-      _recive_buffer(CHUNK + 1)
-{
-    assert((service != nullptr) && "ASIO service is invalid!");
-    if (service == nullptr)
+      _started(false)
+{
+    CreateReceivers(services);
+}
+
+void UDPServer::CreateReceivers(const std::vector<std::shared_ptr<Service>>& services)
+{
+    assert(!services.empty() && "ASIO service is invalid!");
+    if (services.empty())
         throw CppCommon::ArgumentException("ASIO service is invalid!");
+
+    for (auto& service : services)
+    {
+        assert((service != nullptr) && "ASIO service is invalid!");
+        if (service == nullptr)
+            throw CppCommon::ArgumentException("ASIO service is invalid!");
+
+        _receivers.emplace_back(std::make_unique<Receiver>(service));
+
+#if !defined(SO_REUSEPORT)
+        // Only one socket could receive datagrams if SO_REUSEPORT is not supported
+        break;
+#endif
+    }
+}
+
+Statistics UDPServer::statistics() const noexcept
+{
+    Statistics result;
+    for (auto& receiver : _receivers)
+        receiver->statistics.Collect(result);
+    return result;
 }
 
 bool UDPServer::Start()
@@ -85,14 +110,9 @@ bool UDPServer::Start()
         if (IsStarted())
             return;
 
-        // Open the server socket
-        _socket = asio::ip::udp::socket(*_service->service(), _endpoint);
-
         // Reset statistic
-        _datagrams_sent = 0;
-        _datagrams_received = 0;
-        _bytes_sent = 0;
-        _bytes_received = 0;
+        for (auto& receiver : _receivers)
+            receiver->statistics.Reset();
 
          // Update the started flag
         _started = true;
@@ -100,8 +120,9 @@ bool UDPServer::Start()
         // Call the server started handler
         onStarted();
 
-        // Try to receive datagrams from the clients
-        TryReceive();
+        // Open all receivers and try to receive datagrams from the clients
+        for (auto& receiver : _receivers)
+            Open(receiver.get());
     });
 
     return true;
@@ -132,8 +153,15 @@ bool UDPServer::Stop()
         if (!IsStarted())
             return;
 
-        // Close the server socket
-        _socket.close();
+        // Close receivers sockets
+        for (auto& receiver_ptr : _receivers)
+        {
+            Receiver* receiver = receiver_ptr.get();
+            receiver->service->Dispatch([this, self, receiver]()
+            {
+                receiver->socket.close();
+            });
+        }
 
         // Update the started flag
         _started = false;
@@ -175,12 +203,11 @@ bool UDPServer::Send(const asio::ip::udp::endpoint& endpoint, const void* buffer
     asio::error_code ec;
 
     // Sent datagram to the server
-    size_t sent = _socket.send_to(asio::const_buffer(buffer, size), endpoint, 0, ec);
+    size_t sent = _receivers.front()->socket.send_to(asio::const_buffer(buffer, size), endpoint, 0, ec);
     if (sent > 0)
     {
         // Update statistic
-        ++_datagrams_sent;
-        _bytes_sent += sent;
+        _receivers.front()->statistics.Sent(sent, 1);
 
         // Call the datagram sent handler
         onSent(endpoint, sent);
@@ -196,19 +223,46 @@ bool UDPServer::Send(const asio::ip::udp::endpoint& endpoint, const void* buffer
     return true;
 }
 
-void UDPServer::TryReceive()
+void UDPServer::Open(Receiver* receiver)
 {
-    if (_reciving)
+    // Dispatch the open routine into the receiver service
+    auto self(this->shared_from_this());
+    receiver->service->Dispatch([this, self, receiver]()
+    {
+        if (!IsStarted())
+            return;
+
+        // Open the receiver socket
+        if (_receivers.size() == 1)
+            receiver->socket = asio::ip::udp::socket(*receiver->service->service(), _endpoint);
+        else
+        {
+            receiver->socket = asio::ip::udp::socket(*receiver->service->service(), _endpoint.protocol());
+            receiver->socket.set_option(asio::ip::udp::socket::reuse_address(true));
+#if defined(SO_REUSEPORT)
+            receiver->socket.set_option(ReusePort(true));
+#endif
+            receiver->socket.bind(_endpoint);
+        }
+
+        // Try to receive datagrams from the clients
+        TryReceive(receiver);
+    });
+}
+
+void UDPServer::TryReceive(Receiver* receiver)
+{
+    if (receiver->reciving)
         return;
 
     if (!IsStarted())
         return;
 
-    _reciving = true;
+    receiver->reciving = true;
     auto self(this->shared_from_this());
-    _socket.async_receive_from(asio::buffer(_recive_buffer.data(), _recive_buffer.size()), _recive_endpoint, [this, self](std::error_code ec, std::size_t size)
+    receiver->socket.async_receive_from(asio::buffer(receiver->recive_buffer.data(), receiver->recive_buffer.size()), receiver->recive_endpoint, MakeAllocHandler(receiver->recive_storage, [this, self, receiver](std::error_code ec, std::size_t size)
     {
-        _reciving = false;
+        receiver->reciving = false;
 
         if (!IsStarted())
             return;
@@ -217,23 +271,22 @@ void UDPServer::TryReceive()
         if (size > 0)
         {
             // Update statistic
-            ++_datagrams_received;
-            _bytes_received += size;
+            receiver->statistics.Received(size, 1);
 
             // Call the datagram received handler
-            onReceived(_recive_endpoint, _recive_buffer.data(), size);
+            onReceived(receiver->recive_endpoint, receiver->recive_buffer.data(), size);
 
             // If the receive buffer is full increase its size
-            if (_recive_buffer.size() == size)
-                _recive_buffer.resize(2 * size);
+            if (receiver->recive_buffer.size() == size)
+                receiver->recive_buffer.resize(2 * size);
         }
 
         // Try to receive again if the session is valid
         if (!ec)
-            TryReceive();
+            TryReceive(receiver);
         else
             SendError(ec);
-    });
+    }));
 }
 
 void UDPServer::SendError(std::error_code ec)
@@ -0,0 +1,248 @@
+/*!
+    \file zero_copy.cpp
+    \brief Zero copy send implementation
+    \author Ivan Shynkarenka
+    \date 29.03.2017
+    \copyright MIT License
+*/
+
+#include "server/asio/zero_copy.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+#if defined(linux) || defined(__linux) || defined(__linux__)
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define ZERO_COPY_SUPPORTED
+#endif
+#endif
+
+namespace CppServer {
+namespace Asio {
+
+bool ZeroCopy::Open(asio::ip::tcp::socket& socket)
+{
+    _sequence = 0;
+    _enabled = false;
+
+    if (_threshold == 0)
+        return false;
+
+#if defined(ZERO_COPY_SUPPORTED)
+    // Kernels older than 4.14 fail with ENOPROTOOPT
+    int enable = 1;
+    if (::setsockopt(socket.native_handle(), SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0)
+        _enabled = true;
+#endif
+
+    return _enabled;
+}
+
+void ZeroCopy::Close()
+{
+    _pending.clear();
+    _sequence = 0;
+    _enabled = false;
+}
+
+bool ZeroCopy::Linger(asio::ip::tcp::socket& socket, ZeroCopyLinger& linger)
+{
+    bool first = false;
+
+#if defined(ZERO_COPY_SUPPORTED)
+    // Release buffers of already completed sends
+    if (socket.is_open() && (Complete(socket) > 0))
+    {
+        // Shut down the connection, the duplicated descriptor keeps the socket error queue after the socket is closed
+        int descriptor = ::dup(socket.native_handle());
+        if (descriptor >= 0)
+            ::shutdown(descriptor, SHUT_RDWR);
+        first = linger.Add(descriptor, std::move(_pending));
+    }
+#endif
+
+    Close();
+    return first;
+}
+
+size_t ZeroCopy::Send(asio::ip::tcp::socket& socket, const std::vector<asio::const_buffer>& buffers, const std::shared_ptr<const void>& holder, asio::error_code& ec)
+{
+    ec.clear();
+
+#if defined(ZERO_COPY_SUPPORTED)
+    if (buffers.empty())
+        return 0;
+
+    // Prepare the scatter/gather array
+    iovec iov[64];
+    size_t count = std::min(buffers.size(), sizeof(iov) / sizeof(iov[0]));
+    for (size_t i = 0; i < count; ++i)
+    {
+        iov[i].iov_base = (void*)asio::buffer_cast<const void*>(buffers[i]);
+        iov[i].iov_len = asio::buffer_size(buffers[i]);
+    }
+
+    msghdr message = {};
+    message.msg_iov = iov;
+    message.msg_iovlen = count;
+
+    int fd = socket.native_handle();
+    bool copied = false;
+    ssize_t result;
+    do
+    {
+        result = ::sendmsg(fd, &message, MSG_ZEROCOPY | MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while ((result < 0) && (errno == EINTR));
+
+    // Fall back to the normal copy if the kernel cannot pin more pages
+    if ((result < 0) && (errno == ENOBUFS))
+    {
+        copied = true;
+        do
+        {
+            result = ::sendmsg(fd, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while ((result < 0) && (errno == EINTR));
+    }
+
+    if (result < 0)
+    {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            ec = asio::error::would_block;
+        else
+            ec = asio::error_code(errno, asio::error::get_system_category());
+        return 0;
+    }
+
+    // Each successful zero copy send gets the next completion sequence number
+    if (!copied)
+        _pending.push_back(Pending{ _sequence++, holder });
+
+    return (size_t)result;
+#else
+    ec = asio::error::operation_not_supported;
+    return 0;
+#endif
+}
+
+size_t ZeroCopy::Complete(asio::ip::tcp::socket& socket)
+{
+    // Deferred copies are more expensive than normal sends
+    if (Receive(socket.native_handle(), _pending))
+        _enabled = false;
+
+    return _pending.size();
+}
+
+bool ZeroCopy::Receive(int descriptor, std::deque<Pending>& pending)
+{
+    bool copied = false;
+
+#if defined(ZERO_COPY_SUPPORTED)
+    while (!pending.empty())
+    {
+        uint8_t control[128];
+        msghdr message = {};
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t result = ::recvmsg(descriptor, &message, MSG_ERRQUEUE | MSG_DONTWAIT);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg))
+        {
+            if (!(((cmsg->cmsg_level == SOL_IP) && (cmsg->cmsg_type == IP_RECVERR)) ||
+                  ((cmsg->cmsg_level == SOL_IPV6) && (cmsg->cmsg_type == IPV6_RECVERR))))
+                continue;
+
+            const sock_extended_err* error = (const sock_extended_err*)CMSG_DATA(cmsg);
+            if ((error->ee_errno != 0) || (error->ee_origin != SO_EE_ORIGIN_ZEROCOPY))
+                continue;
+
+            if (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                copied = true;
+
+            Release(pending, error->ee_info, error->ee_data);
+        }
+    }
+#endif
+
+    return copied;
+}
+
+void ZeroCopy::Release(std::deque<Pending>& pending, uint32_t first, uint32_t last)
+{
+    // Completed range is inclusive and might wrap around
+    uint32_t range = last - first;
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [first, range](const Pending& item) { return (uint32_t)(item.sequence - first) <= range; }), pending.end());
+}
+
+ZeroCopyLinger::~ZeroCopyLinger()
+{
+#if defined(ZERO_COPY_SUPPORTED)
+    for (auto& socket : _sockets)
+        if (socket.descriptor >= 0)
+            ::close(socket.descriptor);
+#endif
+}
+
+size_t ZeroCopyLinger::size() const
+{
+    std::lock_guard<std::mutex> locker(_lock);
+    return _sockets.size();
+}
+
+size_t ZeroCopyLinger::Poll()
+{
+    std::lock_guard<std::mutex> locker(_lock);
+
+    size_t lingering = 0;
+    for (size_t i = 0; i < _sockets.size();)
+    {
+        Socket& socket = _sockets[i];
+
+        // Sockets without the duplicated descriptor keep their buffers till the linger is destroyed
+        if (socket.descriptor < 0)
+        {
+            ++i;
+            continue;
+        }
+
+        ZeroCopy::Receive(socket.descriptor, socket.pending);
+        if (socket.pending.empty())
+        {
+#if defined(ZERO_COPY_SUPPORTED)
+            ::close(socket.descriptor);
+#endif
+            std::swap(socket, _sockets.back());
+            _sockets.pop_back();
+            continue;
+        }
+
+        ++lingering;
+        ++i;
+    }
+    return lingering;
+}
+
+bool ZeroCopyLinger::Add(int descriptor, std::deque<ZeroCopy::Pending>&& pending)
+{
+    std::lock_guard<std::mutex> locker(_lock);
+
+    bool first = (descriptor >= 0) && std::none_of(_sockets.begin(), _sockets.end(), [](const Socket& socket) { return socket.descriptor >= 0; });
+    _sockets.push_back(Socket{ descriptor, std::move(pending) });
+    return first;
+}
+
+} // namespace Asio
+} // namespace CppServer
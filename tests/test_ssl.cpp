@@ -8,6 +8,7 @@
 #include "server/asio/ssl_server.h"
 #include "threads/thread.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <vector>
@@ -84,6 +85,7 @@ public:
     std::atomic<bool> connected;
     std::atomic<bool> handshaked;
     std::atomic<bool> disconnected;
+    std::atomic<bool> recycled;
     std::atomic<bool> error;
 
     explicit EchoSSLSession(std::shared_ptr<SSLServer<EchoSSLServer, EchoSSLSession>> server, asio::ip::tcp::socket&& socket, std::shared_ptr<asio::ssl::context> context)
@@ -91,6 +93,7 @@ public:
           connected(false),
           handshaked(false),
           disconnected(false),
+          recycled(false),
           error(false)
     {
     }
@@ -99,6 +102,7 @@ protected:
     void onConnected() override { connected = true; }
     void onHandshaked() override { handshaked = true; }
     void onDisconnected() override { disconnected = true; }
+    void onRecycled() override { connected = false; handshaked = false; disconnected = false; recycled = true; }
     void onReceived(const void* buffer, size_t size) override { Send(buffer, size); }
     void onError(int error, const std::string& category, const std::string& message) override { error = true; }
 };
@@ -111,6 +115,7 @@ public:
     std::atomic<bool> connected;
     std::atomic<bool> disconnected;
     std::atomic<size_t> clients;
+    std::atomic<size_t> recycled;
     std::atomic<bool> error;
 
     explicit EchoSSLServer(std::shared_ptr<EchoSSLService> service, std::shared_ptr<asio::ssl::context> context, InternetProtocol protocol, int port)
@@ -120,6 +125,7 @@ public:
           connected(false),
           disconnected(false),
           clients(0),
+          recycled(0),
           error(false)
     {
     }
@@ -138,11 +144,37 @@ public:
 protected:
     void onStarted() override { started = true; }
     void onStopped() override { stopped = true; }
-    void onConnected(std::shared_ptr<EchoSSLSession>& session) override { connected = true; ++clients; }
+    void onConnected(std::shared_ptr<EchoSSLSession>& session) override { connected = true; ++clients; if (session->recycled) ++recycled; }
     void onDisconnected(std::shared_ptr<EchoSSLSession>& session) override { disconnected = true; --clients; }
     void onError(int error, const std::string& category, const std::string& message) override { error = true; }
 };
 
+class FramedSSLClient : public EchoSSLClient
+{
+public:
+    std::atomic<size_t> messages;
+    std::atomic<bool> invalid;
+
+    explicit FramedSSLClient(std::shared_ptr<EchoSSLService> service, std::shared_ptr<asio::ssl::context> context, const std::string& address, int port)
+        : EchoSSLClient(service, context, address, port),
+          messages(0),
+          invalid(false)
+    {
+        SetupFraming();
+        SetupReceiveRing(4096);
+    }
+
+protected:
+    void onReceivedMessage(const void* buffer, size_t size) override
+    {
+        // Check the message parsed in place from the receive ring
+        const uint8_t* data = (const uint8_t*)buffer;
+        if ((size != (messages % 3000 + 1)) || !std::all_of(data, data + size, [size](uint8_t value) { return value == ('a' + size % 26); }))
+            invalid = true;
+        ++messages;
+    }
+};
+
 TEST_CASE("SSL server", "[CppServer][Asio]")
 {
     const std::string address = "127.0.0.1";
@@ -477,3 +509,258 @@ TEST_CASE("SSL server random test", "[CppServer][Asio]")
     REQUIRE(server->bytes_received() > 0);
     REQUIRE(!server->error);
 }
+
+TEST_CASE("SSL server receive ring", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 3336;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoSSLService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and prepare a new SSL server context
+    auto server_context = EchoSSLServer::CreateContext();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoSSLServer>(service, server_context, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and prepare a new SSL client context
+    auto client_context = EchoSSLServer::CreateContext();
+
+    // Create and connect Framed client with the receive ring
+    auto client = std::make_shared<FramedSSLClient>(service, client_context, address, port);
+    REQUIRE(client->receive_ring() >= 4096);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || !client->IsHandshaked() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send messages of different sizes to the Echo server
+    size_t total = 0;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        size_t size = i % 3000 + 1;
+        client->SendFrame(std::string(size, (char)('a' + size % 26)));
+        total += 4 + size;
+    }
+
+    // Wait for all messages echoed...
+    while (client->messages != 1000)
+        Thread::Yield();
+    REQUIRE(!client->invalid);
+
+    // Disconnect the Framed client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || client->IsHandshaked() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_received() == total);
+    REQUIRE(server->bytes_sent() == total);
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("SSL server session pool", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 3337;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoSSLService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and prepare a new SSL server context
+    auto server_context = EchoSSLServer::CreateContext();
+
+    // Create and start Echo server with the session pool
+    auto server = std::make_shared<EchoSSLServer>(service, server_context, InternetProtocol::IPv4, port);
+    server->SetupSessionPool(2);
+    REQUIRE(server->session_pool() == 2);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and prepare a new SSL client context
+    auto client_context = EchoSSLServer::CreateContext();
+
+    // Connect and disconnect clients one by one
+    for (int i = 0; i < 10; ++i)
+    {
+        auto client = std::make_shared<EchoSSLClient>(service, client_context, address, port);
+        REQUIRE(client->Connect());
+        while (!client->IsConnected() || !client->IsHandshaked() || (server->clients != 1))
+            Thread::Yield();
+
+        // Check the echo from the new or reused session
+        client->Send("test");
+        while (client->bytes_received() != 4)
+            Thread::Yield();
+
+        // Sessions disconnected by both sides are recycled with a new SSL stream
+        if ((i % 2) == 0)
+            REQUIRE(client->Disconnect());
+        else
+            server->DisconnectAll();
+        while (client->IsConnected() || client->IsHandshaked() || (server->clients != 0))
+            Thread::Yield();
+        REQUIRE(!client->error);
+
+        // Wait for the released session returned into the session pool
+        Thread::Sleep(10);
+    }
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->recycled > 0);
+    REQUIRE(server->bytes_received() == 40);
+    REQUIRE(server->bytes_sent() == 40);
+    REQUIRE(!server->error);
+}
+
+TEST_CASE("SSL server disconnect", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 3339;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoSSLService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and prepare a new SSL server context
+    auto server_context = EchoSSLServer::CreateContext();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoSSLServer>(service, server_context, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and prepare a new SSL client context
+    auto client_context = EchoSSLServer::CreateContext();
+
+    // Create and connect Echo client
+    auto client = std::make_shared<EchoSSLClient>(service, client_context, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || !client->IsHandshaked() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send a message to the Echo server
+    client->Send("test");
+
+    // Wait for all data processed...
+    while (client->bytes_received() != 4)
+        Thread::Yield();
+
+    // Disconnect all clients from the server side, the client drops the connection without close_notify
+    REQUIRE(server->DisconnectAll());
+    while (client->IsConnected() || client->IsHandshaked() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->connected);
+    REQUIRE(server->disconnected);
+    REQUIRE(server->bytes_received() == 4);
+    REQUIRE(!server->error);
+
+    // Check the Echo client state
+    REQUIRE(client->disconnected);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("SSL server idle timeouts", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 3338;
+
+    // Create and start Asio service with the fine timing wheel
+    auto service = std::make_shared<EchoSSLService>();
+    service->SetupTimingWheel(10);
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and prepare a new SSL server context
+    auto server_context = EchoSSLServer::CreateContext();
+
+    // Create and start Echo server with the read idle timeout
+    auto server = std::make_shared<EchoSSLServer>(service, server_context, InternetProtocol::IPv4, port);
+    server->SetupIdleTimeouts(200, 0);
+    REQUIRE(server->read_timeout() == 200);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and prepare a new SSL client context
+    auto client_context = EchoSSLServer::CreateContext();
+
+    // Create and connect Echo client
+    auto client = std::make_shared<EchoSSLClient>(service, client_context, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || !client->IsHandshaked() || (server->clients != 1))
+        Thread::Yield();
+
+    // Check the active client is kept connected
+    for (int i = 0; i < 20; ++i)
+    {
+        client->Send("test");
+        Thread::Sleep(20);
+    }
+    REQUIRE(client->IsConnected());
+
+    // Check the silent client is disconnected after the read idle timeout
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_received() == 80);
+    REQUIRE(!server->error);
+}
@@ -8,8 +8,14 @@
 #include "server/asio/tcp_server.h"
 #include "threads/thread.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <thread>
 #include <vector>
 
 using namespace CppCommon;
@@ -25,8 +31,9 @@ public:
     std::atomic<bool> idle;
     std::atomic<bool> error;
 
-    explicit EchoTCPService()
-        : thread_initialize(false),
+    explicit EchoTCPService(int threads = 1)
+        : Service(threads),
+          thread_initialize(false),
           thread_cleanup(false),
           started(false),
           stopped(false),
@@ -72,12 +79,18 @@ class EchoTCPSession : public TCPSession<EchoTCPServer, EchoTCPSession>
 public:
     std::atomic<bool> connected;
     std::atomic<bool> disconnected;
+    std::atomic<bool> buffer_high;
+    std::atomic<bool> buffer_low;
+    std::atomic<bool> recycled;
     std::atomic<bool> error;
 
     explicit EchoTCPSession(std::shared_ptr<TCPServer<EchoTCPServer, EchoTCPSession>> server, asio::ip::tcp::socket&& socket)
         : TCPSession<EchoTCPServer, EchoTCPSession>(server, std::move(socket)),
           connected(false),
           disconnected(false),
+          buffer_high(false),
+          buffer_low(false),
+          recycled(false),
           error(false)
     {
     }
@@ -85,7 +98,10 @@ public:
 protected:
     void onConnected() override { connected = true; }
     void onDisconnected() override { disconnected = true; }
+    void onRecycled() override { connected = false; disconnected = false; recycled = true; }
     void onReceived(const void* buffer, size_t size) override { Send(buffer, size); }
+    void onSendBufferHigh() override { buffer_high = true; }
+    void onSendBufferLow() override { buffer_low = true; }
     void onError(int error, const std::string& category, const std::string& message) override { error = true; }
 };
 
@@ -97,6 +113,8 @@ public:
     std::atomic<bool> connected;
     std::atomic<bool> disconnected;
     std::atomic<size_t> clients;
+    std::atomic<uint64_t> last_key;
+    std::atomic<size_t> recycled;
     std::atomic<bool> error;
 
     explicit EchoTCPServer(std::shared_ptr<EchoTCPService> service, InternetProtocol protocol, int port)
@@ -106,6 +124,21 @@ public:
           connected(false),
           disconnected(false),
           clients(0),
+          last_key(0),
+          recycled(0),
+          error(false)
+    {
+    }
+
+    explicit EchoTCPServer(const std::vector<std::shared_ptr<Service>>& services, InternetProtocol protocol, int port, ShardPolicy policy)
+        : TCPServer<EchoTCPServer, EchoTCPSession>(services, protocol, port, policy),
+          started(false),
+          stopped(false),
+          connected(false),
+          disconnected(false),
+          clients(0),
+          last_key(0),
+          recycled(0),
           error(false)
     {
     }
@@ -113,11 +146,155 @@ public:
 protected:
     void onStarted() override { started = true; }
     void onStopped() override { stopped = true; }
-    void onConnected(std::shared_ptr<EchoTCPSession>& session) override { connected = true; ++clients; }
+    void onConnected(std::shared_ptr<EchoTCPSession>& session) override { connected = true; last_key = session->key(); ++clients; if (session->recycled) ++recycled; }
     void onDisconnected(std::shared_ptr<EchoTCPSession>& session) override { disconnected = true; --clients; }
     void onError(int error, const std::string& category, const std::string& message) override { error = true; }
 };
 
+class FramedTCPClient : public EchoTCPClient
+{
+public:
+    std::atomic<size_t> messages;
+    std::atomic<size_t> message_bytes;
+
+    explicit FramedTCPClient(std::shared_ptr<EchoTCPService> service, const std::string& address, int port)
+        : EchoTCPClient(service, address, port),
+          messages(0),
+          message_bytes(0)
+    {
+    }
+
+protected:
+    void onReceivedMessage(const void* buffer, size_t size) override { ++messages; message_bytes += size; }
+};
+
+class FramedTCPServer;
+
+class FramedTCPSession : public TCPSession<FramedTCPServer, FramedTCPSession>
+{
+public:
+    explicit FramedTCPSession(std::shared_ptr<TCPServer<FramedTCPServer, FramedTCPSession>> server, asio::ip::tcp::socket&& socket)
+        : TCPSession<FramedTCPServer, FramedTCPSession>(server, std::move(socket))
+    {
+        SetupFraming(2, ByteOrder::LittleEndian, 1000);
+    }
+
+protected:
+    void onReceivedMessage(const void* buffer, size_t size) override { SendFrame(buffer, size); }
+};
+
+class FramedTCPServer : public TCPServer<FramedTCPServer, FramedTCPSession>
+{
+public:
+    std::atomic<size_t> clients;
+
+    explicit FramedTCPServer(std::shared_ptr<EchoTCPService> service, InternetProtocol protocol, int port)
+        : TCPServer<FramedTCPServer, FramedTCPSession>(service, protocol, port),
+          clients(0)
+    {
+    }
+
+protected:
+    void onConnected(std::shared_ptr<FramedTCPSession>& session) override { ++clients; }
+    void onDisconnected(std::shared_ptr<FramedTCPSession>& session) override { --clients; }
+};
+
+class FileTCPClient : public EchoTCPClient
+{
+public:
+    std::string data;
+    std::atomic<size_t> received;
+
+    explicit FileTCPClient(std::shared_ptr<EchoTCPService> service, const std::string& address, int port)
+        : EchoTCPClient(service, address, port),
+          received(0)
+    {
+    }
+
+protected:
+    void onReceived(const void* buffer, size_t size) override { data.append((const char*)buffer, size); received += size; }
+};
+
+class CorkTCPClient : public FileTCPClient
+{
+public:
+    std::atomic<size_t> writes;
+
+    explicit CorkTCPClient(std::shared_ptr<EchoTCPService> service, const std::string& address, int port)
+        : FileTCPClient(service, address, port),
+          writes(0)
+    {
+    }
+
+protected:
+    void onSent(size_t sent, size_t pending) override { ++writes; }
+};
+
+class RingTCPClient : public EchoTCPClient
+{
+public:
+    static const size_t RECORD = 1000;
+
+    std::atomic<size_t> records;
+    std::atomic<bool> invalid;
+
+    explicit RingTCPClient(std::shared_ptr<EchoTCPService> service, const std::string& address, int port)
+        : EchoTCPClient(service, address, port),
+          records(0),
+          invalid(false)
+    {
+        SetupReceiveRing(4096);
+    }
+
+protected:
+    void onReceivedRing(const void* buffer, size_t size) override
+    {
+        // Check and consume complete records only
+        const uint8_t* data = (const uint8_t*)buffer;
+        size_t count = size / RECORD;
+        for (size_t i = 0; i < count; ++i, ++records)
+            if (!std::all_of(data + i * RECORD, data + (i + 1) * RECORD, [this](uint8_t value) { return value == ('a' + records % 26); }))
+                invalid = true;
+        ConsumeReceived(count * RECORD);
+    }
+};
+
+class HeartbeatTCPServer : public EchoTCPServer
+{
+public:
+    std::atomic<size_t> read_idle;
+    std::atomic<size_t> write_idle;
+    std::atomic<size_t> lifetime;
+
+    explicit HeartbeatTCPServer(std::shared_ptr<EchoTCPService> service, InternetProtocol protocol, int port)
+        : EchoTCPServer(service, protocol, port),
+          read_idle(0),
+          write_idle(0),
+          lifetime(0)
+    {
+    }
+
+protected:
+    void onIdle(std::shared_ptr<EchoTCPSession>& session, IdleTimeout timeout) override
+    {
+        // Send heartbeats into sessions which are idle for writes
+        switch (timeout)
+        {
+            case IdleTimeout::Read:
+                ++read_idle;
+                break;
+            case IdleTimeout::Write:
+                ++write_idle;
+                session->Send("ping");
+                break;
+            case IdleTimeout::Lifetime:
+                ++lifetime;
+                break;
+        }
+        EchoTCPServer::onIdle(session, timeout);
+    }
+};
+
 TEST_CASE("TCP server", "[CppServer][Asio]")
 {
     const std::string address = "127.0.0.1";
@@ -433,3 +610,1799 @@ TEST_CASE("TCP server random test", "[CppServer][Asio]")
     REQUIRE(server->bytes_received() > 0);
     REQUIRE(!server->error);
 }
+
+TEST_CASE("TCP server multithreading", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1114;
+
+    // Create and start Asio service with several working threads
+    auto service = std::make_shared<EchoTCPService>(4);
+    REQUIRE(service->threads() == 4);
+    REQUIRE(service->IsStrandRequired());
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo clients
+    std::vector<std::shared_ptr<EchoTCPClient>> clients;
+    for (int i = 0; i < 10; ++i)
+    {
+        auto client = std::make_shared<EchoTCPClient>(service, address, port);
+        REQUIRE(client->Connect());
+        clients.emplace_back(client);
+    }
+    for (auto& client : clients)
+        while (!client->IsConnected())
+            Thread::Yield();
+    while (server->clients != clients.size())
+        Thread::Yield();
+
+    // Send messages to the Echo server from all clients
+    for (int i = 0; i < 100; ++i)
+        for (auto& client : clients)
+            client->Send("test");
+
+    // Wait for all data processed...
+    for (auto& client : clients)
+        while (client->bytes_received() != 400)
+            Thread::Yield();
+
+    // Disconnect all Echo clients
+    for (auto& client : clients)
+        REQUIRE(client->Disconnect());
+    for (auto& client : clients)
+        while (client->IsConnected())
+            Thread::Yield();
+    while (server->clients != 0)
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->started);
+    REQUIRE(server->stopped);
+    REQUIRE(server->connected);
+    REQUIRE(server->disconnected);
+    REQUIRE(server->bytes_sent() == 4000);
+    REQUIRE(server->bytes_received() == 4000);
+    REQUIRE(!server->error);
+
+    // Check the Echo clients state
+    for (auto& client : clients)
+    {
+        REQUIRE(client->bytes_sent() == 400);
+        REQUIRE(client->bytes_received() == 400);
+        REQUIRE(!client->error);
+    }
+}
+
+TEST_CASE("TCP server polling threads", "[CppServer][Asio]")
+{
+    // Check all working threads run handlers in the polling and the adaptive polling modes
+    for (int spin_budget : { 0, 1000 })
+    {
+        // Create and start Asio service with 4 working threads in the polling mode
+        auto service = std::make_shared<EchoTCPService>(4);
+        service->SetupAdaptivePolling(spin_budget);
+        REQUIRE(service->Start(true));
+        while (!service->IsStarted() || !service->started)
+            Thread::Yield();
+
+        // Let working threads pass their first polling iterations
+        Thread::Sleep(100);
+
+        // Each handler waits for all others, so they meet only if all working threads are running
+        std::atomic<int> running(0);
+        std::atomic<int> met(0);
+        std::atomic<int> finished(0);
+        for (int i = 0; i < 4; ++i)
+        {
+            service->Post([&running, &met, &finished]()
+            {
+                ++running;
+                for (int j = 0; (j < 5000) && (running < 4); ++j)
+                    Thread::Sleep(1);
+                if (running == 4)
+                    ++met;
+                ++finished;
+            });
+        }
+        while (finished != 4)
+            Thread::Yield();
+        REQUIRE(met == 4);
+
+        // Stop the Asio service
+        REQUIRE(service->Stop());
+        while (service->IsStarted())
+            Thread::Yield();
+
+        // Check the Asio service state
+        REQUIRE(service->started);
+        REQUIRE(service->stopped);
+        REQUIRE(!service->error);
+    }
+}
+
+TEST_CASE("TCP server sharding", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1115;
+
+    for (auto policy : { ShardPolicy::RoundRobin, ShardPolicy::LeastLoaded, ShardPolicy::ReusePort })
+    {
+        // Create and start Asio service for clients
+        auto service = std::make_shared<EchoTCPService>();
+        REQUIRE(service->Start());
+        while (!service->IsStarted())
+            Thread::Yield();
+
+        // Create and start Asio services for server shards
+        std::vector<std::shared_ptr<Service>> services;
+        for (int i = 0; i < 4; ++i)
+        {
+            auto shard_service = std::make_shared<EchoTCPService>();
+            REQUIRE(shard_service->Start());
+            while (!shard_service->IsStarted())
+                Thread::Yield();
+            services.emplace_back(shard_service);
+        }
+
+        // Create and start sharded Echo server
+        auto server = std::make_shared<EchoTCPServer>(services, InternetProtocol::IPv4, port, policy);
+        REQUIRE(server->shards() == 4);
+        REQUIRE(server->shard_policy() == policy);
+        REQUIRE(server->Start());
+        while (!server->IsStarted())
+            Thread::Yield();
+
+        // Create and connect Echo clients
+        std::vector<std::shared_ptr<EchoTCPClient>> clients;
+        for (int i = 0; i < 8; ++i)
+        {
+            auto client = std::make_shared<EchoTCPClient>(service, address, port);
+            REQUIRE(client->Connect());
+            clients.emplace_back(client);
+        }
+        for (auto& client : clients)
+            while (!client->IsConnected())
+                Thread::Yield();
+        while (server->clients != clients.size())
+            Thread::Yield();
+        REQUIRE(server->current_sessions() == clients.size());
+
+        // Send messages to the Echo server from all clients
+        for (int i = 0; i < 100; ++i)
+            for (auto& client : clients)
+                client->Send("test");
+
+        // Wait for all data processed...
+        for (auto& client : clients)
+            while (client->bytes_received() != 400)
+                Thread::Yield();
+
+        // Multicast some data to all shards
+        server->Multicast("test");
+
+        // Wait for all data processed...
+        for (auto& client : clients)
+            while (client->bytes_received() != 404)
+                Thread::Yield();
+
+        // Disconnect all Echo clients
+        for (auto& client : clients)
+            REQUIRE(client->Disconnect());
+        for (auto& client : clients)
+            while (client->IsConnected())
+                Thread::Yield();
+        while (server->clients != 0)
+            Thread::Yield();
+        REQUIRE(server->current_sessions() == 0);
+
+        // Stop the Echo server
+        REQUIRE(server->Stop());
+        while (server->IsStarted())
+            Thread::Yield();
+
+        // Stop Asio services
+        for (auto& shard_service : services)
+        {
+            REQUIRE(shard_service->Stop());
+            while (shard_service->IsStarted())
+                Thread::Yield();
+        }
+        REQUIRE(service->Stop());
+        while (service->IsStarted())
+            Thread::Yield();
+
+        // Check the Echo server state
+        REQUIRE(server->started);
+        REQUIRE(server->stopped);
+        REQUIRE(server->connected);
+        REQUIRE(server->disconnected);
+        REQUIRE(server->bytes_sent() == 3232);
+        REQUIRE(server->bytes_received() == 3200);
+        REQUIRE(!server->error);
+
+        // Check the Echo server statistics collected from all shards
+        Statistics statistics;
+        for (size_t i = 0; i < server->shards(); ++i)
+            statistics += server->statistics(i);
+        REQUIRE(statistics.bytes_sent == 3232);
+        REQUIRE(statistics.bytes_received == 3200);
+        REQUIRE(statistics.messages_sent == 0);
+        REQUIRE(statistics.messages_received == 0);
+
+        // Check sessions are bound to the shards which accepted them
+        if (policy == ShardPolicy::RoundRobin)
+            for (size_t i = 0; i < server->shards(); ++i)
+                REQUIRE(server->statistics(i).bytes_received == 800);
+
+        // Check the Echo clients state
+        for (auto& client : clients)
+        {
+            REQUIRE(client->bytes_sent() == 400);
+            REQUIRE(client->bytes_received() == 404);
+            REQUIRE(!client->error);
+        }
+    }
+}
+
+TEST_CASE("TCP server shared buffers", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1116;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client
+    auto client = std::make_shared<EchoTCPClient>(service, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Prepare shared buffers
+    SharedBuffer large(std::vector<uint8_t>(1000000, 'x'));
+    SharedBuffer header(std::string("header"));
+    SharedBuffer body("test", 4);
+    REQUIRE(large.size() == 1000000);
+    REQUIRE(header.Slice(0, 4).size() == 4);
+    REQUIRE(header.Slice(2, 4).data() == header.data() + 2);
+
+    // Send shared buffers to the Echo server
+    client->Send(large);
+    client->Send(large);
+    client->Send({ header, body, header.Slice(0, 4) });
+    client->Send("test");
+
+    // Wait for all data processed...
+    while (client->bytes_received() != 2000018)
+        Thread::Yield();
+
+    // Disconnect the Echo client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_sent() == 2000018);
+    REQUIRE(server->bytes_received() == 2000018);
+    REQUIRE(!server->error);
+
+    // Check the Echo client state
+    REQUIRE(client->bytes_sent() == 2000018);
+    REQUIRE(client->bytes_received() == 2000018);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server multiple producers", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1117;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client
+    auto client = std::make_shared<EchoTCPClient>(service, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send messages to the Echo server from several producer threads
+    std::vector<std::thread> producers;
+    for (int i = 0; i < 4; ++i)
+    {
+        producers.emplace_back(Thread::Start([client]()
+        {
+            for (int j = 0; j < 1000; ++j)
+                client->Send("test");
+        }));
+    }
+    for (auto& producer : producers)
+        producer.join();
+
+    // Wait for all data processed...
+    while (client->bytes_received() != 16000)
+        Thread::Yield();
+
+    // Disconnect the Echo client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_sent() == 16000);
+    REQUIRE(server->bytes_received() == 16000);
+    REQUIRE(!server->error);
+
+    // Check the Echo client state
+    REQUIRE(client->bytes_sent() == 16000);
+    REQUIRE(client->bytes_received() == 16000);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server find session", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1118;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo clients one by one to collect session keys
+    std::vector<std::shared_ptr<EchoTCPClient>> clients;
+    std::vector<uint64_t> keys;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        auto client = std::make_shared<EchoTCPClient>(service, address, port);
+        REQUIRE(client->Connect());
+        while (!client->IsConnected() || (server->clients != (i + 1)))
+            Thread::Yield();
+        clients.push_back(client);
+        keys.push_back(server->last_key);
+    }
+
+    // Check all connected sessions are found by their keys
+    for (auto key : keys)
+    {
+        auto session = server->FindSession(key);
+        REQUIRE(session);
+        REQUIRE(session->key() == key);
+    }
+    REQUIRE(keys[0] != keys[1]);
+    REQUIRE(keys[1] != keys[2]);
+    REQUIRE(!server->FindSession(0));
+    REQUIRE(!server->FindSession(keys[2] + 1));
+
+    // Disconnect the second Echo client
+    REQUIRE(clients[1]->Disconnect());
+    while (clients[1]->IsConnected() || server->FindSession(keys[1]))
+        Thread::Yield();
+
+    // Check the rest sessions are still found
+    REQUIRE(server->FindSession(keys[0]));
+    REQUIRE(server->FindSession(keys[2]));
+
+    // Disconnect all Echo clients
+    REQUIRE(server->DisconnectAll());
+    while (server->clients != 0)
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->started);
+    REQUIRE(server->stopped);
+    REQUIRE(server->connected);
+    REQUIRE(server->disconnected);
+    REQUIRE(!server->error);
+}
+
+TEST_CASE("TCP server id policy", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1119;
+
+    for (auto policy : { IdPolicy::Sequential, IdPolicy::ShardSequential, IdPolicy::UUID })
+    {
+        // Create and start Asio service for clients
+        auto service = std::make_shared<EchoTCPService>();
+        REQUIRE(service->Start());
+        while (!service->IsStarted())
+            Thread::Yield();
+
+        // Create and start Asio services for server shards
+        std::vector<std::shared_ptr<Service>> services;
+        for (int i = 0; i < 2; ++i)
+        {
+            auto shard_service = std::make_shared<EchoTCPService>();
+            REQUIRE(shard_service->Start());
+            while (!shard_service->IsStarted())
+                Thread::Yield();
+            services.emplace_back(shard_service);
+        }
+
+        // Create and start sharded Echo server with the given id policy
+        auto server = std::make_shared<EchoTCPServer>(services, InternetProtocol::IPv4, port, ShardPolicy::RoundRobin);
+        server->SetupIdPolicy(policy);
+        REQUIRE(server->id_policy() == policy);
+        REQUIRE(server->Start());
+        while (!server->IsStarted())
+            Thread::Yield();
+
+        // Create and connect Echo clients one by one to collect session keys
+        std::vector<std::shared_ptr<EchoTCPClient>> clients;
+        std::vector<uint64_t> keys;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            auto client = std::make_shared<EchoTCPClient>(service, address, port);
+            client->SetupIdPolicy(policy);
+            REQUIRE(client->Connect());
+            while (!client->IsConnected() || (server->clients != (i + 1)))
+                Thread::Yield();
+            clients.push_back(client);
+            keys.push_back(server->last_key);
+        }
+
+        // Check session keys and Ids
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            auto session = server->FindSession(keys[i]);
+            REQUIRE(session);
+            if (policy == IdPolicy::ShardSequential)
+                REQUIRE((((keys[i] >> SHARD_KEY_SHIFT) == 1) || ((keys[i] >> SHARD_KEY_SHIFT) == 2)));
+            else
+                REQUIRE((keys[i] >> SHARD_KEY_SHIFT) == 0);
+            if (policy == IdPolicy::UUID)
+            {
+                REQUIRE(session->id() != MakeId(keys[i]));
+                REQUIRE(clients[i]->id() != MakeId(clients[i]->key()));
+            }
+            else
+            {
+                REQUIRE(session->id() == MakeId(keys[i]));
+                REQUIRE(clients[i]->id() == MakeId(clients[i]->key()));
+            }
+            for (size_t j = 0; j < i; ++j)
+                REQUIRE(keys[i] != keys[j]);
+        }
+
+        // Disconnect all Echo clients
+        REQUIRE(server->DisconnectAll());
+        while (server->clients != 0)
+            Thread::Yield();
+
+        // Stop the Echo server
+        REQUIRE(server->Stop());
+        while (server->IsStarted())
+            Thread::Yield();
+
+        // Stop Asio services
+        for (auto& shard_service : services)
+        {
+            REQUIRE(shard_service->Stop());
+            while (shard_service->IsStarted())
+                Thread::Yield();
+        }
+        REQUIRE(service->Stop());
+        while (service->IsStarted())
+            Thread::Yield();
+
+        // Check the Echo server state
+        REQUIRE(!server->error);
+    }
+}
+
+TEST_CASE("TCP server idle receive", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1120;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server in the idle receive mode
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    server->SetupIdleReceive(true);
+    REQUIRE(server->idle_receive());
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client in the idle receive mode
+    auto client = std::make_shared<EchoTCPClient>(service, address, port);
+    client->SetupIdleReceive(true);
+    REQUIRE(client->idle_receive());
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Idle connections should not hold receive buffers
+    REQUIRE(service->buffer_pool().borrowed() == 0);
+
+    // Send small messages and a large one to grow receive buffers
+    for (int i = 0; i < 100; ++i)
+        client->Send("test");
+    std::vector<uint8_t> large(100000, 'x');
+    client->Send(large.data(), large.size());
+
+    // Wait for all data processed...
+    while (client->bytes_received() != (400 + large.size()))
+        Thread::Yield();
+
+    // Wait for all receive buffers returned into the pool
+    while (service->buffer_pool().borrowed() != 0)
+        Thread::Yield();
+    REQUIRE(service->buffer_pool().allocated() > 0);
+
+    // Disconnect the Echo client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_sent() == (400 + large.size()));
+    REQUIRE(server->bytes_received() == (400 + large.size()));
+    REQUIRE(!server->error);
+
+    // Check the Echo client state
+    REQUIRE(client->bytes_sent() == (400 + large.size()));
+    REQUIRE(client->bytes_received() == (400 + large.size()));
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server framing", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1121;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Framed server
+    auto server = std::make_shared<FramedTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Framed client
+    auto client = std::make_shared<FramedTCPClient>(service, address, port);
+    client->SetupFraming(2, ByteOrder::LittleEndian, 1000);
+    REQUIRE(client->framer().enabled());
+    REQUIRE(client->framer().prefix_size() == 2);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send framed messages to the Framed server
+    for (int i = 0; i < 100; ++i)
+        client->SendFrame("test");
+    client->SendFrame(std::string(1000, 'x'));
+
+    // Send a framed message split between several writes
+    const uint8_t prefix[] = { 4, 0 };
+    client->Send(prefix, 1);
+    client->Send(prefix + 1, 1);
+    client->Send("te");
+    client->Send("st");
+
+    // Wait for all messages echoed...
+    while (client->messages != 102)
+        Thread::Yield();
+    REQUIRE(client->message_bytes == 1404);
+    REQUIRE(client->bytes_received() == (1404 + 102 * 2));
+
+    // Reject a message which is larger than the maximal message size
+    REQUIRE(client->SendFrame(std::string(1001, 'x')) == 0);
+    REQUIRE(client->IsConnected());
+
+    // Reject a message which length does not fit the length prefix
+    MessageFramer framer;
+    framer.Setup(2, ByteOrder::LittleEndian, 65535);
+    uint8_t encoded[8];
+    REQUIRE(framer.Encode(65535, encoded) == 2);
+    REQUIRE(((encoded[0] == 0xFF) && (encoded[1] == 0xFF)));
+    REQUIRE(framer.Encode(70000, encoded) == 0);
+
+    // Send a raw message which is larger than the maximal message size
+    const uint8_t oversize[] = { 0xE9, 0x03 };
+    client->Send(oversize, sizeof(oversize));
+
+    // Wait for the Framed client disconnected by the session...
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+    REQUIRE(client->messages == 102);
+
+    // Stop the Framed server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+}
+
+TEST_CASE("TCP server send buffer watermarks", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1122;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server with limited send buffers
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    server->SetupSendBufferWatermarks(65536, 16384, SlowConsumerPolicy::Reject);
+    server->SetupSendBufferLimit(1048576);
+    REQUIRE(server->send_buffer_high() == 65536);
+    REQUIRE(server->send_buffer_low() == 16384);
+    REQUIRE(server->slow_consumer_policy() == SlowConsumerPolicy::Reject);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Connect a slow consumer which does not read anything
+    asio::ip::tcp::socket consumer(*service->service());
+    consumer.connect(asio::ip::tcp::endpoint(asio::ip::address::from_string(address), port));
+    while (server->clients != 1)
+        Thread::Yield();
+    auto session = server->FindSession(server->last_key);
+    REQUIRE(session);
+    REQUIRE(session->send_buffer_high() == 65536);
+
+    // Send data to the slow consumer until the send buffer is full
+    std::vector<uint8_t> data(1024, 'x');
+    size_t sent = 0;
+    while (session->Send(data.data(), data.size()) > 0)
+        sent += data.size();
+    while (!session->buffer_high)
+        Thread::Yield();
+    REQUIRE(server->send_buffer_size() <= 65536);
+
+    // Read all data to drain the send buffer
+    size_t received = 0;
+    while (received < sent)
+        received += consumer.read_some(asio::buffer(data.data(), data.size()));
+    REQUIRE(received == sent);
+    while (!session->buffer_low)
+        Thread::Yield();
+    REQUIRE(server->send_buffer_size() == 0);
+
+    // Disconnect the slow consumer
+    consumer.close();
+    while (server->clients != 0)
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_sent() == sent);
+    REQUIRE(!server->error);
+}
+
+TEST_CASE("TCP server socket options", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1123;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server with tuned socket options
+    SocketOptions server_options;
+    server_options.no_delay = 1;
+    server_options.receive_buffer_size = 65536;
+    server_options.keep_alive = 1;
+    server_options.keep_alive_idle = 60;
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    server->SetupSocketOptions(server_options);
+    REQUIRE(server->socket_options().no_delay == 1);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client with tuned socket options
+    SocketOptions client_options;
+    client_options.no_delay = 1;
+    client_options.keep_alive = 1;
+    auto client = std::make_shared<EchoTCPClient>(service, address, port);
+    client->SetupSocketOptions(client_options);
+    REQUIRE(!client->socket_options().empty());
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Check socket options of the client and the accepted session
+    asio::ip::tcp::no_delay no_delay;
+    asio::socket_base::keep_alive keep_alive;
+    client->socket().get_option(no_delay);
+    client->socket().get_option(keep_alive);
+    REQUIRE(no_delay.value());
+    REQUIRE(keep_alive.value());
+    auto session = server->FindSession(server->last_key);
+    REQUIRE(session);
+    session->socket().get_option(no_delay);
+    session->socket().get_option(keep_alive);
+    REQUIRE(no_delay.value());
+    REQUIRE(keep_alive.value());
+
+    // Send a message to the Echo server
+    client->Send("test");
+
+    // Wait for all data processed...
+    while (client->bytes_received() != 4)
+        Thread::Yield();
+
+    // Disconnect the Echo client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server speculative I/O", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1124;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server with speculative I/O
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    server->SetupSpeculativeIO(true);
+    REQUIRE(server->speculative_io());
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client with speculative I/O
+    auto client = std::make_shared<EchoTCPClient>(service, address, port);
+    client->SetupSpeculativeIO(true);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+    auto session = server->FindSession(server->last_key);
+    REQUIRE(session);
+    REQUIRE(session->speculative_io());
+
+    // Send small and large messages to the Echo server
+    const size_t large = 4 * 1024 * 1024;
+    for (int i = 0; i < 1000; ++i)
+        client->Send("test");
+    client->Send(std::string(large, 'x'));
+
+    // Wait for all data processed...
+    while (client->bytes_received() != (4000 + large))
+        Thread::Yield();
+
+    // Disconnect the Echo client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_sent() == (4000 + large));
+    REQUIRE(server->bytes_received() == (4000 + large));
+    REQUIRE(!server->error);
+
+    // Check the Echo client state
+    REQUIRE(client->bytes_sent() == (4000 + large));
+    REQUIRE(client->bytes_received() == (4000 + large));
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server send file", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1125;
+
+    // Create a test file
+    const std::string path = "test_tcp_send_file.tmp";
+    std::string content;
+    for (int i = 0; i < 100000; ++i)
+        content += std::to_string(i);
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+    }
+    SharedFile file(path);
+    REQUIRE(file);
+    REQUIRE(file.size() == content.size());
+    REQUIRE(!SharedFile("test_tcp_send_file.missing"));
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect File client
+    auto client = std::make_shared<FileTCPClient>(service, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send the file region between other data to the Echo server
+    client->Send("head");
+    REQUIRE(client->SendFile(path, 10, 100000) > 0);
+    client->Send("tail");
+    REQUIRE(client->SendFile("test_tcp_send_file.missing") == 0);
+
+    // Wait for all data echoed in order...
+    std::string expected = "head" + content.substr(10, 100000) + "tail";
+    while (client->received != expected.size())
+        Thread::Yield();
+    REQUIRE(client->data == expected);
+
+    // Send the whole file from the session
+    auto session = server->FindSession(server->last_key);
+    REQUIRE(session);
+    REQUIRE(session->SendFile(file) == content.size());
+
+    // Wait for the whole file received...
+    expected += content;
+    while (client->received != expected.size())
+        Thread::Yield();
+    REQUIRE(client->data == expected);
+
+    // Disconnect the File client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_received() == 100008);
+    REQUIRE(server->bytes_sent() == (100008 + content.size()));
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("TCP server zero copy", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1126;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect File client with zero copy sends
+    auto client = std::make_shared<FileTCPClient>(service, address, port);
+    client->SetupZeroCopy(64 * 1024);
+    REQUIRE(client->zero_copy() == 64 * 1024);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send large buffers between small ones to the Echo server
+    std::string expected;
+    for (int i = 0; i < 16; ++i)
+    {
+        std::string small = std::to_string(i);
+        std::string large(1024 * 1024, (char)('a' + i));
+        client->Send(small);
+        client->Send(SharedBuffer(large));
+        expected += small + large;
+    }
+
+    // Wait for all data echoed in order...
+    while (client->received != expected.size())
+        Thread::Yield();
+    REQUIRE(client->data == expected);
+
+    // Disconnect the File client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_received() == expected.size());
+    REQUIRE(server->bytes_sent() == expected.size());
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server zero copy linger", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1135;
+
+    // Create and start Asio service with the fine timing wheel
+    auto service = std::make_shared<EchoTCPService>();
+    service->SetupTimingWheel(10);
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create the slow peer with the small receive buffer
+    asio::io_service io_service;
+    asio::ip::tcp::acceptor acceptor(io_service, asio::ip::tcp::endpoint(asio::ip::address::from_string(address), port));
+    acceptor.set_option(asio::socket_base::receive_buffer_size(4096));
+    asio::ip::tcp::socket peer(io_service);
+
+    // Create and connect File client with zero copy sends
+    auto client = std::make_shared<FileTCPClient>(service, address, port);
+    client->SetupZeroCopy(64 * 1024);
+    REQUIRE(client->Connect());
+    acceptor.accept(peer);
+    while (!client->IsConnected())
+        Thread::Yield();
+
+    // Check the kernel supports zero copy sends
+    ZeroCopy probe;
+    probe.Setup(1);
+    bool supported = probe.Open(peer);
+
+    // Send the large buffer which cannot be transmitted until the peer reads it
+    std::string large(8 * 1024 * 1024, 'z');
+    client->Send(large);
+    Thread::Sleep(100);
+
+    // Disconnect the File client with zero copy sends still in flight
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected())
+        Thread::Yield();
+
+    // Check buffers of zero copy sends linger in the service
+    if (supported)
+        REQUIRE(service->zero_copy_lingering() == 1);
+
+    // Read all transmitted data till the end of the stream
+    std::vector<char> buffer(64 * 1024);
+    size_t received = 0;
+    bool corrupted = false;
+    asio::error_code ec;
+    for (;;)
+    {
+        size_t size = peer.read_some(asio::buffer(buffer), ec);
+        if (ec)
+            break;
+        corrupted |= std::any_of(buffer.begin(), buffer.begin() + size, [](char ch) { return ch != 'z'; });
+        received += size;
+    }
+    REQUIRE(ec == asio::error::eof);
+    REQUIRE(received == client->bytes_sent());
+    REQUIRE(received > 0);
+    REQUIRE(!corrupted);
+
+    // Check lingering sockets are closed after all completions
+    while (service->zero_copy_lingering() != 0)
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server receive ring", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1127;
+
+    // Check the ring data wrapped around the end of the ring is contiguous
+    RingBuffer ring;
+    ring.Setup(1);
+    REQUIRE(ring.capacity() >= 1);
+    size_t capacity = ring.capacity();
+    REQUIRE(asio::buffer_size(ring.Prepare()) == capacity);
+    ring.Commit(capacity);
+    REQUIRE(ring.full());
+    ring.Consume(capacity - 1);
+    asio::mutable_buffer space = ring.Prepare();
+    REQUIRE(asio::buffer_size(space) == (capacity - 1));
+    std::memset(asio::buffer_cast<void*>(space), 'x', 2);
+    ring.Commit(2);
+    REQUIRE(ring.size() == 3);
+    REQUIRE(ring.data()[1] == 'x');
+    REQUIRE(ring.data()[2] == 'x');
+    ring.Consume(3);
+    REQUIRE(ring.empty());
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Ring client
+    auto client = std::make_shared<RingTCPClient>(service, address, port);
+    REQUIRE(client->receive_ring() >= 4096);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send records which do not fit the receive ring evenly
+    for (size_t i = 0; i < 1000; ++i)
+        client->Send(std::string(RingTCPClient::RECORD, (char)('a' + i % 26)));
+
+    // Wait for all records echoed...
+    while (client->records != 1000)
+        Thread::Yield();
+    REQUIRE(!client->invalid);
+
+    // Disconnect the Ring client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_received() == 1000 * RingTCPClient::RECORD);
+    REQUIRE(server->bytes_sent() == 1000 * RingTCPClient::RECORD);
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server cork", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1128;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Cork client
+    auto client = std::make_shared<CorkTCPClient>(service, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send a multi-part response with nested corks
+    client->Cork();
+    client->Cork();
+    REQUIRE(client->corked());
+    client->Send("header;");
+    client->Send(SharedBuffer(std::string(10000, 'b')));
+    client->Uncork();
+    REQUIRE(client->corked());
+    client->Send(";trailer");
+    std::string expected = "header;" + std::string(10000, 'b') + ";trailer";
+
+    // Check nothing is written while the client is corked
+    Thread::Sleep(100);
+    REQUIRE(client->bytes_sent() == 0);
+    REQUIRE(client->writes == 0);
+
+    // Uncork the client and check all parts are written at once
+    client->Uncork();
+    REQUIRE(!client->corked());
+    while (client->received != expected.size())
+        Thread::Yield();
+    REQUIRE(client->data == expected);
+    REQUIRE(client->bytes_sent() == expected.size());
+    REQUIRE(client->writes == 1);
+
+    // Disconnect the Cork client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_received() == expected.size());
+    REQUIRE(server->bytes_sent() == expected.size());
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server session pool", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1129;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server with the session pool
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    server->SetupSessionPool(2);
+    REQUIRE(server->session_pool() == 2);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Connect and disconnect clients one by one
+    for (int i = 0; i < 10; ++i)
+    {
+        auto client = std::make_shared<FileTCPClient>(service, address, port);
+        REQUIRE(client->Connect());
+        while (!client->IsConnected() || (server->clients != 1))
+            Thread::Yield();
+
+        // Check the echo from the new or reused session
+        client->Send("test");
+        while (client->received != 4)
+            Thread::Yield();
+        REQUIRE(client->data == "test");
+
+        REQUIRE(client->Disconnect());
+        while (client->IsConnected() || (server->clients != 0))
+            Thread::Yield();
+        REQUIRE(!client->error);
+
+        // Wait for the released session returned into the session pool
+        Thread::Sleep(10);
+    }
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->recycled > 0);
+    REQUIRE(server->bytes_received() == 40);
+    REQUIRE(server->bytes_sent() == 40);
+    REQUIRE(!server->error);
+}
+
+TEST_CASE("TCP server session pool stale sends", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1134;
+
+    // Create and start Asio service
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server with the session pool and the counted send buffers
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    server->SetupSessionPool(1);
+    server->SetupSendBufferLimit(1024 * 1024 * 1024);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        auto client = std::make_shared<FileTCPClient>(service, address, port);
+        REQUIRE(client->Connect());
+        while (!client->IsConnected() || (server->clients != 1))
+            Thread::Yield();
+
+        // Send data from a foreign thread while the server disconnects the session
+        auto session = server->FindSession(server->last_key);
+        REQUIRE(session);
+        std::atomic<bool> stop(false);
+        std::thread producer([&session, &stop]()
+        {
+            while (!stop)
+                session->Send("stale");
+        });
+        session->Disconnect();
+        while (client->IsConnected() || (server->clients != 0))
+            Thread::Yield();
+        stop = true;
+        producer.join();
+
+        // Release the last reference to return the session into the session pool
+        session.reset();
+        Thread::Sleep(10);
+        REQUIRE(server->send_buffer_size() == 0);
+
+        // The next client should receive only the echo of its own data
+        auto next = std::make_shared<FileTCPClient>(service, address, port);
+        REQUIRE(next->Connect());
+        while (!next->IsConnected() || (server->clients != 1))
+            Thread::Yield();
+        next->Send("test");
+        while (next->received != 4)
+            Thread::Yield();
+        Thread::Sleep(10);
+        REQUIRE(next->data == "test");
+
+        REQUIRE(next->Disconnect());
+        while (next->IsConnected() || (server->clients != 0))
+            Thread::Yield();
+        Thread::Sleep(10);
+    }
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->recycled > 0);
+    REQUIRE(!server->error);
+}
+
+TEST_CASE("TCP server service instrumentation", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1130;
+
+    // Create and start instrumented Asio service
+    auto service = std::make_shared<EchoTCPService>(2);
+    REQUIRE(!service->instrumentation());
+    service->SetupInstrumentation(true, 10);
+    REQUIRE(service->instrumentation());
+    REQUIRE(service->probe_interval() == 10);
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client
+    auto client = std::make_shared<FileTCPClient>(service, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Send some messages and wait for several loop lag probes
+    for (int i = 0; i < 100; ++i)
+    {
+        client->Send("test");
+        while (client->received != (size_t)(4 * (i + 1)))
+            Thread::Yield();
+    }
+    Thread::Sleep(100);
+
+    // Disconnect the Echo client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Asio service statistics
+    ServiceStatistics statistics = service->statistics();
+    REQUIRE(statistics.threads.size() == 2);
+    REQUIRE(statistics.total.handlers() >= 200);
+    REQUIRE(statistics.total.busy_time > 0);
+    REQUIRE(statistics.total.idle_time > 0);
+    REQUIRE(statistics.total.utilization() < 1.0);
+    REQUIRE(statistics.total.queue_depth.count() > 0);
+    REQUIRE(statistics.total.loop_lag.count() > 0);
+    REQUIRE(statistics.total.handler_time.Percentile(50.0) <= statistics.total.handler_time.max());
+    REQUIRE(statistics.threads[0].handlers() + statistics.threads[1].handlers() == statistics.total.handlers());
+    REQUIRE(!service->error);
+    REQUIRE(!client->error);
+
+    // Check the service histogram buckets
+    for (uint64_t value : { 0ull, 1ull, 7ull, 8ull, 100ull, 1000000ull, 0xFFFFFFFFFFFFFFFFull })
+    {
+        size_t index = ServiceHistogram::Index(value);
+        REQUIRE(index < (size_t)ServiceHistogram::BUCKETS);
+        REQUIRE(ServiceHistogram::Highest(index) >= value);
+        REQUIRE(ServiceHistogram::Highest(index) - value <= value / 4);
+    }
+}
+
+TEST_CASE("TCP server adaptive polling", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1131;
+
+    // Create and start Asio service in the adaptive polling mode
+    auto service = std::make_shared<EchoTCPService>(2);
+    service->SetupAdaptivePolling(1000);
+    REQUIRE(service->spin_budget() == 1000);
+    REQUIRE(service->Start(true));
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoTCPServer>(service, InternetProtocol::IPv4, port);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client
+    auto client = std::make_shared<FileTCPClient>(service, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Check the idle handler is called while working threads spin
+    client->Send("test");
+    while (client->received != 4)
+        Thread::Yield();
+    REQUIRE(service->idle);
+
+    // Check the idle handler is not called while working threads are blocked
+    Thread::Sleep(100);
+    service->idle = false;
+    Thread::Sleep(100);
+    REQUIRE(!service->idle);
+
+    // Check blocked working threads wake up to handle new messages
+    client->Send("test");
+    while (client->received != 8)
+        Thread::Yield();
+    REQUIRE(client->data == "testtest");
+
+    // Disconnect the Echo client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop the Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_received() == 8);
+    REQUIRE(server->bytes_sent() == 8);
+    REQUIRE(!service->error);
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server pinned services", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1132;
+
+    // Check CPU core sets of physical cores
+    auto cores = Service::PhysicalCores();
+    REQUIRE(!cores.empty());
+    std::set<int> logical;
+    for (auto& core : cores)
+    {
+        REQUIRE(!core.empty());
+        for (int i : core)
+            REQUIRE(logical.insert(i).second);
+    }
+
+    // Create and start Asio service for clients
+    auto service = std::make_shared<EchoTCPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start pinned Asio services for server shards
+    auto services = Service::CreatePinned();
+    REQUIRE(services.size() == cores.size());
+    for (size_t i = 0; i < services.size(); ++i)
+    {
+        REQUIRE(services[i]->affinity().size() == 1);
+        REQUIRE(services[i]->affinity()[0] == cores[i]);
+        REQUIRE(services[i]->Start());
+        while (!services[i]->IsStarted())
+            Thread::Yield();
+    }
+
+    // Check pinned working threads use their local buffer pools
+    std::atomic<BufferPool*> local(nullptr);
+    services[0]->Post([&services, &local]() { local = &services[0]->buffer_pool(); });
+    while (local == nullptr)
+        Thread::Yield();
+    REQUIRE(local != &services[0]->buffer_pool());
+
+    // Create and start sharded Echo server
+    auto server = std::make_shared<EchoTCPServer>(services, InternetProtocol::IPv4, port, ShardPolicy::RoundRobin);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client
+    auto client = std::make_shared<FileTCPClient>(service, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Check the echo from the pinned service
+    client->Send("test");
+    while (client->received != 4)
+        Thread::Yield();
+    REQUIRE(client->data == "test");
+
+    // Check session receive buffers are lent from the local buffer pool
+    REQUIRE(services[0]->buffer_pool().borrowed() == 0);
+    REQUIRE(local.load()->allocated() > 0);
+
+    // Disconnect the Echo client
+    REQUIRE(client->Disconnect());
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop Asio services
+    for (auto& pinned : services)
+    {
+        REQUIRE(pinned->Stop());
+        while (pinned->IsStarted())
+            Thread::Yield();
+    }
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->bytes_received() == 4);
+    REQUIRE(server->bytes_sent() == 4);
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+}
+
+TEST_CASE("TCP server handler storage", "[CppServer][Asio]")
+{
+    HandlerStorage storage;
+    REQUIRE(storage.size() == 0);
+    REQUIRE(!storage.in_use());
+
+    // Check the memory block grows for the larger operation
+    void* first = storage.allocate(100);
+    REQUIRE(storage.in_use());
+    REQUIRE(storage.size() == 100);
+    storage.deallocate(first);
+    REQUIRE(!storage.in_use());
+    void* second = storage.allocate(200);
+    REQUIRE(storage.size() == 200);
+    storage.deallocate(second);
+
+    // Check the memory block is recycled for smaller operations
+    void* third = storage.allocate(50);
+    REQUIRE(third == second);
+    REQUIRE(storage.size() == 200);
+
+    // Check the heap fallback while the storage is in use
+    void* fourth = storage.allocate(50);
+    REQUIRE(fourth != third);
+    storage.deallocate(fourth);
+    REQUIRE(storage.in_use());
+    storage.deallocate(third);
+    REQUIRE(!storage.in_use());
+}
+
+TEST_CASE("TCP server timing wheel", "[CppServer][Asio]")
+{
+    TimingWheel wheel(10);
+    std::vector<int> expired;
+    TimingWheel::Timer first([&expired]() { expired.push_back(1); });
+    TimingWheel::Timer second([&expired]() { expired.push_back(2); });
+    TimingWheel::Timer third([&expired]() { expired.push_back(3); });
+
+    // Check timers of different levels expire at their deadlines
+    wheel.Arm(first, 15);
+    wheel.Arm(second, 10 + 300);
+    wheel.Arm(third, 10 + 70000);
+    REQUIRE(wheel.size() == 3);
+    REQUIRE(wheel.Advance(14) == 0);
+    REQUIRE(wheel.Advance(15) == 1);
+    REQUIRE(!first.armed());
+    REQUIRE(wheel.Advance(309) == 0);
+    REQUIRE(wheel.Advance(310) == 1);
+    REQUIRE(wheel.Advance(70009) == 0);
+    REQUIRE(wheel.Advance(70010) == 1);
+    REQUIRE(expired == std::vector<int>({ 1, 2, 3 }));
+    REQUIRE(wheel.empty());
+
+    // Check re-armed and canceled timers
+    expired.clear();
+    wheel.Arm(first, 70100);
+    wheel.Arm(second, 70100);
+    wheel.Arm(first, 70200);
+    REQUIRE(wheel.Cancel(second));
+    REQUIRE(!wheel.Cancel(second));
+    REQUIRE(wheel.Advance(70150) == 0);
+    REQUIRE(wheel.Advance(70200) == 1);
+    REQUIRE(expired == std::vector<int>({ 1 }));
+
+    // Check expired deadlines and re-armed timers from the expiration handler
+    expired.clear();
+    wheel.Arm(first, 0);
+    REQUIRE(first.deadline() == 70201);
+    second.Setup([&wheel, &second, &expired]() { expired.push_back(2); if (expired.size() < 4) wheel.Arm(second, wheel.now() + 100000); });
+    wheel.Arm(second, 70300);
+    REQUIRE(wheel.Advance(70201) == 1);
+    REQUIRE(wheel.Advance(70300) == 1);
+    REQUIRE(wheel.Advance(170299) == 0);
+    REQUIRE(wheel.Advance(270300) == 2);
+    REQUIRE(expired == std::vector<int>({ 1, 2, 2, 2 }));
+
+    // Check the empty wheel jumps to the given tick
+    REQUIRE(wheel.Advance(1ull << 40) == 0);
+    REQUIRE(wheel.now() == (1ull << 40));
+}
+
+TEST_CASE("TCP server idle timeouts", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 1133;
+
+    // Create and start Asio service with the fine timing wheel
+    auto service = std::make_shared<EchoTCPService>();
+    service->SetupTimingWheel(10);
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Echo server with idle timeouts
+    auto server = std::make_shared<HeartbeatTCPServer>(service, InternetProtocol::IPv4, port);
+    server->SetupIdleTimeouts(300, 50);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo client
+    auto client = std::make_shared<FileTCPClient>(service, address, port);
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+
+    // Check the silent client gets heartbeats and is disconnected after the read idle timeout
+    while (client->IsConnected() || (server->clients != 0))
+        Thread::Yield();
+    REQUIRE(server->read_idle == 1);
+    REQUIRE(server->write_idle >= 3);
+    REQUIRE(client->received > 0);
+
+    // Restart the Echo server with the session lifetime
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+    server->SetupIdleTimeouts(300, 0, 600);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Check the active client is kept connected until its lifetime
+    REQUIRE(client->Connect());
+    while (!client->IsConnected() || (server->clients != 1))
+        Thread::Yield();
+    while (client->IsConnected())
+    {
+        client->Send("test");
+        Thread::Sleep(10);
+    }
+    while (server->clients != 0)
+        Thread::Yield();
+    REQUIRE(server->read_idle == 1);
+    REQUIRE(server->lifetime == 1);
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop Asio service
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(!server->error);
+    REQUIRE(!client->error);
+}
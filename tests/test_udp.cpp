@@ -80,6 +80,14 @@ public:
     {
     }
 
+    explicit EchoUDPServer(const std::vector<std::shared_ptr<Service>>& services, InternetProtocol protocol, int port)
+        : UDPServer(services, protocol, port),
+          started(false),
+          stopped(false),
+          error(false)
+    {
+    }
+
 protected:
     void onStarted() override { started = true; }
     void onStopped() override { stopped = true; }
@@ -264,3 +272,86 @@ TEST_CASE("UDP server random test", "[CppServer][Asio]")
     REQUIRE(server->bytes_received() > 0);
     REQUIRE(!server->error);
 }
+
+TEST_CASE("UDP server multiple receivers", "[CppServer][Asio]")
+{
+    const std::string address = "127.0.0.1";
+    const int port = 2226;
+
+    // Create and start Asio service for clients
+    auto service = std::make_shared<EchoUDPService>();
+    REQUIRE(service->Start());
+    while (!service->IsStarted())
+        Thread::Yield();
+
+    // Create and start Asio services for server receivers
+    std::vector<std::shared_ptr<Service>> services;
+    for (int i = 0; i < 4; ++i)
+    {
+        auto receiver_service = std::make_shared<EchoUDPService>();
+        REQUIRE(receiver_service->Start());
+        while (!receiver_service->IsStarted())
+            Thread::Yield();
+        services.emplace_back(receiver_service);
+    }
+
+    // Create and start Echo server
+    auto server = std::make_shared<EchoUDPServer>(services, InternetProtocol::IPv4, port);
+    REQUIRE(server->receivers() == 4);
+    REQUIRE(server->Start());
+    while (!server->IsStarted())
+        Thread::Yield();
+
+    // Create and connect Echo clients
+    std::vector<std::shared_ptr<EchoUDPClient>> clients;
+    for (int i = 0; i < 8; ++i)
+    {
+        auto client = std::make_shared<EchoUDPClient>(service, address, port);
+        REQUIRE(client->Connect());
+        while (!client->IsConnected())
+            Thread::Yield();
+        clients.emplace_back(client);
+    }
+
+    // Send a message to the Echo server from all clients
+    for (auto& client : clients)
+        client->Send("test");
+
+    // Wait for all data processed...
+    for (auto& client : clients)
+        while (client->bytes_received() != 4)
+            Thread::Yield();
+
+    // Disconnect Echo clients
+    for (auto& client : clients)
+    {
+        REQUIRE(client->Disconnect());
+        while (client->IsConnected())
+            Thread::Yield();
+    }
+
+    // Stop the Echo server
+    REQUIRE(server->Stop());
+    while (server->IsStarted())
+        Thread::Yield();
+
+    // Stop Asio services
+    for (auto& receiver_service : services)
+    {
+        REQUIRE(receiver_service->Stop());
+        while (receiver_service->IsStarted())
+            Thread::Yield();
+    }
+    REQUIRE(service->Stop());
+    while (service->IsStarted())
+        Thread::Yield();
+
+    // Check the Echo server state
+    REQUIRE(server->started);
+    REQUIRE(server->stopped);
+    REQUIRE(server->datagrams_sent() == 8);
+    REQUIRE(server->datagrams_received() == 8);
+    REQUIRE(server->bytes_sent() == 32);
+    REQUIRE(server->bytes_received() == 32);
+    REQUIRE(!server->error);
+}